@@ -0,0 +1,301 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "alloc_txn.h"
+
+#include "allocation.h"
+#include "log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Stages class of service definition
+ *
+ * Definition replaces one staged earlier for the same technology,
+ * resource id and class of service.
+ *
+ * @param [in,out] txn allocation transaction
+ * @param [in] entry definition to be staged
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+alloc_txn_stage(struct pqos_alloc_txn *txn, const struct alloc_txn_entry *entry)
+{
+        unsigned i;
+
+        for (i = 0; i < txn->num_entries; i++) {
+                struct alloc_txn_entry *e = &txn->entries[i];
+
+                if (e->technology == entry->technology &&
+                    e->res_id == entry->res_id &&
+                    e->class_id == entry->class_id) {
+                        *e = *entry;
+                        return PQOS_RETVAL_OK;
+                }
+        }
+
+        if (txn->num_entries == txn->max_entries) {
+                unsigned max = txn->max_entries > 0 ? txn->max_entries * 2 : 16;
+                struct alloc_txn_entry *entries;
+
+                entries = realloc(txn->entries, sizeof(*entries) * max);
+                if (entries == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+
+                txn->entries = entries;
+                txn->max_entries = max;
+        }
+
+        txn->entries[txn->num_entries++] = *entry;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Checks if transaction accepts new definitions
+ *
+ * @param [in] txn allocation transaction
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK if definitions can be staged
+ */
+static int
+alloc_txn_check_open(const struct pqos_alloc_txn *txn)
+{
+        if (txn->committed) {
+                LOG_ERROR("Allocation transaction already committed!\n");
+                return PQOS_RETVAL_PARAM;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Compares class ids for qsort()
+ */
+static int
+alloc_txn_cmp_class(const void *a, const void *b)
+{
+        const unsigned class_a = *(const unsigned *)a;
+        const unsigned class_b = *(const unsigned *)b;
+
+        if (class_a < class_b)
+                return -1;
+        if (class_a > class_b)
+                return 1;
+        return 0;
+}
+
+unsigned *
+alloc_txn_classes(const struct pqos_alloc_txn *txn, unsigned *count)
+{
+        unsigned *classes;
+        unsigned i, num = 0;
+
+        ASSERT(txn != NULL);
+        ASSERT(count != NULL);
+
+        if (txn->num_entries == 0)
+                return NULL;
+
+        classes = malloc(sizeof(*classes) * txn->num_entries);
+        if (classes == NULL)
+                return NULL;
+
+        for (i = 0; i < txn->num_entries; i++)
+                classes[i] = txn->entries[i].class_id;
+        qsort(classes, txn->num_entries, sizeof(*classes), alloc_txn_cmp_class);
+
+        for (i = 0; i < txn->num_entries; i++)
+                if (num == 0 || classes[num - 1] != classes[i])
+                        classes[num++] = classes[i];
+
+        *count = num;
+        return classes;
+}
+
+int
+alloc_txn_failed_add(struct pqos_alloc_txn *txn, const unsigned class_id)
+{
+        unsigned i;
+        unsigned *failed;
+
+        ASSERT(txn != NULL);
+
+        for (i = 0; i < txn->num_failed; i++)
+                if (txn->failed[i] == class_id)
+                        return PQOS_RETVAL_OK;
+
+        failed = realloc(txn->failed, sizeof(*failed) * (txn->num_failed + 1));
+        if (failed == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        failed[txn->num_failed++] = class_id;
+        txn->failed = failed;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_alloc_txn_begin(struct pqos_alloc_txn **txn)
+{
+        if (txn == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        *txn = calloc(1, sizeof(**txn));
+        if (*txn == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_alloc_txn_l3ca_set(struct pqos_alloc_txn *txn,
+                        const unsigned l3cat_id,
+                        const unsigned num_cos,
+                        const struct pqos_l3ca *ca)
+{
+        int ret;
+        unsigned i;
+
+        if (txn == NULL || ca == NULL || num_cos == 0)
+                return PQOS_RETVAL_PARAM;
+
+        ret = alloc_txn_check_open(txn);
+        for (i = 0; i < num_cos && ret == PQOS_RETVAL_OK; i++) {
+                struct alloc_txn_entry entry;
+
+                memset(&entry, 0, sizeof(entry));
+                entry.technology = PQOS_TECHNOLOGY_L3CA;
+                entry.res_id = l3cat_id;
+                entry.class_id = ca[i].class_id;
+                entry.u.l3ca = ca[i];
+
+                ret = alloc_txn_stage(txn, &entry);
+        }
+
+        return ret;
+}
+
+int
+pqos_alloc_txn_l2ca_set(struct pqos_alloc_txn *txn,
+                        const unsigned l2id,
+                        const unsigned num_cos,
+                        const struct pqos_l2ca *ca)
+{
+        int ret;
+        unsigned i;
+
+        if (txn == NULL || ca == NULL || num_cos == 0)
+                return PQOS_RETVAL_PARAM;
+
+        ret = alloc_txn_check_open(txn);
+        for (i = 0; i < num_cos && ret == PQOS_RETVAL_OK; i++) {
+                struct alloc_txn_entry entry;
+
+                memset(&entry, 0, sizeof(entry));
+                entry.technology = PQOS_TECHNOLOGY_L2CA;
+                entry.res_id = l2id;
+                entry.class_id = ca[i].class_id;
+                entry.u.l2ca = ca[i];
+
+                ret = alloc_txn_stage(txn, &entry);
+        }
+
+        return ret;
+}
+
+int
+pqos_alloc_txn_mba_set(struct pqos_alloc_txn *txn,
+                       const unsigned mba_id,
+                       const unsigned num_cos,
+                       const struct pqos_mba *requested)
+{
+        int ret;
+        unsigned i;
+
+        if (txn == NULL || requested == NULL || num_cos == 0)
+                return PQOS_RETVAL_PARAM;
+
+        ret = alloc_txn_check_open(txn);
+        for (i = 0; i < num_cos && ret == PQOS_RETVAL_OK; i++) {
+                struct alloc_txn_entry entry;
+
+                memset(&entry, 0, sizeof(entry));
+                entry.technology = requested[i].smba ? PQOS_TECHNOLOGY_SMBA
+                                                     : PQOS_TECHNOLOGY_MBA;
+                entry.res_id = mba_id;
+                entry.class_id = requested[i].class_id;
+                entry.u.mba = requested[i];
+
+                ret = alloc_txn_stage(txn, &entry);
+        }
+
+        return ret;
+}
+
+int
+pqos_alloc_txn_get_failed(const struct pqos_alloc_txn *txn,
+                          const unsigned max_num_cos,
+                          unsigned *num_cos,
+                          unsigned *class_ids)
+{
+        if (txn == NULL || num_cos == NULL || class_ids == NULL ||
+            max_num_cos == 0)
+                return PQOS_RETVAL_PARAM;
+
+        if (txn->num_failed > max_num_cos)
+                return PQOS_RETVAL_ERROR;
+
+        if (txn->num_failed > 0)
+                memcpy(class_ids, txn->failed,
+                       sizeof(*class_ids) * txn->num_failed);
+        *num_cos = txn->num_failed;
+
+        return PQOS_RETVAL_OK;
+}
+
+void
+pqos_alloc_txn_end(struct pqos_alloc_txn *txn)
+{
+        if (txn == NULL)
+                return;
+
+        if (txn->entries != NULL)
+                free(txn->entries);
+        if (txn->failed != NULL)
+                free(txn->failed);
+        free(txn);
+}
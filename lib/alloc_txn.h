@@ -0,0 +1,104 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Staged allocation configuration
+ *
+ * Allocation settings of several technologies and resource ids are
+ * collected in a transaction and applied together on commit.
+ */
+
+#ifndef __PQOS_ALLOC_TXN_H__
+#define __PQOS_ALLOC_TXN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pqos.h"
+#include "types.h"
+
+/**
+ * Single staged class of service definition
+ */
+struct alloc_txn_entry {
+        unsigned technology; /**< PQOS_TECHNOLOGY_* of the definition */
+        unsigned res_id;     /**< L3 cat, L2, MBA or SMBA id */
+        unsigned class_id;   /**< class of service */
+        union {
+                struct pqos_l3ca l3ca;
+                struct pqos_l2ca l2ca;
+                struct pqos_mba mba; /**< MBA and SMBA */
+        } u;
+};
+
+/**
+ * Allocation transaction
+ */
+struct pqos_alloc_txn {
+        unsigned num_entries;            /**< number of staged definitions */
+        unsigned max_entries;            /**< capacity of \a entries */
+        struct alloc_txn_entry *entries; /**< staged definitions */
+        int committed;                   /**< set once commit was attempted */
+        unsigned num_failed;             /**< number of failed classes */
+        unsigned *failed;                /**< classes failed on commit */
+};
+
+/**
+ * @brief Lists classes of service with staged definitions
+ *
+ * @param [in] txn allocation transaction
+ * @param [out] count number of classes in the returned list
+ *
+ * @return Sorted list of class ids, to be freed by the caller
+ * @retval NULL on error or if nothing is staged
+ */
+PQOS_LOCAL unsigned *alloc_txn_classes(const struct pqos_alloc_txn *txn,
+                                       unsigned *count);
+
+/**
+ * @brief Records class of service that failed to be configured on commit
+ *
+ * @param [in,out] txn allocation transaction
+ * @param [in] class_id class of service
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int alloc_txn_failed_add(struct pqos_alloc_txn *txn,
+                                    const unsigned class_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_ALLOC_TXN_H__ */
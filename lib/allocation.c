@@ -47,6 +47,7 @@
 #include "iordt.h"
 #include "log.h"
 #include "machine.h"
+#include "msr_shadow.h"
 #include "os_allocation.h"
 
 #include <inttypes.h>
@@ -87,13 +88,12 @@
 int
 hw_alloc_assoc_read(const unsigned lcore, unsigned *class_id)
 {
-        const uint32_t reg = PQOS_MSR_ASSOC;
         uint64_t val = 0;
 
         if (class_id == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        if (msr_read(lcore, reg, &val) != MACHINE_RETVAL_OK)
+        if (msr_shadow_assoc_read(lcore, &val) != PQOS_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
         val >>= PQOS_MSR_ASSOC_QECOS_SHIFT;
@@ -102,6 +102,81 @@ hw_alloc_assoc_read(const unsigned lcore, unsigned *class_id)
         return PQOS_RETVAL_OK;
 }
 
+/**
+ * @brief Marks classes of service used in requested domains based on
+ *        cached core association
+ *
+ * Gives the same result as scanning association of the domain cores.
+ *
+ * @param [in] type domain type of \a dom_id
+ * @param [in] dom_id L3 CAT, MBA or SMBA resource id
+ * @param [in] num_dom_set number of L3 CAT, MBA and SMBA resource ids
+ *             requested
+ * @param [in] l2cat_id_set L2 CAT resource id requested
+ * @param [in] l2cat_id L2 CAT resource id
+ * @param [in] num_cos number of classes of service to check
+ * @param [in] num_l3_cos number of L3 CAT classes of service
+ * @param [in] num_mba_cos number of MBA classes of service
+ * @param [in] num_smba_cos number of SMBA classes of service
+ * @param [out] used_classes table of used classes of service
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE association of domain cores not cached
+ */
+static int
+hw_alloc_assoc_used_cached(const enum pqos_topo_obj type,
+                           const unsigned dom_id,
+                           const int num_dom_set,
+                           const int l2cat_id_set,
+                           const unsigned l2cat_id,
+                           const unsigned num_cos,
+                           const unsigned num_l3_cos,
+                           const unsigned num_mba_cos,
+                           const unsigned num_smba_cos,
+                           unsigned *used_classes)
+{
+        const struct id_pool *dom_pool = NULL;
+        const struct id_pool *l2_pool = NULL;
+        unsigned num_dom_cos = num_l3_cos;
+        unsigned cos;
+
+        if (num_mba_cos > num_dom_cos)
+                num_dom_cos = num_mba_cos;
+        if (num_smba_cos > num_dom_cos)
+                num_dom_cos = num_smba_cos;
+
+        /* all cores are scanned if resource ids are not known */
+        if (num_dom_set == 0 && (num_dom_cos > 0 || !l2cat_id_set))
+                return PQOS_RETVAL_RESOURCE;
+
+        /* one domain must stand for all requested resources */
+        if ((num_dom_set > 1 || (num_dom_set > 0 && l2cat_id_set)) &&
+            !msr_shadow_cos_aligned())
+                return PQOS_RETVAL_RESOURCE;
+
+        if (num_dom_set > 0) {
+                dom_pool = msr_shadow_cos_pool(type, dom_id);
+                if (dom_pool == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+        }
+        if (l2cat_id_set) {
+                l2_pool = msr_shadow_cos_pool(TOPO_OBJ_L2_CLUSTER, l2cat_id);
+                if (l2_pool == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+        }
+
+        for (cos = 0; cos < num_cos; cos++) {
+                /* COS not supported by L3 CAT and MBA are per L2 cluster */
+                if (l2_pool != NULL && (cos >= num_dom_cos || dom_pool == NULL))
+                        used_classes[cos] = id_pool_is_used(l2_pool, cos);
+                else
+                        used_classes[cos] = id_pool_is_used(dom_pool, cos);
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
 /**
  * @brief Gets unused COS on a socket or L2 cluster
  *
@@ -144,6 +219,8 @@ hw_alloc_assoc_unused(const unsigned technology,
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
         unsigned used_classes[PQOS_MAX_COS];
+        enum pqos_topo_obj dom_type = TOPO_OBJ_L3CAT;
+        unsigned dom_id = 0;
 
         if (class_id == NULL)
                 return PQOS_RETVAL_PARAM;
@@ -207,6 +284,24 @@ hw_alloc_assoc_unused(const unsigned technology,
                         }
         }
 
+        /* Use classes of service tracked by association cache if possible */
+        if (l3cat_id_set) {
+                dom_type = TOPO_OBJ_L3CAT;
+                dom_id = l3cat_id;
+        } else if (mba_id_set) {
+                dom_type = TOPO_OBJ_MBA;
+                dom_id = mba_id;
+        } else if (smba_id_set) {
+                dom_type = TOPO_OBJ_SMBA;
+                dom_id = smba_id;
+        }
+        ret = hw_alloc_assoc_used_cached(
+            dom_type, dom_id, l3cat_id_set + mba_id_set + smba_id_set,
+            l2cat_id_set, l2cat_id, num_cos, num_l3_cos, num_mba_cos,
+            num_smba_cos, used_classes);
+        if (ret == PQOS_RETVAL_OK)
+                goto find_unused;
+
         /* Create a list of used COS */
         for (i = 0; i < cpu->num_cores; i++) {
                 if (l3cat_id_set && cpu->cores[i].l3cat_id != l3cat_id)
@@ -234,6 +329,7 @@ hw_alloc_assoc_unused(const unsigned technology,
                 used_classes[cos] = 1;
         }
 
+find_unused:
         /* Find unused COS */
         for (cos = num_cos - 1; cos != 0; cos--) {
                 if (used_classes[cos] == 0) {
@@ -311,6 +407,8 @@ hw_l3ca_set(const unsigned l3cat_id,
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
         uint64_t l3_ways_mask = 0;
+        struct machine_msr_op *ops = NULL;
+        unsigned num_ops = 0;
 
         ASSERT(ca != NULL);
         ASSERT(num_ca != 0);
@@ -391,11 +489,17 @@ hw_l3ca_set(const unsigned l3cat_id,
         if (ret != PQOS_RETVAL_OK)
                 return ret;
 
+        ops = calloc(num_ca * 2, sizeof(*ops));
+        if (ops == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        /**
+         * Build list of COS mask writes and submit them in one batch
+         */
         if (cdp_enabled) {
                 for (i = 0; i < num_ca; i++) {
                         uint32_t reg =
                             (ca[i].class_id * 2) + PQOS_MSR_L3CA_MASK_START;
-                        int retval = MACHINE_RETVAL_OK;
                         uint64_t cmask = 0, dmask = 0;
 
                         if (ca[i].cdp) {
@@ -406,32 +510,42 @@ hw_l3ca_set(const unsigned l3cat_id,
                                 cmask = ca[i].u.ways_mask;
                         }
 
-                        retval = msr_write(core, reg, dmask);
-                        if (retval != MACHINE_RETVAL_OK)
-                                return PQOS_RETVAL_ERROR;
-
-                        retval = msr_write(core, reg + 1, cmask);
-                        if (retval != MACHINE_RETVAL_OK)
-                                return PQOS_RETVAL_ERROR;
+                        ops[num_ops].lcore = core;
+                        ops[num_ops].reg = reg;
+                        ops[num_ops].op = MACHINE_MSR_OP_WRITE;
+                        ops[num_ops].value = dmask;
+                        num_ops++;
+
+                        ops[num_ops].lcore = core;
+                        ops[num_ops].reg = reg + 1;
+                        ops[num_ops].op = MACHINE_MSR_OP_WRITE;
+                        ops[num_ops].value = cmask;
+                        num_ops++;
                 }
         } else {
                 for (i = 0; i < num_ca; i++) {
-                        uint32_t reg =
-                            ca[i].class_id + PQOS_MSR_L3CA_MASK_START;
-                        uint64_t val = ca[i].u.ways_mask;
-                        int retval = MACHINE_RETVAL_OK;
-
                         if (ca[i].cdp) {
                                 LOG_ERROR("Attempting to set CDP COS "
                                           "while L3 CDP is disabled!\n");
-                                return PQOS_RETVAL_ERROR;
+                                ret = PQOS_RETVAL_ERROR;
+                                goto hw_l3ca_set_exit;
                         }
 
-                        retval = msr_write(core, reg, val);
-                        if (retval != MACHINE_RETVAL_OK)
-                                return PQOS_RETVAL_ERROR;
+                        ops[num_ops].lcore = core;
+                        ops[num_ops].reg =
+                            ca[i].class_id + PQOS_MSR_L3CA_MASK_START;
+                        ops[num_ops].op = MACHINE_MSR_OP_WRITE;
+                        ops[num_ops].value = ca[i].u.ways_mask;
+                        num_ops++;
                 }
         }
+
+        if (msr_batch(ops, num_ops) != MACHINE_RETVAL_OK)
+                ret = PQOS_RETVAL_ERROR;
+
+hw_l3ca_set_exit:
+        free(ops);
+
         return ret;
 }
 
@@ -639,6 +753,8 @@ hw_l2ca_set(const unsigned l2id,
         int cdp_enabled = 0;
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+        struct machine_msr_op *ops = NULL;
+        unsigned num_ops = 0;
 
         ASSERT(ca != NULL);
         ASSERT(num_ca != 0);
@@ -687,11 +803,14 @@ hw_l2ca_set(const unsigned l2id,
         if (ret != PQOS_RETVAL_OK)
                 return ret;
 
+        ops = calloc(num_ca * 2, sizeof(*ops));
+        if (ops == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
         for (i = 0; i < num_ca; i++) {
                 if (cdp_enabled) {
                         uint32_t reg =
                             (ca[i].class_id * 2) + PQOS_MSR_L2CA_MASK_START;
-                        int retval = MACHINE_RETVAL_OK;
                         uint64_t cmask = 0, dmask = 0;
 
                         if (ca[i].cdp) {
@@ -702,31 +821,40 @@ hw_l2ca_set(const unsigned l2id,
                                 cmask = ca[i].u.ways_mask;
                         }
 
-                        retval = msr_write(core, reg, dmask);
-                        if (retval != MACHINE_RETVAL_OK)
-                                return PQOS_RETVAL_ERROR;
-
-                        retval = msr_write(core, reg + 1, cmask);
-                        if (retval != MACHINE_RETVAL_OK)
-                                return PQOS_RETVAL_ERROR;
+                        ops[num_ops].lcore = core;
+                        ops[num_ops].reg = reg;
+                        ops[num_ops].op = MACHINE_MSR_OP_WRITE;
+                        ops[num_ops].value = dmask;
+                        num_ops++;
+
+                        ops[num_ops].lcore = core;
+                        ops[num_ops].reg = reg + 1;
+                        ops[num_ops].op = MACHINE_MSR_OP_WRITE;
+                        ops[num_ops].value = cmask;
+                        num_ops++;
                 } else {
-                        uint32_t reg =
-                            ca[i].class_id + PQOS_MSR_L2CA_MASK_START;
-                        uint64_t val = ca[i].u.ways_mask;
-                        int retval;
-
                         if (ca[i].cdp) {
                                 LOG_ERROR("Attempting to set CDP COS "
                                           "while L2 CDP is disabled!\n");
-                                return PQOS_RETVAL_ERROR;
+                                ret = PQOS_RETVAL_ERROR;
+                                goto hw_l2ca_set_exit;
                         }
 
-                        retval = msr_write(core, reg, val);
-                        if (retval != MACHINE_RETVAL_OK)
-                                return PQOS_RETVAL_ERROR;
+                        ops[num_ops].lcore = core;
+                        ops[num_ops].reg =
+                            ca[i].class_id + PQOS_MSR_L2CA_MASK_START;
+                        ops[num_ops].op = MACHINE_MSR_OP_WRITE;
+                        ops[num_ops].value = ca[i].u.ways_mask;
+                        num_ops++;
                 }
         }
 
+        if (msr_batch(ops, num_ops) != MACHINE_RETVAL_OK)
+                ret = PQOS_RETVAL_ERROR;
+
+hw_l2ca_set_exit:
+        free(ops);
+
         return ret;
 }
 
@@ -1298,19 +1426,18 @@ hw_smba_set_amd(const unsigned smba_id,
 int
 hw_alloc_assoc_write(const unsigned lcore, const unsigned class_id)
 {
-        const uint32_t reg = PQOS_MSR_ASSOC;
         uint64_t val = 0;
         int ret;
 
-        ret = msr_read(lcore, reg, &val);
-        if (ret != MACHINE_RETVAL_OK)
+        ret = msr_shadow_assoc_read(lcore, &val);
+        if (ret != PQOS_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
         val &= (~PQOS_MSR_ASSOC_QECOS_MASK);
         val |= (((uint64_t)class_id) << PQOS_MSR_ASSOC_QECOS_SHIFT);
 
-        ret = msr_write(lcore, reg, val);
-        if (ret != MACHINE_RETVAL_OK)
+        ret = msr_shadow_assoc_write(lcore, val);
+        if (ret != PQOS_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
         return PQOS_RETVAL_OK;
@@ -1635,8 +1762,32 @@ hw_alloc_reset_cos(const unsigned msr_start,
                    const uint64_t msr_val)
 {
         int ret = PQOS_RETVAL_OK;
+        struct machine_msr_op *ops;
         unsigned i;
 
+        if (msr_num == 0)
+                return PQOS_RETVAL_OK;
+
+        ops = calloc(msr_num, sizeof(*ops));
+        if (ops != NULL) {
+                for (i = 0; i < msr_num; i++) {
+                        ops[i].lcore = coreid;
+                        ops[i].reg = msr_start + i;
+                        ops[i].op = MACHINE_MSR_OP_WRITE;
+                        ops[i].value = msr_val;
+                }
+
+                ret = msr_batch(ops, msr_num);
+                free(ops);
+                if (ret == MACHINE_RETVAL_OK)
+                        return PQOS_RETVAL_OK;
+                ret = PQOS_RETVAL_OK;
+        }
+
+        /**
+         * Batch stops at first failure - reset every register one by one
+         * and report error if any of them fails
+         */
         for (i = 0; i < msr_num; i++) {
                 int retval = msr_write(coreid, msr_start + i, msr_val);
 
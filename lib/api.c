@@ -33,6 +33,7 @@
 
 #include "api.h"
 
+#include "alloc_txn.h"
 #include "allocation.h"
 #include "cap.h"
 #include "cpuinfo.h"
@@ -43,11 +44,16 @@
 #include "mmio_dump.h"
 #include "mmio_dump_rmids.h"
 #include "mmio_monitoring.h"
+#include "mon_poll.h"
+#include "mon_pub.h"
+#include "mon_sampler.h"
 #include "monitoring.h"
+#include "msr_shadow.h"
 #include "os_allocation.h"
 #include "os_monitoring.h"
 #include "pci.h"
 #include "pqos_internal.h"
+#include "resctrl.h"
 #include "utils.h"
 
 #include <stdlib.h>
@@ -141,6 +147,10 @@ static struct pqos_api {
         int (*mon_remove_pids)(const unsigned num_pids,
                                const pid_t *pids,
                                struct pqos_mon_data *group);
+        /** Enables following of threads in the monitoring group */
+        int (*mon_track_pids)(struct pqos_mon_data *group, const int enable);
+        /** Updates monitored threads of the monitoring group */
+        int (*mon_sync_pids)(struct pqos_mon_data *group);
         /** Starts uncore monitoring */
         int (*mon_start_uncore)(const unsigned num_sockets,
                                 const unsigned *sockets,
@@ -166,6 +176,10 @@ static struct pqos_api {
         /** Associates channel with given class of service */
         int (*alloc_assoc_set_channel)(const pqos_channel_t channel,
                                        const unsigned class_id);
+        /** Revalidates cached core association */
+        int (*assoc_revalidate)(const unsigned max_cores,
+                                unsigned *num_cores,
+                                unsigned *cores);
         /** Assign first available COS */
         int (*alloc_assign)(const unsigned technology,
                             const unsigned *core_array,
@@ -219,6 +233,8 @@ static struct pqos_api {
                        const unsigned num_cos,
                        const struct pqos_mba *requested,
                        struct pqos_mba *actual);
+        /** Applies staged allocation transaction */
+        int (*alloc_txn_commit)(struct pqos_alloc_txn *txn);
         /** Retrieves tasks associated with COS */
         unsigned *(*pid_get_pid_assoc)(const unsigned class_id,
                                        unsigned *count);
@@ -281,6 +297,7 @@ api_init(int interface, enum pqos_vendor vendor)
                         api.mba_set = hw_mba_set;
                 }
                 api.io_devs_get = hw_io_devs_get;
+                api.assoc_revalidate = msr_shadow_revalidate;
 #ifdef __linux__
         } else if (interface == PQOS_INTER_OS ||
                    interface == PQOS_INTER_OS_RESCTRL_MON) {
@@ -289,6 +306,8 @@ api_init(int interface, enum pqos_vendor vendor)
                 api.mon_start_pids = os_mon_start_pids;
                 api.mon_add_pids = os_mon_add_pids;
                 api.mon_remove_pids = os_mon_remove_pids;
+                api.mon_track_pids = os_mon_track_pids;
+                api.mon_sync_pids = os_mon_sync_pids;
                 api.mon_stop = os_mon_stop;
                 api.alloc_assoc_set = os_alloc_assoc_set;
                 api.alloc_assoc_get = os_alloc_assoc_get;
@@ -314,6 +333,7 @@ api_init(int interface, enum pqos_vendor vendor)
                         api.mba_set = os_mba_set;
                 }
 
+                api.alloc_txn_commit = os_alloc_txn_commit;
                 api.pid_get_pid_assoc = os_pid_get_pid_assoc;
 #endif
         } else if (interface == PQOS_INTER_MMIO) {
@@ -334,6 +354,7 @@ api_init(int interface, enum pqos_vendor vendor)
                 api.dump = mmio_dump;
                 api.dump_rmids = mmio_dump_rmids;
                 api.io_devs_get = mmio_io_devs_get;
+                api.assoc_revalidate = msr_shadow_revalidate;
         }
 
         return PQOS_RETVAL_OK;
@@ -341,11 +362,14 @@ api_init(int interface, enum pqos_vendor vendor)
 
 #define UNSUPPORTED_INTERFACE "Interface not supported!\n"
 
-#define API_CALL(API, PARAMS...)                                               \
+/**
+ * Calls \a API of selected interface holding lock taken by \a GET
+ */
+#define API_CALL_LOCKED(GET, RELEASE, API, PARAMS...)                          \
         ({                                                                     \
                 int ret;                                                       \
                                                                                \
-                lock_get();                                                    \
+                GET();                                                         \
                 do {                                                           \
                         ret = _pqos_check_init(1);                             \
                         if (ret != PQOS_RETVAL_OK)                             \
@@ -358,11 +382,23 @@ api_init(int interface, enum pqos_vendor vendor)
                                 ret = PQOS_RETVAL_RESOURCE;                    \
                         }                                                      \
                 } while (0);                                                   \
-                lock_release();                                                \
+                RELEASE();                                                     \
                                                                                \
                 ret;                                                           \
         })
 
+/**
+ * API call excluding all other API calls
+ */
+#define API_CALL(API, PARAMS...)                                               \
+        API_CALL_LOCKED(lock_get, lock_release, API, PARAMS)
+
+/**
+ * Allocation API call, runs concurrently with monitoring polls
+ */
+#define API_ALLOC_CALL(API, PARAMS...)                                         \
+        API_CALL_LOCKED(lock_alloc_get, lock_alloc_release, API, PARAMS)
+
 /*
  * =======================================
  * Allocation Technology
@@ -371,7 +407,7 @@ api_init(int interface, enum pqos_vendor vendor)
 int
 pqos_alloc_assoc_set(const unsigned lcore, const unsigned class_id)
 {
-        return API_CALL(alloc_assoc_set, lcore, class_id);
+        return API_ALLOC_CALL(alloc_assoc_set, lcore, class_id);
 }
 
 int
@@ -380,13 +416,24 @@ pqos_alloc_assoc_get(const unsigned lcore, unsigned *class_id)
         if (class_id == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(alloc_assoc_get, lcore, class_id);
+        return API_ALLOC_CALL(alloc_assoc_get, lcore, class_id);
+}
+
+int
+pqos_assoc_revalidate(const unsigned max_cores,
+                      unsigned *num_cores,
+                      unsigned *cores)
+{
+        if (num_cores == NULL || (cores == NULL && max_cores > 0))
+                return PQOS_RETVAL_PARAM;
+
+        return API_CALL(assoc_revalidate, max_cores, num_cores, cores);
 }
 
 int
 pqos_alloc_assoc_set_pid(const pid_t task, const unsigned class_id)
 {
-        return API_CALL(alloc_assoc_set_pid, task, class_id);
+        return API_ALLOC_CALL(alloc_assoc_set_pid, task, class_id);
 }
 
 int
@@ -395,7 +442,7 @@ pqos_alloc_assoc_get_pid(const pid_t task, unsigned *class_id)
         if (class_id == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(alloc_assoc_get_pid, task, class_id);
+        return API_ALLOC_CALL(alloc_assoc_get_pid, task, class_id);
 }
 
 int
@@ -413,8 +460,8 @@ pqos_alloc_assign(const unsigned technology,
             !(l2_req || l3_req || mba_req || smba_req))
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(alloc_assign, technology, core_array, core_num,
-                        class_id);
+        return API_ALLOC_CALL(alloc_assign, technology, core_array, core_num,
+                              class_id);
 }
 
 int
@@ -423,7 +470,7 @@ pqos_alloc_release(const unsigned *core_array, const unsigned core_num)
         if (core_num == 0 || core_array == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(alloc_release, core_array, core_num);
+        return API_ALLOC_CALL(alloc_release, core_array, core_num);
 }
 
 int
@@ -435,8 +482,8 @@ pqos_alloc_assign_pid(const unsigned technology,
         if (task_array == NULL || task_num == 0 || class_id == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(alloc_assign_pid, technology, task_array, task_num,
-                        class_id);
+        return API_ALLOC_CALL(alloc_assign_pid, technology, task_array,
+                              task_num, class_id);
 }
 
 int
@@ -445,7 +492,7 @@ pqos_alloc_release_pid(const pid_t *task_array, const unsigned task_num)
         if (task_array == NULL || task_num == 0)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(alloc_release_pid, task_array, task_num);
+        return API_ALLOC_CALL(alloc_release_pid, task_array, task_num);
 }
 
 int
@@ -544,11 +591,11 @@ pqos_pid_get_pid_assoc(const unsigned class_id, unsigned *count)
         if (count == NULL)
                 return NULL;
 
-        lock_get();
+        lock_alloc_get();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
-                lock_release();
+                lock_alloc_release();
                 return NULL;
         }
 
@@ -559,7 +606,7 @@ pqos_pid_get_pid_assoc(const unsigned class_id, unsigned *count)
         } else
                 LOG_INFO(UNSUPPORTED_INTERFACE);
 
-        lock_release();
+        lock_alloc_release();
 
         return tasks;
 }
@@ -578,7 +625,7 @@ pqos_l3ca_set(const unsigned l3cat_id,
         if (ca == NULL || num_cos == 0)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(l3ca_set, l3cat_id, num_cos, ca);
+        return API_ALLOC_CALL(l3ca_set, l3cat_id, num_cos, ca);
 }
 
 int
@@ -590,7 +637,7 @@ pqos_l3ca_get(const unsigned l3cat_id,
         if (num_ca == NULL || ca == NULL || max_num_ca == 0)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(l3ca_get, l3cat_id, max_num_ca, num_ca, ca);
+        return API_ALLOC_CALL(l3ca_get, l3cat_id, max_num_ca, num_ca, ca);
 }
 
 int
@@ -599,7 +646,7 @@ pqos_l3ca_get_min_cbm_bits(unsigned *min_cbm_bits)
         if (min_cbm_bits == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(l3ca_get_min_cbm_bits, min_cbm_bits);
+        return API_ALLOC_CALL(l3ca_get_min_cbm_bits, min_cbm_bits);
 }
 
 /*
@@ -636,7 +683,7 @@ pqos_l2ca_set(const unsigned l2id,
                 }
         }
 
-        return API_CALL(l2ca_set, l2id, num_cos, ca);
+        return API_ALLOC_CALL(l2ca_set, l2id, num_cos, ca);
 }
 
 int
@@ -648,7 +695,7 @@ pqos_l2ca_get(const unsigned l2id,
         if (num_ca == NULL || ca == NULL || max_num_ca == 0)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(l2ca_get, l2id, max_num_ca, num_ca, ca);
+        return API_ALLOC_CALL(l2ca_get, l2id, max_num_ca, num_ca, ca);
 }
 
 int
@@ -657,7 +704,7 @@ pqos_l2ca_get_min_cbm_bits(unsigned *min_cbm_bits)
         if (min_cbm_bits == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(l2ca_get_min_cbm_bits, min_cbm_bits);
+        return API_ALLOC_CALL(l2ca_get_min_cbm_bits, min_cbm_bits);
 }
 
 /*
@@ -679,11 +726,11 @@ pqos_mba_set(const unsigned mba_id,
         if (requested == NULL || num_cos == 0)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_alloc_get();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
-                lock_release();
+                lock_alloc_release();
                 return ret;
         }
 
@@ -699,7 +746,7 @@ pqos_mba_set(const unsigned mba_id,
                      requested[i].mb_max > vconfig->mba_max)) {
                         LOG_ERROR("MBA COS%u rate out of range (from 1-%d)!\n",
                                   requested[i].class_id, vconfig->mba_max);
-                        lock_release();
+                        lock_alloc_release();
                         return PQOS_RETVAL_PARAM;
                 }
         }
@@ -711,7 +758,7 @@ pqos_mba_set(const unsigned mba_id,
                 ret = PQOS_RETVAL_RESOURCE;
         }
 
-        lock_release();
+        lock_alloc_release();
 
         return ret;
 }
@@ -725,7 +772,160 @@ pqos_mba_get(const unsigned mba_id,
         if (num_cos == NULL || mba_tab == NULL || max_num_cos == 0)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(mba_get, mba_id, max_num_cos, num_cos, mba_tab);
+        return API_ALLOC_CALL(mba_get, mba_id, max_num_cos, num_cos, mba_tab);
+}
+
+/*
+ * =======================================
+ * Allocation transaction
+ * =======================================
+ */
+
+/**
+ * @brief Checks staged definitions the same way as the non-staged API
+ *
+ * @param [in] txn allocation transaction
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if technology is not supported by interface
+ */
+static int
+alloc_txn_validate(const struct pqos_alloc_txn *txn)
+{
+        unsigned i;
+        enum pqos_interface interface = _pqos_get_inter();
+
+        for (i = 0; i < txn->num_entries; i++) {
+                const struct alloc_txn_entry *e = &txn->entries[i];
+
+                switch (e->technology) {
+                case PQOS_TECHNOLOGY_L3CA:
+                        if (api.l3ca_set == NULL)
+                                goto alloc_txn_validate_unsupported;
+                        break;
+                case PQOS_TECHNOLOGY_L2CA:
+                        if (api.l2ca_set == NULL)
+                                goto alloc_txn_validate_unsupported;
+                        if ((e->u.l2ca.cdp && (e->u.l2ca.u.s.data_mask == 0 ||
+                                               e->u.l2ca.u.s.code_mask == 0)) ||
+                            (!e->u.l2ca.cdp && e->u.l2ca.u.ways_mask == 0)) {
+                                LOG_ERROR("L2 COS%u bit mask is 0!\n",
+                                          e->class_id);
+                                return PQOS_RETVAL_PARAM;
+                        }
+                        break;
+                case PQOS_TECHNOLOGY_MBA:
+                case PQOS_TECHNOLOGY_SMBA: {
+                        const struct cpuinfo_config *vconfig;
+
+                        if (api.mba_set == NULL)
+                                goto alloc_txn_validate_unsupported;
+                        if (interface == PQOS_INTER_MMIO)
+                                break;
+
+                        cpuinfo_get_config(&vconfig);
+                        if (e->u.mba.ctrl == 0 &&
+                            (e->u.mba.mb_max == 0 ||
+                             e->u.mba.mb_max > vconfig->mba_max)) {
+                                LOG_ERROR("MBA COS%u rate out of range "
+                                          "(from 1-%d)!\n",
+                                          e->class_id, vconfig->mba_max);
+                                return PQOS_RETVAL_PARAM;
+                        }
+                        break;
+                }
+                default:
+                        return PQOS_RETVAL_PARAM;
+                }
+        }
+
+        return PQOS_RETVAL_OK;
+
+alloc_txn_validate_unsupported:
+        LOG_INFO(UNSUPPORTED_INTERFACE);
+        return PQOS_RETVAL_RESOURCE;
+}
+
+/**
+ * @brief Applies staged definitions one at a time
+ *
+ * Used by interfaces programming class of service registers directly,
+ * where each definition is a separate register write anyway.
+ *
+ * @param [in,out] txn allocation transaction
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_ERROR if some classes of service were not configured
+ */
+static int
+alloc_txn_commit_each(struct pqos_alloc_txn *txn)
+{
+        int ret = PQOS_RETVAL_OK;
+        unsigned i;
+
+        for (i = 0; i < txn->num_entries; i++) {
+                const struct alloc_txn_entry *e = &txn->entries[i];
+                int retval;
+
+                if (e->technology == PQOS_TECHNOLOGY_L3CA)
+                        retval = api.l3ca_set(e->res_id, 1, &e->u.l3ca);
+                else if (e->technology == PQOS_TECHNOLOGY_L2CA)
+                        retval = api.l2ca_set(e->res_id, 1, &e->u.l2ca);
+                else
+                        retval = api.mba_set(e->res_id, 1, &e->u.mba, NULL);
+                if (retval == PQOS_RETVAL_OK)
+                        continue;
+
+                LOG_ERROR("Failed to configure COS%u\n", e->class_id);
+                ret = alloc_txn_failed_add(txn, e->class_id);
+                if (ret == PQOS_RETVAL_OK)
+                        ret = PQOS_RETVAL_ERROR;
+        }
+
+        return ret;
+}
+
+int
+pqos_alloc_txn_commit(struct pqos_alloc_txn *txn)
+{
+        int ret;
+
+        if (txn == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (txn->committed) {
+                LOG_ERROR("Allocation transaction already committed!\n");
+                return PQOS_RETVAL_PARAM;
+        }
+
+        lock_alloc_get();
+
+        ret = _pqos_check_init(1);
+        if (ret != PQOS_RETVAL_OK) {
+                lock_alloc_release();
+                return ret;
+        }
+
+        ret = alloc_txn_validate(txn);
+        if (ret != PQOS_RETVAL_OK) {
+                lock_alloc_release();
+                return ret;
+        }
+
+        if (api.alloc_txn_commit != NULL)
+                ret = api.alloc_txn_commit(txn);
+        else
+                ret = alloc_txn_commit_each(txn);
+
+        /* definitions failing validation may be staged again */
+        if (ret != PQOS_RETVAL_PARAM && ret != PQOS_RETVAL_RESOURCE)
+                txn->committed = 1;
+
+        lock_alloc_release();
+
+        return ret;
 }
 
 /*
@@ -740,7 +940,7 @@ pqos_alloc_assoc_get_channel(const pqos_channel_t channel, unsigned *class_id)
         if (class_id == NULL || channel == 0)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(alloc_assoc_get_channel, channel, class_id);
+        return API_ALLOC_CALL(alloc_assoc_get_channel, channel, class_id);
 }
 
 int
@@ -754,11 +954,11 @@ pqos_alloc_assoc_get_dev(const uint16_t segment,
         if (class_id == NULL || vc >= PQOS_DEV_MAX_CHANNELS)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_alloc_get();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
-                lock_release();
+                lock_alloc_release();
                 return ret;
         }
 
@@ -776,7 +976,7 @@ pqos_alloc_assoc_get_dev(const uint16_t segment,
                 ret = PQOS_RETVAL_RESOURCE;
         }
 
-        lock_release();
+        lock_alloc_release();
 
         return ret;
 }
@@ -788,7 +988,7 @@ pqos_alloc_assoc_set_channel(const pqos_channel_t channel,
         if (channel == 0)
                 return PQOS_RETVAL_PARAM;
 
-        return API_CALL(alloc_assoc_set_channel, channel, class_id);
+        return API_ALLOC_CALL(alloc_assoc_set_channel, channel, class_id);
 }
 
 int
@@ -802,11 +1002,11 @@ pqos_alloc_assoc_set_dev(const uint16_t segment,
         if (vc >= PQOS_DEV_MAX_CHANNELS)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_alloc_get();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
-                lock_release();
+                lock_alloc_release();
                 return ret;
         }
 
@@ -824,7 +1024,7 @@ pqos_alloc_assoc_set_dev(const uint16_t segment,
                         ret = pqos_devinfo_get_channel_shared(dev, channel_id,
                                                               &shared);
                         if (ret != PQOS_RETVAL_OK) {
-                                lock_release();
+                                lock_alloc_release();
                                 return ret;
                         }
                         if (shared)
@@ -839,7 +1039,7 @@ pqos_alloc_assoc_set_dev(const uint16_t segment,
                 ret = PQOS_RETVAL_RESOURCE;
         }
 
-        lock_release();
+        lock_alloc_release();
 
         return ret;
 }
@@ -859,6 +1059,8 @@ pqos_mon_reset(void)
 int
 pqos_mon_reset_config(const struct pqos_mon_config *cfg)
 {
+        int ret;
+
         /* validate parameters */
         if (cfg != NULL) {
                 if (cfg->l3_iordt != PQOS_REQUIRE_IORDT_ON &&
@@ -880,7 +1082,27 @@ pqos_mon_reset_config(const struct pqos_mon_config *cfg)
                 }
         }
 
-        return API_CALL(mon_reset, cfg);
+        lock_get();
+
+        ret = _pqos_check_init(1);
+        if (ret != PQOS_RETVAL_OK) {
+                lock_release();
+                return ret;
+        }
+
+        if (api.mon_reset != NULL)
+                ret = api.mon_reset(cfg);
+        else {
+                LOG_INFO(UNSUPPORTED_INTERFACE);
+                ret = PQOS_RETVAL_RESOURCE;
+        }
+
+        if (ret == PQOS_RETVAL_OK)
+                mon_pub_reset();
+
+        lock_release();
+
+        return ret;
 }
 
 int
@@ -1090,6 +1312,13 @@ pqos_mon_stop(struct pqos_mon_data *group)
                 return ret;
         }
 
+        if (__atomic_load_n(&group->intl->sampled, __ATOMIC_RELAXED) != 0) {
+                LOG_ERROR("Monitoring group is sampled, "
+                          "stop the sampler first\n");
+                lock_release();
+                return PQOS_RETVAL_BUSY;
+        }
+
         if (api.mon_stop != NULL)
                 ret = api.mon_stop(group);
         else {
@@ -1097,6 +1326,8 @@ pqos_mon_stop(struct pqos_mon_data *group)
                 ret = PQOS_RETVAL_RESOURCE;
         }
 
+        mon_pub_remove(group);
+
         if (group->intl->manage_memory)
                 free(group);
         else {
@@ -1127,7 +1358,7 @@ pqos_mon_poll(struct pqos_mon_data **groups, const unsigned num_groups)
                         return PQOS_RETVAL_PARAM;
         }
 
-        lock_get();
+        lock_get_shared();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
@@ -1135,15 +1366,117 @@ pqos_mon_poll(struct pqos_mon_data **groups, const unsigned num_groups)
                 return ret;
         }
 
-        for (i = 0; i < num_groups; i++) {
-                int retval = pqos_mon_poll_events(groups[i]);
+        /* Polls of disjoint groups run concurrently */
+        mon_poll_lock(groups, num_groups);
 
-                if (retval != PQOS_RETVAL_OK) {
-                        LOG_WARN("Failed to poll event on group number %u\n",
-                                 i);
-                        ret = retval;
-                }
+        /**
+         * Apply thread membership changes of tracked PID groups
+         */
+        for (i = 0; i < num_groups && api.mon_sync_pids != NULL; i++) {
+                if (groups[i]->intl == NULL || !groups[i]->intl->track_pids)
+                        continue;
+
+                if (api.mon_sync_pids(groups[i]) != PQOS_RETVAL_OK)
+                        LOG_WARN("Failed to update threads of monitored "
+                                 "tasks\n");
+        }
+
+        mmio_mon_snapshot_begin(groups, num_groups);
+
+        ret = mon_poll(groups, num_groups);
+        if (ret == PQOS_RETVAL_OK || ret == PQOS_RETVAL_OVERFLOW)
+                mon_pub_write(groups, num_groups);
+
+        mmio_mon_snapshot_end(groups, num_groups);
+        mon_poll_unlock(groups, num_groups);
+        lock_release();
+
+        return ret;
+}
+
+int
+pqos_mon_sampler_start(struct pqos_mon_data **groups,
+                       const unsigned num_groups,
+                       const struct pqos_mon_sampler_config *cfg,
+                       struct pqos_mon_sampler **sampler)
+{
+        int ret;
+        unsigned i;
+
+        if (groups == NULL || num_groups == 0 || cfg == NULL ||
+            sampler == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (cfg->period_us == 0 || cfg->history > MON_SAMPLER_MAX_HISTORY)
+                return PQOS_RETVAL_PARAM;
+
+        for (i = 0; i < num_groups; i++) {
+                if (groups[i] == NULL)
+                        return PQOS_RETVAL_PARAM;
+                if (groups[i]->valid != GROUP_VALID_MARKER)
+                        return PQOS_RETVAL_PARAM;
+                if (groups[i]->event == 0)
+                        return PQOS_RETVAL_PARAM;
         }
+
+        lock_get_shared();
+
+        ret = _pqos_check_init(1);
+        if (ret == PQOS_RETVAL_OK)
+                ret = mon_sampler_start(groups, num_groups, cfg, sampler);
+
+        lock_release();
+
+        return ret;
+}
+
+int
+pqos_resctrl_lock_stats_get(struct pqos_resctrl_lock_stats *stats)
+{
+        if (stats == NULL)
+                return PQOS_RETVAL_PARAM;
+
+#ifdef __linux__
+        resctrl_lock_stats_get(stats);
+
+        return PQOS_RETVAL_OK;
+#else
+        memset(stats, 0, sizeof(*stats));
+
+        return PQOS_RETVAL_RESOURCE;
+#endif
+}
+
+int
+pqos_mon_publish_start(const char *path, const unsigned max_groups)
+{
+        int ret;
+
+        if (path == NULL || max_groups == 0)
+                return PQOS_RETVAL_PARAM;
+
+        lock_get();
+
+        ret = _pqos_check_init(1);
+        if (ret == PQOS_RETVAL_OK)
+                ret = mon_pub_start(path, max_groups);
+
+        lock_release();
+
+        return ret;
+}
+
+int
+pqos_mon_publish_stop(void)
+{
+        int ret;
+
+        lock_get();
+
+        ret = _pqos_check_init(1);
+        if (ret == PQOS_RETVAL_OK)
+                mon_pub_stop();
+
         lock_release();
 
         return ret;
@@ -1298,6 +1631,18 @@ pqos_mon_remove_pids(const unsigned num_pids,
         return API_CALL(mon_remove_pids, num_pids, pids, group);
 }
 
+int
+pqos_mon_track_pids(struct pqos_mon_data *group, const int enable)
+{
+        if (group == NULL || (enable != 0 && enable != 1))
+                return PQOS_RETVAL_PARAM;
+
+        if (group->valid != GROUP_VALID_MARKER)
+                return PQOS_RETVAL_PARAM;
+
+        return API_CALL(mon_track_pids, group, enable);
+}
+
 int
 pqos_mon_start_uncore(const unsigned num_sockets,
                       const unsigned *sockets,
@@ -1454,6 +1799,73 @@ pqos_mon_start_dev_exit:
         return ret;
 }
 
+/**
+ * @brief Gives counter value and delta of monitoring group event
+ *
+ * @param [in] group monitoring group
+ * @param [in] event_id monitoring event
+ * @param [out] value counter value
+ * @param [out] delta counter delta
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM for events without counter value
+ */
+static int
+mon_value_get(const struct pqos_mon_data *const group,
+              const enum pqos_mon_event event_id,
+              uint64_t *value,
+              uint64_t *delta)
+{
+        switch (event_id) {
+        case PQOS_MON_EVENT_L3_OCCUP:
+                *value = group->values.llc;
+                *delta = 0;
+                break;
+        case PQOS_MON_EVENT_LMEM_BW:
+                *value = group->values.mbm_local;
+                *delta = group->values.mbm_local_delta;
+                break;
+        case PQOS_MON_EVENT_TMEM_BW:
+                *value = group->values.mbm_total;
+                *delta = group->values.mbm_total_delta;
+                break;
+        case PQOS_MON_EVENT_RMEM_BW:
+                *value = group->values.mbm_remote;
+                *delta = group->values.mbm_remote_delta;
+                break;
+        case PQOS_PERF_EVENT_LLC_MISS:
+                *value = group->values.llc_misses;
+                *delta = group->values.llc_misses_delta;
+                break;
+        case PQOS_PERF_EVENT_LLC_REF:
+                *value = group->values.llc_references;
+                *delta = group->values.llc_references_delta;
+                break;
+        case PQOS_PERF_EVENT_LLC_MISS_PCIE_READ:
+                *value = group->intl->values.pcie.llc_misses.read;
+                *delta = group->intl->values.pcie.llc_misses.read_delta;
+                break;
+        case PQOS_PERF_EVENT_LLC_MISS_PCIE_WRITE:
+                *value = group->intl->values.pcie.llc_misses.write;
+                *delta = group->intl->values.pcie.llc_misses.write_delta;
+                break;
+        case PQOS_PERF_EVENT_LLC_REF_PCIE_READ:
+                *value = group->intl->values.pcie.llc_references.read;
+                *delta = group->intl->values.pcie.llc_references.read_delta;
+                break;
+        case PQOS_PERF_EVENT_LLC_REF_PCIE_WRITE:
+                *value = group->intl->values.pcie.llc_references.write;
+                *delta = group->intl->values.pcie.llc_references.write_delta;
+                break;
+        default:
+                LOG_ERROR("Unknown event %x\n", event_id);
+                return PQOS_RETVAL_PARAM;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
 int
 pqos_mon_get_value(const struct pqos_mon_data *const group,
                    const enum pqos_mon_event event_id,
@@ -1479,7 +1891,7 @@ pqos_mon_get_value(const struct pqos_mon_data *const group,
         if ((group->event & event_id) == 0)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_get_shared();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
@@ -1487,55 +1899,13 @@ pqos_mon_get_value(const struct pqos_mon_data *const group,
                 return ret;
         }
 
-        switch (event_id) {
-        case PQOS_MON_EVENT_L3_OCCUP:
-                if (delta != NULL)
-                        LOG_WARN("Counter delta is undefined for "
-                                 "PQOS_MON_EVENT_L3_OCCUP\n");
-                _value = group->values.llc;
-                _delta = 0;
-                break;
-        case PQOS_MON_EVENT_LMEM_BW:
-                _value = group->values.mbm_local;
-                _delta = group->values.mbm_local_delta;
-                break;
-        case PQOS_MON_EVENT_TMEM_BW:
-                _value = group->values.mbm_total;
-                _delta = group->values.mbm_total_delta;
-                break;
-        case PQOS_MON_EVENT_RMEM_BW:
-                _value = group->values.mbm_remote;
-                _delta = group->values.mbm_remote_delta;
-                break;
-        case PQOS_PERF_EVENT_LLC_MISS:
-                _value = group->values.llc_misses;
-                _delta = group->values.llc_misses_delta;
-                break;
-        case PQOS_PERF_EVENT_LLC_REF:
-                _value = group->values.llc_references;
-                _delta = group->values.llc_references_delta;
-                break;
-        case PQOS_PERF_EVENT_LLC_MISS_PCIE_READ:
-                _value = group->intl->values.pcie.llc_misses.read;
-                _delta = group->intl->values.pcie.llc_misses.read_delta;
-                break;
-        case PQOS_PERF_EVENT_LLC_MISS_PCIE_WRITE:
-                _value = group->intl->values.pcie.llc_misses.write;
-                _delta = group->intl->values.pcie.llc_misses.write_delta;
-                break;
-        case PQOS_PERF_EVENT_LLC_REF_PCIE_READ:
-                _value = group->intl->values.pcie.llc_references.read;
-                _delta = group->intl->values.pcie.llc_references.read_delta;
-                break;
-        case PQOS_PERF_EVENT_LLC_REF_PCIE_WRITE:
-                _value = group->intl->values.pcie.llc_references.write;
-                _delta = group->intl->values.pcie.llc_references.write_delta;
-                break;
-        default:
-                LOG_ERROR("Unknown event %x\n", event_id);
-                ret = PQOS_RETVAL_PARAM;
-        }
+        mon_poll_lock_group(group);
+
+        if (event_id == PQOS_MON_EVENT_L3_OCCUP && delta != NULL)
+                LOG_WARN("Counter delta is undefined for "
+                         "PQOS_MON_EVENT_L3_OCCUP\n");
 
+        ret = mon_value_get(group, event_id, &_value, &_delta);
         if (ret == PQOS_RETVAL_OK) {
                 if (value != NULL)
                         *value = _value;
@@ -1543,6 +1913,87 @@ pqos_mon_get_value(const struct pqos_mon_data *const group,
                         *delta = _delta;
         }
 
+        mon_poll_unlock_group(group);
+        lock_release();
+
+        return ret;
+}
+
+int
+pqos_mon_get_rate(const struct pqos_mon_data *const group,
+                  const enum pqos_mon_event event_id,
+                  double *rate)
+{
+        uint64_t interval;
+        uint64_t value;
+        uint64_t delta;
+        int ret;
+
+        if (group == NULL || rate == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (group->valid != GROUP_VALID_MARKER)
+                return PQOS_RETVAL_PARAM;
+
+        if ((group->event & event_id) == 0 ||
+            event_id == PQOS_MON_EVENT_L3_OCCUP)
+                return PQOS_RETVAL_PARAM;
+
+        lock_get_shared();
+
+        ret = _pqos_check_init(1);
+        if (ret != PQOS_RETVAL_OK) {
+                lock_release();
+                return ret;
+        }
+
+        mon_poll_lock_group(group);
+
+        interval = group->intl->poll_time.interval;
+        if (interval == 0)
+                ret = PQOS_RETVAL_UNAVAILABLE;
+        else if (event_id == PQOS_PERF_EVENT_IPC)
+                *rate = group->values.ipc;
+        else {
+                ret = mon_value_get(group, event_id, &value, &delta);
+                if (ret == PQOS_RETVAL_OK)
+                        *rate = (double)delta * 1e9 / (double)interval;
+        }
+
+        mon_poll_unlock_group(group);
+        lock_release();
+
+        return ret;
+}
+
+int
+pqos_mon_get_poll_time(const struct pqos_mon_data *const group,
+                       struct pqos_mon_poll_time *poll_time)
+{
+        int ret;
+
+        if (group == NULL || poll_time == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (group->valid != GROUP_VALID_MARKER)
+                return PQOS_RETVAL_PARAM;
+
+        lock_get_shared();
+
+        ret = _pqos_check_init(1);
+        if (ret != PQOS_RETVAL_OK) {
+                lock_release();
+                return ret;
+        }
+
+        mon_poll_lock_group(group);
+
+        if (group->intl->poll_time.begin == 0)
+                ret = PQOS_RETVAL_UNAVAILABLE;
+        else
+                *poll_time = group->intl->poll_time;
+
+        mon_poll_unlock_group(group);
         lock_release();
 
         return ret;
@@ -1568,7 +2019,7 @@ pqos_mon_get_region_value(const struct pqos_mon_data *const group,
         if ((group->event & event_id) == 0)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_get_shared();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
@@ -1576,6 +2027,8 @@ pqos_mon_get_region_value(const struct pqos_mon_data *const group,
                 return ret;
         }
 
+        mon_poll_lock_group(group);
+
         switch (event_id) {
         case PQOS_MON_EVENT_L3_OCCUP:
                 if (delta != NULL)
@@ -1619,6 +2072,7 @@ pqos_mon_get_region_value(const struct pqos_mon_data *const group,
                         *delta = _delta;
         }
 
+        mon_poll_unlock_group(group);
         lock_release();
 
         return ret;
@@ -1640,7 +2094,7 @@ pqos_mon_get_tel_value(const struct pqos_mon_data *group,
         if ((group->event & event) == 0)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_get_shared();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
@@ -1648,6 +2102,8 @@ pqos_mon_get_tel_value(const struct pqos_mon_data *group,
                 return ret;
         }
 
+        mon_poll_lock_group(group);
+
         intl = group->intl;
 
         switch (event) {
@@ -1661,17 +2117,20 @@ pqos_mon_get_tel_value(const struct pqos_mon_data *group,
                 slot = PQOS_TEL_SLOT_POWER;
                 break;
         default:
+                mon_poll_unlock_group(group);
                 lock_release();
                 return PQOS_RETVAL_PARAM;
         }
 
         if (!intl->resctrl.tel[slot].valid) {
+                mon_poll_unlock_group(group);
                 lock_release();
                 return PQOS_RETVAL_RESOURCE;
         }
 
         *value = intl->resctrl.tel[slot].current;
 
+        mon_poll_unlock_group(group);
         lock_release();
 
         return PQOS_RETVAL_OK;
@@ -1691,7 +2150,7 @@ pqos_mon_get_ipc(const struct pqos_mon_data *const group, double *value)
         if ((group->event & PQOS_PERF_EVENT_IPC) == 0)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_get_shared();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
@@ -1699,8 +2158,46 @@ pqos_mon_get_ipc(const struct pqos_mon_data *const group, double *value)
                 return ret;
         }
 
+        mon_poll_lock_group(group);
+
         *value = group->values.ipc;
 
+        mon_poll_unlock_group(group);
+        lock_release();
+
+        return ret;
+}
+
+int
+pqos_mon_get_perf_scale(const struct pqos_mon_data *const group, double *value)
+{
+        int ret;
+
+        if (group == NULL || value == NULL || group->intl == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (group->valid != GROUP_VALID_MARKER)
+                return PQOS_RETVAL_PARAM;
+
+        lock_get_shared();
+
+        ret = _pqos_check_init(1);
+        if (ret != PQOS_RETVAL_OK) {
+                lock_release();
+                return ret;
+        }
+
+        mon_poll_lock_group(group);
+
+        if (group->intl->perf.grp_event == 0) {
+                mon_poll_unlock_group(group);
+                lock_release();
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        *value = group->intl->perf.grp_scale;
+
+        mon_poll_unlock_group(group);
         lock_release();
 
         return ret;
@@ -63,12 +63,17 @@
 #include "lock.h"
 #include "log.h"
 #include "machine.h"
+#include "mmio.h"
 #include "mmio_common.h"
+#include "mon_pub.h"
+#include "mon_sampler.h"
 #include "monitoring.h"
 #include "mrrm.h"
+#include "msr_shadow.h"
 #include "os_cap.h"
 #include "resctrl.h"
 #include "resctrl_alloc.h"
+#include "snapshot.h"
 #include "utils.h"
 
 #include <stdlib.h>
@@ -794,6 +799,11 @@ pqos_init(const struct pqos_config *config)
                 goto log_init_error;
         }
 
+        /**
+         * Capabilities and topology may be served from snapshot
+         */
+        (void)snapshot_open(interface);
+
         /**
          * Topology not provided through config.
          * CPU discovery done through internal mechanism.
@@ -805,6 +815,12 @@ pqos_init(const struct pqos_config *config)
                 goto log_init_error;
         }
 
+        ret = _pqos_utils_init(interface, cpu);
+        if (ret != PQOS_RETVAL_OK) {
+                LOG_ERROR("Utils initialization error!\n");
+                goto cpuinfo_init_error;
+        }
+
         /**
          * Find max core id in the topology
          */
@@ -843,18 +859,16 @@ pqos_init(const struct pqos_config *config)
                          "and cause unexpected behaviour\n");
 #endif
 
-        ret = discover_capabilities(&cap, cpu, interface);
+        ret = snapshot_check_cfg();
+        if (ret == PQOS_RETVAL_OK)
+                ret = snapshot_get_cap(&cap);
+        if (ret != PQOS_RETVAL_OK)
+                ret = discover_capabilities(&cap, cpu, interface);
         if (ret != PQOS_RETVAL_OK) {
                 LOG_ERROR("discover_capabilities() error %d\n", ret);
                 goto machine_init_error;
         }
 
-        ret = _pqos_utils_init(interface);
-        if (ret != PQOS_RETVAL_OK) {
-                fprintf(stderr, "Utils initialization error!\n");
-                goto machine_init_error;
-        }
-
         ret = api_init(interface, cpu->vendor);
         if (ret != PQOS_RETVAL_OK) {
                 LOG_ERROR("lock_init() error %d\n", ret);
@@ -863,6 +877,14 @@ pqos_init(const struct pqos_config *config)
 
         _pqos_set_inter(interface);
 
+        if (interface == PQOS_INTER_MSR || interface == PQOS_INTER_MMIO) {
+                ret = msr_shadow_init(cpu);
+                if (ret != PQOS_RETVAL_OK) {
+                        LOG_ERROR("msr_shadow_init() error %d\n", ret);
+                        goto machine_init_error;
+                }
+        }
+
         ret = erdt_init(cap, cpu, &erdt);
         switch (ret) {
         case PQOS_RETVAL_RESOURCE:
@@ -891,6 +913,10 @@ pqos_init(const struct pqos_config *config)
                 if (ret != PQOS_RETVAL_OK)
                         goto machine_init_error;
 
+                ret = mmio_map_init(erdt);
+                if (ret != PQOS_RETVAL_OK)
+                        goto machine_init_error;
+
                 /* Set Region Aware MBM and MBA mode, if MMIO interface is
                  * selected and ERDT table is present
                  */
@@ -1008,11 +1034,17 @@ pqos_init(const struct pqos_config *config)
         }
 
 machine_init_error:
-        if (ret != PQOS_RETVAL_OK)
+        if (ret != PQOS_RETVAL_OK && interface == PQOS_INTER_MMIO)
+                mmio_map_fini();
+        if (ret != PQOS_RETVAL_OK) {
+                msr_shadow_fini();
                 (void)machine_fini();
+        }
 cpuinfo_init_error:
-        if (ret != PQOS_RETVAL_OK)
+        if (ret != PQOS_RETVAL_OK) {
+                _pqos_utils_fini();
                 (void)cpuinfo_fini();
+        }
 log_init_error:
         if (ret != PQOS_RETVAL_OK)
                 (void)log_fini();
@@ -1025,6 +1057,10 @@ init_error:
                 }
         }
 
+        if (ret == PQOS_RETVAL_OK)
+                (void)snapshot_store(cpu, cap);
+        snapshot_close();
+
         if (ret == PQOS_RETVAL_OK) {
                 m_init_done = 1;
                 m_sysconf.cap = cap;
@@ -1054,6 +1090,14 @@ pqos_fini(void)
 
         lock_get();
 
+        /* sampling threads would keep polling released groups */
+        if (mon_sampler_running() > 0) {
+                LOG_ERROR("Monitoring samplers still running, "
+                          "stop them before library shutdown\n");
+                lock_release();
+                return PQOS_RETVAL_BUSY;
+        }
+
         if (interface == PQOS_INTER_MMIO)
                 mmio_set_mbm_mba_mode(PQOS_TOTAL_MBM_MBA_MODE, m_sysconf.erdt);
 
@@ -1064,13 +1108,18 @@ pqos_fini(void)
                 return ret;
         }
 
+        mon_pub_stop();
         pqos_mon_fini();
         pqos_alloc_fini();
+#ifdef __linux__
+        resctrl_lock_fini();
+#endif
 
         if (interface == PQOS_INTER_MMIO) {
                 cores_domains_fini();
                 channels_domains_fini();
                 mrrm_fini();
+                mmio_map_fini();
         }
 
         ret = iordt_fini();
@@ -1081,6 +1130,9 @@ pqos_fini(void)
 
         erdt_fini();
 
+        msr_shadow_fini();
+        _pqos_utils_fini();
+
         ret = cpuinfo_fini();
         if (ret != 0) {
                 retval = PQOS_RETVAL_ERROR;
@@ -1134,7 +1186,7 @@ pqos_cap_get(const struct pqos_cap **cap, const struct pqos_cpuinfo **cpu)
         if (cap == NULL && cpu == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_get_shared();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
@@ -1163,7 +1215,7 @@ pqos_sysconfig_get(const struct pqos_sysconfig **sysconf)
         if (sysconf == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_get_shared();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
@@ -1186,6 +1238,8 @@ _pqos_cap_l3cdp_change(const enum pqos_cdp_config cdp)
         unsigned i;
         enum pqos_interface interface = _pqos_get_inter();
 
+        snapshot_invalidate();
+
         ASSERT(cdp == PQOS_REQUIRE_CDP_ON || cdp == PQOS_REQUIRE_CDP_OFF ||
                cdp == PQOS_REQUIRE_CDP_ANY);
         ASSERT(m_sysconf.cap != NULL);
@@ -1241,6 +1295,8 @@ _pqos_cap_l3iordt_change(const enum pqos_iordt_config iordt)
         struct pqos_cap *cap = m_sysconf.cap;
         unsigned i;
 
+        snapshot_invalidate();
+
         ASSERT(iordt == PQOS_REQUIRE_IORDT_ON ||
                iordt == PQOS_REQUIRE_IORDT_OFF ||
                iordt == PQOS_REQUIRE_IORDT_ANY);
@@ -1274,6 +1330,8 @@ _pqos_cap_l2cdp_change(const enum pqos_cdp_config cdp)
         int ret;
         enum pqos_interface interface = _pqos_get_inter();
 
+        snapshot_invalidate();
+
         ASSERT(cdp == PQOS_REQUIRE_CDP_ON || cdp == PQOS_REQUIRE_CDP_OFF ||
                cdp == PQOS_REQUIRE_CDP_ANY);
         ASSERT(m_sysconf.cap != NULL);
@@ -1330,6 +1388,8 @@ _pqos_cap_mba_change(const enum pqos_mba_config cfg)
         enum pqos_interface interface = _pqos_get_inter();
 #endif
 
+        snapshot_invalidate();
+
         ASSERT(cfg == PQOS_MBA_DEFAULT || cfg == PQOS_MBA_CTRL ||
                cfg == PQOS_MBA_ANY);
         ASSERT(m_sysconf.cap != NULL);
@@ -1374,6 +1434,8 @@ _pqos_cap_mon_iordt_change(const enum pqos_iordt_config iordt)
         struct pqos_cap_mon *mon_cap = NULL;
         unsigned i;
 
+        snapshot_invalidate();
+
         ASSERT(iordt == PQOS_REQUIRE_IORDT_ON ||
                iordt == PQOS_REQUIRE_IORDT_OFF ||
                iordt == PQOS_REQUIRE_IORDT_ANY);
@@ -1404,6 +1466,8 @@ _pqos_cap_mon_snc_change(const enum pqos_snc_config cfg)
         struct pqos_cap_mon *mon_cap = NULL;
         unsigned i;
 
+        snapshot_invalidate();
+
         ASSERT(cfg == PQOS_REQUIRE_SNC_LOCAL || cfg == PQOS_REQUIRE_SNC_TOTAL ||
                cfg == PQOS_REQUIRE_SNC_ANY);
         ASSERT(m_sysconf.cap != NULL);
@@ -1446,6 +1510,8 @@ _pqos_cap_smba_change(const enum pqos_mba_config cfg)
                cfg == PQOS_MBA_ANY);
         ASSERT(m_sysconf.cap != NULL);
 
+        snapshot_invalidate();
+
         if (m_sysconf.cap == NULL)
                 return;
 
@@ -1568,7 +1634,7 @@ pqos_inter_get(enum pqos_interface *interface)
         if (interface == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        lock_get();
+        lock_get_shared();
 
         ret = _pqos_check_init(1);
         if (ret != PQOS_RETVAL_OK) {
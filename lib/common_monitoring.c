@@ -47,6 +47,7 @@
 #include "log.h"
 #include "machine.h"
 #include "monitoring.h"
+#include "msr_shadow.h"
 #include "perf_monitoring.h"
 #include "utils.h"
 
@@ -256,19 +257,17 @@ int
 mon_assoc_write(const unsigned lcore, const pqos_rmid_t rmid)
 {
         int ret = 0;
-        uint32_t reg = 0;
         uint64_t val = 0;
 
-        reg = PQOS_MSR_ASSOC;
-        ret = msr_read(lcore, reg, &val);
-        if (ret != MACHINE_RETVAL_OK)
+        ret = msr_shadow_assoc_read(lcore, &val);
+        if (ret != PQOS_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
         val &= PQOS_MSR_ASSOC_QECOS_MASK;
         val |= (uint64_t)(rmid & PQOS_MSR_ASSOC_RMID_MASK);
 
-        ret = msr_write(lcore, reg, val);
-        if (ret != MACHINE_RETVAL_OK)
+        ret = msr_shadow_assoc_write(lcore, val);
+        if (ret != PQOS_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
         return PQOS_RETVAL_OK;
@@ -278,13 +277,12 @@ int
 mon_assoc_read(const unsigned lcore, pqos_rmid_t *rmid)
 {
         int ret = 0;
-        uint32_t reg = PQOS_MSR_ASSOC;
         uint64_t val = 0;
 
         ASSERT(rmid != NULL);
 
-        ret = msr_read(lcore, reg, &val);
-        if (ret != MACHINE_RETVAL_OK)
+        ret = msr_shadow_assoc_read(lcore, &val);
+        if (ret != PQOS_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
         val &= PQOS_MSR_ASSOC_RMID_MASK;
@@ -350,8 +348,20 @@ mon_start_perf(struct pqos_mon_data *group, enum pqos_mon_event event)
         /* Start IA32 performance counters */
         if (hw_event) {
                 ret = ia32_perf_counter_start(group, hw_event);
-                if (ret == PQOS_RETVAL_OK)
-                        group->intl->hw.event |= hw_event;
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+
+                /* counter read ops, reused on every poll */
+                group->intl->hw.perf_ops =
+                    calloc(group->num_cores > 0 ? group->num_cores : 1,
+                           sizeof(group->intl->hw.perf_ops[0]));
+                if (group->intl->hw.perf_ops == NULL) {
+                        LOG_ERROR("Memory allocation failed\n");
+                        (void)ia32_perf_counter_stop(group->num_cores,
+                                                     group->cores, hw_event);
+                        return PQOS_RETVAL_RESOURCE;
+                }
+                group->intl->hw.event |= hw_event;
         }
 
         return ret;
@@ -381,6 +391,9 @@ mon_stop_perf(struct pqos_mon_data *group)
                         hw_event |= evt;
         }
 
+        free(group->intl->hw.perf_ops);
+        group->intl->hw.perf_ops = NULL;
+
         /* Stop IA32 performance counters */
         if (hw_event) {
                 ret = ia32_perf_counter_stop(group->num_cores, group->cores,
@@ -406,6 +419,7 @@ mon_read_perf(struct pqos_mon_data *group, const enum pqos_mon_event event)
         uint64_t reg;
         uint64_t *value;
         uint64_t *delta;
+        struct machine_msr_op *ops;
 
         switch (event) {
         case (enum pqos_mon_event)PQOS_PERF_EVENT_INSTRUCTIONS:
@@ -436,15 +450,23 @@ mon_read_perf(struct pqos_mon_data *group, const enum pqos_mon_event event)
          * If multiple cores monitored in one group
          * then we have to accumulate the values in the group.
          */
-        for (n = 0; n < group->num_cores; n++) {
-                uint64_t tmp = 0;
-                int ret = msr_read(group->cores[n], reg, &tmp);
+        ops = group->intl->hw.perf_ops;
+        if (ops == NULL)
+                return PQOS_RETVAL_ERROR;
 
-                if (ret != MACHINE_RETVAL_OK)
-                        return PQOS_RETVAL_ERROR;
-                val += tmp;
+        for (n = 0; n < group->num_cores; n++) {
+                ops[n].lcore = group->cores[n];
+                ops[n].reg = (uint32_t)reg;
+                ops[n].op = MACHINE_MSR_OP_READ;
+                ops[n].value = 0;
         }
 
+        if (msr_batch(ops, group->num_cores) != MACHINE_RETVAL_OK)
+                return PQOS_RETVAL_ERROR;
+
+        for (n = 0; n < group->num_cores; n++)
+                val += ops[n].value;
+
         *delta = val - *value;
         *value = val;
 
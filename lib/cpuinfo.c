@@ -45,10 +45,12 @@
 #include "machine.h"
 #include "os_allocation.h"
 #include "os_cpuinfo.h"
+#include "snapshot.h"
 #include "utils.h"
 
 #include <errno.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <string.h>
 #include <unistd.h> /* sysconf() */
@@ -78,20 +80,6 @@ static struct cpuinfo_config m_config;
 static struct pqos_cacheinfo m_l2;
 static struct pqos_cacheinfo m_l3;
 
-/**
- * Internal APIC information structure
- */
-struct apic_info {
-        uint32_t smt_mask;      /**< mask to get SMT ID */
-        uint32_t smt_size;      /**< size of SMT ID mask */
-        uint32_t core_mask;     /**< mask to get CORE ID */
-        uint32_t core_smt_mask; /**< mask to get CORE+SMT ID */
-        uint32_t pkg_mask;      /**< mask to get PACKAGE ID */
-        uint32_t pkg_shift;     /**< bits to shift to get PACKAGE ID */
-        uint32_t l2_shift;      /**< bits to shift to get L2 ID */
-        uint32_t l3_shift;      /**< bits to shift to get L3 ID */
-};
-
 /**
  * Own typedef to simplify dealing with cpu set differences.
  */
@@ -380,7 +368,7 @@ detect_apic_masks(struct apic_info *apic)
 /**
  * @brief Detects CPU information
  *
- * - schedules current task to run on \a cpu
+ * - schedules current thread to run on \a cpu
  * - runs CPUID leaf 0xB to get cpu's APICID
  * - uses \a apic & APICID information to:
  *   - retrieve socket id (physical package id)
@@ -432,11 +420,9 @@ detect_cpu(const int cpu,
 }
 
 /**
- * @brief Builds CPU topology structure
+ * @brief Detects information of all processors one by one
  *
  * - saves current task CPU affinity
- * - retrieves number of processors in the system
- * - detects information on APICID structure
  * - for each processor in the system:
  *      - change affinity to run only on the processor
  *      - read APICID of current processor with CPUID
@@ -444,6 +430,174 @@ detect_cpu(const int cpu,
  * - restores initial task CPU affinity
  *
  * @param [in] apic information about APICID structure
+ * @param [out] cores table of \a max_core_count entries to be filled in
+ * @param [in] max_core_count number of processors in the system
+ *
+ * @return Number of detected processors
+ * @retval -1 on error
+ */
+PQOS_STATIC int
+cpuinfo_detect_serial(const struct apic_info *apic,
+                      struct pqos_coreinfo *cores,
+                      int max_core_count)
+{
+        int i, core_count = 0;
+        cpu_set_t *current_mask;
+
+        current_mask = CPU_ALLOC(max_core_count);
+        if (current_mask == NULL)
+                return -1;
+
+        if (get_affinity(current_mask, max_core_count) != 0) {
+                LOG_ERROR("Error retrieving CPU affinity mask!");
+                CPU_FREE(current_mask);
+                return -1;
+        }
+
+        for (i = 0; i < max_core_count; ++i)
+                if (detect_cpu(i, apic, &cores[core_count], max_core_count) ==
+                    0)
+                        core_count++;
+
+        if (set_affinity_mask(current_mask, max_core_count) != 0) {
+                LOG_ERROR("Couldn't restore original CPU affinity mask!");
+                core_count = -1;
+        }
+
+        CPU_FREE(current_mask);
+        return core_count;
+}
+
+#ifdef __linux__
+/**
+ * Maximum number of threads used by parallel topology detection
+ */
+#define TOPO_MAX_THREADS 64
+
+/**
+ * Minimum number of processors detected by a single thread
+ */
+#define TOPO_MIN_CHUNK 8
+
+/**
+ * Chunk of processors detected by a single thread
+ */
+struct topo_chunk {
+        pthread_t thread;
+        const struct apic_info *apic;
+        int first;                   /**< first processor of the chunk */
+        int last;                    /**< last processor of the chunk + 1 */
+        int max_core_count;          /**< number of processors */
+        struct pqos_coreinfo *cores; /**< results indexed by processor id */
+        int *detected;               /**< detection status of processors */
+};
+
+/**
+ * @brief Detection thread routine
+ *
+ * Thread migrates itself through processors of the chunk.
+ * Affinity of the calling task is not affected.
+ *
+ * @param [in] arg processor chunk
+ *
+ * @return NULL
+ */
+static void *
+topo_chunk_main(void *arg)
+{
+        struct topo_chunk *chunk = (struct topo_chunk *)arg;
+        int i;
+
+        for (i = chunk->first; i < chunk->last; i++)
+                chunk->detected[i] = detect_cpu(i, chunk->apic,
+                                                &chunk->cores[i],
+                                                chunk->max_core_count) == 0;
+
+        return NULL;
+}
+
+/**
+ * @brief Detects information of all processors in parallel
+ *
+ * Processors are split into chunks detected concurrently by short-lived
+ * threads. Each thread changes only its own affinity, so the calling
+ * task is never migrated. Detected processors are reported in the same
+ * order as by cpuinfo_detect_serial().
+ *
+ * @param [in] apic information about APICID structure
+ * @param [out] cores table of \a max_core_count entries to be filled in
+ * @param [in] max_core_count number of processors in the system
+ *
+ * @return Number of detected processors
+ * @retval -1 on error
+ */
+PQOS_STATIC int
+cpuinfo_detect_parallel(const struct apic_info *apic,
+                        struct pqos_coreinfo *cores,
+                        int max_core_count)
+{
+        struct topo_chunk chunks[TOPO_MAX_THREADS];
+        struct pqos_coreinfo *tmp;
+        int *detected;
+        int num_threads, chunk_size;
+        int i, started, core_count = 0;
+
+        num_threads = (max_core_count + TOPO_MIN_CHUNK - 1) / TOPO_MIN_CHUNK;
+        if (num_threads > TOPO_MAX_THREADS)
+                num_threads = TOPO_MAX_THREADS;
+        chunk_size = (max_core_count + num_threads - 1) / num_threads;
+
+        tmp = calloc(max_core_count, sizeof(*tmp));
+        detected = calloc(max_core_count, sizeof(*detected));
+        if (tmp == NULL || detected == NULL) {
+                free(tmp);
+                free(detected);
+                return -1;
+        }
+
+        for (started = 0; started < num_threads; started++) {
+                struct topo_chunk *chunk = &chunks[started];
+
+                chunk->apic = apic;
+                chunk->first = started * chunk_size;
+                chunk->last = chunk->first + chunk_size;
+                if (chunk->last > max_core_count)
+                        chunk->last = max_core_count;
+                chunk->max_core_count = max_core_count;
+                chunk->cores = tmp;
+                chunk->detected = detected;
+
+                if (pthread_create(&chunk->thread, NULL, topo_chunk_main,
+                                   chunk) != 0) {
+                        LOG_WARN("Failed to create topology detection "
+                                 "thread\n");
+                        core_count = -1;
+                        break;
+                }
+        }
+
+        for (i = 0; i < started; i++)
+                pthread_join(chunks[i].thread, NULL);
+
+        if (core_count == 0)
+                for (i = 0; i < max_core_count; i++)
+                        if (detected[i])
+                                cores[core_count++] = tmp[i];
+
+        free(tmp);
+        free(detected);
+        return core_count;
+}
+#endif /* __linux__ */
+
+/**
+ * @brief Builds CPU topology structure
+ *
+ * - retrieves number of processors in the system
+ * - detects information of each processor using APICID structure,
+ *   in parallel where supported with serial detection as fallback
+ *
+ * @param [in] apic information about APICID structure
  *
  * @return Pointer to CPU topology structure
  * @retval NULL on error
@@ -451,10 +605,8 @@ detect_cpu(const int cpu,
 static struct pqos_cpuinfo *
 cpuinfo_build_topo(struct apic_info *apic)
 {
-        int i, max_core_count;
-        unsigned core_count = 0;
+        int max_core_count, core_count = -1;
         struct pqos_cpuinfo *l_cpu = NULL;
-        cpu_set_t *current_mask = NULL;
 
         max_core_count = sysconf(_SC_NPROCESSORS_CONF);
         if (max_core_count <= 0) {
@@ -462,16 +614,8 @@ cpuinfo_build_topo(struct apic_info *apic)
                 return NULL;
         }
 
-        current_mask = CPU_ALLOC(max_core_count);
-        if (get_affinity(current_mask, max_core_count) != 0) {
-                LOG_ERROR("Error retrieving CPU affinity mask!");
-                CPU_FREE(current_mask);
-                return NULL;
-        }
-
         if (pqos_set_no_files_limit(max_core_count)) {
                 LOG_ERROR("Open files limit not sufficient!\n");
-                CPU_FREE(current_mask);
                 return NULL;
         }
 
@@ -481,31 +625,25 @@ cpuinfo_build_topo(struct apic_info *apic)
         l_cpu = (struct pqos_cpuinfo *)malloc(mem_sz);
         if (l_cpu == NULL) {
                 LOG_ERROR("Couldn't allocate CPU topology structure!");
-                CPU_FREE(current_mask);
                 return NULL;
         }
-        l_cpu->mem_size = (unsigned)mem_sz;
         memset(l_cpu, 0, mem_sz);
+        l_cpu->mem_size = (unsigned)mem_sz;
 
-        for (i = 0; i < max_core_count; ++i)
-                if (detect_cpu(i, apic, &l_cpu->cores[core_count],
-                               max_core_count) == 0)
-                        core_count++;
+#ifdef __linux__
+        core_count =
+            cpuinfo_detect_parallel(apic, l_cpu->cores, max_core_count);
+#endif
+        if (core_count < 0)
+                core_count =
+                    cpuinfo_detect_serial(apic, l_cpu->cores, max_core_count);
 
-        if (set_affinity_mask(current_mask, max_core_count) != 0) {
-                LOG_ERROR("Couldn't restore original CPU affinity mask!");
-                CPU_FREE(current_mask);
+        if (core_count <= 0) {
                 free(l_cpu);
                 return NULL;
         }
 
-        CPU_FREE(current_mask);
-        l_cpu->num_cores = core_count;
-        if (core_count == 0) {
-                free(l_cpu);
-                l_cpu = NULL;
-        }
-
+        l_cpu->num_cores = (unsigned)core_count;
         return l_cpu;
 }
 
@@ -652,7 +790,10 @@ cpuinfo_init(enum pqos_interface interface, struct pqos_cpuinfo **topology)
                 return -EFAULT;
         }
 
-        if (interface == PQOS_INTER_MSR || interface == PQOS_INTER_MMIO)
+        m_cpu = snapshot_get_cpuinfo();
+        if (m_cpu != NULL)
+                LOG_INFO("CPU topology loaded from snapshot\n");
+        else if (interface == PQOS_INTER_MSR || interface == PQOS_INTER_MMIO)
                 m_cpu = cpuinfo_build_topo(&apic);
 #ifdef __linux__
         else if (interface == PQOS_INTER_OS ||
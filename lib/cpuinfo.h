@@ -42,6 +42,7 @@
 #include "types.h"
 
 #include <errno.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +58,20 @@ extern "C" {
 /* No MBA 4.0 support model */
 #define CPU_MODEL_01 0x01
 
+/**
+ * Internal APIC information structure
+ */
+struct apic_info {
+        uint32_t smt_mask;      /**< mask to get SMT ID */
+        uint32_t smt_size;      /**< size of SMT ID mask */
+        uint32_t core_mask;     /**< mask to get CORE ID */
+        uint32_t core_smt_mask; /**< mask to get CORE+SMT ID */
+        uint32_t pkg_mask;      /**< mask to get PACKAGE ID */
+        uint32_t pkg_shift;     /**< bits to shift to get PACKAGE ID */
+        uint32_t l2_shift;      /**< bits to shift to get L2 ID */
+        uint32_t l3_shift;      /**< bits to shift to get L3 ID */
+};
+
 /**
  * CPU vendor configuration value
  */
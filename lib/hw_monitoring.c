@@ -44,16 +44,20 @@
 #include "common_monitoring.h"
 #include "cpu_registers.h"
 #include "cpuinfo.h"
+#include "id_pool.h"
 #include "iordt.h"
 #include "log.h"
 #include "machine.h"
+#include "mbm_sampler.h"
 #include "monitoring.h"
+#include "msr_shadow.h"
 #include "perf_monitoring.h"
 #include "uncore_monitoring.h"
 #include "utils.h"
 
 #include <dirent.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -62,6 +66,7 @@
  * Local data types
  * ---------------------------------------
  */
+#define HW_MON_EVTSEL_LOCKS 64 /**< number of event selection locks */
 
 /**
  * ---------------------------------------
@@ -70,6 +75,14 @@
  */
 static unsigned m_rmid_max = 0; /**< max RMID */
 
+/**
+ * Event selection and counter registers are shared by all groups polled
+ * on a core. Select and read sequences of concurrent polls are serialized
+ * with a lock selected by core number.
+ */
+static pthread_mutex_t m_evtsel_lock[HW_MON_EVTSEL_LOCKS] = {
+    [0 ... HW_MON_EVTSEL_LOCKS - 1] = PTHREAD_MUTEX_INITIALIZER};
+
 /**
  * ---------------------------------------
  * Local Functions
@@ -123,6 +136,8 @@ hw_mon_init(const struct pqos_cpuinfo *cpu, const struct pqos_cap *cap)
         else if (ret != PQOS_RETVAL_OK)
                 goto hw_mon_init_exit;
 
+        ret = mbm_sampler_init(cpu, cap);
+
 hw_mon_init_exit:
         if (ret != PQOS_RETVAL_OK)
                 hw_mon_fini();
@@ -135,6 +150,7 @@ hw_mon_fini(void)
 {
         m_rmid_max = 0;
 
+        mbm_sampler_fini();
         uncore_mon_fini();
 
 #ifdef __linux__
@@ -243,53 +259,47 @@ get_socket(const struct pqos_cpuinfo *cpu, unsigned numa, unsigned *socket)
         return PQOS_RETVAL_ERROR;
 }
 
-int
-hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
-                    const enum pqos_mon_event event,
-                    pqos_rmid_t min_rmid,
-                    pqos_rmid_t max_rmid,
-                    const struct pqos_mon_options *opt)
+/**
+ * @brief Marks RMIDs associated with cores and channels of the cluster
+ *
+ * @param [in] ctx poll context with cluster id
+ * @param [in] max_rmid highest RMID of interest
+ * @param [in] iordt I/O RDT monitoring enabled
+ * @param [out] used pool of used RMIDs, to be released by the caller
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK success
+ */
+static int
+hw_mon_assoc_used(const struct pqos_mon_poll_ctx *ctx,
+                  const pqos_rmid_t max_rmid,
+                  const int iordt,
+                  struct id_pool *used)
 {
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
-        const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_devinfo *dev = _pqos_get_dev();
         int ret = PQOS_RETVAL_OK;
-        unsigned rmid = 0;
-        unsigned *core_list = NULL;
+        const unsigned *core_list = NULL;
+        unsigned *core_alloc = NULL;
         unsigned i, core_count;
-        uint8_t *rmid_list = NULL;
-        int iordt;
 
-        ASSERT(ctx != NULL);
-
-#ifndef PQOS_RMID_CUSTOM
-        UNUSED_PARAM(opt);
-#endif
-        /* Getting max RMID for given event */
-        ret = rmid_get_event_max(cap, &rmid, event);
+        ret = id_pool_init(used, max_rmid + 1);
         if (ret != PQOS_RETVAL_OK)
                 return ret;
-        if (rmid - 1 < max_rmid)
-                max_rmid = rmid - 1;
-        if (min_rmid < 1)
-                min_rmid = 1;
-
-        ret = pqos_mon_iordt_enabled(cap, NULL, &iordt);
-        if (ret != PQOS_RETVAL_OK)
-                goto rmid_alloc_error;
-
-        /* list of used RMIDs */
-        rmid_list = (uint8_t *)calloc(max_rmid + 2, sizeof(rmid_list[0]));
-        if (rmid_list == NULL)
-                return PQOS_RETVAL_RESOURCE;
 
         /**
          * Check for free RMID in the cluster by reading current associations.
          */
-        core_list = pqos_cpu_get_cores_l3id(cpu, ctx->cluster, &core_count);
+        core_list = pqos_cpu_get_cores_span(cpu, TOPO_OBJ_L3_CLUSTER,
+                                            ctx->cluster, &core_count);
+        if (core_list == NULL) {
+                core_alloc =
+                    pqos_cpu_get_cores_l3id(cpu, ctx->cluster, &core_count);
+                core_list = core_alloc;
+        }
         if (core_list == NULL) {
                 ret = PQOS_RETVAL_ERROR;
-                goto rmid_alloc_error;
+                goto rmid_used_exit;
         }
         ASSERT(core_count > 0);
 
@@ -299,9 +309,8 @@ hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
 
                 ret = hw_mon_assoc_read(core_list[i], &rmid);
                 if (ret != PQOS_RETVAL_OK)
-                        goto rmid_alloc_error;
-                if (rmid <= max_rmid)
-                        rmid_list[rmid] = 1;
+                        goto rmid_used_exit;
+                id_pool_get(used, rmid);
         }
 
         /* mark used RMIDs for channels */
@@ -322,16 +331,66 @@ hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
                                 if (socket != ctx->cluster)
                                         continue;
                         } else if (ret != PQOS_RETVAL_RESOURCE)
-                                goto rmid_alloc_error;
+                                goto rmid_used_exit;
 
                         ret = iordt_mon_assoc_read(channel->channel_id, &rmid);
                         if (ret != PQOS_RETVAL_OK)
-                                goto rmid_alloc_error;
+                                goto rmid_used_exit;
 
-                        if (rmid <= max_rmid)
-                                rmid_list[rmid] = 1;
+                        id_pool_get(used, rmid);
                 }
 
+rmid_used_exit:
+        if (core_alloc != NULL)
+                free(core_alloc);
+        return ret;
+}
+
+int
+hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
+                    const enum pqos_mon_event event,
+                    pqos_rmid_t min_rmid,
+                    pqos_rmid_t max_rmid,
+                    const struct pqos_mon_options *opt)
+{
+        const struct pqos_cap *cap = _pqos_get_cap();
+        const struct pqos_devinfo *dev = _pqos_get_dev();
+        int ret = PQOS_RETVAL_OK;
+        unsigned rmid = 0;
+        const struct id_pool *pool;
+        struct id_pool used = {0, NULL, NULL};
+        int iordt;
+
+        ASSERT(ctx != NULL);
+
+#ifndef PQOS_RMID_CUSTOM
+        UNUSED_PARAM(opt);
+#endif
+        /* Getting max RMID for given event */
+        ret = rmid_get_event_max(cap, &rmid, event);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+        if (rmid - 1 < max_rmid)
+                max_rmid = rmid - 1;
+        if (min_rmid < 1)
+                min_rmid = 1;
+
+        ret = pqos_mon_iordt_enabled(cap, NULL, &iordt);
+        if (ret != PQOS_RETVAL_OK)
+                goto rmid_alloc_error;
+
+        /**
+         * RMIDs of cluster cores are tracked by association cache,
+         * channels need to be checked separately.
+         */
+        pool = msr_shadow_rmid_pool(ctx->cluster);
+        if (pool == NULL || (iordt && dev != NULL)) {
+                ret = hw_mon_assoc_used(ctx, max_rmid, iordt, &used);
+                if (ret != PQOS_RETVAL_OK)
+                        goto rmid_alloc_error;
+                pool = &used;
+        }
+
 #ifdef PQOS_RMID_CUSTOM
         if (opt->rmid.type == PQOS_RMID_TYPE_MAP) {
                 if (opt->rmid.rmid < min_rmid || opt->rmid.rmid > max_rmid) {
@@ -342,7 +401,7 @@ hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
                 }
 
                 if (opt->rmid.rmid > max_rmid ||
-                    rmid_list[opt->rmid.rmid] != 0) {
+                    id_pool_is_used(pool, opt->rmid.rmid)) {
                         LOG_ERROR("Custom RMID %u in use\n", opt->rmid.rmid);
                         ret = PQOS_RETVAL_ERROR;
                         goto rmid_alloc_error;
@@ -352,13 +411,9 @@ hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
 
         } else if (opt->rmid.type == PQOS_RMID_TYPE_DEFAULT) {
 #endif
-                ret = PQOS_RETVAL_ERROR;
-                for (i = min_rmid; i <= max_rmid; i++)
-                        if (rmid_list[i] == 0) {
-                                ret = PQOS_RETVAL_OK;
-                                ctx->rmid = i;
-                                break;
-                        }
+                ret = id_pool_find_free(pool, min_rmid, max_rmid, &rmid);
+                if (ret == PQOS_RETVAL_OK)
+                        ctx->rmid = rmid;
 #ifdef PQOS_RMID_CUSTOM
         } else {
                 LOG_ERROR("RMID Custom: Unsupported rmid type: %u\n",
@@ -367,10 +422,7 @@ hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
 #endif
 
 rmid_alloc_error:
-        if (rmid_list != NULL)
-                free(rmid_list);
-        if (core_list != NULL)
-                free(core_list);
+        id_pool_fini(&used);
         return ret;
 }
 
@@ -466,7 +518,45 @@ hw_mon_assoc_get_channel(const pqos_channel_t channel_id, pqos_rmid_t *rmid)
 int
 hw_mon_reset(const struct pqos_mon_config *cfg)
 {
-        return mon_reset(cfg);
+        int ret;
+
+        ret = mon_reset(cfg);
+        if (ret == PQOS_RETVAL_OK)
+                mbm_sampler_reset();
+
+        return ret;
+}
+
+/**
+ * @brief Acquires event selection locks
+ *
+ * Locks are taken in ascending order to avoid deadlocks.
+ *
+ * @param [in] mask bitmask of locks to acquire
+ */
+static void
+hw_mon_evtsel_lock(const uint64_t mask)
+{
+        unsigned i;
+
+        for (i = 0; i < HW_MON_EVTSEL_LOCKS; i++)
+                if (mask & (1ULL << i))
+                        pthread_mutex_lock(&m_evtsel_lock[i]);
+}
+
+/**
+ * @brief Symmetric operation to \a hw_mon_evtsel_lock to release the locks
+ *
+ * @param [in] mask bitmask of locks to release
+ */
+static void
+hw_mon_evtsel_unlock(const uint64_t mask)
+{
+        unsigned i;
+
+        for (i = 0; i < HW_MON_EVTSEL_LOCKS; i++)
+                if (mask & (1ULL << i))
+                        pthread_mutex_unlock(&m_evtsel_lock[i]);
 }
 
 int
@@ -479,6 +569,7 @@ hw_mon_read(const unsigned lcore,
         uint64_t val = 0;
         uint64_t val_evtsel = 0;
         int flag_wrt = 1;
+        const uint64_t lock = 1ULL << (lcore % HW_MON_EVTSEL_LOCKS);
 
         /**
          * Set event selection register (RMID + event id)
@@ -487,6 +578,7 @@ hw_mon_read(const unsigned lcore,
         val_evtsel <<= PQOS_MSR_MON_EVTSEL_RMID_SHIFT;
         val_evtsel |= ((uint64_t)event) & PQOS_MSR_MON_EVTSEL_EVTID_MASK;
 
+        hw_mon_evtsel_lock(lock);
         for (retries = 0; retries < 4; retries++) {
                 if (flag_wrt) {
                         if (msr_write(lcore, PQOS_MSR_MON_EVTSEL, val_evtsel) !=
@@ -518,6 +610,8 @@ hw_mon_read(const unsigned lcore,
                 retval = PQOS_RETVAL_OK;
                 break;
         }
+        hw_mon_evtsel_unlock(lock);
+
         /**
          * Store event value
          */
@@ -530,6 +624,74 @@ hw_mon_read(const unsigned lcore,
         return retval;
 }
 
+int
+hw_mon_read_batch(const unsigned num_ctx,
+                  const struct pqos_mon_poll_ctx *ctx,
+                  const unsigned event,
+                  uint64_t *values,
+                  struct machine_msr_op *ops)
+{
+        unsigned i;
+        int retval = PQOS_RETVAL_OK;
+        int ret;
+        uint64_t lock = 0;
+
+        ASSERT(ctx != NULL);
+        ASSERT(values != NULL);
+        ASSERT(ops != NULL);
+
+        if (num_ctx == 0)
+                return PQOS_RETVAL_OK;
+
+        /**
+         * Select event and read counter for each context
+         */
+        for (i = 0; i < num_ctx; i++) {
+                uint64_t val_evtsel;
+
+                val_evtsel = ((uint64_t)ctx[i].rmid) &
+                             PQOS_MSR_MON_EVTSEL_RMID_MASK;
+                val_evtsel <<= PQOS_MSR_MON_EVTSEL_RMID_SHIFT;
+                val_evtsel |=
+                    ((uint64_t)event) & PQOS_MSR_MON_EVTSEL_EVTID_MASK;
+
+                ops[i * 2].lcore = ctx[i].lcore;
+                ops[i * 2].reg = PQOS_MSR_MON_EVTSEL;
+                ops[i * 2].op = MACHINE_MSR_OP_WRITE;
+                ops[i * 2].value = val_evtsel;
+
+                ops[i * 2 + 1].lcore = ctx[i].lcore;
+                ops[i * 2 + 1].reg = PQOS_MSR_MON_QMC;
+                ops[i * 2 + 1].op = MACHINE_MSR_OP_READ;
+
+                lock |= 1ULL << (ctx[i].lcore % HW_MON_EVTSEL_LOCKS);
+        }
+
+        hw_mon_evtsel_lock(lock);
+        ret = msr_batch(ops, num_ctx * 2);
+        hw_mon_evtsel_unlock(lock);
+        if (ret != MACHINE_RETVAL_OK)
+                return PQOS_RETVAL_ERROR;
+
+        for (i = 0; i < num_ctx; i++) {
+                const uint64_t val = ops[i * 2 + 1].value;
+
+                if ((val & (PQOS_MSR_MON_QMC_ERROR |
+                            PQOS_MSR_MON_QMC_UNAVAILABLE)) == 0ULL) {
+                        values[i] = val & PQOS_MSR_MON_QMC_DATA_MASK;
+                        continue;
+                }
+
+                /* Data not ready or event selection changed - retry */
+                retval = hw_mon_read(ctx[i].lcore, ctx[i].rmid, event,
+                                     &values[i]);
+                if (retval != PQOS_RETVAL_OK)
+                        break;
+        }
+
+        return retval;
+}
+
 /**
  * @brief Gives the difference between two values with regard to the possible
  *        overrun and counter length
@@ -586,6 +748,7 @@ hw_mon_start_counter(struct pqos_mon_data *group,
         unsigned num_ctxs = 0;
         unsigned i;
         int ret = PQOS_RETVAL_OK;
+        int sampled = 0;
         enum pqos_mon_event ctx_event = (enum pqos_mon_event)(
             event & (PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_LMEM_BW |
                      PQOS_MON_EVENT_TMEM_BW | PQOS_MON_EVENT_RMEM_BW));
@@ -680,12 +843,25 @@ hw_mon_start_counter(struct pqos_mon_data *group,
         }
         ctxs = NULL;
 
+        /* counter read buffers, reused on every poll */
+        group->intl->hw.ops =
+            calloc(num_ctxs * 2, sizeof(group->intl->hw.ops[0]));
+        group->intl->hw.values =
+            calloc(num_ctxs, sizeof(group->intl->hw.values[0]));
+        if (group->intl->hw.ops == NULL || group->intl->hw.values == NULL)
+                ret = PQOS_RETVAL_RESOURCE;
+
+        if (ret == PQOS_RETVAL_OK) {
+                ret = mbm_sampler_add(group->intl->hw.ctx, num_ctxs, ctx_event);
+                sampled = ret == PQOS_RETVAL_OK;
+        }
+
         /**
          * Associate requested cores with
          * the allocated RMID
          */
         group->num_cores = num_cores;
-        for (i = 0; i < num_cores; i++) {
+        for (i = 0; i < num_cores && ret == PQOS_RETVAL_OK; i++) {
                 pqos_rmid_t rmid = core2rmid[i];
 
                 ret = hw_mon_assoc_write(group->cores[i], rmid);
@@ -699,8 +875,15 @@ hw_mon_start_counter(struct pqos_mon_data *group,
         } else {
                 for (i = 0; i < num_cores; i++)
                         (void)hw_mon_assoc_write(group->cores[i], RMID0);
-                if (group->intl->hw.ctx != NULL)
-                        free(group->intl->hw.ctx);
+                if (sampled)
+                        mbm_sampler_remove(group->intl->hw.ctx, num_ctxs,
+                                           ctx_event);
+                free(group->intl->hw.ctx);
+                free(group->intl->hw.ops);
+                free(group->intl->hw.values);
+                group->intl->hw.ctx = NULL;
+                group->intl->hw.ops = NULL;
+                group->intl->hw.values = NULL;
         }
 
 hw_mon_start_counter_exit:
@@ -1108,6 +1291,29 @@ hw_mon_start_channels(const unsigned num_channels,
         for (i = 0; i < group->num_channels; i++)
                 group->channels[i] = channels[i];
 
+        /* counter read buffers, reused on every poll */
+        group->intl->hw.ops =
+            calloc(num_ctx * 2, sizeof(group->intl->hw.ops[0]));
+        group->intl->hw.values =
+            calloc(num_ctx, sizeof(group->intl->hw.values[0]));
+        if (group->intl->hw.ops == NULL || group->intl->hw.values == NULL) {
+                free(group->intl->hw.ops);
+                free(group->intl->hw.values);
+                group->intl->hw.ops = NULL;
+                group->intl->hw.values = NULL;
+                ret = PQOS_RETVAL_RESOURCE;
+                goto hw_mon_start_channels_exit;
+        }
+
+        ret = mbm_sampler_add(ctxs, num_ctx, req_events);
+        if (ret != PQOS_RETVAL_OK) {
+                free(group->intl->hw.ops);
+                free(group->intl->hw.values);
+                group->intl->hw.ops = NULL;
+                group->intl->hw.values = NULL;
+                goto hw_mon_start_channels_exit;
+        }
+
         group->intl->hw.num_ctx = num_ctx;
         group->intl->hw.ctx = ctxs;
         group->intl->hw.event |= req_events;
@@ -1203,6 +1409,9 @@ hw_mon_stop(struct pqos_mon_data *group)
         if (ret != PQOS_RETVAL_OK)
                 retval = ret;
 
+        mbm_sampler_remove(group->intl->hw.ctx, group->intl->hw.num_ctx,
+                           group->intl->hw.event);
+
         /**
          * Free poll contexts, core list and clear the group structure
          */
@@ -1211,6 +1420,8 @@ hw_mon_stop(struct pqos_mon_data *group)
         if (group->channels != NULL)
                 free(group->channels);
         free(group->intl->hw.ctx);
+        free(group->intl->hw.ops);
+        free(group->intl->hw.values);
 
         return retval;
 }
@@ -1224,6 +1435,10 @@ hw_mon_read_counter(struct pqos_mon_data *group,
         uint64_t max_value = 1LLU << 24;
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_monitor *pmon;
+        const unsigned num_ctx = group->intl->hw.num_ctx;
+        uint64_t *values = group->intl->hw.values;
+        const int sampled =
+            event != PQOS_MON_EVENT_L3_OCCUP && mbm_sampler_enabled();
         unsigned i;
         int ret;
 
@@ -1235,20 +1450,25 @@ hw_mon_read_counter(struct pqos_mon_data *group,
         if (ret == PQOS_RETVAL_OK)
                 max_value = 1LLU << pmon->counter_length;
 
-        for (i = 0; i < group->intl->hw.num_ctx; i++) {
-                uint64_t tmp = 0;
-                const unsigned lcore = group->intl->hw.ctx[i].lcore;
-                const pqos_rmid_t rmid = group->intl->hw.ctx[i].rmid;
-                int retval;
-
-                retval = hw_mon_read(lcore, rmid, get_event_id(event), &tmp);
-                if (retval != MACHINE_RETVAL_OK)
+        if (sampled) {
+                /* accumulated 64-bit value, never overflows */
+                ret = mbm_sampler_read(group->intl->hw.ctx, num_ctx, event,
+                                       &value);
+                if (ret != PQOS_RETVAL_OK)
+                        return PQOS_RETVAL_ERROR;
+        } else {
+                ret = hw_mon_read_batch(num_ctx, group->intl->hw.ctx,
+                                        get_event_id(event), values,
+                                        group->intl->hw.ops);
+                if (ret != PQOS_RETVAL_OK)
                         return PQOS_RETVAL_ERROR;
 
-                value += tmp;
+                for (i = 0; i < num_ctx; i++) {
+                        value += values[i];
 
-                if (value >= max_value)
-                        value -= max_value;
+                        if (value >= max_value)
+                                value -= max_value;
+                }
         }
 
         switch (event) {
@@ -1256,7 +1476,8 @@ hw_mon_read_counter(struct pqos_mon_data *group,
                 pv->llc = scale_event(event, value);
                 break;
         case PQOS_MON_EVENT_LMEM_BW:
-                if (pmon->counter_length == 32 && pv->mbm_local > value)
+                if (!sampled && pmon->counter_length == 32 &&
+                    pv->mbm_local > value)
                         ret = PQOS_RETVAL_OVERFLOW;
                 if (group->intl->valid_mbm_read) {
                         pv->mbm_local_delta =
@@ -1269,7 +1490,8 @@ hw_mon_read_counter(struct pqos_mon_data *group,
                 pv->mbm_local = value;
                 break;
         case PQOS_MON_EVENT_TMEM_BW:
-                if (pmon->counter_length == 32 && pv->mbm_local > value)
+                if (!sampled && pmon->counter_length == 32 &&
+                    pv->mbm_local > value)
                         ret = PQOS_RETVAL_OVERFLOW;
                 if (group->intl->valid_mbm_read) {
                         pv->mbm_total_delta =
@@ -41,6 +41,7 @@
 extern "C" {
 #endif
 
+#include "machine.h"
 #include "monitoring.h"
 #include "pqos.h"
 #include "pqos_internal.h"
@@ -261,6 +262,30 @@ PQOS_LOCAL int hw_mon_read(const unsigned lcore,
                            const unsigned event,
                            uint64_t *value);
 
+/**
+ * @brief Reads monitoring event data for a table of poll contexts
+ *
+ * Event selection and counter read for all contexts are submitted
+ * as a single MSR batch. Counters reporting error or unavailable data
+ * are re-read with \a hw_mon_read.
+ *
+ * This function doesn't acquire API lock.
+ *
+ * @param num_ctx number of poll contexts
+ * @param ctx table of poll contexts
+ * @param event monitoring event
+ * @param values table of \a num_ctx elements to store read values
+ * @param ops table of 2 * \a num_ctx MSR operations used for the batch
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int hw_mon_read_batch(const unsigned num_ctx,
+                                 const struct pqos_mon_poll_ctx *ctx,
+                                 const unsigned event,
+                                 uint64_t *values,
+                                 struct machine_msr_op *ops);
+
 /**
  * @brief Hardware interface to start uncore monitoring of selected \a sockets
  *
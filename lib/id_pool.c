@@ -0,0 +1,160 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "id_pool.h"
+
+#include "pqos.h"
+
+#include <stdlib.h>
+
+#define ID_POOL_WORD_BITS 64
+
+/**
+ * @brief Number of bitmap words needed for \a num ids
+ */
+static unsigned
+id_pool_words(const unsigned num)
+{
+        return (num + ID_POOL_WORD_BITS - 1) / ID_POOL_WORD_BITS;
+}
+
+int
+id_pool_init(struct id_pool *pool, const unsigned num)
+{
+        ASSERT(pool != NULL);
+        ASSERT(num > 0);
+
+        pool->num = num;
+        pool->ref = calloc(num, sizeof(pool->ref[0]));
+        pool->used = calloc(id_pool_words(num), sizeof(pool->used[0]));
+        if (pool->ref == NULL || pool->used == NULL) {
+                id_pool_fini(pool);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+void
+id_pool_fini(struct id_pool *pool)
+{
+        if (pool == NULL)
+                return;
+
+        free(pool->ref);
+        free(pool->used);
+        pool->ref = NULL;
+        pool->used = NULL;
+        pool->num = 0;
+}
+
+void
+id_pool_get(struct id_pool *pool, const unsigned id)
+{
+        if (id >= pool->num)
+                return;
+
+        if (pool->ref[id]++ == 0)
+                pool->used[id / ID_POOL_WORD_BITS] |=
+                    1ULL << (id % ID_POOL_WORD_BITS);
+}
+
+void
+id_pool_put(struct id_pool *pool, const unsigned id)
+{
+        if (id >= pool->num)
+                return;
+
+        ASSERT(pool->ref[id] > 0);
+        if (pool->ref[id] == 0)
+                return;
+
+        if (--pool->ref[id] == 0)
+                pool->used[id / ID_POOL_WORD_BITS] &=
+                    ~(1ULL << (id % ID_POOL_WORD_BITS));
+}
+
+int
+id_pool_is_used(const struct id_pool *pool, const unsigned id)
+{
+        if (id >= pool->num)
+                return 0;
+
+        return (pool->used[id / ID_POOL_WORD_BITS] >>
+                (id % ID_POOL_WORD_BITS)) &
+               1;
+}
+
+int
+id_pool_find_free(const struct id_pool *pool,
+                  const unsigned min,
+                  const unsigned max,
+                  unsigned *id)
+{
+        unsigned word = min / ID_POOL_WORD_BITS;
+        uint64_t mask;
+
+        ASSERT(id != NULL);
+
+        if (min > max)
+                return PQOS_RETVAL_ERROR;
+        if (min >= pool->num) {
+                *id = min;
+                return PQOS_RETVAL_OK;
+        }
+
+        /* ignore ids below min in the first word */
+        mask = ~0ULL << (min % ID_POOL_WORD_BITS);
+
+        for (; word < id_pool_words(pool->num); word++) {
+                const uint64_t avail = ~pool->used[word] & mask;
+                unsigned found;
+
+                mask = ~0ULL;
+                if (avail == 0)
+                        continue;
+
+                found = word * ID_POOL_WORD_BITS + __builtin_ctzll(avail);
+                if (found > max)
+                        return PQOS_RETVAL_ERROR;
+
+                *id = found;
+                return PQOS_RETVAL_OK;
+        }
+
+        /* ids past the pool range are free */
+        if (pool->num > max)
+                return PQOS_RETVAL_ERROR;
+
+        *id = pool->num;
+        return PQOS_RETVAL_OK;
+}
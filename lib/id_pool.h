@@ -0,0 +1,128 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Reference counted pool of ids
+ *
+ * Ids with non-zero reference count are marked in a bitmap of 64-bit
+ * words, so that free id lookup takes one bit scan per word.
+ */
+
+#ifndef __PQOS_ID_POOL_H__
+#define __PQOS_ID_POOL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "types.h"
+
+#include <stdint.h>
+
+/**
+ * Pool of ids 0 to num - 1
+ */
+struct id_pool {
+        unsigned num;   /**< number of ids in the pool */
+        unsigned *ref;  /**< reference count of each id */
+        uint64_t *used; /**< bitmap of ids with non-zero reference count */
+};
+
+/**
+ * @brief Initializes pool with no ids in use
+ *
+ * @param [out] pool id pool
+ * @param [in] num number of ids
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE on memory allocation failure
+ */
+PQOS_LOCAL int id_pool_init(struct id_pool *pool, const unsigned num);
+
+/**
+ * @brief Releases memory used by the pool
+ *
+ * @param [in,out] pool id pool
+ */
+PQOS_LOCAL void id_pool_fini(struct id_pool *pool);
+
+/**
+ * @brief Takes reference to \a id, ids out of pool range are ignored
+ *
+ * @param [in,out] pool id pool
+ * @param [in] id id to take
+ */
+PQOS_LOCAL void id_pool_get(struct id_pool *pool, const unsigned id);
+
+/**
+ * @brief Drops reference to \a id, ids out of pool range are ignored
+ *
+ * @param [in,out] pool id pool
+ * @param [in] id id to release
+ */
+PQOS_LOCAL void id_pool_put(struct id_pool *pool, const unsigned id);
+
+/**
+ * @brief Checks if \a id is referenced
+ *
+ * @param [in] pool id pool
+ * @param [in] id id to check
+ *
+ * @return 1 if \a id is in use, 0 if it is free or out of pool range
+ */
+PQOS_LOCAL int id_pool_is_used(const struct id_pool *pool, const unsigned id);
+
+/**
+ * @brief Finds lowest free id in range \a min to \a max
+ *
+ * Ids out of pool range are considered free.
+ *
+ * @param [in] pool id pool
+ * @param [in] min lowest acceptable id
+ * @param [in] max highest acceptable id
+ * @param [out] id free id
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_ERROR all ids in range are in use
+ */
+PQOS_LOCAL int id_pool_find_free(const struct id_pool *pool,
+                                 const unsigned min,
+                                 const unsigned max,
+                                 unsigned *id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_ID_POOL_H__ */
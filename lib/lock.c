@@ -35,6 +35,9 @@
  *
  * provide functions for safe access to PQoS API - this is required for
  * allocation and monitoring modules which also implement PQoS API
+ *
+ * Lock order: API lock, allocation lock, monitoring group locks,
+ * resctrl filesystem lock.
  */
 
 #include "lock.h"
@@ -68,12 +71,30 @@ lock_get(void)
         /* no-op */
 }
 
+void
+lock_get_shared(void)
+{
+        /* no-op */
+}
+
 void
 lock_release(void)
 {
         /* no-op */
 }
 
+void
+lock_alloc_get(void)
+{
+        /* no-op */
+}
+
+void
+lock_alloc_release(void)
+{
+        /* no-op */
+}
+
 #else /* UNLOCK_CUSTOM */
 
 #include "log.h"
@@ -106,7 +127,8 @@ lock_release(void)
  * API thread/process safe access is secured through these locks.
  */
 static int m_apilock = -1;
-static pthread_mutex_t m_apilock_mutex;
+static pthread_rwlock_t m_apilock_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_mutex_t m_alloc_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pid_t m_pid = 0;
 static unsigned long m_start_time = 0;
 
@@ -240,6 +262,36 @@ write_lockfile(pid_t pid, unsigned long start_time)
         return 0;
 }
 
+/**
+ * @brief Initializes API read-write lock
+ *
+ * Writers are preferred where supported so that a stream of monitoring
+ * polls does not starve exclusive API calls.
+ *
+ * @param [out] rwlock lock to initialize
+ *
+ * @return Operation status
+ * retval 0 on success
+ * retval -1 on failure
+ */
+static int
+lock_rwlock_init(pthread_rwlock_t *rwlock)
+{
+        pthread_rwlockattr_t attr;
+        int ret;
+
+        if (pthread_rwlockattr_init(&attr) != 0)
+                return -1;
+#if defined(__linux__) && defined(__GLIBC__)
+        pthread_rwlockattr_setkind_np(
+            &attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+        ret = pthread_rwlock_init(rwlock, &attr);
+        pthread_rwlockattr_destroy(&attr);
+
+        return ret == 0 ? 0 : -1;
+}
+
 int
 lock_init(void)
 {
@@ -331,7 +383,16 @@ lock_init(void)
                 return -1;
         }
 
-        if (pthread_mutex_init(&m_apilock_mutex, NULL) != 0) {
+        if (lock_rwlock_init(&m_apilock_rwlock) != 0) {
+                close(m_apilock);
+                unlink(LOCKFILE);
+                m_apilock = -1;
+                pthread_mutex_unlock(&init_mutex);
+                return -1;
+        }
+
+        if (pthread_mutex_init(&m_alloc_mutex, NULL) != 0) {
+                pthread_rwlock_destroy(&m_apilock_rwlock);
                 close(m_apilock);
                 unlink(LOCKFILE);
                 m_apilock = -1;
@@ -351,7 +412,10 @@ lock_fini(void)
         if (close(m_apilock) != 0)
                 ret = -1;
 
-        if (pthread_mutex_destroy(&m_apilock_mutex) != 0)
+        if (pthread_rwlock_destroy(&m_apilock_rwlock) != 0)
+                ret = -1;
+
+        if (pthread_mutex_destroy(&m_alloc_mutex) != 0)
                 ret = -1;
 
         /* Remove lock file on exit */
@@ -365,16 +429,42 @@ lock_fini(void)
 void
 lock_get(void)
 {
-        if (pthread_mutex_lock(&m_apilock_mutex) != 0)
-                fprintf(stderr, "API mutex lock error: %s\n", strerror(errno));
+        if (pthread_rwlock_wrlock(&m_apilock_rwlock) != 0)
+                fprintf(stderr, "API lock error: %s\n", strerror(errno));
+}
+
+void
+lock_get_shared(void)
+{
+        if (pthread_rwlock_rdlock(&m_apilock_rwlock) != 0)
+                fprintf(stderr, "API lock error: %s\n", strerror(errno));
 }
 
 void
 lock_release(void)
 {
-        if (pthread_mutex_unlock(&m_apilock_mutex) != 0)
-                fprintf(stderr, "API mutex unlock error: %s\n",
+        if (pthread_rwlock_unlock(&m_apilock_rwlock) != 0)
+                fprintf(stderr, "API unlock error: %s\n", strerror(errno));
+}
+
+void
+lock_alloc_get(void)
+{
+        lock_get_shared();
+
+        if (pthread_mutex_lock(&m_alloc_mutex) != 0)
+                fprintf(stderr, "Allocation mutex lock error: %s\n",
                         strerror(errno));
 }
 
+void
+lock_alloc_release(void)
+{
+        if (pthread_mutex_unlock(&m_alloc_mutex) != 0)
+                fprintf(stderr, "Allocation mutex unlock error: %s\n",
+                        strerror(errno));
+
+        lock_release();
+}
+
 #endif /* UNLOCK_CUSTOM */
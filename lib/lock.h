@@ -72,18 +72,43 @@ PQOS_LOCAL int lock_init(void);
 PQOS_LOCAL int lock_fini(void);
 
 /**
- * @brief Acquires lock for PQoS API use
+ * @brief Acquires exclusive lock for PQoS API use
  *
- * Only one thread at a time is allowed to use the API.
- * Each PQoS API need to use api_lock and api_unlock functions.
+ * Taken by API calls changing state shared between subsystems, e.g.
+ * library initialization, monitoring group start and stop or CDP
+ * reconfiguration. No other API call runs while the lock is held.
  */
 PQOS_LOCAL void lock_get(void);
 
 /**
- * @brief Symmetric operation to \a lock_get to release the lock
+ * @brief Acquires shared lock for PQoS API use
+ *
+ * Taken by API calls that only read state immutable after initialization,
+ * e.g. capabilities and CPU topology, or that protect the state they
+ * modify with a subsystem lock. Shared holders run concurrently.
+ */
+PQOS_LOCAL void lock_get_shared(void);
+
+/**
+ * @brief Symmetric operation to \a lock_get and \a lock_get_shared
+ *        to release the lock
  */
 PQOS_LOCAL void lock_release(void);
 
+/**
+ * @brief Acquires shared API lock and allocation lock
+ *
+ * Only one thread at a time is allowed to change or read allocation
+ * configuration and class of service association. Monitoring polls run
+ * concurrently.
+ */
+PQOS_LOCAL void lock_alloc_get(void);
+
+/**
+ * @brief Symmetric operation to \a lock_alloc_get to release the locks
+ */
+PQOS_LOCAL void lock_alloc_release(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,14 +50,55 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sys/ioctl.h>
+#endif
 #ifdef __FreeBSD__
 #include <sys/cpuctl.h>
 #include <sys/ioctl.h>
 #endif
 
+#ifdef __linux__
+/**
+ * MSR batch interface exposed by msr-safe driver
+ */
+#define MSR_BATCH_DEV "/dev/cpu/msr_batch"
+
+struct msr_batch_op {
+        uint16_t cpu;     /**< CPU to execute operation on */
+        uint16_t isrdmsr; /**< 0 - WRMSR, non-zero - RDMSR */
+        int32_t err;      /**< operation error */
+        uint32_t msr;     /**< MSR address */
+        uint64_t msrdata; /**< value to write or value read */
+        uint64_t wmask;   /**< write mask applied to WRMSR */
+};
+
+struct msr_batch_array {
+        uint32_t numops;          /**< number of operations */
+        struct msr_batch_op *ops; /**< table of operations */
+};
+
+#define X86_IOC_MSR_BATCH _IOWR('c', 0xA2, struct msr_batch_array)
+
+/**
+ * Per-thread table of batch operations, grown on demand and reused
+ */
+struct msr_batch_buf {
+        unsigned size;             /**< number of entries in ops table */
+        struct msr_batch_op ops[]; /**< table of operations */
+};
+
+static pthread_once_t m_msr_batch_once = PTHREAD_ONCE_INIT;
+static pthread_key_t m_msr_batch_key; /**< thread's struct msr_batch_buf */
+static int m_msr_batch_key_ok = 0;    /**< set once key has been created */
+#endif
+
 static int *m_msr_fd = NULL;    /**< MSR driver file descriptors table */
 static unsigned m_maxcores = 0; /**< max number of cores (size of the
                                    table above too) */
+static int m_msr_batch_fd = -1; /**< MSR batch driver file descriptor */
+static int m_msr_batch_off = 0; /**< set once batch driver rejected request */
 
 int
 machine_init(const unsigned max_core_id)
@@ -84,6 +125,15 @@ machine_init(const unsigned max_core_id)
         for (i = 0; i < m_maxcores; i++)
                 m_msr_fd[i] = -1;
 
+#ifdef __linux__
+        m_msr_batch_off = 0;
+        m_msr_batch_fd = open(MSR_BATCH_DEV, O_RDWR);
+        if (m_msr_batch_fd < 0)
+                LOG_DEBUG("MSR batch interface not available\n");
+        else
+                LOG_INFO("Using MSR batch interface\n");
+#endif
+
         return MACHINE_RETVAL_OK;
 }
 
@@ -109,6 +159,19 @@ machine_fini(void)
         m_msr_fd = NULL;
         m_maxcores = 0;
 
+        if (m_msr_batch_fd != -1) {
+                close(m_msr_batch_fd);
+                m_msr_batch_fd = -1;
+        }
+
+#ifdef __linux__
+        /* other threads release their buffers on exit */
+        if (m_msr_batch_key_ok) {
+                free(pthread_getspecific(m_msr_batch_key));
+                (void)pthread_setspecific(m_msr_batch_key, NULL);
+        }
+#endif
+
         return MACHINE_RETVAL_OK;
 }
 
@@ -164,10 +227,11 @@ msr_file_open(const unsigned lcore)
         ASSERT(lcore < m_maxcores);
         ASSERT(m_msr_fd != NULL);
 
-        int fd = m_msr_fd[lcore];
+        int fd = __atomic_load_n(&m_msr_fd[lcore], __ATOMIC_ACQUIRE);
 
         if (fd < 0) {
                 char fname[32];
+                int cached = -1;
 
                 memset(fname, 0, sizeof(fname));
 #ifdef __linux__
@@ -179,8 +243,13 @@ msr_file_open(const unsigned lcore)
                 fd = open(fname, O_RDWR);
                 if (fd < 0)
                         LOG_WARN("Error opening file '%s'!\n", fname);
-                else
-                        m_msr_fd[lcore] = fd;
+                /* concurrent caller may have cached its descriptor first */
+                else if (!__atomic_compare_exchange_n(
+                             &m_msr_fd[lcore], &cached, fd, 0,
+                             __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                        close(fd);
+                        fd = cached;
+                }
         }
 
         return fd;
@@ -278,3 +347,166 @@ msr_write(const unsigned lcore, const uint32_t reg, const uint64_t value)
 
         return ret;
 }
+
+#ifdef __linux__
+/**
+ * @brief Creates key of per-thread batch operation tables
+ */
+static void
+msr_batch_key_create(void)
+{
+        if (pthread_key_create(&m_msr_batch_key, free) == 0)
+                m_msr_batch_key_ok = 1;
+}
+
+/**
+ * @brief Retrieves calling thread's table of batch operations
+ *
+ * Table is grown when it holds less than \a num_ops entries
+ * and is kept for subsequent requests of the thread.
+ *
+ * @param [in] num_ops required number of entries
+ *
+ * @return Pointer to the table
+ * @retval NULL on error
+ */
+static struct msr_batch_op *
+msr_batch_buf_get(const unsigned num_ops)
+{
+        struct msr_batch_buf *buf;
+        struct msr_batch_buf *new_buf;
+
+        if (pthread_once(&m_msr_batch_once, msr_batch_key_create) != 0 ||
+            !m_msr_batch_key_ok)
+                return NULL;
+
+        buf = pthread_getspecific(m_msr_batch_key);
+        if (buf != NULL && buf->size >= num_ops)
+                return buf->ops;
+
+        new_buf = realloc(buf, sizeof(*buf) + num_ops * sizeof(buf->ops[0]));
+        if (new_buf == NULL)
+                return NULL;
+        new_buf->size = num_ops;
+
+        if (pthread_setspecific(m_msr_batch_key, new_buf) != 0) {
+                free(new_buf);
+                return NULL;
+        }
+
+        return new_buf->ops;
+}
+
+/**
+ * @brief Executes table of MSR operations using MSR batch driver
+ *
+ * @param [in,out] ops table of MSR operations
+ * @param [in] num_ops number of operations in \a ops table
+ *
+ * @return Operation status
+ * @retval MACHINE_RETVAL_OK on success
+ * @retval MACHINE_RETVAL_PARAM if batch driver can't handle the request
+ */
+static int
+msr_batch_ioctl(struct machine_msr_op *ops, const unsigned num_ops)
+{
+        struct msr_batch_array arr;
+        struct msr_batch_op *bops;
+        int ret = MACHINE_RETVAL_OK;
+        unsigned i;
+
+        bops = msr_batch_buf_get(num_ops);
+        if (bops == NULL)
+                return MACHINE_RETVAL_PARAM;
+
+        for (i = 0; i < num_ops; i++) {
+                if (ops[i].lcore > UINT16_MAX)
+                        return MACHINE_RETVAL_PARAM;
+
+                memset(&bops[i], 0, sizeof(bops[i]));
+                bops[i].cpu = (uint16_t)ops[i].lcore;
+                bops[i].isrdmsr = (ops[i].op == MACHINE_MSR_OP_READ);
+                bops[i].msr = ops[i].reg;
+                if (ops[i].op == MACHINE_MSR_OP_WRITE)
+                        bops[i].msrdata = ops[i].value;
+        }
+
+        arr.numops = num_ops;
+        arr.ops = bops;
+
+        if (ioctl(m_msr_batch_fd, X86_IOC_MSR_BATCH, &arr) != 0) {
+                /**
+                 * Batch driver rejected request, use MSR driver instead.
+                 * Descriptor stays open until machine_fini() as other
+                 * threads may be issuing requests on it.
+                 */
+                if (!__atomic_exchange_n(&m_msr_batch_off, 1,
+                                         __ATOMIC_RELAXED))
+                        LOG_INFO("MSR batch request failed, falling back "
+                                 "to MSR driver\n");
+                return MACHINE_RETVAL_PARAM;
+        }
+
+        for (i = 0; i < num_ops; i++) {
+                if (bops[i].err != 0) {
+                        LOG_ERROR("%s failed for reg[0x%x] on lcore %u\n",
+                                  bops[i].isrdmsr ? "RDMSR" : "WRMSR",
+                                  (unsigned)ops[i].reg, ops[i].lcore);
+                        ret = MACHINE_RETVAL_ERROR;
+                        break;
+                }
+                if (ops[i].op == MACHINE_MSR_OP_READ)
+                        ops[i].value = bops[i].msrdata;
+        }
+
+        return ret;
+}
+#endif
+
+int
+msr_batch(struct machine_msr_op *ops, const unsigned num_ops)
+{
+        unsigned i;
+
+        ASSERT(ops != NULL);
+        if (ops == NULL)
+                return MACHINE_RETVAL_PARAM;
+
+        ASSERT(m_msr_fd != NULL);
+        if (m_msr_fd == NULL)
+                return MACHINE_RETVAL_ERROR;
+
+        for (i = 0; i < num_ops; i++) {
+                ASSERT(ops[i].lcore < m_maxcores);
+                if (ops[i].lcore >= m_maxcores)
+                        return MACHINE_RETVAL_PARAM;
+                if (ops[i].op != MACHINE_MSR_OP_READ &&
+                    ops[i].op != MACHINE_MSR_OP_WRITE)
+                        return MACHINE_RETVAL_PARAM;
+        }
+
+#ifdef __linux__
+        if (m_msr_batch_fd != -1 && num_ops > 1 &&
+            !__atomic_load_n(&m_msr_batch_off, __ATOMIC_RELAXED)) {
+                int ret = msr_batch_ioctl(ops, num_ops);
+
+                if (ret != MACHINE_RETVAL_PARAM)
+                        return ret;
+        }
+#endif
+
+        for (i = 0; i < num_ops; i++) {
+                int ret;
+
+                if (ops[i].op == MACHINE_MSR_OP_READ)
+                        ret = msr_read(ops[i].lcore, ops[i].reg,
+                                       &ops[i].value);
+                else
+                        ret = msr_write(ops[i].lcore, ops[i].reg,
+                                        ops[i].value);
+                if (ret != MACHINE_RETVAL_OK)
+                        return ret;
+        }
+
+        return MACHINE_RETVAL_OK;
+}
@@ -56,6 +56,9 @@ extern "C" {
 /* cpuid leaf for cache topology */
 #define CPUID_LEAF_CACHE 4
 
+#define MACHINE_MSR_OP_READ  0 /**< RDMSR operation */
+#define MACHINE_MSR_OP_WRITE 1 /**< WRMSR operation */
+
 /**
  * Results of CPUID operation are stored in this structure.
  * It consists of 4x32bits IA registers: EAX, EBX, ECX and EDX.
@@ -67,6 +70,16 @@ struct cpuid_out {
         uint32_t edx;
 };
 
+/**
+ * Single MSR operation submitted as part of a batch
+ */
+struct machine_msr_op {
+        unsigned lcore; /**< logical core id */
+        uint32_t reg;   /**< MSR address */
+        int op;         /**< MACHINE_MSR_OP_READ or MACHINE_MSR_OP_WRITE */
+        uint64_t value; /**< value to write or place to store value read */
+};
+
 /**
  * @brief Initializes machine module
  *
@@ -123,6 +136,23 @@ msr_read(const unsigned lcore, const uint32_t reg, uint64_t *value);
 PQOS_LOCAL int
 msr_write(const unsigned lcore, const uint32_t reg, const uint64_t value);
 
+/**
+ * @brief Executes a batch of RDMSR/WRMSR operations
+ *
+ * Operations are executed in table order. Operations targeting the same
+ * logical core are guaranteed to execute in the order they were submitted.
+ * If MSR batch driver is available then whole table is submitted with a
+ * single ioctl, otherwise operations are executed one by one and processing
+ * stops on the first failure.
+ *
+ * @param [in,out] ops table of MSR operations
+ * @param [in] num_ops number of operations in \a ops table
+ *
+ * @return Operation status
+ * @retval MACHINE_RETVAL_OK on success
+ */
+PQOS_LOCAL int msr_batch(struct machine_msr_op *ops, const unsigned num_ops);
+
 #ifdef __cplusplus
 }
 #endif
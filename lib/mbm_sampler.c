@@ -0,0 +1,564 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mbm_sampler.h"
+
+#include "cap.h"
+#include "hw_monitoring.h"
+#include "log.h"
+#include "machine.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Default maximum socket bandwidth in GB/s */
+#define MBM_SAMPLER_DEFAULT_BW 1000
+/** Number of samples taken within counter wrap period */
+#define MBM_SAMPLER_MARGIN 4
+/** Sampling period limits in microseconds */
+#define MBM_SAMPLER_MIN_PERIOD 1000
+#define MBM_SAMPLER_MAX_PERIOD 1000000
+
+/**
+ * Sampled MBM events
+ */
+enum mbm_sampler_evt {
+        MBM_SAMPLER_LMEM = 0,
+        MBM_SAMPLER_TMEM,
+        MBM_SAMPLER_EVT_NUM
+};
+
+static const enum pqos_mon_event m_evt[MBM_SAMPLER_EVT_NUM] = {
+    PQOS_MON_EVENT_LMEM_BW, PQOS_MON_EVENT_TMEM_BW};
+/** IA32_QM_EVTSEL event ids */
+static const unsigned m_evt_id[MBM_SAMPLER_EVT_NUM] = {3, 2};
+
+/**
+ * MBM counter of one RMID in one L3 cluster
+ */
+struct mbm_sampler_counter {
+        unsigned lcore;  /**< core used to read the counter */
+        unsigned refcnt; /**< number of monitoring groups using it */
+        int valid;       /**< last counter value read */
+        uint64_t last;   /**< last counter value */
+        uint64_t acc;    /**< accumulated counter increments */
+};
+
+static struct mbm_sampler_counter *m_counter = NULL;
+static unsigned m_cluster_num = 0;
+static unsigned m_rmid_num = 0;
+static unsigned *m_core_cluster = NULL; /**< L3 cluster of each lcore */
+static unsigned m_core_num = 0;         /**< size of m_core_cluster */
+static uint64_t m_mask[MBM_SAMPLER_EVT_NUM]; /**< counter value mask */
+
+/* Buffers for reading counters, sized for all RMIDs in all clusters */
+static unsigned *m_idx = NULL;
+static struct pqos_mon_poll_ctx *m_ctx = NULL;
+static uint64_t *m_values = NULL;
+static struct machine_msr_op *m_ops = NULL;
+
+/** protects counters and read buffers */
+static pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t m_cond;
+static pthread_t m_thread;
+static int m_started = 0;   /**< sampling thread created */
+static int m_stop = 0;      /**< sampling thread shall exit */
+static uint64_t m_period = 0; /**< sampling period in microseconds */
+
+/**
+ * @brief Gives index of counter read by poll context
+ *
+ * @param [in] ctx poll context
+ * @param [in] evt sampled event
+ * @param [out] idx counter index
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM core or RMID out of range
+ */
+static int
+mbm_sampler_idx(const struct pqos_mon_poll_ctx *ctx,
+                const unsigned evt,
+                unsigned *idx)
+{
+        unsigned cluster;
+
+        if (ctx->lcore >= m_core_num || ctx->rmid >= m_rmid_num)
+                return PQOS_RETVAL_PARAM;
+
+        cluster = m_core_cluster[ctx->lcore];
+        if (cluster >= m_cluster_num)
+                return PQOS_RETVAL_PARAM;
+
+        *idx = (cluster * m_rmid_num + ctx->rmid) * MBM_SAMPLER_EVT_NUM + evt;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Reads counters listed in m_idx and accumulates increments
+ *
+ * Must be called with m_mutex held.
+ *
+ * @param [in] num number of counters in m_idx
+ * @param [in] evt sampled event
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+mbm_sampler_sample(const unsigned num, const unsigned evt)
+{
+        unsigned i;
+        int ret;
+
+        for (i = 0; i < num; i++) {
+                const unsigned idx = m_idx[i];
+
+                m_ctx[i].lcore = m_counter[idx].lcore;
+                m_ctx[i].rmid = (idx / MBM_SAMPLER_EVT_NUM) % m_rmid_num;
+        }
+
+        ret = hw_mon_read_batch(num, m_ctx, m_evt_id[evt], m_values, m_ops);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        for (i = 0; i < num; i++) {
+                struct mbm_sampler_counter *counter = &m_counter[m_idx[i]];
+
+                /* unsigned difference modulo counter length */
+                if (counter->valid)
+                        counter->acc +=
+                            (m_values[i] - counter->last) & m_mask[evt];
+                counter->last = m_values[i];
+                counter->valid = 1;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Samples all counters used by monitoring groups
+ */
+static void
+mbm_sampler_sample_all(void)
+{
+        const unsigned total = m_cluster_num * m_rmid_num * MBM_SAMPLER_EVT_NUM;
+        unsigned evt;
+
+        for (evt = 0; evt < MBM_SAMPLER_EVT_NUM; evt++) {
+                unsigned num = 0;
+                unsigned i;
+
+                for (i = evt; i < total; i += MBM_SAMPLER_EVT_NUM)
+                        if (m_counter[i].refcnt > 0)
+                                m_idx[num++] = i;
+
+                if (num > 0 && mbm_sampler_sample(num, evt) != PQOS_RETVAL_OK)
+                        LOG_DEBUG("Failed to sample MBM counters\n");
+        }
+}
+
+/**
+ * @brief Sampling thread
+ *
+ * @param arg unused
+ */
+static void *
+mbm_sampler_main(void *arg)
+{
+        struct timespec next;
+        struct timespec now;
+
+        UNUSED_PARAM(arg);
+
+        pthread_mutex_lock(&m_mutex);
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        while (!m_stop) {
+                next.tv_sec += m_period / 1000000;
+                next.tv_nsec += (m_period % 1000000) * 1000;
+                if (next.tv_nsec >= 1000000000) {
+                        next.tv_sec++;
+                        next.tv_nsec -= 1000000000;
+                }
+
+                /* do not try to catch up after the process was stopped */
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                if (now.tv_sec > next.tv_sec + 1)
+                        next = now;
+
+                while (!m_stop && pthread_cond_timedwait(&m_cond, &m_mutex,
+                                                         &next) != ETIMEDOUT)
+                        ;
+
+                if (!m_stop)
+                        mbm_sampler_sample_all();
+        }
+        pthread_mutex_unlock(&m_mutex);
+
+        return NULL;
+}
+
+/**
+ * @brief Computes sampling period for MBM event
+ *
+ * @param [in] pmon monitoring event capability
+ * @param [in] bw maximum socket bandwidth in bytes per second
+ *
+ * @return sampling period in microseconds
+ */
+static uint64_t
+mbm_sampler_wrap_period(const struct pqos_monitor *pmon, const uint64_t bw)
+{
+        const uint64_t mask = pmon->counter_length < 64
+                                  ? (1ULL << pmon->counter_length) - 1
+                                  : UINT64_MAX;
+        const double scale =
+            pmon->scale_factor > 0 ? (double)pmon->scale_factor : 1.0;
+        /* bytes counted until counter wraps */
+        const double wrap = ((double)mask + 1.0) * scale;
+        const double period = wrap / (double)bw * 1000000.0;
+
+        if (period / MBM_SAMPLER_MARGIN < MBM_SAMPLER_MIN_PERIOD)
+                return MBM_SAMPLER_MIN_PERIOD;
+        if (period / MBM_SAMPLER_MARGIN > MBM_SAMPLER_MAX_PERIOD)
+                return MBM_SAMPLER_MAX_PERIOD;
+
+        return (uint64_t)(period / MBM_SAMPLER_MARGIN);
+}
+
+int
+mbm_sampler_init(const struct pqos_cpuinfo *cpu, const struct pqos_cap *cap)
+{
+        const char *env = getenv("RDT_MBM_SAMPLER");
+        const struct pqos_capability *item = NULL;
+        pthread_condattr_t attr;
+        uint64_t bw;
+        unsigned total;
+        unsigned evt;
+        unsigned i;
+        int ret = PQOS_RETVAL_OK;
+
+        ASSERT(cpu != NULL);
+        ASSERT(cap != NULL);
+
+        if (env == NULL)
+                return PQOS_RETVAL_OK;
+
+        mbm_sampler_fini();
+
+        if (pqos_cap_get_type(cap, PQOS_CAP_TYPE_MON, &item) !=
+            PQOS_RETVAL_OK)
+                return PQOS_RETVAL_OK;
+
+        bw = strtoull(env, NULL, 10);
+        if (bw == 0)
+                bw = MBM_SAMPLER_DEFAULT_BW;
+        bw *= 1000000000ULL;
+
+        m_period = 0;
+        for (evt = 0; evt < MBM_SAMPLER_EVT_NUM; evt++) {
+                const struct pqos_monitor *pmon;
+                uint64_t period;
+
+                m_mask[evt] = 0;
+                if (pqos_cap_get_event(cap, m_evt[evt], &pmon) !=
+                    PQOS_RETVAL_OK)
+                        continue;
+
+                m_mask[evt] = pmon->counter_length < 64
+                                  ? (1ULL << pmon->counter_length) - 1
+                                  : UINT64_MAX;
+                period = mbm_sampler_wrap_period(pmon, bw);
+                if (m_period == 0 || period < m_period)
+                        m_period = period;
+        }
+        if (m_period == 0) {
+                LOG_INFO("MBM not supported, counters are not sampled\n");
+                return PQOS_RETVAL_OK;
+        }
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                if (cpu->cores[i].lcore >= m_core_num)
+                        m_core_num = cpu->cores[i].lcore + 1;
+                if (cpu->cores[i].l3_id >= m_cluster_num)
+                        m_cluster_num = cpu->cores[i].l3_id + 1;
+        }
+        m_rmid_num = item->u.mon->max_rmid + 1;
+        total = m_cluster_num * m_rmid_num;
+
+        m_core_cluster = malloc(m_core_num * sizeof(m_core_cluster[0]));
+        m_counter = calloc(total * MBM_SAMPLER_EVT_NUM, sizeof(m_counter[0]));
+        m_idx = calloc(total, sizeof(m_idx[0]));
+        m_ctx = calloc(total, sizeof(m_ctx[0]));
+        m_values = calloc(total, sizeof(m_values[0]));
+        m_ops = calloc(total * 2, sizeof(m_ops[0]));
+        if (m_core_cluster == NULL || m_counter == NULL || m_idx == NULL ||
+            m_ctx == NULL || m_values == NULL || m_ops == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto mbm_sampler_init_exit;
+        }
+
+        for (i = 0; i < m_core_num; i++)
+                m_core_cluster[i] = m_cluster_num;
+        for (i = 0; i < cpu->num_cores; i++)
+                m_core_cluster[cpu->cores[i].lcore] = cpu->cores[i].l3_id;
+
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&m_cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        m_stop = 0;
+        if (pthread_create(&m_thread, NULL, mbm_sampler_main, NULL) != 0) {
+                LOG_ERROR("Failed to create MBM sampling thread\n");
+                pthread_cond_destroy(&m_cond);
+                ret = PQOS_RETVAL_ERROR;
+                goto mbm_sampler_init_exit;
+        }
+        m_started = 1;
+
+        LOG_INFO("MBM counters sampled every %llu us\n",
+                 (unsigned long long)m_period);
+
+mbm_sampler_init_exit:
+        if (ret != PQOS_RETVAL_OK)
+                mbm_sampler_fini();
+
+        return ret;
+}
+
+void
+mbm_sampler_fini(void)
+{
+        if (m_started) {
+                pthread_mutex_lock(&m_mutex);
+                m_stop = 1;
+                pthread_cond_signal(&m_cond);
+                pthread_mutex_unlock(&m_mutex);
+
+                pthread_join(m_thread, NULL);
+                pthread_cond_destroy(&m_cond);
+                m_started = 0;
+        }
+
+        free(m_counter);
+        m_counter = NULL;
+        free(m_core_cluster);
+        m_core_cluster = NULL;
+        free(m_idx);
+        m_idx = NULL;
+        free(m_ctx);
+        m_ctx = NULL;
+        free(m_values);
+        m_values = NULL;
+        free(m_ops);
+        m_ops = NULL;
+
+        m_cluster_num = 0;
+        m_rmid_num = 0;
+        m_core_num = 0;
+        m_period = 0;
+}
+
+int
+mbm_sampler_enabled(void)
+{
+        return m_started;
+}
+
+uint64_t
+mbm_sampler_period(void)
+{
+        return m_started ? m_period : 0;
+}
+
+/**
+ * @brief Checks if monitoring events require sampling of MBM event
+ *
+ * @param [in] event monitoring events
+ * @param [in] evt sampled event
+ *
+ * @return 1 if event is sampled
+ */
+static int
+mbm_sampler_event(const enum pqos_mon_event event, const unsigned evt)
+{
+        /* remote bandwidth is computed from local and total */
+        return m_mask[evt] != 0 &&
+               (event & (m_evt[evt] | PQOS_MON_EVENT_RMEM_BW)) != 0;
+}
+
+int
+mbm_sampler_add(const struct pqos_mon_poll_ctx *ctx,
+                const unsigned num_ctx,
+                const enum pqos_mon_event event)
+{
+        unsigned evt;
+        unsigned i;
+        unsigned idx;
+
+        if (!m_started)
+                return PQOS_RETVAL_OK;
+
+        ASSERT(ctx != NULL || num_ctx == 0);
+
+        for (i = 0; i < num_ctx; i++)
+                if (mbm_sampler_idx(&ctx[i], 0, &idx) != PQOS_RETVAL_OK)
+                        return PQOS_RETVAL_PARAM;
+
+        pthread_mutex_lock(&m_mutex);
+        for (evt = 0; evt < MBM_SAMPLER_EVT_NUM; evt++) {
+                unsigned num = 0;
+
+                if (!mbm_sampler_event(event, evt))
+                        continue;
+
+                for (i = 0; i < num_ctx; i++) {
+                        struct mbm_sampler_counter *counter;
+
+                        (void)mbm_sampler_idx(&ctx[i], evt, &idx);
+                        counter = &m_counter[idx];
+                        if (counter->refcnt++ > 0)
+                                continue;
+
+                        counter->lcore = ctx[i].lcore;
+                        counter->valid = 0;
+                        counter->acc = 0;
+                        m_idx[num++] = idx;
+                }
+
+                /* base for accumulation, otherwise taken by next sample */
+                if (num > 0 && mbm_sampler_sample(num, evt) != PQOS_RETVAL_OK)
+                        LOG_DEBUG("Failed to sample MBM counters\n");
+        }
+        pthread_mutex_unlock(&m_mutex);
+
+        return PQOS_RETVAL_OK;
+}
+
+void
+mbm_sampler_remove(const struct pqos_mon_poll_ctx *ctx,
+                   const unsigned num_ctx,
+                   const enum pqos_mon_event event)
+{
+        unsigned evt;
+        unsigned i;
+
+        if (!m_started)
+                return;
+
+        ASSERT(ctx != NULL || num_ctx == 0);
+
+        pthread_mutex_lock(&m_mutex);
+        for (evt = 0; evt < MBM_SAMPLER_EVT_NUM; evt++) {
+                if (!mbm_sampler_event(event, evt))
+                        continue;
+
+                for (i = 0; i < num_ctx; i++) {
+                        unsigned idx;
+
+                        if (mbm_sampler_idx(&ctx[i], evt, &idx) !=
+                            PQOS_RETVAL_OK)
+                                continue;
+                        if (m_counter[idx].refcnt > 0)
+                                m_counter[idx].refcnt--;
+                }
+        }
+        pthread_mutex_unlock(&m_mutex);
+}
+
+void
+mbm_sampler_reset(void)
+{
+        const unsigned total = m_cluster_num * m_rmid_num * MBM_SAMPLER_EVT_NUM;
+        unsigned i;
+
+        if (!m_started)
+                return;
+
+        pthread_mutex_lock(&m_mutex);
+        for (i = 0; i < total; i++) {
+                m_counter[i].refcnt = 0;
+                m_counter[i].valid = 0;
+        }
+        pthread_mutex_unlock(&m_mutex);
+}
+
+int
+mbm_sampler_read(const struct pqos_mon_poll_ctx *ctx,
+                 const unsigned num_ctx,
+                 const enum pqos_mon_event event,
+                 uint64_t *value)
+{
+        const unsigned evt = event == PQOS_MON_EVENT_LMEM_BW
+                                 ? MBM_SAMPLER_LMEM
+                                 : MBM_SAMPLER_TMEM;
+        uint64_t sum = 0;
+        unsigned i;
+        int ret = PQOS_RETVAL_OK;
+
+        ASSERT(event == PQOS_MON_EVENT_LMEM_BW ||
+               event == PQOS_MON_EVENT_TMEM_BW);
+        ASSERT(value != NULL);
+
+        if (!m_started || num_ctx > m_cluster_num * m_rmid_num)
+                return PQOS_RETVAL_PARAM;
+
+        pthread_mutex_lock(&m_mutex);
+        for (i = 0; i < num_ctx; i++) {
+                ret = mbm_sampler_idx(&ctx[i], evt, &m_idx[i]);
+                if (ret != PQOS_RETVAL_OK ||
+                    m_counter[m_idx[i]].refcnt == 0) {
+                        ret = PQOS_RETVAL_PARAM;
+                        goto mbm_sampler_read_exit;
+                }
+        }
+
+        ret = mbm_sampler_sample(num_ctx, evt);
+        if (ret != PQOS_RETVAL_OK) {
+                ret = PQOS_RETVAL_ERROR;
+                goto mbm_sampler_read_exit;
+        }
+
+        for (i = 0; i < num_ctx; i++)
+                sum += m_counter[m_idx[i]].acc;
+        *value = sum;
+
+mbm_sampler_read_exit:
+        pthread_mutex_unlock(&m_mutex);
+
+        return ret;
+}
@@ -0,0 +1,155 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief MBM counter sampler
+ *
+ * MBM counters are 24 or 32 bits wide and wrap within a fraction of a
+ * second on high bandwidth sockets. When the RDT_MBM_SAMPLER environment
+ * variable is set, a background thread reads the MBM counters of all
+ * started monitoring groups more often than the counters can wrap and
+ * keeps 64-bit accumulators per RMID. Polls of monitoring groups on MSR
+ * interface return accumulated values, so no interval is lost to counter
+ * overflow regardless of the polling period.
+ *
+ * The sampling period is a quarter of the time it takes to wrap the
+ * counter at maximum socket bandwidth, given in GB/s as the variable
+ * value (1000 GB/s by default).
+ */
+
+#ifndef __PQOS_MBM_SAMPLER_H__
+#define __PQOS_MBM_SAMPLER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "monitoring.h"
+#include "pqos.h"
+#include "types.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Initializes MBM sampler and starts sampling thread
+ *
+ * Does nothing unless RDT_MBM_SAMPLER environment variable is set.
+ *
+ * @param [in] cpu CPU topology
+ * @param [in] cap capabilities
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE on memory allocation failure
+ * @retval PQOS_RETVAL_ERROR if sampling thread could not be started
+ */
+PQOS_LOCAL int mbm_sampler_init(const struct pqos_cpuinfo *cpu,
+                                const struct pqos_cap *cap);
+
+/**
+ * @brief Stops sampling thread and releases MBM sampler
+ */
+PQOS_LOCAL void mbm_sampler_fini(void);
+
+/**
+ * @brief Checks if MBM counters are sampled
+ *
+ * @return 1 if sampler is running, 0 otherwise
+ */
+PQOS_LOCAL int mbm_sampler_enabled(void);
+
+/**
+ * @brief Gives sampling period
+ *
+ * @return sampling period in microseconds, 0 if sampler is not running
+ */
+PQOS_LOCAL uint64_t mbm_sampler_period(void);
+
+/**
+ * @brief Starts sampling MBM counters of monitoring group
+ *
+ * Counters shared by several groups are sampled once. Current counter
+ * values are read as a base for accumulation.
+ *
+ * @param [in] ctx poll contexts of monitoring group
+ * @param [in] num_ctx number of poll contexts
+ * @param [in] event monitoring events of the group
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success or if sampler is not running
+ * @retval PQOS_RETVAL_PARAM core or RMID out of range
+ */
+PQOS_LOCAL int mbm_sampler_add(const struct pqos_mon_poll_ctx *ctx,
+                               const unsigned num_ctx,
+                               const enum pqos_mon_event event);
+
+/**
+ * @brief Symmetric operation to \a mbm_sampler_add
+ *
+ * @param [in] ctx poll contexts of monitoring group
+ * @param [in] num_ctx number of poll contexts
+ * @param [in] event monitoring events of the group
+ */
+PQOS_LOCAL void mbm_sampler_remove(const struct pqos_mon_poll_ctx *ctx,
+                                   const unsigned num_ctx,
+                                   const enum pqos_mon_event event);
+
+/**
+ * @brief Stops sampling all counters, used on monitoring reset
+ */
+PQOS_LOCAL void mbm_sampler_reset(void);
+
+/**
+ * @brief Reads accumulated MBM counter of monitoring group
+ *
+ * Counters are sampled before accumulators are summed up.
+ *
+ * @param [in] ctx poll contexts of monitoring group
+ * @param [in] num_ctx number of poll contexts
+ * @param [in] event PQOS_MON_EVENT_LMEM_BW or PQOS_MON_EVENT_TMEM_BW
+ * @param [out] value sum of accumulated counter increments
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM counter is not sampled
+ * @retval PQOS_RETVAL_ERROR on counter read error
+ */
+PQOS_LOCAL int mbm_sampler_read(const struct pqos_mon_poll_ctx *ctx,
+                                const unsigned num_ctx,
+                                const enum pqos_mon_event event,
+                                uint64_t *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_MBM_SAMPLER_H__ */
@@ -42,6 +42,179 @@
 #include "string.h"
 
 #include <inttypes.h>
+#include <stdlib.h>
+
+/**
+ * Register block mapped for the library lifetime
+ */
+struct mmio_map {
+        uint64_t address; /**< physical address of the block */
+        uint64_t size;    /**< block size in bytes */
+        uint8_t *mem;     /**< virtual address of the block */
+        int writable;     /**< block mapped for write */
+};
+
+static struct mmio_map *m_map = NULL; /**< register block mappings */
+static unsigned m_map_num = 0;        /**< number of mappings */
+
+/**
+ * @brief Adds register block to mapping table
+ *
+ * @param[in] address physical address of the block
+ * @param[in] size block size in bytes
+ * @param[in] writable map block for write
+ */
+static void
+mmio_map_add(const uint64_t address, const uint64_t size, const int writable)
+{
+        uint8_t *mem;
+        unsigned i;
+
+        if (address == 0 || size == 0)
+                return;
+
+        for (i = 0; i < m_map_num; i++)
+                if (m_map[i].address == address && m_map[i].size == size &&
+                    m_map[i].writable >= writable)
+                        return;
+
+        if (writable)
+                mem = pqos_mmap_write(address, size);
+        else
+                mem = pqos_mmap_read(address, size);
+        if (mem == NULL) {
+                LOG_WARN("Unable to map register block at %#" PRIx64 "\n",
+                         address);
+                return;
+        }
+
+        m_map[m_map_num].address = address;
+        m_map[m_map_num].size = size;
+        m_map[m_map_num].mem = mem;
+        m_map[m_map_num].writable = writable;
+        m_map_num++;
+}
+
+/**
+ * @brief Maps register block for read or write
+ *
+ * Returns address within one of the blocks mapped by mmio_map_init or maps
+ * the block if it is not available.
+ *
+ * @param[in] address physical address
+ * @param[in] size size in bytes
+ * @param[in] writable map for write
+ *
+ * @return virtual address
+ * @retval NULL on error
+ */
+static uint8_t *
+mmio_map(const uint64_t address, const uint64_t size, const int writable)
+{
+        unsigned i;
+
+        for (i = 0; i < m_map_num; i++) {
+                const struct mmio_map *map = &m_map[i];
+
+                if (address >= map->address &&
+                    address + size <= map->address + map->size &&
+                    map->writable >= writable)
+                        return map->mem + (address - map->address);
+        }
+
+        if (writable)
+                return pqos_mmap_write(address, size);
+        else
+                return pqos_mmap_read(address, size);
+}
+
+/**
+ * @brief Releases memory obtained with mmio_map
+ *
+ * @param[in] mem virtual address
+ * @param[in] size size in bytes
+ */
+static void
+mmio_unmap(void *mem, const uint64_t size)
+{
+        unsigned i;
+
+        for (i = 0; i < m_map_num; i++)
+                if ((uint8_t *)mem >= m_map[i].mem &&
+                    (uint8_t *)mem < m_map[i].mem + m_map[i].size)
+                        return;
+
+        pqos_munmap(mem, size);
+}
+
+int
+mmio_map_init(const struct pqos_erdt_info *erdt)
+{
+        unsigned i;
+
+        ASSERT(erdt != NULL);
+        ASSERT(m_map == NULL);
+
+        m_map = calloc(erdt->num_cpu_agents * 6 + erdt->num_dev_agents * 4,
+                       sizeof(*m_map));
+        if (m_map == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        for (i = 0; i < erdt->num_cpu_agents; i++) {
+                const struct pqos_cpu_agent_info *agent = &erdt->cpu_agents[i];
+
+                mmio_map_add(agent->rmdd.control_reg_base_addr, RDT_REG_SIZE,
+                             1);
+                mmio_map_add(agent->cmrc.block_base_addr,
+                             (uint64_t)agent->cmrc.block_size * PAGE_SIZE, 0);
+                mmio_map_add(agent->mmrc.reg_block_base_addr,
+                             (uint64_t)agent->mmrc.reg_block_size * PAGE_SIZE,
+                             0);
+                mmio_map_add(agent->marc.opt_bw_reg_block_base_addr,
+                             (uint64_t)agent->marc.reg_block_size * PAGE_SIZE,
+                             1);
+                mmio_map_add(agent->marc.min_bw_reg_block_base_addr,
+                             (uint64_t)agent->marc.reg_block_size * PAGE_SIZE,
+                             1);
+                mmio_map_add(agent->marc.max_bw_reg_block_base_addr,
+                             (uint64_t)agent->marc.reg_block_size * PAGE_SIZE,
+                             1);
+        }
+
+        for (i = 0; i < erdt->num_dev_agents; i++) {
+                const struct pqos_device_agent_info *agent =
+                    &erdt->dev_agents[i];
+
+                mmio_map_add(agent->rmdd.control_reg_base_addr, RDT_REG_SIZE,
+                             1);
+                mmio_map_add(agent->cmrd.reg_base_addr,
+                             (uint64_t)agent->cmrd.reg_block_size * PAGE_SIZE,
+                             0);
+                mmio_map_add(agent->ibrd.reg_base_addr,
+                             (uint64_t)agent->ibrd.reg_block_size * PAGE_SIZE,
+                             0);
+                mmio_map_add(agent->card.reg_base_addr,
+                             (uint64_t)agent->card.reg_block_size * PAGE_SIZE,
+                             1);
+        }
+
+        LOG_DEBUG("Mapped %u MMIO register blocks\n", m_map_num);
+
+        return PQOS_RETVAL_OK;
+}
+
+void
+mmio_map_fini(void)
+{
+        unsigned i;
+
+        for (i = 0; i < m_map_num; i++)
+                pqos_munmap(m_map[i].mem, m_map[i].size);
+
+        free(m_map);
+        m_map = NULL;
+        m_map_num = 0;
+}
 
 /* Helper functions for MMIO data retriveal */
 
@@ -165,7 +338,7 @@ _copy_generic_rmid_range(unsigned int rmid_first,
         rmid_idx = rmid_first % register_clump_size;
 
         /* Initial number of RMIDs in clump to copy */
-        rmid_to_copy = register_clump_size - rmid_idx + 1;
+        rmid_to_copy = register_clump_size - rmid_idx;
 
         while (rmid_count > 0) {
                 if (rmid_count <= rmid_to_copy) {
@@ -184,7 +357,9 @@ _copy_generic_rmid_range(unsigned int rmid_first,
                         rmid_count -= rmid_to_copy;
                         rmid_to_copy = register_clump_size;
                         rmid_idx = 0;
-                        cur_clump_addr += register_offset;
+                        cur_clump_addr =
+                            (uint64_t *)((uint8_t *)cur_clump_addr +
+                                         register_clump_stride);
                 }
         }
 
@@ -198,14 +373,14 @@ get_mba_mode_v1(const struct pqos_erdt_rmdd *rmdd, uint64_t *value)
 {
         uint64_t *mem;
 
-        mem = (uint64_t *)pqos_mmap_read(rmdd->control_reg_base_addr,
-                                         RDT_REG_SIZE);
+        mem = (uint64_t *)mmio_map(rmdd->control_reg_base_addr, RDT_REG_SIZE,
+                                   0);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
         *value = *mem;
 
-        pqos_munmap(mem, RDT_REG_SIZE);
+        mmio_unmap(mem, RDT_REG_SIZE);
 
         return PQOS_RETVAL_OK;
 }
@@ -218,14 +393,14 @@ set_mbm_mba_mode_v1(const struct pqos_erdt_rmdd *rmdd, unsigned int value)
 
         ASSERT(value <= 1);
 
-        mem = (uint64_t *)pqos_mmap_write(rmdd->control_reg_base_addr,
-                                          RDT_REG_SIZE);
+        mem = (uint64_t *)mmio_map(rmdd->control_reg_base_addr, RDT_REG_SIZE,
+                                   1);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
         *mem = (*mem & RDT_CTRL_TME_RESET_MASK) | (value << RDT_CTRL_TME_SHIFT);
 
-        pqos_munmap(mem, RDT_REG_SIZE);
+        mmio_unmap(mem, RDT_REG_SIZE);
 
         return PQOS_RETVAL_OK;
 }
@@ -240,7 +415,7 @@ get_l3_cmt_rmid_range_v1(const struct pqos_erdt_cmrc *cmrc,
         uint64_t *mem;
         uint64_t size = (uint64_t)cmrc->block_size * PAGE_SIZE;
 
-        mem = (uint64_t *)pqos_mmap_read(cmrc->block_base_addr, size);
+        mem = (uint64_t *)mmio_map(cmrc->block_base_addr, size, 0);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -259,7 +434,7 @@ get_l3_cmt_rmid_range_v1(const struct pqos_erdt_cmrc *cmrc,
                                        cmrc->clump_size, cmrc->clump_stride, 0,
                                        (void *)rmids_val);
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -271,7 +446,7 @@ get_l3_mbm_region_rmid_range_v1(const struct pqos_erdt_mmrc *mmrc,
                                 unsigned int rmid_last,
                                 l3_mbm_rmid_t *rmids_val)
 {
-        unsigned int rmid_count = rmid_last - rmid_first + 1;
+        unsigned int rmid = rmid_first;
         uint64_t rmid_block_addr;
         uint64_t rmid_offset;
         uint64_t *mem;
@@ -284,7 +459,7 @@ get_l3_mbm_region_rmid_range_v1(const struct pqos_erdt_mmrc *mmrc,
                 return PQOS_RETVAL_ERROR;
         }
 
-        mem = (uint64_t *)pqos_mmap_read(mmrc->reg_block_base_addr, size);
+        mem = (uint64_t *)mmio_map(mmrc->reg_block_base_addr, size, 0);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -300,26 +475,40 @@ get_l3_mbm_region_rmid_range_v1(const struct pqos_erdt_mmrc *mmrc,
                  __func__, mmrc->reg_block_base_addr, (void *)mem,
                  mmrc->reg_block_size);
 
-        rmid_block_addr = ((rmid_first % 32) / 8) * 4 * PAGE_SIZE;
-        rmid_offset =
-            ((((rmid_first / 32) * BYTES_PER_RMID_ENTRY) + rmid_first % 8) *
-             BYTES_PER_RMID_ENTRY) +
-            region_num * MBM_REGION_SIZE;
-
-        LOG_INFO("%s(): rmid_block_addr: %#" PRIx64 ", "
-                 "rmid_offset: %#" PRIx64 "\n"
-                 " rmids val virtual address: %p\n",
-                 __func__, rmid_block_addr, rmid_offset,
-                 (void *)((uint8_t *)mem + rmid_block_addr + rmid_offset));
-
-        memcpy(rmids_val,
-               (const void *)((uint8_t *)mem + rmid_block_addr + rmid_offset),
-               rmid_count * BYTES_PER_RMID_ENTRY);
+        /* Registers of 8 consecutive RMIDs are adjacent, next group of 8
+         * RMIDs is located in the next 4 page block
+         */
+        while (rmid <= rmid_last) {
+                unsigned int rmid_count = 8 - rmid % 8;
+
+                if (rmid_count > rmid_last - rmid + 1)
+                        rmid_count = rmid_last - rmid + 1;
+
+                rmid_block_addr = ((rmid % 32) / 8) * 4 * PAGE_SIZE;
+                rmid_offset =
+                    ((((rmid / 32) * BYTES_PER_RMID_ENTRY) + rmid % 8) *
+                     BYTES_PER_RMID_ENTRY) +
+                    region_num * MBM_REGION_SIZE;
+
+                LOG_INFO("%s(): rmid_block_addr: %#" PRIx64 ", "
+                         "rmid_offset: %#" PRIx64 "\n"
+                         " rmids val virtual address: %p\n",
+                         __func__, rmid_block_addr, rmid_offset,
+                         (void *)((uint8_t *)mem + rmid_block_addr +
+                                  rmid_offset));
+
+                memcpy(&rmids_val[rmid - rmid_first],
+                       (const void *)((uint8_t *)mem + rmid_block_addr +
+                                      rmid_offset),
+                       rmid_count * BYTES_PER_RMID_ENTRY);
+
+                rmid += rmid_count;
+        }
 
         LOG_INFO("%s(): rmid_first value: %x\n", __func__,
                  *(uint64_t *)rmids_val);
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return PQOS_RETVAL_OK;
 }
@@ -341,8 +530,7 @@ get_mba_optimal_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
                 return PQOS_RETVAL_ERROR;
         }
 
-        mem =
-            (uint64_t *)pqos_mmap_read(marc->opt_bw_reg_block_base_addr, size);
+        mem = (uint64_t *)mmio_map(marc->opt_bw_reg_block_base_addr, size, 0);
 
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
@@ -359,7 +547,7 @@ get_mba_optimal_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
         ret = _get_clos_region_value(
             *_get_clos_addr_by_region(mem, region_num, clos_number), region_num,
             value);
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -381,8 +569,7 @@ set_mba_optimal_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
                 return PQOS_RETVAL_ERROR;
         }
 
-        mem =
-            (uint64_t *)pqos_mmap_write(marc->opt_bw_reg_block_base_addr, size);
+        mem = (uint64_t *)mmio_map(marc->opt_bw_reg_block_base_addr, size, 1);
 
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
@@ -399,7 +586,7 @@ set_mba_optimal_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
             _get_clos_addr_by_region(mem, region_num, clos_number), region_num,
             value);
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -421,8 +608,7 @@ get_mba_min_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
                 return PQOS_RETVAL_ERROR;
         }
 
-        mem =
-            (uint64_t *)pqos_mmap_read(marc->min_bw_reg_block_base_addr, size);
+        mem = (uint64_t *)mmio_map(marc->min_bw_reg_block_base_addr, size, 0);
 
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
@@ -439,7 +625,7 @@ get_mba_min_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
             *_get_clos_addr_by_region(mem, region_num, clos_number), region_num,
             value);
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -461,8 +647,7 @@ set_mba_min_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
                 return PQOS_RETVAL_ERROR;
         }
 
-        mem =
-            (uint64_t *)pqos_mmap_write(marc->min_bw_reg_block_base_addr, size);
+        mem = (uint64_t *)mmio_map(marc->min_bw_reg_block_base_addr, size, 1);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -478,7 +663,7 @@ set_mba_min_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
             _get_clos_addr_by_region(mem, region_num, clos_number), region_num,
             value);
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -500,8 +685,7 @@ get_mba_max_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
                 return PQOS_RETVAL_ERROR;
         }
 
-        mem =
-            (uint64_t *)pqos_mmap_read(marc->max_bw_reg_block_base_addr, size);
+        mem = (uint64_t *)mmio_map(marc->max_bw_reg_block_base_addr, size, 0);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -516,7 +700,7 @@ get_mba_max_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
         ret = _get_clos_region_value(
             *_get_clos_addr_by_region(mem, region_num, clos_number), region_num,
             value);
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -538,8 +722,7 @@ set_mba_max_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
                 return PQOS_RETVAL_ERROR;
         }
 
-        mem =
-            (uint64_t *)pqos_mmap_write(marc->max_bw_reg_block_base_addr, size);
+        mem = (uint64_t *)mmio_map(marc->max_bw_reg_block_base_addr, size, 1);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -555,7 +738,7 @@ set_mba_max_bw_region_clos_v1(const struct pqos_erdt_marc *marc,
             _get_clos_addr_by_region(mem, region_num, clos_number), region_num,
             value);
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -570,7 +753,7 @@ get_iol3_cmt_rmid_range_v1(const struct pqos_erdt_cmrd *cmrd,
         uint64_t *mem;
         uint64_t size = (uint64_t)cmrd->reg_block_size * PAGE_SIZE;
 
-        mem = (uint64_t *)pqos_mmap_read(cmrd->reg_base_addr, size);
+        mem = (uint64_t *)mmio_map(cmrd->reg_base_addr, size, 0);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -588,7 +771,7 @@ get_iol3_cmt_rmid_range_v1(const struct pqos_erdt_cmrd *cmrd,
         ret = _copy_generic_rmid_range(rmid_first, rmid_last, mem,
                                        cmrd->clump_size, PAGE_SIZE,
                                        cmrd->offset, (void *)rmids_val);
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -603,7 +786,7 @@ get_total_iol3_mbm_rmid_range_v1(const struct pqos_erdt_ibrd *ibrd,
         uint64_t *mem;
         uint64_t size = (uint64_t)ibrd->reg_block_size * PAGE_SIZE;
 
-        mem = (uint64_t *)pqos_mmap_read(ibrd->reg_base_addr, size);
+        mem = (uint64_t *)mmio_map(ibrd->reg_base_addr, size, 0);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -620,7 +803,7 @@ get_total_iol3_mbm_rmid_range_v1(const struct pqos_erdt_ibrd *ibrd,
         ret = _copy_generic_rmid_range(rmid_first, rmid_last, mem,
                                        ibrd->bw_reg_clump_size, PAGE_SIZE,
                                        ibrd->bw_reg_offset, (void *)rmids_val);
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -635,7 +818,7 @@ get_miss_iol3_mbm_rmid_range_v1(const struct pqos_erdt_ibrd *ibrd,
         uint64_t *mem;
         uint64_t size = (uint64_t)ibrd->reg_block_size * PAGE_SIZE;
 
-        mem = (uint64_t *)pqos_mmap_read(ibrd->reg_base_addr, size);
+        mem = (uint64_t *)mmio_map(ibrd->reg_base_addr, size, 0);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -654,7 +837,7 @@ get_miss_iol3_mbm_rmid_range_v1(const struct pqos_erdt_ibrd *ibrd,
             rmid_first, rmid_last, mem, ibrd->miss_reg_clump_size, PAGE_SIZE,
             ibrd->miss_bw_reg_offset, (void *)rmids_val);
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return ret;
 }
@@ -668,7 +851,7 @@ get_iol3_cbm_clos_v1(const struct pqos_erdt_card *card,
         uint64_t *mem;
         uint64_t size = (uint64_t)card->reg_block_size * (uint64_t)PAGE_SIZE;
 
-        mem = (uint64_t *)pqos_mmap_read(card->reg_base_addr, size);
+        mem = (uint64_t *)mmio_map(card->reg_base_addr, size, 0);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -686,7 +869,7 @@ get_iol3_cbm_clos_v1(const struct pqos_erdt_card *card,
                                (PAGE_SIZE * block_number));
         *value = *value >> IOL3_CBM_SHIFT;
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return PQOS_RETVAL_OK;
 }
@@ -700,7 +883,7 @@ set_iol3_cbm_clos_v1(const struct pqos_erdt_card *card,
         uint64_t *mem;
         uint64_t size = (uint64_t)card->reg_block_size * (uint64_t)PAGE_SIZE;
 
-        mem = (uint64_t *)pqos_mmap_write(card->reg_base_addr, size);
+        mem = (uint64_t *)mmio_map(card->reg_base_addr, size, 1);
         if (mem == NULL)
                 return PQOS_RETVAL_ERROR;
 
@@ -717,7 +900,7 @@ set_iol3_cbm_clos_v1(const struct pqos_erdt_card *card,
                 LOG_ERROR("%s: Register Block Size is 0. "
                           "Unable to write IO L3 CBM.\n",
                           __func__);
-                pqos_munmap(mem, size);
+                mmio_unmap(mem, size);
                 return PQOS_RETVAL_ERROR;
         }
 
@@ -728,7 +911,7 @@ set_iol3_cbm_clos_v1(const struct pqos_erdt_card *card,
                 *clos_addr = value << IOL3_CBM_SHIFT;
         }
 
-        pqos_munmap(mem, size);
+        mmio_unmap(mem, size);
 
         return PQOS_RETVAL_OK;
 }
@@ -113,6 +113,28 @@ typedef uint64_t iol3_cmt_rmid_t;
 /* Describes both TOTAL_IO_BW_RMID and IO_MISS_BW_RMID registers */
 typedef uint64_t iol3_mbm_rmid_t;
 
+/* MMIO register block mapping */
+
+/**
+ * @brief Maps all ERDT register blocks (RMDD, CMRC, MMRC, MARC, CMRD, IBRD
+ * and CARD) once so that register accessors don't need to map and unmap
+ * /dev/mem on every access
+ *
+ * Blocks that fail to map are accessed through per call mapping.
+ *
+ * @param[in] erdt ERDT table info
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if memory allocation fails
+ */
+int mmio_map_init(const struct pqos_erdt_info *erdt);
+
+/**
+ * @brief Unmaps register blocks mapped by mmio_map_init
+ */
+void mmio_map_fini(void);
+
 /* MMIO data retrieval functions */
 
 /**
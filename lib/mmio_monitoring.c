@@ -44,18 +44,21 @@
 #include "common_monitoring.h"
 #include "cpu_registers.h"
 #include "cpuinfo.h"
+#include "id_pool.h"
 #include "iordt.h"
 #include "log.h"
 #include "machine.h"
 #include "mmio.h"
 #include "mmio_common.h"
 #include "monitoring.h"
+#include "msr_shadow.h"
 #include "perf_monitoring.h"
 #include "utils.h"
 
 #include <dirent.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -71,6 +74,23 @@ struct rmid_list_t {
         pqos_rmid_t *rmids;
 };
 
+/**
+ * RMID counters of a CPU agent read once per pqos_mon_poll() call
+ */
+struct mmio_mon_snapshot {
+        pqos_rmid_t rmid_first;                   /**< first RMID in use */
+        pqos_rmid_t rmid_last;                    /**< last RMID in use */
+        int cmt_valid;                            /**< L3 occupancy read */
+        int mbm_valid[PQOS_MAX_MEM_REGIONS];      /**< region MBM read */
+        l3_cmt_rmid_t *cmt;                       /**< L3 occupancy counters */
+        l3_mbm_rmid_t *mbm[PQOS_MAX_MEM_REGIONS]; /**< region MBM counters */
+        pthread_mutex_t lock; /**< serializes lazy reads of parallel poll */
+        pthread_mutex_t poll_lock; /**< held by poll using the snapshot */
+};
+
+static struct mmio_mon_snapshot *m_snapshot = NULL; /**< per CPU agent */
+static unsigned m_snapshot_num = 0;                 /**< number of agents */
+
 /*
  * =======================================
  * =======================================
@@ -81,6 +101,77 @@ struct rmid_list_t {
  * =======================================
  */
 
+/**
+ * @brief Releases RMID counter snapshot buffers
+ */
+static void
+mmio_mon_snapshot_fini(void)
+{
+        unsigned i;
+        int j;
+
+        for (i = 0; i < m_snapshot_num; i++) {
+                free(m_snapshot[i].cmt);
+                for (j = 0; j < PQOS_MAX_MEM_REGIONS; j++)
+                        free(m_snapshot[i].mbm[j]);
+                pthread_mutex_destroy(&m_snapshot[i].lock);
+                pthread_mutex_destroy(&m_snapshot[i].poll_lock);
+        }
+
+        free(m_snapshot);
+        m_snapshot = NULL;
+        m_snapshot_num = 0;
+}
+
+/**
+ * @brief Allocates RMID counter snapshot buffers for all CPU agents
+ *
+ * @param [in] erdt ERDT table info
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if memory allocation fails
+ */
+static int
+mmio_mon_snapshot_init(const struct pqos_erdt_info *erdt)
+{
+        unsigned i;
+        int j;
+
+        if (erdt == NULL || erdt->num_cpu_agents == 0)
+                return PQOS_RETVAL_OK;
+
+        m_snapshot = calloc(erdt->num_cpu_agents, sizeof(*m_snapshot));
+        if (m_snapshot == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        m_snapshot_num = erdt->num_cpu_agents;
+        for (i = 0; i < m_snapshot_num; i++) {
+                pthread_mutex_init(&m_snapshot[i].lock, NULL);
+                pthread_mutex_init(&m_snapshot[i].poll_lock, NULL);
+        }
+
+        for (i = 0; i < m_snapshot_num; i++) {
+                struct mmio_mon_snapshot *snap = &m_snapshot[i];
+
+                snap->cmt = calloc(m_rmid_max + 1, sizeof(*snap->cmt));
+                if (snap->cmt == NULL)
+                        goto mmio_mon_snapshot_init_error;
+
+                for (j = 0; j < PQOS_MAX_MEM_REGIONS; j++) {
+                        snap->mbm[j] =
+                            calloc(m_rmid_max + 1, sizeof(*snap->mbm[j]));
+                        if (snap->mbm[j] == NULL)
+                                goto mmio_mon_snapshot_init_error;
+                }
+        }
+
+        return PQOS_RETVAL_OK;
+
+mmio_mon_snapshot_init_error:
+        mmio_mon_snapshot_fini();
+        return PQOS_RETVAL_RESOURCE;
+}
+
 int
 mmio_mon_init(const struct pqos_cpuinfo *cpu, const struct pqos_cap *cap)
 {
@@ -100,6 +191,10 @@ mmio_mon_init(const struct pqos_cpuinfo *cpu, const struct pqos_cap *cap)
         }
         LOG_DEBUG("Max RMID per monitoring cluster is %u\n", m_rmid_max);
 
+        ret = mmio_mon_snapshot_init(_pqos_get_erdt());
+        if (ret != PQOS_RETVAL_OK)
+                goto mmio_mon_init_exit;
+
 #ifdef __linux__
         ret = perf_mon_init(cpu, cap);
         if (ret == PQOS_RETVAL_RESOURCE)
@@ -116,6 +211,7 @@ mmio_mon_init_exit:
 int
 mmio_mon_fini(void)
 {
+        mmio_mon_snapshot_fini();
         m_rmid_max = 0;
 
 #ifdef __linux__
@@ -197,6 +293,60 @@ rmid_get_event_max(const struct pqos_cap *cap,
         return PQOS_RETVAL_OK;
 }
 
+/**
+ * @brief Marks RMIDs associated with cores of the cluster
+ *
+ * @param [in] ctx poll context with cluster id
+ * @param [in] max_rmid highest RMID of interest
+ * @param [out] used pool of used RMIDs, to be released by the caller
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK success
+ */
+static int
+mmio_mon_assoc_used(const struct pqos_mon_poll_ctx *ctx,
+                    const pqos_rmid_t max_rmid,
+                    struct id_pool *used)
+{
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+        int ret = PQOS_RETVAL_OK;
+        const unsigned *core_list = NULL;
+        unsigned *core_alloc = NULL;
+        unsigned i, core_count;
+
+        ret = id_pool_init(used, max_rmid + 1);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        /**
+         * Check for free RMID in the cluster by reading current associations.
+         */
+        core_list = pqos_cpu_get_cores_span(cpu, TOPO_OBJ_L3_CLUSTER,
+                                            ctx->cluster, &core_count);
+        if (core_list == NULL) {
+                core_alloc =
+                    pqos_cpu_get_cores_l3id(cpu, ctx->cluster, &core_count);
+                core_list = core_alloc;
+        }
+        if (core_list == NULL)
+                return PQOS_RETVAL_ERROR;
+        ASSERT(core_count > 0);
+
+        /* Mark RMIDs used for core monitoring */
+        for (i = 0; i < core_count; i++) {
+                pqos_rmid_t rmid;
+
+                ret = mmio_mon_assoc_read(core_list[i], &rmid);
+                if (ret != PQOS_RETVAL_OK)
+                        break;
+                id_pool_get(used, rmid);
+        }
+
+        if (core_alloc != NULL)
+                free(core_alloc);
+        return ret;
+}
+
 int
 mmio_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
                       const enum pqos_mon_event event,
@@ -204,13 +354,11 @@ mmio_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
                       pqos_rmid_t max_rmid,
                       const struct pqos_mon_options *opt)
 {
-        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
         const struct pqos_cap *cap = _pqos_get_cap();
         int ret = PQOS_RETVAL_OK;
         unsigned rmid = 0;
-        unsigned *core_list = NULL;
-        unsigned i, core_count;
-        uint8_t *rmid_list = NULL;
+        const struct id_pool *pool;
+        struct id_pool used = {0, NULL, NULL};
 
         ASSERT(ctx != NULL);
 
@@ -226,30 +374,13 @@ mmio_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
         if (min_rmid < 1)
                 min_rmid = 1;
 
-        /* list of used RMIDs */
-        rmid_list = (uint8_t *)calloc(max_rmid + 2, sizeof(rmid_list[0]));
-        if (rmid_list == NULL)
-                return PQOS_RETVAL_RESOURCE;
-
-        /**
-         * Check for free RMID in the cluster by reading current associations.
-         */
-        core_list = pqos_cpu_get_cores_l3id(cpu, ctx->cluster, &core_count);
-        if (core_list == NULL) {
-                ret = PQOS_RETVAL_ERROR;
-                goto rmid_alloc_error;
-        }
-        ASSERT(core_count > 0);
-
-        /* Mark RMIDs used for core monitoring */
-        for (i = 0; i < core_count; i++) {
-                pqos_rmid_t rmid;
-
-                ret = mmio_mon_assoc_read(core_list[i], &rmid);
+        /* RMIDs of cluster cores are tracked by association cache */
+        pool = msr_shadow_rmid_pool(ctx->cluster);
+        if (pool == NULL) {
+                ret = mmio_mon_assoc_used(ctx, max_rmid, &used);
                 if (ret != PQOS_RETVAL_OK)
                         goto rmid_alloc_error;
-                if (rmid <= max_rmid)
-                        rmid_list[rmid] = 1;
+                pool = &used;
         }
 
 #ifdef PQOS_RMID_CUSTOM
@@ -262,7 +393,7 @@ mmio_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
                 }
 
                 if (opt->rmid.rmid > max_rmid ||
-                    rmid_list[opt->rmid.rmid] != 0) {
+                    id_pool_is_used(pool, opt->rmid.rmid)) {
                         LOG_ERROR("Custom RMID %u in use\n", opt->rmid.rmid);
                         ret = PQOS_RETVAL_ERROR;
                         goto rmid_alloc_error;
@@ -272,13 +403,9 @@ mmio_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
 
         } else if (opt->rmid.type == PQOS_RMID_TYPE_DEFAULT) {
 #endif
-                ret = PQOS_RETVAL_ERROR;
-                for (i = min_rmid; i <= max_rmid; i++)
-                        if (rmid_list[i] == 0) {
-                                ret = PQOS_RETVAL_OK;
-                                ctx->rmid = i;
-                                break;
-                        }
+                ret = id_pool_find_free(pool, min_rmid, max_rmid, &rmid);
+                if (ret == PQOS_RETVAL_OK)
+                        ctx->rmid = rmid;
 #ifdef PQOS_RMID_CUSTOM
         } else {
                 LOG_ERROR("RMID Custom: Unsupported rmid type: %u\n",
@@ -287,10 +414,7 @@ mmio_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
 #endif
 
 rmid_alloc_error:
-        if (rmid_list != NULL)
-                free(rmid_list);
-        if (core_list != NULL)
-                free(core_list);
+        id_pool_fini(&used);
         return ret;
 }
 
@@ -1071,6 +1195,247 @@ mmio_mon_stop(struct pqos_mon_data *group)
         return retval;
 }
 
+/**
+ * @brief Checks if groups use snapshot of CPU agent
+ *
+ * @param [in] cores_domains CPU agent of each core
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ * @param [in] domain CPU agent index
+ *
+ * @return 1 if any group reads counters of \a domain, 0 otherwise
+ */
+static int
+mmio_mon_snapshot_used(const struct pqos_cores_domains *cores_domains,
+                       struct pqos_mon_data **groups,
+                       const unsigned num_groups,
+                       const unsigned domain)
+{
+        unsigned i, j;
+
+        for (i = 0; i < num_groups; i++) {
+                const struct pqos_mon_data_internal *intl = groups[i]->intl;
+
+                if (!(intl->hw.event &
+                      (PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_TMEM_BW)))
+                        continue;
+
+                for (j = 0; j < intl->hw.num_ctx; j++) {
+                        const unsigned lcore = intl->hw.ctx[j].lcore;
+
+                        if (lcore < cores_domains->num_cores &&
+                            cores_domains->domains[lcore] == domain &&
+                            intl->hw.ctx[j].rmid <= m_rmid_max)
+                                return 1;
+                }
+        }
+
+        return 0;
+}
+
+void
+mmio_mon_snapshot_begin(struct pqos_mon_data **groups,
+                        const unsigned num_groups)
+{
+        const struct pqos_cores_domains *cores_domains =
+            _pqos_get_cores_domains();
+        unsigned i, j;
+
+        if (m_snapshot == NULL || cores_domains == NULL)
+                return;
+
+        /**
+         * Lock snapshots of CPU agents used by the groups only, in ascending
+         * order, so polls of groups on other CPU agents run concurrently.
+         */
+        for (i = 0; i < m_snapshot_num; i++) {
+                struct mmio_mon_snapshot *snap = &m_snapshot[i];
+
+                if (!mmio_mon_snapshot_used(cores_domains, groups, num_groups,
+                                            i))
+                        continue;
+
+                pthread_mutex_lock(&snap->poll_lock);
+                snap->rmid_first = m_rmid_max;
+                snap->rmid_last = 0;
+                snap->cmt_valid = 0;
+                memset(snap->mbm_valid, 0, sizeof(snap->mbm_valid));
+        }
+
+        /* Find range of RMIDs in use on each CPU agent */
+        for (i = 0; i < num_groups; i++) {
+                struct pqos_mon_data_internal *intl = groups[i]->intl;
+
+                if (!(intl->hw.event &
+                      (PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_TMEM_BW)))
+                        continue;
+
+                for (j = 0; j < intl->hw.num_ctx; j++) {
+                        const unsigned lcore = intl->hw.ctx[j].lcore;
+                        const pqos_rmid_t rmid = intl->hw.ctx[j].rmid;
+                        struct mmio_mon_snapshot *snap;
+
+                        if (lcore >= cores_domains->num_cores ||
+                            cores_domains->domains[lcore] >= m_snapshot_num ||
+                            rmid > m_rmid_max)
+                                continue;
+
+                        snap = &m_snapshot[cores_domains->domains[lcore]];
+                        if (rmid < snap->rmid_first)
+                                snap->rmid_first = rmid;
+                        if (rmid > snap->rmid_last)
+                                snap->rmid_last = rmid;
+                }
+
+                intl->hw.snapshot = 1;
+        }
+}
+
+void
+mmio_mon_snapshot_end(struct pqos_mon_data **groups,
+                      const unsigned num_groups)
+{
+        const struct pqos_cores_domains *cores_domains =
+            _pqos_get_cores_domains();
+        unsigned i;
+
+        if (m_snapshot == NULL || cores_domains == NULL)
+                return;
+
+        for (i = 0; i < num_groups; i++)
+                groups[i]->intl->hw.snapshot = 0;
+
+        for (i = 0; i < m_snapshot_num; i++)
+                if (mmio_mon_snapshot_used(cores_domains, groups, num_groups,
+                                           i))
+                        pthread_mutex_unlock(&m_snapshot[i].poll_lock);
+}
+
+/**
+ * @brief Gets RMID counter snapshot of CPU agent
+ *
+ * @param [in] group monitoring group being polled
+ * @param [in] domain CPU agent index
+ * @param [in] rmid RMID to be read
+ *
+ * @return snapshot covering \a rmid
+ * @retval NULL if snapshot is not available
+ */
+static struct mmio_mon_snapshot *
+mmio_mon_snapshot_get(const struct pqos_mon_data *group,
+                      const unsigned domain,
+                      const pqos_rmid_t rmid)
+{
+        struct mmio_mon_snapshot *snap;
+
+        /* CPU agents of the group are locked by mmio_mon_snapshot_begin */
+        if (!group->intl->hw.snapshot || domain >= m_snapshot_num)
+                return NULL;
+
+        snap = &m_snapshot[domain];
+        if (rmid < snap->rmid_first || rmid > snap->rmid_last)
+                return NULL;
+
+        return snap;
+}
+
+/**
+ * @brief Reads L3 occupancy counter of \a rmid
+ *
+ * When snapshot is taken all counters of the CPU agent in use are read
+ * with the first call and following calls are served from the snapshot.
+ *
+ * @param [in] group monitoring group being polled
+ * @param [in] domain CPU agent index
+ * @param [in] cmrc CMRC structure of the CPU agent
+ * @param [in] rmid RMID to be read
+ * @param [out] value counter value
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+mmio_mon_read_cmt(const struct pqos_mon_data *group,
+                  const unsigned domain,
+                  const struct pqos_erdt_cmrc *cmrc,
+                  const pqos_rmid_t rmid,
+                  l3_cmt_rmid_t *value)
+{
+        struct mmio_mon_snapshot *snap =
+            mmio_mon_snapshot_get(group, domain, rmid);
+        int ret;
+
+        if (snap == NULL)
+                return get_l3_cmt_rmid_range_v1(cmrc, rmid, rmid, value);
+
+        pthread_mutex_lock(&snap->lock);
+        if (!snap->cmt_valid) {
+                ret = get_l3_cmt_rmid_range_v1(cmrc, snap->rmid_first,
+                                               snap->rmid_last, snap->cmt);
+                if (ret != PQOS_RETVAL_OK) {
+                        pthread_mutex_unlock(&snap->lock);
+                        return ret;
+                }
+                snap->cmt_valid = 1;
+        }
+
+        *value = snap->cmt[rmid - snap->rmid_first];
+        pthread_mutex_unlock(&snap->lock);
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Reads region MBM counter of \a rmid
+ *
+ * When snapshot is taken all counters of the CPU agent in use are read
+ * with the first call and following calls are served from the snapshot.
+ *
+ * @param [in] group monitoring group being polled
+ * @param [in] domain CPU agent index
+ * @param [in] mmrc MMRC structure of the CPU agent
+ * @param [in] region_num memory region number
+ * @param [in] rmid RMID to be read
+ * @param [out] value counter value
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+mmio_mon_read_mbm(const struct pqos_mon_data *group,
+                  const unsigned domain,
+                  const struct pqos_erdt_mmrc *mmrc,
+                  const int region_num,
+                  const pqos_rmid_t rmid,
+                  l3_mbm_rmid_t *value)
+{
+        struct mmio_mon_snapshot *snap =
+            mmio_mon_snapshot_get(group, domain, rmid);
+        int ret;
+
+        if (snap == NULL || region_num < 0 ||
+            region_num >= PQOS_MAX_MEM_REGIONS)
+                return get_l3_mbm_region_rmid_range_v1(mmrc, region_num, rmid,
+                                                       rmid, value);
+
+        pthread_mutex_lock(&snap->lock);
+        if (!snap->mbm_valid[region_num]) {
+                ret = get_l3_mbm_region_rmid_range_v1(
+                    mmrc, region_num, snap->rmid_first, snap->rmid_last,
+                    snap->mbm[region_num]);
+                if (ret != PQOS_RETVAL_OK) {
+                        pthread_mutex_unlock(&snap->lock);
+                        return ret;
+                }
+                snap->mbm_valid[region_num] = 1;
+        }
+
+        *value = snap->mbm[region_num][rmid - snap->rmid_first];
+        pthread_mutex_unlock(&snap->lock);
+
+        return PQOS_RETVAL_OK;
+}
+
 int
 mmio_mon_read_counter(struct pqos_mon_data *group,
                       const enum pqos_mon_event event)
@@ -1102,12 +1467,14 @@ mmio_mon_read_counter(struct pqos_mon_data *group,
                 for (i = 0; i < group->intl->hw.num_ctx; i++) {
                         const unsigned lcore = group->intl->hw.ctx[i].lcore;
                         const pqos_rmid_t rmid = group->intl->hw.ctx[i].rmid;
+                        const unsigned domain = cores_domains->domains[lcore];
                         const struct pqos_erdt_cmrc *cmrc =
-                            &erdt->cpu_agents[cores_domains->domains[lcore]]
-                                 .cmrc;
+                            &erdt->cpu_agents[domain].cmrc;
 
-                        get_l3_cmt_rmid_range_v1(cmrc, rmid, rmid,
-                                                 &tmp_rmid_val);
+                        ret = mmio_mon_read_cmt(group, domain, cmrc, rmid,
+                                                &tmp_rmid_val);
+                        if (ret != PQOS_RETVAL_OK)
+                                return ret;
 
                         if (!is_available_l3_cmt_rmid(tmp_rmid_val)) {
                                 LOG_ERROR("RMID %u is not available for "
@@ -1129,16 +1496,16 @@ mmio_mon_read_counter(struct pqos_mon_data *group,
                 for (i = 0; i < group->intl->hw.num_ctx; i++) {
                         const unsigned lcore = group->intl->hw.ctx[i].lcore;
                         const pqos_rmid_t rmid = group->intl->hw.ctx[i].rmid;
+                        const unsigned domain = cores_domains->domains[lcore];
                         const struct pqos_erdt_mmrc *mmrc =
-                            &erdt->cpu_agents[cores_domains->domains[lcore]]
-                                 .mmrc;
+                            &erdt->cpu_agents[domain].mmrc;
 
                         for (j = 0; j < group->regions.num_mem_regions; j++) {
                                 int region_num = group->regions.region_num[j];
 
-                                ret = get_l3_mbm_region_rmid_range_v1(
-                                    mmrc, region_num, rmid, rmid,
-                                    &tmp_values[j]);
+                                ret = mmio_mon_read_mbm(group, domain, mmrc,
+                                                        region_num, rmid,
+                                                        &tmp_values[j]);
                                 if (ret != PQOS_RETVAL_OK)
                                         return ret;
 
@@ -266,6 +266,34 @@ PQOS_LOCAL int mmio_mon_stop(struct pqos_mon_data *group);
 PQOS_LOCAL int mmio_mon_read_counter(struct pqos_mon_data *group,
                                      const enum pqos_mon_event event);
 
+/**
+ * @brief Enables RMID counter snapshot for the current poll
+ *
+ * Finds range of RMIDs used by \a groups on each CPU agent. L3 occupancy
+ * and region MBM counters of the range are read from MMIO once per poll,
+ * by the first group that needs them, and served to the remaining groups
+ * from the snapshot. No-op if MMIO monitoring is not initialized.
+ *
+ * Snapshot of each CPU agent used by \a groups is locked until
+ * \a mmio_mon_snapshot_end is called, so only concurrent polls of groups
+ * sharing a CPU agent are serialized.
+ *
+ * @param groups table of monitoring groups to be polled
+ * @param num_groups number of monitoring groups
+ */
+PQOS_LOCAL void mmio_mon_snapshot_begin(struct pqos_mon_data **groups,
+                                        const unsigned num_groups);
+
+/**
+ * @brief Disables RMID counter snapshot after poll is complete
+ *
+ * @param groups table of monitoring groups passed to
+ *               \a mmio_mon_snapshot_begin
+ * @param num_groups number of monitoring groups
+ */
+PQOS_LOCAL void mmio_mon_snapshot_end(struct pqos_mon_data **groups,
+                                      const unsigned num_groups);
+
 /**
  * @brief Hardware interface poll monitoring data
  *
@@ -0,0 +1,491 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mon_poll.h"
+
+#include "log.h"
+#include "monitoring.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+/**
+ * Worker polling groups of one socket
+ */
+struct mon_poll_worker {
+        pthread_t thread;
+        unsigned socket;    /**< socket id */
+        unsigned *idx;      /**< indexes of groups to poll */
+        unsigned num_idx;   /**< number of groups to poll */
+        int ret;            /**< poll status */
+        int started;        /**< thread created */
+};
+
+static struct mon_poll_worker *m_worker = NULL; /**< per socket workers */
+static unsigned m_worker_num = 0;              /**< number of workers */
+static unsigned *m_core_worker = NULL;         /**< worker of each lcore */
+static unsigned m_core_num = 0;                /**< size of m_core_worker */
+
+static unsigned *m_local_idx = NULL;  /**< groups polled along workers */
+static unsigned *m_serial_idx = NULL; /**< groups polled after workers */
+static unsigned m_max_idx = 0;        /**< size of group index tables */
+
+static struct pqos_mon_data **m_groups = NULL; /**< groups being polled */
+static pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t m_cond_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t m_cond_done = PTHREAD_COND_INITIALIZER;
+static unsigned m_generation = 0; /**< incremented on each poll request */
+static unsigned m_pending = 0;    /**< workers still polling */
+static int m_stop = 0;            /**< workers shall exit */
+
+/** serializes poll requests to workers */
+static pthread_mutex_t m_request_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** protects busy flag of monitoring groups */
+static pthread_mutex_t m_busy_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t m_cond_busy = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Polls selected monitoring groups
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] idx indexes of groups to poll
+ * @param [in] num_idx number of groups to poll
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+mon_poll_groups(struct pqos_mon_data **groups,
+                const unsigned *idx,
+                const unsigned num_idx)
+{
+        int ret = PQOS_RETVAL_OK;
+        unsigned i;
+
+        for (i = 0; i < num_idx; i++) {
+                int retval = pqos_mon_poll_events(groups[idx[i]]);
+
+                if (retval != PQOS_RETVAL_OK) {
+                        LOG_WARN("Failed to poll event on group number %u\n",
+                                 idx[i]);
+                        ret = retval;
+                }
+        }
+
+        return ret;
+}
+
+/**
+ * @brief Worker thread main loop
+ *
+ * @param [in] arg worker structure
+ *
+ * @return NULL
+ */
+static void *
+mon_poll_worker_main(void *arg)
+{
+        struct mon_poll_worker *worker = (struct mon_poll_worker *)arg;
+        unsigned generation = 0;
+
+        pthread_mutex_lock(&m_mutex);
+        for (;;) {
+                while (!m_stop && generation == m_generation)
+                        pthread_cond_wait(&m_cond_start, &m_mutex);
+                if (m_stop)
+                        break;
+                generation = m_generation;
+                pthread_mutex_unlock(&m_mutex);
+
+                worker->ret =
+                    mon_poll_groups(m_groups, worker->idx, worker->num_idx);
+
+                pthread_mutex_lock(&m_mutex);
+                if (--m_pending == 0)
+                        pthread_cond_signal(&m_cond_done);
+        }
+        pthread_mutex_unlock(&m_mutex);
+
+        return NULL;
+}
+
+/**
+ * @brief Pins worker thread to cores of its socket
+ *
+ * @param [in] cpu CPU topology structure
+ * @param [in] worker worker structure
+ */
+static void
+mon_poll_worker_pin(const struct pqos_cpuinfo *cpu,
+                    const struct mon_poll_worker *worker)
+{
+#ifdef __linux__
+        cpu_set_t cpuset;
+        unsigned i;
+
+        CPU_ZERO(&cpuset);
+        for (i = 0; i < cpu->num_cores; i++)
+                if (cpu->cores[i].socket == worker->socket &&
+                    cpu->cores[i].lcore < CPU_SETSIZE)
+                        CPU_SET(cpu->cores[i].lcore, &cpuset);
+
+        if (pthread_setaffinity_np(worker->thread, sizeof(cpuset), &cpuset) !=
+            0)
+                LOG_WARN("Failed to pin poll worker to socket %u\n",
+                         worker->socket);
+#else
+        UNUSED_PARAM(cpu);
+        UNUSED_PARAM(worker);
+#endif
+}
+
+int
+mon_poll_init(const struct pqos_cpuinfo *cpu)
+{
+        unsigned *sockets;
+        unsigned num_sockets = 0;
+        unsigned i;
+        int ret = PQOS_RETVAL_OK;
+
+        ASSERT(cpu != NULL);
+
+        if (getenv("RDT_MON_POLL_PARALLEL") == NULL)
+                return PQOS_RETVAL_OK;
+
+        sockets = pqos_cpu_get_sockets(cpu, &num_sockets);
+        if (sockets == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        if (num_sockets < 2) {
+                LOG_INFO("Single socket system, parallel poll disabled\n");
+                goto mon_poll_init_exit;
+        }
+
+        for (i = 0; i < cpu->num_cores; i++)
+                if (cpu->cores[i].lcore >= m_core_num)
+                        m_core_num = cpu->cores[i].lcore + 1;
+
+        m_core_worker = calloc(m_core_num, sizeof(m_core_worker[0]));
+        m_worker = calloc(num_sockets, sizeof(m_worker[0]));
+        if (m_core_worker == NULL || m_worker == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto mon_poll_init_exit;
+        }
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                unsigned j;
+
+                for (j = 0; j < num_sockets; j++)
+                        if (sockets[j] == cpu->cores[i].socket)
+                                break;
+                m_core_worker[cpu->cores[i].lcore] = j;
+        }
+
+        m_stop = 0;
+        m_generation = 0;
+        for (i = 0; i < num_sockets; i++) {
+                struct mon_poll_worker *worker = &m_worker[i];
+
+                worker->socket = sockets[i];
+                if (pthread_create(&worker->thread, NULL, mon_poll_worker_main,
+                                   worker) != 0) {
+                        LOG_ERROR("Failed to create poll worker\n");
+                        ret = PQOS_RETVAL_ERROR;
+                        goto mon_poll_init_exit;
+                }
+                worker->started = 1;
+                m_worker_num++;
+                mon_poll_worker_pin(cpu, worker);
+        }
+
+        LOG_INFO("Parallel poll enabled with %u workers\n", m_worker_num);
+
+mon_poll_init_exit:
+        free(sockets);
+        if (ret != PQOS_RETVAL_OK)
+                mon_poll_fini();
+
+        return ret;
+}
+
+int
+mon_poll_fini(void)
+{
+        unsigned i;
+
+        if (m_worker != NULL) {
+                pthread_mutex_lock(&m_mutex);
+                m_stop = 1;
+                pthread_cond_broadcast(&m_cond_start);
+                pthread_mutex_unlock(&m_mutex);
+
+                for (i = 0; i < m_worker_num; i++) {
+                        if (m_worker[i].started)
+                                pthread_join(m_worker[i].thread, NULL);
+                        free(m_worker[i].idx);
+                }
+                free(m_worker);
+                m_worker = NULL;
+        }
+        m_worker_num = 0;
+
+        free(m_local_idx);
+        m_local_idx = NULL;
+        free(m_serial_idx);
+        m_serial_idx = NULL;
+        m_max_idx = 0;
+
+        free(m_core_worker);
+        m_core_worker = NULL;
+        m_core_num = 0;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Reserves index tables for \a num_groups groups
+ *
+ * Tables are grown only, so steady state polling does not allocate.
+ *
+ * @param [in] num_groups number of monitoring groups
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+mon_poll_reserve(const unsigned num_groups)
+{
+        unsigned *idx;
+        unsigned i;
+
+        if (m_max_idx >= num_groups)
+                return PQOS_RETVAL_OK;
+
+        for (i = 0; i < m_worker_num; i++) {
+                idx = realloc(m_worker[i].idx, num_groups * sizeof(idx[0]));
+                if (idx == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+                m_worker[i].idx = idx;
+        }
+
+        idx = realloc(m_local_idx, num_groups * sizeof(idx[0]));
+        if (idx == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        m_local_idx = idx;
+
+        idx = realloc(m_serial_idx, num_groups * sizeof(idx[0]));
+        if (idx == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        m_serial_idx = idx;
+
+        m_max_idx = num_groups;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Finds worker owning all cores of \a group
+ *
+ * @param [in] group monitoring group
+ *
+ * @return worker index
+ * @retval m_worker_num if group has no cores or its cores span sockets
+ */
+static unsigned
+mon_poll_group_worker(const struct pqos_mon_data *group)
+{
+        unsigned worker;
+        unsigned i;
+
+        if (group->num_cores == 0 || group->cores[0] >= m_core_num)
+                return m_worker_num;
+
+        worker = m_core_worker[group->cores[0]];
+        for (i = 1; i < group->num_cores; i++)
+                if (group->cores[i] >= m_core_num ||
+                    m_core_worker[group->cores[i]] != worker)
+                        return m_worker_num;
+
+        return worker;
+}
+
+int
+mon_poll(struct pqos_mon_data **groups, const unsigned num_groups)
+{
+        unsigned num_local = 0;
+        unsigned num_serial = 0;
+        unsigned i;
+        int ret = PQOS_RETVAL_OK;
+        int retval;
+
+        ASSERT(groups != NULL);
+
+        if (m_worker_num == 0) {
+                for (i = 0; i < num_groups; i++) {
+                        retval = mon_poll_groups(groups, &i, 1);
+                        if (retval != PQOS_RETVAL_OK)
+                                ret = retval;
+                }
+                return ret;
+        }
+
+        /* Workers serve one poll request at a time */
+        pthread_mutex_lock(&m_request_mutex);
+
+        ret = mon_poll_reserve(num_groups);
+        if (ret != PQOS_RETVAL_OK)
+                goto mon_poll_exit;
+
+        for (i = 0; i < m_worker_num; i++)
+                m_worker[i].num_idx = 0;
+
+        /*
+         * Groups with all cores on one socket are polled by worker of that
+         * socket. Task groups have no per core state and are polled by the
+         * calling thread together with workers. Remaining groups would touch
+         * per core state owned by more than one worker, they are polled
+         * after workers are done.
+         */
+        for (i = 0; i < num_groups; i++) {
+                const struct pqos_mon_data *group = groups[i];
+                const unsigned worker = mon_poll_group_worker(group);
+
+                if (worker < m_worker_num)
+                        m_worker[worker].idx[m_worker[worker].num_idx++] = i;
+                else if (group->num_cores == 0 && group->num_pids > 0)
+                        m_local_idx[num_local++] = i;
+                else
+                        m_serial_idx[num_serial++] = i;
+        }
+
+        pthread_mutex_lock(&m_mutex);
+        m_groups = groups;
+        m_pending = m_worker_num;
+        m_generation++;
+        pthread_cond_broadcast(&m_cond_start);
+        pthread_mutex_unlock(&m_mutex);
+
+        ret = mon_poll_groups(groups, m_local_idx, num_local);
+
+        pthread_mutex_lock(&m_mutex);
+        while (m_pending > 0)
+                pthread_cond_wait(&m_cond_done, &m_mutex);
+        m_groups = NULL;
+        pthread_mutex_unlock(&m_mutex);
+
+        for (i = 0; i < m_worker_num; i++)
+                if (m_worker[i].ret != PQOS_RETVAL_OK)
+                        ret = m_worker[i].ret;
+
+        retval = mon_poll_groups(groups, m_serial_idx, num_serial);
+        if (retval != PQOS_RETVAL_OK)
+                ret = retval;
+
+mon_poll_exit:
+        pthread_mutex_unlock(&m_request_mutex);
+
+        return ret;
+}
+
+/**
+ * @brief Checks if any of the groups is locked
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ *
+ * @return 1 if some group is locked, 0 otherwise
+ */
+static int
+mon_poll_busy(struct pqos_mon_data *const *groups, const unsigned num_groups)
+{
+        unsigned i;
+
+        for (i = 0; i < num_groups; i++)
+                if (groups[i]->intl->busy)
+                        return 1;
+
+        return 0;
+}
+
+void
+mon_poll_lock(struct pqos_mon_data *const *groups, const unsigned num_groups)
+{
+        unsigned i;
+
+        ASSERT(groups != NULL);
+
+        pthread_mutex_lock(&m_busy_mutex);
+        while (mon_poll_busy(groups, num_groups))
+                pthread_cond_wait(&m_cond_busy, &m_busy_mutex);
+        for (i = 0; i < num_groups; i++)
+                groups[i]->intl->busy = 1;
+        pthread_mutex_unlock(&m_busy_mutex);
+}
+
+void
+mon_poll_unlock(struct pqos_mon_data *const *groups, const unsigned num_groups)
+{
+        unsigned i;
+
+        ASSERT(groups != NULL);
+
+        pthread_mutex_lock(&m_busy_mutex);
+        for (i = 0; i < num_groups; i++)
+                groups[i]->intl->busy = 0;
+        pthread_cond_broadcast(&m_cond_busy);
+        pthread_mutex_unlock(&m_busy_mutex);
+}
+
+void
+mon_poll_lock_group(const struct pqos_mon_data *group)
+{
+        ASSERT(group != NULL);
+
+        pthread_mutex_lock(&m_busy_mutex);
+        while (group->intl->busy)
+                pthread_cond_wait(&m_cond_busy, &m_busy_mutex);
+        group->intl->busy = 1;
+        pthread_mutex_unlock(&m_busy_mutex);
+}
+
+void
+mon_poll_unlock_group(const struct pqos_mon_data *group)
+{
+        ASSERT(group != NULL);
+
+        pthread_mutex_lock(&m_busy_mutex);
+        group->intl->busy = 0;
+        pthread_cond_broadcast(&m_cond_busy);
+        pthread_mutex_unlock(&m_busy_mutex);
+}
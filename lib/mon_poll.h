@@ -0,0 +1,130 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @brief Parallel polling of monitoring groups
+ *
+ * Groups are partitioned by socket of their first core and each partition
+ * is polled by a worker thread pinned to that socket. Callers keep holding
+ * the shared API lock for the whole poll.
+ *
+ * Concurrent polls are allowed. Groups are locked with mon_poll_lock so
+ * that a group is polled or read by one thread at a time.
+ */
+
+#ifndef __PQOS_MON_POLL_H__
+#define __PQOS_MON_POLL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pqos.h"
+#include "types.h"
+
+/**
+ * @brief Initializes parallel poll engine
+ *
+ * Worker threads are created only if "RDT_MON_POLL_PARALLEL" environment
+ * variable is set and there is more than one socket in the system.
+ *
+ * @param [in] cpu CPU topology structure
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int mon_poll_init(const struct pqos_cpuinfo *cpu);
+
+/**
+ * @brief Shuts down parallel poll engine
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int mon_poll_fini(void);
+
+/**
+ * @brief Polls monitoring groups
+ *
+ * Groups are polled by per socket worker threads when the engine is
+ * enabled, otherwise serially by the calling thread.
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int mon_poll(struct pqos_mon_data **groups,
+                        const unsigned num_groups);
+
+/**
+ * @brief Locks monitoring groups
+ *
+ * Waits until none of the groups is locked by another thread and locks
+ * all of them at once, so overlapping sets of groups cannot deadlock.
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ */
+PQOS_LOCAL void mon_poll_lock(struct pqos_mon_data *const *groups,
+                              const unsigned num_groups);
+
+/**
+ * @brief Symmetric operation to \a mon_poll_lock to unlock the groups
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ */
+PQOS_LOCAL void mon_poll_unlock(struct pqos_mon_data *const *groups,
+                                const unsigned num_groups);
+
+/**
+ * @brief Locks single monitoring group
+ *
+ * @param [in] group monitoring group
+ */
+PQOS_LOCAL void mon_poll_lock_group(const struct pqos_mon_data *group);
+
+/**
+ * @brief Symmetric operation to \a mon_poll_lock_group to unlock the group
+ *
+ * @param [in] group monitoring group
+ */
+PQOS_LOCAL void mon_poll_unlock_group(const struct pqos_mon_data *group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_MON_POLL_H__ */
@@ -0,0 +1,457 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mon_pub.h"
+
+#include "log.h"
+#include "monitoring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Number of attempts to read a consistent copy of a slot */
+#define MON_PUB_READ_RETRIES 1000
+
+/**
+ * Published data opened for reading
+ */
+struct pqos_mon_pub {
+        void *addr;                       /**< mapped file */
+        size_t size;                      /**< size of mapping */
+        const struct mon_pub_header *hdr; /**< file header */
+        const struct mon_pub_slot *slots; /**< group slots */
+};
+
+/** Publisher mapping, NULL if not publishing */
+static void *m_addr = NULL;
+static size_t m_size = 0;
+static struct mon_pub_header *m_hdr = NULL;
+static struct mon_pub_slot *m_slots = NULL;
+/** Slots assigned to monitoring groups */
+static uint8_t *m_assigned = NULL;
+/** Generation of slot assignment stored in monitoring groups */
+static unsigned m_gen = 0;
+/** Serializes slot assignment of concurrent polls */
+static pthread_mutex_t m_assign_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Computes size of published file
+ *
+ * @param [in] num_slots number of group slots
+ *
+ * @return file size in bytes
+ */
+static size_t
+mon_pub_size(const unsigned num_slots)
+{
+        return sizeof(struct mon_pub_header) +
+               (size_t)num_slots * sizeof(struct mon_pub_slot);
+}
+
+/**
+ * @brief Writes slot holding readers off with sequence counter
+ *
+ * Slot is written by a single publisher thread at a time.
+ *
+ * @param [in] slot group slot
+ * @param [in] group published group data, NULL to clear the slot
+ */
+static void
+mon_pub_slot_write(struct mon_pub_slot *slot,
+                   const struct pqos_mon_pub_group *group)
+{
+        const uint64_t seq = slot->seq;
+
+        __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        if (group != NULL) {
+                slot->group = *group;
+                slot->used = 1;
+        } else {
+                memset(&slot->group, 0, sizeof(slot->group));
+                slot->used = 0;
+        }
+
+        __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+int
+mon_pub_start(const char *path, const unsigned max_groups)
+{
+        const size_t size = mon_pub_size(max_groups);
+        char *tmp = NULL;
+        void *addr = MAP_FAILED;
+        int fd = -1;
+        int ret = PQOS_RETVAL_ERROR;
+
+        if (m_addr != NULL) {
+                LOG_ERROR("Monitoring data is already published\n");
+                return PQOS_RETVAL_BUSY;
+        }
+
+        m_assigned = calloc(max_groups, sizeof(*m_assigned));
+        tmp = malloc(strlen(path) + sizeof(".XXXXXX"));
+        if (m_assigned == NULL || tmp == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto mon_pub_start_exit;
+        }
+
+        /* Readers of replaced file keep their mapping of the old one */
+        strcpy(tmp, path);
+        strcat(tmp, ".XXXXXX");
+        fd = mkstemp(tmp);
+        if (fd < 0) {
+                LOG_ERROR("Failed to create %s: %s\n", tmp, strerror(errno));
+                goto mon_pub_start_exit;
+        }
+
+        if (fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0 ||
+            ftruncate(fd, (off_t)size) != 0) {
+                LOG_ERROR("Failed to set up %s: %s\n", tmp, strerror(errno));
+                goto mon_pub_start_exit;
+        }
+
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+                LOG_ERROR("Failed to map %s: %s\n", tmp, strerror(errno));
+                goto mon_pub_start_exit;
+        }
+
+        m_hdr = (struct mon_pub_header *)addr;
+        m_hdr->version = MON_PUB_VERSION;
+        m_hdr->group_size = sizeof(struct pqos_mon_pub_group);
+        m_hdr->slot_size = sizeof(struct mon_pub_slot);
+        m_hdr->num_slots = max_groups;
+        m_hdr->pid = (uint64_t)getpid();
+        m_hdr->magic = MON_PUB_MAGIC;
+
+        if (rename(tmp, path) != 0) {
+                LOG_ERROR("Failed to create %s: %s\n", path, strerror(errno));
+                goto mon_pub_start_exit;
+        }
+
+        m_addr = addr;
+        m_size = size;
+        m_slots = (struct mon_pub_slot *)(m_hdr + 1);
+        m_gen++;
+        ret = PQOS_RETVAL_OK;
+
+        LOG_INFO("Publishing monitoring data of up to %u groups in %s\n",
+                 max_groups, path);
+
+mon_pub_start_exit:
+        if (ret != PQOS_RETVAL_OK) {
+                if (addr != MAP_FAILED)
+                        munmap(addr, size);
+                if (fd >= 0)
+                        unlink(tmp);
+                free(m_assigned);
+                m_assigned = NULL;
+                m_hdr = NULL;
+        }
+        if (fd >= 0)
+                close(fd);
+        free(tmp);
+
+        return ret;
+}
+
+void
+mon_pub_stop(void)
+{
+        if (m_addr == NULL)
+                return;
+
+        __atomic_store_n(&m_hdr->pid, 0, __ATOMIC_RELEASE);
+        munmap(m_addr, m_size);
+        free(m_assigned);
+
+        m_addr = NULL;
+        m_size = 0;
+        m_hdr = NULL;
+        m_slots = NULL;
+        m_assigned = NULL;
+}
+
+/**
+ * @brief Gives slot of monitoring group, assigns free one if needed
+ *
+ * @param [in] group monitoring group
+ *
+ * @return group slot, NULL if all slots are taken
+ */
+static struct mon_pub_slot *
+mon_pub_slot_get(struct pqos_mon_data *group)
+{
+        struct pqos_mon_data_internal *intl = group->intl;
+        struct mon_pub_slot *slot = NULL;
+        unsigned i;
+
+        if (intl->pub_slot != 0 && intl->pub_gen == m_gen)
+                return &m_slots[intl->pub_slot - 1];
+
+        pthread_mutex_lock(&m_assign_lock);
+        for (i = 0; i < m_hdr->num_slots; i++)
+                if (!m_assigned[i]) {
+                        m_assigned[i] = 1;
+                        intl->pub_slot = i + 1;
+                        intl->pub_gen = m_gen;
+                        slot = &m_slots[i];
+                        break;
+                }
+        pthread_mutex_unlock(&m_assign_lock);
+
+        if (slot == NULL)
+                LOG_DEBUG("No free slot to publish monitoring group\n");
+
+        return slot;
+}
+
+/**
+ * @brief Fills published data of monitoring group
+ *
+ * @param [in] group monitoring group
+ * @param [in] timestamp poll time in ns
+ * @param [in] prev previously published data of the group
+ * @param [out] data published group data
+ */
+static void
+mon_pub_fill(const struct pqos_mon_data *group,
+             const uint64_t timestamp,
+             const struct pqos_mon_pub_group *prev,
+             struct pqos_mon_pub_group *data)
+{
+        unsigned i;
+
+        memset(data, 0, sizeof(*data));
+        data->event = group->event;
+        data->num_cores = group->num_cores;
+        data->num_pids = group->num_pids;
+        data->num_channels = group->num_channels;
+
+        for (i = 0; i < PQOS_MON_PUB_MAX_IDS; i++)
+                if (i < group->num_cores)
+                        data->ids[i] = group->cores[i];
+                else if (i < group->num_pids)
+                        data->ids[i] = (uint64_t)group->pids[i];
+                else if (i < group->num_channels)
+                        data->ids[i] = group->channels[i];
+
+        data->timestamp = timestamp;
+        data->polls = prev->polls + 1;
+        if (prev->polls > 0 && timestamp > prev->timestamp)
+                data->interval = timestamp - prev->timestamp;
+        data->values = group->values;
+        data->region_values = group->region_values;
+        data->regions = group->regions;
+}
+
+void
+mon_pub_write(struct pqos_mon_data **groups, const unsigned num_groups)
+{
+        struct pqos_mon_pub_group data;
+        struct timespec ts;
+        uint64_t timestamp;
+        unsigned i;
+
+        if (m_addr == NULL)
+                return;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        timestamp = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+        for (i = 0; i < num_groups; i++) {
+                struct mon_pub_slot *slot = mon_pub_slot_get(groups[i]);
+
+                if (slot == NULL)
+                        continue;
+
+                mon_pub_fill(groups[i], timestamp, &slot->group, &data);
+                mon_pub_slot_write(slot, &data);
+        }
+}
+
+void
+mon_pub_remove(struct pqos_mon_data *group)
+{
+        struct pqos_mon_data_internal *intl = group->intl;
+
+        if (intl == NULL || intl->pub_slot == 0)
+                return;
+
+        if (m_addr != NULL && intl->pub_gen == m_gen) {
+                mon_pub_slot_write(&m_slots[intl->pub_slot - 1], NULL);
+                m_assigned[intl->pub_slot - 1] = 0;
+        }
+
+        intl->pub_slot = 0;
+}
+
+void
+mon_pub_reset(void)
+{
+        unsigned i;
+
+        if (m_addr == NULL)
+                return;
+
+        for (i = 0; i < m_hdr->num_slots; i++)
+                if (m_assigned[i]) {
+                        mon_pub_slot_write(&m_slots[i], NULL);
+                        m_assigned[i] = 0;
+                }
+
+        /* slots stored in existing groups are stale */
+        m_gen++;
+}
+
+/*
+ * =======================================
+ * Reader API, no library initialization
+ * =======================================
+ */
+
+int
+pqos_mon_pub_open(const char *path, struct pqos_mon_pub **pub)
+{
+        const struct mon_pub_header *hdr;
+        struct pqos_mon_pub *p;
+        struct stat st;
+        void *addr;
+        int fd;
+
+        if (path == NULL || pub == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+                return PQOS_RETVAL_ERROR;
+
+        if (fstat(fd, &st) != 0 ||
+            (size_t)st.st_size < sizeof(struct mon_pub_header)) {
+                close(fd);
+                return PQOS_RETVAL_ERROR;
+        }
+
+        addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED)
+                return PQOS_RETVAL_ERROR;
+
+        hdr = (const struct mon_pub_header *)addr;
+        if (hdr->magic != MON_PUB_MAGIC || hdr->version != MON_PUB_VERSION ||
+            hdr->group_size != sizeof(struct pqos_mon_pub_group) ||
+            hdr->slot_size != sizeof(struct mon_pub_slot) ||
+            (size_t)st.st_size < mon_pub_size(hdr->num_slots)) {
+                munmap(addr, st.st_size);
+                return PQOS_RETVAL_ERROR;
+        }
+
+        p = malloc(sizeof(*p));
+        if (p == NULL) {
+                munmap(addr, st.st_size);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        p->addr = addr;
+        p->size = st.st_size;
+        p->hdr = hdr;
+        p->slots = (const struct mon_pub_slot *)(hdr + 1);
+        *pub = p;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_mon_pub_close(struct pqos_mon_pub *pub)
+{
+        if (pub == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        munmap(pub->addr, pub->size);
+        free(pub);
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_mon_pub_num_slots(const struct pqos_mon_pub *pub, unsigned *num_slots)
+{
+        if (pub == NULL || num_slots == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        *num_slots = pub->hdr->num_slots;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_mon_pub_read(const struct pqos_mon_pub *pub,
+                  const unsigned slot,
+                  struct pqos_mon_pub_group *group)
+{
+        const struct mon_pub_slot *s;
+        unsigned i;
+
+        if (pub == NULL || group == NULL || slot >= pub->hdr->num_slots)
+                return PQOS_RETVAL_PARAM;
+
+        s = &pub->slots[slot];
+        for (i = 0; i < MON_PUB_READ_RETRIES; i++) {
+                const uint64_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+                uint32_t used;
+
+                if (seq & 1)
+                        continue;
+
+                used = s->used;
+                memcpy(group, &s->group, sizeof(*group));
+
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != seq)
+                        continue;
+
+                return used ? PQOS_RETVAL_OK : PQOS_RETVAL_UNAVAILABLE;
+        }
+
+        return PQOS_RETVAL_BUSY;
+}
@@ -0,0 +1,132 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @brief Publishing of polled monitoring data
+ *
+ * One library instance can write values of polled monitoring groups into
+ * a memory mapped file that any number of processes read without
+ * initializing the library. The file starts with a header followed by
+ * one cache line aligned slot per monitoring group. Each slot is guarded
+ * by a sequence counter that is odd while the slot is written, readers
+ * retry until they copy the slot with an unchanged even counter and never
+ * block the publisher.
+ */
+
+#ifndef __PQOS_MON_PUB_H__
+#define __PQOS_MON_PUB_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pqos.h"
+#include "types.h"
+
+#include <stdint.h>
+
+/** Published file magic, "PQOSPUB1" */
+#define MON_PUB_MAGIC   0x31425550534f5150ULL
+#define MON_PUB_VERSION 1
+/** Alignment of published group slots */
+#define MON_PUB_ALIGN 64
+
+/**
+ * Published file header
+ */
+struct mon_pub_header {
+        uint64_t magic;      /**< MON_PUB_MAGIC */
+        uint32_t version;    /**< MON_PUB_VERSION */
+        uint32_t group_size; /**< size of struct pqos_mon_pub_group */
+        uint32_t slot_size;  /**< size of struct mon_pub_slot */
+        uint32_t num_slots;  /**< number of group slots */
+        uint64_t pid;        /**< publisher process, 0 once stopped */
+} __attribute__((aligned(MON_PUB_ALIGN)));
+
+/**
+ * Published monitoring group slot
+ */
+struct mon_pub_slot {
+        uint64_t seq;  /**< sequence counter, odd while slot is written */
+        uint32_t used; /**< slot holds a monitoring group */
+        uint32_t reserved;
+        struct pqos_mon_pub_group group; /**< published group data */
+} __attribute__((aligned(MON_PUB_ALIGN)));
+
+/**
+ * @brief Starts publishing of polled monitoring data
+ *
+ * @param [in] path file to publish data in
+ * @param [in] max_groups number of group slots
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_BUSY if publishing is already started
+ * @retval PQOS_RETVAL_ERROR if file could not be created
+ */
+PQOS_LOCAL int mon_pub_start(const char *path, const unsigned max_groups);
+
+/**
+ * @brief Stops publishing of polled monitoring data
+ */
+PQOS_LOCAL void mon_pub_stop(void);
+
+/**
+ * @brief Publishes values of polled monitoring groups
+ *
+ * Groups not published before are assigned free slots. Groups must be
+ * locked with mon_poll_lock().
+ *
+ * @param [in] groups polled monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ */
+PQOS_LOCAL void mon_pub_write(struct pqos_mon_data **groups,
+                              const unsigned num_groups);
+
+/**
+ * @brief Releases slot of stopped monitoring group
+ *
+ * @param [in] group monitoring group
+ */
+PQOS_LOCAL void mon_pub_remove(struct pqos_mon_data *group);
+
+/**
+ * @brief Releases all slots, used on monitoring reset
+ */
+PQOS_LOCAL void mon_pub_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_MON_PUB_H__ */
@@ -0,0 +1,465 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mon_sampler.h"
+
+#include "log.h"
+#include "monitoring.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/eventfd.h>
+#endif
+
+/** Sequence number of ring entry being written */
+#define MON_SAMPLER_WRITING UINT64_MAX
+
+/**
+ * Ring entry holding one sample
+ */
+struct mon_sampler_entry {
+        uint64_t seq; /**< sequence number of stored sample */
+        struct pqos_mon_sample sample;
+};
+
+struct pqos_mon_sampler {
+        struct pqos_mon_data **groups; /**< sampled monitoring groups */
+        unsigned num_groups;           /**< number of monitoring groups */
+        struct pqos_mon_sampler_config cfg;
+        unsigned size;                   /**< ring size, power of 2 */
+        struct mon_sampler_entry *ring;  /**< rings of all groups */
+        uint64_t head;                   /**< sequence of next sample */
+        int efd;                         /**< eventfd, -1 if none */
+
+        pthread_t thread;
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        int stop; /**< sampling thread shall exit */
+
+        struct pqos_mon_sampler *next; /**< next running sampler */
+};
+
+/** Running samplers */
+static struct pqos_mon_sampler *mon_sampler_list = NULL;
+/** Protects \a mon_sampler_list */
+static pthread_mutex_t mon_sampler_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Adds sampler to the list of running samplers
+ *
+ * @param [in] sampler sampler handle
+ */
+static void
+mon_sampler_link(struct pqos_mon_sampler *sampler)
+{
+        pthread_mutex_lock(&mon_sampler_list_mutex);
+        sampler->next = mon_sampler_list;
+        mon_sampler_list = sampler;
+        pthread_mutex_unlock(&mon_sampler_list_mutex);
+}
+
+/**
+ * @brief Removes sampler from the list of running samplers
+ *
+ * @param [in] sampler sampler handle
+ */
+static void
+mon_sampler_unlink(struct pqos_mon_sampler *sampler)
+{
+        struct pqos_mon_sampler **p;
+
+        pthread_mutex_lock(&mon_sampler_list_mutex);
+        for (p = &mon_sampler_list; *p != NULL; p = &(*p)->next)
+                if (*p == sampler) {
+                        *p = sampler->next;
+                        break;
+                }
+        pthread_mutex_unlock(&mon_sampler_list_mutex);
+}
+
+unsigned
+mon_sampler_running(void)
+{
+        const struct pqos_mon_sampler *s;
+        unsigned num = 0;
+
+        pthread_mutex_lock(&mon_sampler_list_mutex);
+        for (s = mon_sampler_list; s != NULL; s = s->next)
+                num++;
+        pthread_mutex_unlock(&mon_sampler_list_mutex);
+
+        return num;
+}
+
+/**
+ * @brief Gives ring entry of sample of monitoring group
+ *
+ * @param [in] sampler sampler handle
+ * @param [in] group monitoring group index
+ * @param [in] seq sample sequence number
+ *
+ * @return ring entry
+ */
+static inline struct mon_sampler_entry *
+mon_sampler_entry(const struct pqos_mon_sampler *sampler,
+                  const unsigned group,
+                  const uint64_t seq)
+{
+        return &sampler->ring[(size_t)group * sampler->size +
+                              (seq & (sampler->size - 1))];
+}
+
+void
+mon_sampler_poll(struct pqos_mon_sampler *sampler)
+{
+        const uint64_t seq = sampler->head;
+        struct timespec ts;
+        uint64_t timestamp;
+        unsigned i;
+        int ret;
+
+        ret = pqos_mon_poll(sampler->groups, sampler->num_groups);
+        if (ret != PQOS_RETVAL_OK && ret != PQOS_RETVAL_OVERFLOW) {
+                LOG_DEBUG("Sampler poll failed with status %d\n", ret);
+                return;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        timestamp = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+        for (i = 0; i < sampler->num_groups; i++) {
+                struct mon_sampler_entry *entry =
+                    mon_sampler_entry(sampler, i, seq);
+                const struct pqos_mon_data *group = sampler->groups[i];
+
+                __atomic_store_n(&entry->seq, MON_SAMPLER_WRITING,
+                                 __ATOMIC_RELAXED);
+                __atomic_thread_fence(__ATOMIC_RELEASE);
+
+                entry->sample.seq = seq;
+                entry->sample.timestamp = timestamp;
+                entry->sample.status = ret;
+                entry->sample.poll_time = group->intl->poll_time;
+                entry->sample.values = group->values;
+                entry->sample.region_values = group->region_values;
+
+                __atomic_store_n(&entry->seq, seq, __ATOMIC_RELEASE);
+        }
+
+        __atomic_store_n(&sampler->head, seq + 1, __ATOMIC_RELEASE);
+
+#ifdef __linux__
+        if (sampler->efd >= 0) {
+                const uint64_t one = 1;
+
+                if (write(sampler->efd, &one, sizeof(one)) != sizeof(one))
+                        LOG_DEBUG("Failed to signal sampler eventfd\n");
+        }
+#endif
+        if (sampler->cfg.callback != NULL)
+                sampler->cfg.callback(sampler->cfg.context, seq);
+}
+
+/**
+ * @brief Sampling thread
+ *
+ * @param arg sampler handle
+ */
+static void *
+mon_sampler_main(void *arg)
+{
+        struct pqos_mon_sampler *sampler = (struct pqos_mon_sampler *)arg;
+        const unsigned period = sampler->cfg.period_us;
+        struct timespec next;
+        struct timespec now;
+
+        pthread_mutex_lock(&sampler->mutex);
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        while (!sampler->stop) {
+                next.tv_sec += period / 1000000;
+                next.tv_nsec += (period % 1000000) * 1000;
+                if (next.tv_nsec >= 1000000000) {
+                        next.tv_sec++;
+                        next.tv_nsec -= 1000000000;
+                }
+
+                /* do not try to catch up after the process was stopped */
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                if (now.tv_sec > next.tv_sec + 1)
+                        next = now;
+
+                while (!sampler->stop &&
+                       pthread_cond_timedwait(&sampler->cond, &sampler->mutex,
+                                              &next) != ETIMEDOUT)
+                        ;
+
+                if (sampler->stop)
+                        break;
+
+                /* stop request must not wait for the poll */
+                pthread_mutex_unlock(&sampler->mutex);
+                mon_sampler_poll(sampler);
+                pthread_mutex_lock(&sampler->mutex);
+        }
+        pthread_mutex_unlock(&sampler->mutex);
+
+        return NULL;
+}
+
+/**
+ * @brief Sets affinity of sampling thread to configured core
+ *
+ * Affinity is set in thread attributes, so the thread never runs on
+ * another core, not even for its first poll.
+ *
+ * @param [in] sampler sampler handle
+ * @param [in,out] attr sampling thread attributes
+ */
+static void
+mon_sampler_pin(const struct pqos_mon_sampler *sampler, pthread_attr_t *attr)
+{
+#ifdef __linux__
+        cpu_set_t cpuset;
+
+        if (sampler->cfg.lcore < 0)
+                return;
+
+        CPU_ZERO(&cpuset);
+        if (sampler->cfg.lcore < CPU_SETSIZE)
+                CPU_SET(sampler->cfg.lcore, &cpuset);
+
+        if (pthread_attr_setaffinity_np(attr, sizeof(cpuset), &cpuset) != 0)
+                LOG_WARN("Failed to pin sampling thread to core %d\n",
+                         sampler->cfg.lcore);
+#else
+        UNUSED_PARAM(attr);
+        if (sampler->cfg.lcore >= 0)
+                LOG_WARN("Sampling thread pinning not supported\n");
+#endif
+}
+
+/**
+ * @brief Releases sampler resources
+ *
+ * @param [in] sampler sampler handle
+ */
+static void
+mon_sampler_free(struct pqos_mon_sampler *sampler)
+{
+        if (sampler->efd >= 0)
+                close(sampler->efd);
+        free(sampler->ring);
+        free(sampler->groups);
+        free(sampler);
+}
+
+int
+mon_sampler_start(struct pqos_mon_data **groups,
+                  const unsigned num_groups,
+                  const struct pqos_mon_sampler_config *cfg,
+                  struct pqos_mon_sampler **sampler)
+{
+        struct pqos_mon_sampler *s;
+        pthread_condattr_t attr;
+        pthread_attr_t thread_attr;
+        size_t i;
+        int ret;
+
+        s = calloc(1, sizeof(*s));
+        if (s == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        s->efd = -1;
+        s->cfg = *cfg;
+        s->num_groups = num_groups;
+        s->size = 1;
+        while (s->size < cfg->history)
+                s->size <<= 1;
+        if (cfg->history == 0)
+                s->size = MON_SAMPLER_DEFAULT_HISTORY;
+
+        s->groups = malloc(num_groups * sizeof(*s->groups));
+        s->ring = malloc((size_t)num_groups * s->size * sizeof(*s->ring));
+        if (s->groups == NULL || s->ring == NULL) {
+                mon_sampler_free(s);
+                return PQOS_RETVAL_RESOURCE;
+        }
+        memcpy(s->groups, groups, num_groups * sizeof(*s->groups));
+        for (i = 0; i < (size_t)num_groups * s->size; i++)
+                s->ring[i].seq = MON_SAMPLER_WRITING;
+
+#ifdef __linux__
+        s->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (s->efd < 0)
+                LOG_WARN("Failed to create sampler eventfd\n");
+#endif
+
+        pthread_mutex_init(&s->mutex, NULL);
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&s->cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        pthread_attr_init(&thread_attr);
+        mon_sampler_pin(s, &thread_attr);
+        ret = pthread_create(&s->thread, &thread_attr, mon_sampler_main, s);
+        pthread_attr_destroy(&thread_attr);
+        if (ret != 0) {
+                LOG_ERROR("Failed to create sampling thread\n");
+                pthread_cond_destroy(&s->cond);
+                pthread_mutex_destroy(&s->mutex);
+                mon_sampler_free(s);
+                return PQOS_RETVAL_ERROR;
+        }
+
+        /* groups can not be stopped until the sampler is stopped */
+        for (i = 0; i < num_groups; i++)
+                __atomic_add_fetch(&groups[i]->intl->sampled, 1,
+                                   __ATOMIC_RELAXED);
+        mon_sampler_link(s);
+
+        LOG_INFO("Sampling %u monitoring groups every %u us\n", num_groups,
+                 cfg->period_us);
+
+        *sampler = s;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_mon_sampler_stop(struct pqos_mon_sampler *sampler)
+{
+        unsigned i;
+
+        if (sampler == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        pthread_mutex_lock(&sampler->mutex);
+        sampler->stop = 1;
+        pthread_cond_signal(&sampler->cond);
+        pthread_mutex_unlock(&sampler->mutex);
+
+        pthread_join(sampler->thread, NULL);
+        mon_sampler_unlink(sampler);
+        for (i = 0; i < sampler->num_groups; i++)
+                __atomic_sub_fetch(&sampler->groups[i]->intl->sampled, 1,
+                                   __ATOMIC_RELAXED);
+        pthread_cond_destroy(&sampler->cond);
+        pthread_mutex_destroy(&sampler->mutex);
+        mon_sampler_free(sampler);
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_mon_sampler_eventfd(const struct pqos_mon_sampler *sampler, int *fd)
+{
+        if (sampler == NULL || fd == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (sampler->efd < 0)
+                return PQOS_RETVAL_RESOURCE;
+
+        *fd = sampler->efd;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_mon_sampler_seq(const struct pqos_mon_sampler *sampler, uint64_t *seq)
+{
+        if (sampler == NULL || seq == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        *seq = __atomic_load_n(&sampler->head, __ATOMIC_ACQUIRE);
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+pqos_mon_sampler_read(const struct pqos_mon_sampler *sampler,
+                      const unsigned group,
+                      uint64_t *seq,
+                      struct pqos_mon_sample *samples,
+                      const unsigned max_samples,
+                      unsigned *num_samples)
+{
+        uint64_t head;
+        uint64_t next;
+        unsigned num = 0;
+
+        if (sampler == NULL || seq == NULL || num_samples == NULL ||
+            (samples == NULL && max_samples > 0))
+                return PQOS_RETVAL_PARAM;
+        if (group >= sampler->num_groups)
+                return PQOS_RETVAL_PARAM;
+
+        next = *seq;
+        head = __atomic_load_n(&sampler->head, __ATOMIC_ACQUIRE);
+        if (next > head)
+                return PQOS_RETVAL_PARAM;
+
+        while (num < max_samples && next < head) {
+                const struct mon_sampler_entry *entry;
+
+                /* oldest entry may be overwritten with the next sample */
+                if (head - next >= sampler->size)
+                        next = head - sampler->size + 1;
+
+                entry = mon_sampler_entry(sampler, group, next);
+                if (__atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE) == next) {
+                        samples[num] = entry->sample;
+                        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                        if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) ==
+                            next) {
+                                num++;
+                                next++;
+                                continue;
+                        }
+                }
+
+                /* sample overwritten while reading, catch up with producer */
+                head = __atomic_load_n(&sampler->head, __ATOMIC_ACQUIRE);
+        }
+
+        *seq = next;
+        *num_samples = num;
+
+        return PQOS_RETVAL_OK;
+}
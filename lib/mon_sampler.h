@@ -0,0 +1,98 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @brief Background sampling of monitoring groups
+ *
+ * Sampling thread polls a set of monitoring groups with fixed period and
+ * pushes timestamped samples into a ring per group. Sampling thread is
+ * the only producer. Consumers keep their own read position and copy
+ * ring entries guarded by entry sequence numbers, so any number of them
+ * can read concurrently without blocking the producer. Consumers falling
+ * behind by more than the ring size lose the oldest samples.
+ */
+
+#ifndef __PQOS_MON_SAMPLER_H__
+#define __PQOS_MON_SAMPLER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pqos.h"
+#include "types.h"
+
+/** Default number of samples kept per group */
+#define MON_SAMPLER_DEFAULT_HISTORY 64
+/** Maximum number of samples kept per group */
+#define MON_SAMPLER_MAX_HISTORY (1U << 20)
+
+/**
+ * @brief Creates sampler and starts sampling thread
+ *
+ * @param [in] groups monitoring groups to be sampled
+ * @param [in] num_groups number of monitoring groups
+ * @param [in] cfg sampler configuration
+ * @param [out] sampler sampler handle
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE on memory allocation failure
+ * @retval PQOS_RETVAL_ERROR if sampling thread could not be started
+ */
+PQOS_LOCAL int mon_sampler_start(struct pqos_mon_data **groups,
+                                 const unsigned num_groups,
+                                 const struct pqos_mon_sampler_config *cfg,
+                                 struct pqos_mon_sampler **sampler);
+
+/**
+ * @brief Polls monitoring groups and publishes new samples
+ *
+ * Called from sampling thread every period.
+ *
+ * @param [in] sampler sampler handle
+ */
+PQOS_LOCAL void mon_sampler_poll(struct pqos_mon_sampler *sampler);
+
+/**
+ * @brief Gives number of running samplers
+ *
+ * @return number of samplers started and not stopped yet
+ */
+PQOS_LOCAL unsigned mon_sampler_running(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_MON_SAMPLER_H__ */
@@ -35,7 +35,9 @@
 #include "cap.h"
 #include "hw_monitoring.h"
 #include "log.h"
+#include "mbm_sampler.h"
 #include "mmio_monitoring.h"
+#include "mon_poll.h"
 #include "os_monitoring.h"
 #include "perf_monitoring.h"
 #include "types.h"
@@ -45,6 +47,8 @@
 #include "resctrl_monitoring.h"
 #endif
 
+#include <time.h>
+
 /**
  * ---------------------------------------
  * Local macros
@@ -119,6 +123,12 @@ pqos_mon_init(const struct pqos_cpuinfo *cpu,
         if (interface == PQOS_INTER_MMIO)
                 ret = mmio_mon_init(cpu, cap);
 
+        /* Parallel poll is optional, fall back to serial poll on error */
+        if (ret == PQOS_RETVAL_OK &&
+            (interface == PQOS_INTER_MSR || interface == PQOS_INTER_MMIO) &&
+            mon_poll_init(cpu) != PQOS_RETVAL_OK)
+                LOG_WARN("Parallel poll initialization failed\n");
+
 pqos_mon_init_exit:
         return ret;
 }
@@ -130,6 +140,8 @@ pqos_mon_fini(void)
 #ifdef __linux__
         enum pqos_interface interface = _pqos_get_inter();
 
+        mon_poll_fini();
+
         if (interface == PQOS_INTER_OS ||
             interface == PQOS_INTER_OS_RESCTRL_MON)
                 ret = os_mon_fini();
@@ -139,6 +151,8 @@ pqos_mon_fini(void)
         if (interface == PQOS_INTER_MMIO)
                 ret = mmio_mon_fini();
 #else
+        mon_poll_fini();
+
         if (interface == PQOS_INTER_MMIO)
                 ret = mmio_mon_fini();
         else if (interface == PQOS_INTER_MSR)
@@ -148,12 +162,79 @@ pqos_mon_fini(void)
         return ret;
 }
 
+/**
+ * @brief Reads time stamp counter
+ *
+ * @return TSC value, 0 if not available
+ */
+static inline uint64_t
+mon_tsc(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+        uint32_t low, high;
+
+        asm volatile("rdtsc" : "=a"(low), "=d"(high));
+
+        return ((uint64_t)high << 32) | low;
+#else
+        return 0;
+#endif
+}
+
+/**
+ * @brief Reads monotonic clock
+ *
+ * @return time in ns
+ */
+static inline uint64_t
+mon_time_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Updates timing of counter reads of monitoring group
+ *
+ * Interval between polls is measured between midpoints of counter reads.
+ *
+ * @param [in,out] poll_time group poll timing
+ * @param [in] begin time before counter reads
+ * @param [in] tsc_begin TSC before counter reads
+ */
+static void
+mon_poll_time_update(struct pqos_mon_poll_time *poll_time,
+                     const uint64_t begin,
+                     const uint64_t tsc_begin)
+{
+        const uint64_t tsc_end = mon_tsc();
+        const uint64_t end = mon_time_ns();
+        const uint64_t prev_mid = poll_time->begin +
+                                  (poll_time->end - poll_time->begin) / 2;
+        const uint64_t mid = begin + (end - begin) / 2;
+
+        poll_time->interval = 0;
+        if (poll_time->begin != 0 && mid > prev_mid)
+                poll_time->interval = mid - prev_mid;
+
+        poll_time->begin = begin;
+        poll_time->end = end;
+        poll_time->tsc_begin = tsc_begin;
+        poll_time->tsc_end = tsc_end;
+        poll_time->latency = end - begin;
+}
+
 int
 pqos_mon_poll_events(struct pqos_mon_data *group)
 {
         unsigned i;
         int ret = PQOS_RETVAL_OK;
         enum pqos_interface interface = _pqos_get_inter();
+        uint64_t begin;
+        uint64_t tsc_begin;
 
         /** List of non virtual events */
         const enum pqos_mon_event mon_event[] = {
@@ -182,6 +263,9 @@ pqos_mon_poll_events(struct pqos_mon_data *group)
         }
 #endif
 
+        begin = mon_time_ns();
+        tsc_begin = mon_tsc();
+
         for (i = 0; i < DIM(mon_event); i++) {
                 enum pqos_mon_event evt = mon_event[i];
 
@@ -230,6 +314,8 @@ pqos_mon_poll_events(struct pqos_mon_data *group)
 #endif
         }
 
+        mon_poll_time_update(&group->intl->poll_time, begin, tsc_begin);
+
         /**
          * Calculate values of virtual events
          */
@@ -248,12 +334,17 @@ pqos_mon_poll_events(struct pqos_mon_data *group)
                 ret = pqos_cap_get_event(cap, PQOS_MON_EVENT_RMEM_BW, &pmon);
                 if (ret == PQOS_RETVAL_OK)
                         max_value = 1LLU << pmon->counter_length;
+                /* sampled counters are 64-bit accumulators */
+                if (group->intl->hw.num_ctx > 0 && mbm_sampler_enabled())
+                        max_value = 0;
 
                 if (max_value > 0 &&
                     group->values.mbm_local > group->values.mbm_total)
                         group->values.mbm_remote = max_value -
                                                    group->values.mbm_local +
                                                    group->values.mbm_total;
+                else if (group->values.mbm_local > group->values.mbm_total)
+                        group->values.mbm_remote = 0;
                 else
                         group->values.mbm_remote =
                             group->values.mbm_total - group->values.mbm_local;
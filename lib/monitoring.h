@@ -58,6 +58,13 @@ struct pqos_mon_poll_ctx {
         pqos_rmid_t rmid;
 };
 
+/**
+ * Maximum number of events in perf event group
+ */
+#define PERF_MON_GROUP_MAX 4
+
+struct perf_event_mmap_page;
+
 /**
  * Perf monitoring poll context
  */
@@ -69,6 +76,23 @@ struct pqos_mon_perf_ctx {
         int fd_cyc;
         int fd_llc_misses;
         int fd_llc_references;
+
+        /* Last raw read of perf event group */
+        uint64_t grp_raw[PERF_MON_GROUP_MAX]; /**< counter values */
+        uint64_t grp_enabled;                 /**< time enabled */
+        uint64_t grp_running;                 /**< time running */
+        /** Mapped perf event pages of group events used by rdpmc */
+        struct perf_event_mmap_page *grp_page[PERF_MON_GROUP_MAX];
+};
+
+/**
+ * Resctrl counter file kept open between polls
+ */
+struct pqos_mon_resctrl_fd {
+        unsigned class_id;         /**< COS id */
+        unsigned l3id;             /**< L3 domain id */
+        enum pqos_mon_event event; /**< monitoring event */
+        int fd;                    /**< counter file descriptor */
 };
 
 /**
@@ -116,6 +140,19 @@ struct pqos_mon_data_internal {
                 enum pqos_mon_event event;     /**< Started perf events */
                 struct pqos_mon_perf_ctx *ctx; /**< Perf poll context for each
                                                   core/tid */
+
+                /* Events read together as one perf event group */
+                enum pqos_mon_event grp_event; /**< Started group events */
+                /** Group events in order of creation, leader first */
+                enum pqos_mon_event grp_evt[PERF_MON_GROUP_MAX];
+                unsigned grp_num;                /**< Number of group events */
+                enum pqos_mon_event grp_pending; /**< Read, not yet polled */
+                /** Group event values scaled for multiplexing */
+                uint64_t grp_val[PERF_MON_GROUP_MAX];
+                /** Ratio of time running to time enabled in last read */
+                double grp_scale;
+                /** Final counter values of tasks removed from the group */
+                struct pqos_event_values retired;
         } perf;
 
         /**
@@ -131,6 +168,15 @@ struct pqos_mon_data_internal {
                 unsigned *l3id;    /**< list of l3ids being monitored */
                 unsigned num_l3id; /**< Number of l3ids */
 
+                /* Counter files kept open between polls */
+                struct pqos_mon_resctrl_fd *fds;
+                unsigned num_fds;
+
+                /* COS ids holding mon group directory */
+                unsigned *assoc_cos;
+                unsigned num_assoc_cos;
+                unsigned assoc_gen; /**< generation of assoc_cos list */
+
                 /* AET telemetry state */
                 struct pqos_tel_slot tel[PQOS_TEL_NUM_SLOTS];
                 struct timespec
@@ -151,6 +197,10 @@ struct pqos_mon_data_internal {
                 enum pqos_mon_event event;     /**< Started hw events */
                 struct pqos_mon_poll_ctx *ctx; /**< core, cluster & RMID */
                 unsigned num_ctx;              /**< number of poll contexts */
+                struct machine_msr_op *ops; /**< counter read MSR ops */
+                uint64_t *values;           /**< counter read values */
+                struct machine_msr_op *perf_ops; /**< IA32 perf read ops */
+                int snapshot; /**< MMIO counter snapshot taken for poll */
         } hw;
 
         /* Uncore specific section */
@@ -161,10 +211,17 @@ struct pqos_mon_data_internal {
 
         int valid_mbm_read; /**< flag to discard 1st invalid read */
         int manage_memory;  /**< mon data memory is managed by lib */
+        int track_pids;     /**< follow threads of monitored tasks */
+        int busy;           /**< group locked by mon_poll_lock */
+        unsigned sampled;   /**< number of samplers polling the group */
+        unsigned pub_slot;  /**< published data slot + 1, 0 if none */
+        unsigned pub_gen;   /**< generation of published data slot */
 
         /* I/O RDT flags */
         int valid_io_total_read; /**< flag to discard 1st invalid read */
         int valid_io_miss_read;  /**< flag to discard 1st invalid read */
+
+        struct pqos_mon_poll_time poll_time; /**< timing of last poll */
 };
 
 /**
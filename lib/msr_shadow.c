@@ -0,0 +1,540 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "msr_shadow.h"
+
+#include "cap.h"
+#include "cpu_registers.h"
+#include "id_pool.h"
+#include "log.h"
+#include "machine.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Topology domains with ids in use tracked by the shadow
+ */
+enum msr_shadow_dom {
+        SHADOW_DOM_L3 = 0, /**< L3 cluster, RMIDs */
+        SHADOW_DOM_L3CAT,  /**< L3 CAT domain, classes of service */
+        SHADOW_DOM_MBA,    /**< MBA domain, classes of service */
+        SHADOW_DOM_SMBA,   /**< SMBA domain, classes of service */
+        SHADOW_DOM_L2,     /**< L2 cluster, classes of service */
+        SHADOW_DOM_NUM
+};
+
+/**
+ * Ids associated with cores of a topology domain
+ */
+struct msr_shadow_domain {
+        unsigned id;         /**< topology object id */
+        unsigned unknown;    /**< number of cores not cached */
+        unsigned lcore;      /**< first core of the domain */
+        struct id_pool pool; /**< ids in use */
+};
+
+/**
+ * Cached IA32_PQR_ASSOC value of a core
+ */
+struct msr_shadow_entry {
+        uint64_t value; /**< register value */
+        uint64_t stamp; /**< time of last hardware access in microseconds */
+        int valid;      /**< \a value reflects hardware state */
+        /** domains of the core, NULL if not in topology */
+        struct msr_shadow_domain *dom[SHADOW_DOM_NUM];
+};
+
+static struct msr_shadow_entry *m_shadow = NULL; /**< indexed by lcore */
+static unsigned m_shadow_num = 0;                /**< number of entries */
+static uint64_t m_interval = 0; /**< revalidation interval in us, 0 - never */
+
+static struct msr_shadow_domain *m_dom[SHADOW_DOM_NUM];
+static unsigned m_dom_num[SHADOW_DOM_NUM];
+static int m_cos_aligned = 0; /**< COS domains share the same cores */
+
+/**
+ * @brief Gets monotonic time in microseconds
+ */
+static uint64_t
+msr_shadow_time(void)
+{
+        struct timespec ts;
+
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+                return 0;
+
+        return (uint64_t)ts.tv_sec * 1000000ULL +
+               (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/**
+ * @brief Gets id of the core's topology domain
+ */
+static unsigned
+msr_shadow_core_dom_id(const struct pqos_coreinfo *core,
+                       const enum msr_shadow_dom type)
+{
+        switch (type) {
+        case SHADOW_DOM_L3:
+                return core->l3_id;
+        case SHADOW_DOM_L3CAT:
+                return core->l3cat_id;
+        case SHADOW_DOM_MBA:
+                return core->mba_id;
+        case SHADOW_DOM_SMBA:
+                return core->smba_id;
+        case SHADOW_DOM_L2:
+        default:
+                return core->l2_id;
+        }
+}
+
+/**
+ * @brief Finds tracked topology domain
+ *
+ * @return Domain
+ * @retval NULL if not found
+ */
+static struct msr_shadow_domain *
+msr_shadow_dom_find(const enum msr_shadow_dom type, const unsigned id)
+{
+        unsigned i;
+
+        for (i = 0; i < m_dom_num[type]; i++)
+                if (m_dom[type][i].id == id)
+                        return &m_dom[type][i];
+
+        return NULL;
+}
+
+/**
+ * @brief Takes or drops references to ids held by cached core association
+ */
+static void
+msr_shadow_account(const struct msr_shadow_entry *entry, const int take)
+{
+        const unsigned rmid =
+            (unsigned)(entry->value & PQOS_MSR_ASSOC_RMID_MASK);
+        const unsigned cos =
+            (unsigned)(entry->value >> PQOS_MSR_ASSOC_QECOS_SHIFT);
+        unsigned i;
+
+        for (i = 0; i < SHADOW_DOM_NUM; i++) {
+                struct msr_shadow_domain *dom = entry->dom[i];
+                const unsigned id = (i == SHADOW_DOM_L3) ? rmid : cos;
+
+                if (dom == NULL)
+                        continue;
+
+                if (take)
+                        id_pool_get(&dom->pool, id);
+                else
+                        id_pool_put(&dom->pool, id);
+        }
+}
+
+/**
+ * @brief Stores register value read from or written to hardware
+ */
+static void
+msr_shadow_update(const unsigned lcore,
+                  const uint64_t value,
+                  const uint64_t stamp)
+{
+        struct msr_shadow_entry *entry;
+        unsigned i;
+
+        if (m_shadow == NULL || lcore >= m_shadow_num)
+                return;
+
+        entry = &m_shadow[lcore];
+        if (entry->valid)
+                msr_shadow_account(entry, 0);
+        else
+                for (i = 0; i < SHADOW_DOM_NUM; i++)
+                        if (entry->dom[i] != NULL)
+                                entry->dom[i]->unknown--;
+
+        entry->value = value;
+        entry->stamp = stamp;
+        entry->valid = 1;
+        msr_shadow_account(entry, 1);
+}
+
+/**
+ * @brief Marks cached core association as unknown
+ */
+static void
+msr_shadow_invalidate(const unsigned lcore)
+{
+        struct msr_shadow_entry *entry;
+        unsigned i;
+
+        if (m_shadow == NULL || lcore >= m_shadow_num)
+                return;
+
+        entry = &m_shadow[lcore];
+        if (!entry->valid)
+                return;
+
+        msr_shadow_account(entry, 0);
+        for (i = 0; i < SHADOW_DOM_NUM; i++)
+                if (entry->dom[i] != NULL)
+                        entry->dom[i]->unknown++;
+        entry->valid = 0;
+}
+
+/**
+ * @brief Creates topology domains and assigns them to cores
+ *
+ * @param [in] cpu CPU topology
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+msr_shadow_dom_init(const struct pqos_cpuinfo *cpu)
+{
+        unsigned i, type;
+
+        for (type = 0; type < SHADOW_DOM_NUM; type++) {
+                m_dom[type] = calloc(cpu->num_cores, sizeof(m_dom[type][0]));
+                if (m_dom[type] == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+        }
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                const struct pqos_coreinfo *core = &cpu->cores[i];
+                struct msr_shadow_entry *entry = &m_shadow[core->lcore];
+
+                for (type = 0; type < SHADOW_DOM_NUM; type++) {
+                        const unsigned id = msr_shadow_core_dom_id(core, type);
+                        struct msr_shadow_domain *dom;
+                        unsigned num;
+                        int ret;
+
+                        dom = msr_shadow_dom_find(type, id);
+                        if (dom == NULL) {
+                                num = (type == SHADOW_DOM_L3)
+                                          ? PQOS_MSR_ASSOC_RMID_MASK + 1
+                                          : PQOS_MAX_COS;
+                                dom = &m_dom[type][m_dom_num[type]];
+                                ret = id_pool_init(&dom->pool, num);
+                                if (ret != PQOS_RETVAL_OK)
+                                        return ret;
+                                dom->id = id;
+                                dom->lcore = core->lcore;
+                                m_dom_num[type]++;
+                        }
+
+                        dom->unknown++;
+                        entry->dom[type] = dom;
+                }
+        }
+
+        /**
+         * COS domains of all types cover the same cores and L2 clusters
+         * do not cross them if first core of each domain has the same
+         * domain ids as every other core of the domain.
+         */
+        m_cos_aligned = 1;
+        for (i = 0; i < cpu->num_cores && m_cos_aligned; i++) {
+                const struct msr_shadow_entry *entry =
+                    &m_shadow[cpu->cores[i].lcore];
+
+                for (type = SHADOW_DOM_L3CAT; type < SHADOW_DOM_NUM; type++) {
+                        const struct msr_shadow_entry *first =
+                            &m_shadow[entry->dom[type]->lcore];
+                        unsigned t;
+
+                        for (t = SHADOW_DOM_L3CAT; t < SHADOW_DOM_L2; t++)
+                                if (first->dom[t] != entry->dom[t])
+                                        m_cos_aligned = 0;
+                }
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Reads IA32_PQR_ASSOC of all cores in one MSR batch
+ *
+ * @param [in] cpu CPU topology
+ *
+ * @return Table of executed read operations, one per core in \a cpu
+ * @retval NULL on error
+ */
+static struct machine_msr_op *
+msr_shadow_read_all(const struct pqos_cpuinfo *cpu)
+{
+        struct machine_msr_op *ops;
+        unsigned i;
+
+        ops = calloc(cpu->num_cores, sizeof(ops[0]));
+        if (ops == NULL)
+                return NULL;
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                ops[i].lcore = cpu->cores[i].lcore;
+                ops[i].reg = PQOS_MSR_ASSOC;
+                ops[i].op = MACHINE_MSR_OP_READ;
+        }
+
+        if (msr_batch(ops, cpu->num_cores) != MACHINE_RETVAL_OK) {
+                free(ops);
+                return NULL;
+        }
+
+        return ops;
+}
+
+int
+msr_shadow_init(const struct pqos_cpuinfo *cpu)
+{
+        struct machine_msr_op *ops;
+        const char *env;
+        unsigned max_core = 0;
+        uint64_t stamp;
+        unsigned i;
+
+        ASSERT(cpu != NULL);
+
+        msr_shadow_fini();
+
+        for (i = 0; i < cpu->num_cores; i++)
+                if (cpu->cores[i].lcore > max_core)
+                        max_core = cpu->cores[i].lcore;
+
+        m_shadow = calloc(max_core + 1, sizeof(m_shadow[0]));
+        if (m_shadow == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        m_shadow_num = max_core + 1;
+
+        if (msr_shadow_dom_init(cpu) != PQOS_RETVAL_OK) {
+                msr_shadow_fini();
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        env = getenv("RDT_ASSOC_REVALIDATE_MS");
+        if (env != NULL) {
+                m_interval = strtoull(env, NULL, 10) * 1000ULL;
+                LOG_INFO("Core association revalidated every %s ms\n", env);
+        }
+
+        ops = msr_shadow_read_all(cpu);
+        if (ops == NULL) {
+                LOG_DEBUG("Core association will be read on first use\n");
+                return PQOS_RETVAL_OK;
+        }
+
+        stamp = msr_shadow_time();
+        for (i = 0; i < cpu->num_cores; i++)
+                msr_shadow_update(ops[i].lcore, ops[i].value, stamp);
+
+        free(ops);
+
+        return PQOS_RETVAL_OK;
+}
+
+void
+msr_shadow_fini(void)
+{
+        unsigned type, i;
+
+        for (type = 0; type < SHADOW_DOM_NUM; type++) {
+                for (i = 0; i < m_dom_num[type]; i++)
+                        id_pool_fini(&m_dom[type][i].pool);
+                free(m_dom[type]);
+                m_dom[type] = NULL;
+                m_dom_num[type] = 0;
+        }
+        m_cos_aligned = 0;
+
+        free(m_shadow);
+        m_shadow = NULL;
+        m_shadow_num = 0;
+        m_interval = 0;
+}
+
+int
+msr_shadow_assoc_read(const unsigned lcore, uint64_t *value)
+{
+        uint64_t stamp = 0;
+
+        ASSERT(value != NULL);
+
+        if (m_shadow != NULL && lcore < m_shadow_num &&
+            m_shadow[lcore].valid) {
+                if (m_interval == 0) {
+                        *value = m_shadow[lcore].value;
+                        return PQOS_RETVAL_OK;
+                }
+
+                stamp = msr_shadow_time();
+                if (stamp - m_shadow[lcore].stamp < m_interval) {
+                        *value = m_shadow[lcore].value;
+                        return PQOS_RETVAL_OK;
+                }
+        }
+
+        if (msr_read(lcore, PQOS_MSR_ASSOC, value) != MACHINE_RETVAL_OK)
+                return PQOS_RETVAL_ERROR;
+
+        if (m_interval != 0 && stamp == 0)
+                stamp = msr_shadow_time();
+        msr_shadow_update(lcore, *value, stamp);
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+msr_shadow_assoc_write(const unsigned lcore, const uint64_t value)
+{
+        if (msr_write(lcore, PQOS_MSR_ASSOC, value) != MACHINE_RETVAL_OK) {
+                /* register state unknown */
+                msr_shadow_invalidate(lcore);
+                return PQOS_RETVAL_ERROR;
+        }
+
+        msr_shadow_update(lcore, value,
+                          m_interval != 0 ? msr_shadow_time() : 0);
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+msr_shadow_revalidate(const unsigned max_cores,
+                      unsigned *num_cores,
+                      unsigned *cores)
+{
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+        struct machine_msr_op *ops;
+        unsigned changed = 0;
+        uint64_t stamp;
+        unsigned i;
+
+        ASSERT(num_cores != NULL);
+
+        if (m_shadow == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        ops = msr_shadow_read_all(cpu);
+        if (ops == NULL) {
+                for (i = 0; i < m_shadow_num; i++)
+                        msr_shadow_invalidate(i);
+                return PQOS_RETVAL_ERROR;
+        }
+
+        stamp = msr_shadow_time();
+        for (i = 0; i < cpu->num_cores; i++) {
+                const unsigned lcore = ops[i].lcore;
+                const struct msr_shadow_entry *entry;
+
+                if (lcore >= m_shadow_num)
+                        continue;
+
+                entry = &m_shadow[lcore];
+                if (entry->valid && entry->value != ops[i].value) {
+                        LOG_WARN("Core %u association changed externally: "
+                                 "COS%u RMID%u -> COS%u RMID%u\n",
+                                 lcore,
+                                 (unsigned)(entry->value >>
+                                            PQOS_MSR_ASSOC_QECOS_SHIFT),
+                                 (unsigned)(entry->value &
+                                            PQOS_MSR_ASSOC_RMID_MASK),
+                                 (unsigned)(ops[i].value >>
+                                            PQOS_MSR_ASSOC_QECOS_SHIFT),
+                                 (unsigned)(ops[i].value &
+                                            PQOS_MSR_ASSOC_RMID_MASK));
+                        if (cores != NULL && changed < max_cores)
+                                cores[changed] = lcore;
+                        changed++;
+                }
+
+                msr_shadow_update(lcore, ops[i].value, stamp);
+        }
+
+        free(ops);
+        *num_cores = changed;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Gets pool of tracked domain if all its cores are cached
+ */
+static const struct id_pool *
+msr_shadow_pool(const enum msr_shadow_dom type, const unsigned id)
+{
+        const struct msr_shadow_domain *dom;
+
+        /* cached values may be outdated */
+        if (m_shadow == NULL || m_interval != 0)
+                return NULL;
+
+        dom = msr_shadow_dom_find(type, id);
+        if (dom == NULL || dom->unknown > 0)
+                return NULL;
+
+        return &dom->pool;
+}
+
+const struct id_pool *
+msr_shadow_rmid_pool(const unsigned l3_id)
+{
+        return msr_shadow_pool(SHADOW_DOM_L3, l3_id);
+}
+
+const struct id_pool *
+msr_shadow_cos_pool(const enum pqos_topo_obj type, const unsigned id)
+{
+        switch (type) {
+        case TOPO_OBJ_L3CAT:
+                return msr_shadow_pool(SHADOW_DOM_L3CAT, id);
+        case TOPO_OBJ_MBA:
+                return msr_shadow_pool(SHADOW_DOM_MBA, id);
+        case TOPO_OBJ_SMBA:
+                return msr_shadow_pool(SHADOW_DOM_SMBA, id);
+        case TOPO_OBJ_L2_CLUSTER:
+                return msr_shadow_pool(SHADOW_DOM_L2, id);
+        default:
+                return NULL;
+        }
+}
+
+int
+msr_shadow_cos_aligned(void)
+{
+        return m_cos_aligned;
+}
@@ -0,0 +1,161 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Shadow of core association registers
+ *
+ * IA32_PQR_ASSOC value (RMID and COS) of every core is read once at
+ * initialization and updated on every write done by the library, so
+ * that association lookups on MSR and MMIO interfaces do not access
+ * hardware. Cached values can be revalidated on demand or, when the
+ * RDT_ASSOC_REVALIDATE_MS environment variable is set, after given
+ * number of milliseconds.
+ *
+ * RMIDs used in each L3 cluster and classes of service used in each
+ * allocation domain are reference counted as associations change, so
+ * unused ids are found without visiting the cores.
+ */
+
+#ifndef __PQOS_MSR_SHADOW_H__
+#define __PQOS_MSR_SHADOW_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "id_pool.h"
+#include "pqos.h"
+#include "types.h"
+#include "utils.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Initializes association shadow
+ *
+ * Cores whose association could not be read are read from hardware
+ * on first access.
+ *
+ * @param [in] cpu CPU topology
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE on memory allocation failure
+ */
+PQOS_LOCAL int msr_shadow_init(const struct pqos_cpuinfo *cpu);
+
+/**
+ * @brief Releases association shadow
+ */
+PQOS_LOCAL void msr_shadow_fini(void);
+
+/**
+ * @brief Reads IA32_PQR_ASSOC of \a lcore
+ *
+ * Hardware is accessed only if shadow is not initialized or cached value
+ * is not valid.
+ *
+ * @param [in] lcore logical core id
+ * @param [out] value register value
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int msr_shadow_assoc_read(const unsigned lcore, uint64_t *value);
+
+/**
+ * @brief Writes IA32_PQR_ASSOC of \a lcore and updates the shadow
+ *
+ * @param [in] lcore logical core id
+ * @param [in] value register value
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int msr_shadow_assoc_write(const unsigned lcore,
+                                      const uint64_t value);
+
+/**
+ * @brief Re-reads association of all cores and reports external changes
+ *
+ * @param [in] max_cores size of \a cores table
+ * @param [out] num_cores number of cores with association changed
+ *              outside of the library
+ * @param [out] cores table to store first \a max_cores changed cores
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE shadow not initialized
+ */
+PQOS_LOCAL int msr_shadow_revalidate(const unsigned max_cores,
+                                     unsigned *num_cores,
+                                     unsigned *cores);
+
+/**
+ * @brief Gets RMIDs associated with cores of L3 cluster
+ *
+ * Pool is maintained on every association change and is valid until the
+ * next one.
+ *
+ * @param [in] l3_id L3 cluster id
+ *
+ * @return RMIDs in use
+ * @retval NULL if association of some cluster cores is not cached
+ */
+PQOS_LOCAL const struct id_pool *msr_shadow_rmid_pool(const unsigned l3_id);
+
+/**
+ * @brief Gets classes of service associated with cores of a domain
+ *
+ * @param [in] type TOPO_OBJ_L3CAT, TOPO_OBJ_MBA, TOPO_OBJ_SMBA
+ *             or TOPO_OBJ_L2_CLUSTER
+ * @param [in] id domain id
+ *
+ * @return Classes of service in use
+ * @retval NULL if association of some domain cores is not cached
+ */
+PQOS_LOCAL const struct id_pool *
+msr_shadow_cos_pool(const enum pqos_topo_obj type, const unsigned id);
+
+/**
+ * @brief Checks if L3 CAT, MBA and SMBA domains consist of the same cores
+ *        and L2 clusters do not span multiple domains
+ *
+ * @return 1 if domains are aligned, 0 otherwise
+ */
+PQOS_LOCAL int msr_shadow_cos_aligned(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_MSR_SHADOW_H__ */
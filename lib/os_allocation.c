@@ -33,6 +33,7 @@
 
 #include "os_allocation.h"
 
+#include "alloc_txn.h"
 #include "allocation.h"
 #include "cap.h"
 #include "common.h"
@@ -1204,21 +1205,29 @@ verify_smba_id(const unsigned smba_id, const struct pqos_cpuinfo *cpu)
         return ret;
 }
 
-int
-os_l3ca_set(const unsigned l3cat_id,
-            const unsigned num_cos,
-            const struct pqos_l3ca *ca)
+/**
+ * @brief Validates L3 CAT classes of service before they are applied
+ *
+ * @param [in] l3cat_id L3 CAT resource id
+ * @param [in] num_cos number of classes of service at \a ca
+ * @param [in] ca class of service definitions
+ * @param [out] cdp_enabled L3 CDP state
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_l3ca_check(const unsigned l3cat_id,
+              const unsigned num_cos,
+              const struct pqos_l3ca *ca,
+              int *cdp_enabled)
 {
         int ret;
         unsigned i;
         unsigned num_grps = 0, l3ca_num;
-        int cdp_enabled = 0;
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
 
-        ASSERT(ca != NULL);
-        ASSERT(num_cos != 0);
-
         /**
          * Check if class bitmasks are zero.
          */
@@ -1264,9 +1273,58 @@ os_l3ca_set(const unsigned l3cat_id,
 
         ret = verify_l3cat_id(l3cat_id, cpu);
         if (ret != PQOS_RETVAL_OK)
-                goto os_l3ca_set_exit;
+                return ret;
+
+        return pqos_l3ca_cdp_enabled(cap, NULL, cdp_enabled);
+}
+
+/**
+ * @brief Converts L3 CAT class of service to the current CDP mode
+ *
+ * @param [in] ca requested class of service definition
+ * @param [in] cdp_enabled L3 CDP state
+ * @param [out] l3ca class of service definition to be written
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_l3ca_convert(const struct pqos_l3ca *ca,
+                const int cdp_enabled,
+                struct pqos_l3ca *l3ca)
+{
+        if (ca->cdp == 1 && cdp_enabled == 0) {
+                LOG_ERROR("Attempting to set CDP COS while L3 CDP "
+                          "is disabled!\n");
+                return PQOS_RETVAL_ERROR;
+        }
+
+        if (cdp_enabled == 1 && ca->cdp == 0) {
+                l3ca->class_id = ca->class_id;
+                l3ca->cdp = 1;
+                l3ca->u.s.data_mask = ca->u.ways_mask;
+                l3ca->u.s.code_mask = ca->u.ways_mask;
+        } else
+                *l3ca = *ca;
 
-        ret = pqos_l3ca_cdp_enabled(cap, NULL, &cdp_enabled);
+        return PQOS_RETVAL_OK;
+}
+
+int
+os_l3ca_set(const unsigned l3cat_id,
+            const unsigned num_cos,
+            const struct pqos_l3ca *ca)
+{
+        int ret;
+        unsigned i;
+        int cdp_enabled = 0;
+        const struct pqos_cap *cap = _pqos_get_cap();
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+
+        ASSERT(ca != NULL);
+        ASSERT(num_cos != 0);
+
+        ret = os_l3ca_check(l3cat_id, num_cos, ca, &cdp_enabled);
         if (ret != PQOS_RETVAL_OK)
                 goto os_l3ca_set_exit;
 
@@ -1276,13 +1334,11 @@ os_l3ca_set(const unsigned l3cat_id,
 
         for (i = 0; i < num_cos; i++) {
                 struct resctrl_schemata *schmt;
+                struct pqos_l3ca l3ca;
 
-                if (ca[i].cdp == 1 && cdp_enabled == 0) {
-                        LOG_ERROR("Attempting to set CDP COS while L3 CDP "
-                                  "is disabled!\n");
-                        ret = PQOS_RETVAL_ERROR;
+                ret = os_l3ca_convert(&ca[i], cdp_enabled, &l3ca);
+                if (ret != PQOS_RETVAL_OK)
                         goto os_l3ca_set_unlock;
-                }
 
                 schmt = resctrl_schemata_alloc(cap, cpu);
                 if (schmt == NULL)
@@ -1294,18 +1350,8 @@ os_l3ca_set(const unsigned l3cat_id,
                             resctrl_alloc_schemata_read(ca[i].class_id, schmt);
 
                 /* update schemata */
-                if (ret == PQOS_RETVAL_OK) {
-                        struct pqos_l3ca l3ca;
-
-                        if (cdp_enabled == 1 && ca[i].cdp == 0) {
-                                l3ca.cdp = 1;
-                                l3ca.u.s.data_mask = ca[i].u.ways_mask;
-                                l3ca.u.s.code_mask = ca[i].u.ways_mask;
-                        } else
-                                l3ca = ca[i];
-
+                if (ret == PQOS_RETVAL_OK)
                         ret = resctrl_schemata_l3ca_set(schmt, l3cat_id, &l3ca);
-                }
 
                 /* write schemata */
                 if (ret == PQOS_RETVAL_OK)
@@ -1451,21 +1497,29 @@ verify_l2_id(const unsigned l2id, const struct pqos_cpuinfo *cpu)
         return ret;
 }
 
-int
-os_l2ca_set(const unsigned l2id,
-            const unsigned num_cos,
-            const struct pqos_l2ca *ca)
+/**
+ * @brief Validates L2 CAT classes of service before they are applied
+ *
+ * @param [in] l2id unique L2 cache identifier
+ * @param [in] num_cos number of classes of service at \a ca
+ * @param [in] ca class of service definitions
+ * @param [out] cdp_enabled L2 CDP state
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_l2ca_check(const unsigned l2id,
+              const unsigned num_cos,
+              const struct pqos_l2ca *ca,
+              int *cdp_enabled)
 {
         int ret;
         unsigned i;
         unsigned num_grps = 0, l2ca_num;
-        int cdp_enabled;
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
 
-        ASSERT(ca != NULL);
-        ASSERT(num_cos != 0);
-
         /* Check L2 CBM is non-contiguous */
         if (!cap_get_l2ca_non_contignous()) {
                 unsigned idx;
@@ -1491,9 +1545,9 @@ os_l2ca_set(const unsigned l2id,
         if (num_cos > num_grps)
                 return PQOS_RETVAL_PARAM;
 
-        ret = pqos_l2ca_cdp_enabled(cap, NULL, &cdp_enabled);
+        ret = pqos_l2ca_cdp_enabled(cap, NULL, cdp_enabled);
         if (ret != PQOS_RETVAL_OK)
-                goto os_l2ca_set_exit;
+                return ret;
 
         /*
          * Check if class id's are within allowed range.
@@ -1506,7 +1560,56 @@ os_l2ca_set(const unsigned l2id,
                 }
         }
 
-        ret = verify_l2_id(l2id, cpu);
+        return verify_l2_id(l2id, cpu);
+}
+
+/**
+ * @brief Converts L2 CAT class of service to the current CDP mode
+ *
+ * @param [in] ca requested class of service definition
+ * @param [in] cdp_enabled L2 CDP state
+ * @param [out] l2ca class of service definition to be written
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_l2ca_convert(const struct pqos_l2ca *ca,
+                const int cdp_enabled,
+                struct pqos_l2ca *l2ca)
+{
+        if (ca->cdp == 1 && cdp_enabled == 0) {
+                LOG_ERROR("Attempting to set CDP COS while L2 CDP "
+                          "is disabled!\n");
+                return PQOS_RETVAL_ERROR;
+        }
+
+        if (cdp_enabled == 1 && ca->cdp == 0) {
+                l2ca->class_id = ca->class_id;
+                l2ca->cdp = 1;
+                l2ca->u.s.data_mask = ca->u.ways_mask;
+                l2ca->u.s.code_mask = ca->u.ways_mask;
+        } else
+                *l2ca = *ca;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+os_l2ca_set(const unsigned l2id,
+            const unsigned num_cos,
+            const struct pqos_l2ca *ca)
+{
+        int ret;
+        unsigned i;
+        int cdp_enabled;
+        const struct pqos_cap *cap = _pqos_get_cap();
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+
+        ASSERT(ca != NULL);
+        ASSERT(num_cos != 0);
+
+        ret = os_l2ca_check(l2id, num_cos, ca, &cdp_enabled);
         if (ret != PQOS_RETVAL_OK)
                 goto os_l2ca_set_exit;
 
@@ -1516,13 +1619,11 @@ os_l2ca_set(const unsigned l2id,
 
         for (i = 0; i < num_cos; i++) {
                 struct resctrl_schemata *schmt;
+                struct pqos_l2ca l2ca;
 
-                if (ca[i].cdp == 1 && cdp_enabled == 0) {
-                        LOG_ERROR("Attempting to set CDP COS while L2 CDP "
-                                  "is disabled!\n");
-                        ret = PQOS_RETVAL_ERROR;
+                ret = os_l2ca_convert(&ca[i], cdp_enabled, &l2ca);
+                if (ret != PQOS_RETVAL_OK)
                         goto os_l2ca_set_unlock;
-                }
 
                 schmt = resctrl_schemata_alloc(cap, cpu);
                 if (schmt == NULL)
@@ -1534,18 +1635,8 @@ os_l2ca_set(const unsigned l2id,
                             resctrl_alloc_schemata_read(ca[i].class_id, schmt);
 
                 /* update schemata */
-                if (ret == PQOS_RETVAL_OK) {
-                        struct pqos_l2ca l2ca;
-
-                        if (cdp_enabled == 1 && ca[i].cdp == 0) {
-                                l2ca.cdp = 1;
-                                l2ca.u.s.data_mask = ca[i].u.ways_mask;
-                                l2ca.u.s.code_mask = ca[i].u.ways_mask;
-                        } else
-                                l2ca = ca[i];
-
+                if (ret == PQOS_RETVAL_OK)
                         ret = resctrl_schemata_l2ca_set(schmt, l2id, &l2ca);
-                }
 
                 if (ret == PQOS_RETVAL_OK)
                         ret = resctrl_alloc_schemata_write(
@@ -1658,28 +1749,39 @@ os_l2ca_get_min_cbm_bits(unsigned *min_cbm_bits)
         return ret;
 }
 
-int
-os_mba_set(const unsigned mba_id,
-           const unsigned num_cos,
-           const struct pqos_mba *requested,
-           struct pqos_mba *actual)
+/**
+ * @brief Validates MBA or SMBA classes of service before they are applied
+ *
+ * @param [in] type PQOS_CAP_TYPE_MBA or PQOS_CAP_TYPE_SMBA
+ * @param [in] id MBA or SMBA resource id
+ * @param [in] num_cos number of classes of service at \a requested
+ * @param [in] requested class of service definitions
+ * @param [out] mba_cap MBA or SMBA capability
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_mba_check(const enum pqos_cap_type type,
+             const unsigned id,
+             const unsigned num_cos,
+             const struct pqos_mba *requested,
+             const struct pqos_cap_mba **mba_cap)
 {
         int ret;
-        unsigned i, step = 0;
+        unsigned i;
         unsigned num_grps = 0;
+        const char *name = type == PQOS_CAP_TYPE_SMBA ? "SMBA" : "MBA";
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
-        const struct pqos_capability *mba_cap = NULL;
-
-        ASSERT(requested != NULL);
-        ASSERT(num_cos != 0);
+        const struct pqos_capability *capability = NULL;
 
         /**
-         * Check if MBA is supported
+         * Check if MBA/SMBA is supported
          */
-        ret = pqos_cap_get_type(cap, PQOS_CAP_TYPE_MBA, &mba_cap);
+        ret = pqos_cap_get_type(cap, type, &capability);
         if (ret != PQOS_RETVAL_OK)
-                return PQOS_RETVAL_RESOURCE; /* MBA not supported */
+                return PQOS_RETVAL_RESOURCE; /* MBA/SMBA not supported */
 
         ret = resctrl_alloc_get_grps_num(cap, &num_grps);
         if (ret != PQOS_RETVAL_OK)
@@ -1688,19 +1790,88 @@ os_mba_set(const unsigned mba_id,
         if (num_cos > num_grps)
                 return PQOS_RETVAL_PARAM;
 
-        step = mba_cap->u.mba->throttle_step;
-
         /**
          * Check if class id's are within allowed range.
          */
         for (i = 0; i < num_cos; i++)
                 if (requested[i].class_id >= num_grps) {
-                        LOG_ERROR("MBA COS%u is out of range (COS%u is max)!\n",
-                                  requested[i].class_id, num_grps - 1);
+                        LOG_ERROR("%s COS%u is out of range (COS%u is max)!\n",
+                                  name, requested[i].class_id, num_grps - 1);
                         return PQOS_RETVAL_PARAM;
                 }
 
-        ret = verify_mba_id(mba_id, cpu);
+        if (type == PQOS_CAP_TYPE_SMBA) {
+                *mba_cap = capability->u.smba;
+                return verify_smba_id(id, cpu);
+        }
+
+        *mba_cap = capability->u.mba;
+        return verify_mba_id(id, cpu);
+}
+
+/**
+ * @brief Converts MBA or SMBA class of service to the value to be written
+ *
+ * @param [in] mba_cap MBA or SMBA capability
+ * @param [in] step throttling step to round rate to, 0 to keep the rate
+ * @param [in] requested requested class of service definition
+ * @param [out] mba class of service definition to be written
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_mba_convert(const struct pqos_cap_mba *mba_cap,
+               const unsigned step,
+               const struct pqos_mba *requested,
+               struct pqos_mba *mba)
+{
+        const char *name = requested->smba ? "SMBA" : "MBA";
+
+        if (mba_cap->ctrl_on == 0 && requested->ctrl) {
+                LOG_ERROR("%s controller requested but not enabled!\n",
+                          name);
+                return PQOS_RETVAL_PARAM;
+        }
+
+        if (mba_cap->ctrl_on == 1 && !requested->ctrl) {
+                LOG_ERROR("Expected %s controller but not requested!\n",
+                          name);
+                return PQOS_RETVAL_PARAM;
+        }
+
+        *mba = *requested;
+        if (step == 0)
+                return PQOS_RETVAL_OK;
+
+        if (mba->ctrl == 0) {
+                mba->mb_max =
+                    (((requested->mb_max + (step / 2)) / step) * step);
+                if (mba->mb_max == 0)
+                        mba->mb_max = step;
+        } else if (mba->mb_max > UINT32_MAX - step)
+                mba->mb_max -= mba->mb_max % step;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+os_mba_set(const unsigned mba_id,
+           const unsigned num_cos,
+           const struct pqos_mba *requested,
+           struct pqos_mba *actual)
+{
+        int ret;
+        unsigned i;
+        const struct pqos_cap *cap = _pqos_get_cap();
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+        const struct pqos_cap_mba *mba_cap = NULL;
+
+        ASSERT(requested != NULL);
+        ASSERT(num_cos != 0);
+
+        ret = os_mba_check(PQOS_CAP_TYPE_MBA, mba_id, num_cos, requested,
+                           &mba_cap);
         if (ret != PQOS_RETVAL_OK)
                 goto os_mba_set_exit;
 
@@ -1710,20 +1881,12 @@ os_mba_set(const unsigned mba_id,
 
         for (i = 0; i < num_cos; i++) {
                 struct resctrl_schemata *schmt;
+                struct pqos_mba mba;
 
-                if (mba_cap->u.mba->ctrl_on == 0 && requested[i].ctrl) {
-                        LOG_ERROR("MBA controller requested but"
-                                  " not enabled!\n");
-                        ret = PQOS_RETVAL_PARAM;
-                        goto os_mba_set_unlock;
-                }
-
-                if (mba_cap->u.mba->ctrl_on == 1 && !requested[i].ctrl) {
-                        LOG_ERROR("Expected MBA controller but"
-                                  " not requested!\n");
-                        ret = PQOS_RETVAL_PARAM;
+                ret = os_mba_convert(mba_cap, mba_cap->throttle_step,
+                                     &requested[i], &mba);
+                if (ret != PQOS_RETVAL_OK)
                         goto os_mba_set_unlock;
-                }
 
                 schmt = resctrl_schemata_alloc(cap, cpu);
                 if (schmt == NULL)
@@ -1734,24 +1897,9 @@ os_mba_set(const unsigned mba_id,
                         ret = resctrl_alloc_schemata_read(requested[i].class_id,
                                                           schmt);
 
-                /* update and write schemata */
-                if (ret == PQOS_RETVAL_OK) {
-                        struct pqos_mba mba;
-
-                        mba = requested[i];
-
-                        if (mba.ctrl == 0) {
-                                mba.mb_max =
-                                    (((requested[i].mb_max + (step / 2)) /
-                                      step) *
-                                     step);
-                                if (mba.mb_max == 0)
-                                        mba.mb_max = step;
-                        } else if (mba.mb_max > UINT32_MAX - step)
-                                mba.mb_max -= mba.mb_max % step;
-
+                /* update schemata */
+                if (ret == PQOS_RETVAL_OK)
                         ret = resctrl_schemata_mba_set(schmt, mba_id, &mba);
-                }
 
                 /* write schemata */
                 if (ret == PQOS_RETVAL_OK)
@@ -1792,10 +1940,9 @@ os_mba_set_amd(const unsigned mba_id,
 {
         int ret;
         unsigned i;
-        unsigned num_grps = 0;
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
-        const struct pqos_capability *mba_cap = NULL;
+        const struct pqos_cap_mba *mba_cap = NULL;
 
         ASSERT(requested != NULL);
         ASSERT(num_cos != 0);
@@ -1805,31 +1952,8 @@ os_mba_set_amd(const unsigned mba_id,
                 return ret;
         }
 
-        /**
-         * Check if MBA is supported
-         */
-        ret = pqos_cap_get_type(cap, PQOS_CAP_TYPE_MBA, &mba_cap);
-        if (ret != PQOS_RETVAL_OK)
-                return PQOS_RETVAL_RESOURCE; /* MBA not supported */
-
-        ret = resctrl_alloc_get_grps_num(cap, &num_grps);
-        if (ret != PQOS_RETVAL_OK)
-                return ret;
-
-        if (num_cos > num_grps)
-                return PQOS_RETVAL_PARAM;
-
-        /**
-         * Check if class id's are within allowed range.
-         */
-        for (i = 0; i < num_cos; i++)
-                if (requested[i].class_id >= num_grps) {
-                        LOG_ERROR("MBA COS%u is out of range (COS%u is max)!\n",
-                                  requested[i].class_id, num_grps - 1);
-                        return PQOS_RETVAL_PARAM;
-                }
-
-        ret = verify_mba_id(mba_id, cpu);
+        ret = os_mba_check(PQOS_CAP_TYPE_MBA, mba_id, num_cos, requested,
+                           &mba_cap);
         if (ret != PQOS_RETVAL_OK)
                 goto os_mba_set_exit;
 
@@ -1839,20 +1963,11 @@ os_mba_set_amd(const unsigned mba_id,
 
         for (i = 0; i < num_cos; i++) {
                 struct resctrl_schemata *schmt;
+                struct pqos_mba mba;
 
-                if (mba_cap->u.mba->ctrl_on == 0 && requested[i].ctrl) {
-                        LOG_ERROR("MBA controller requested but not "
-                                  "enabled!\n");
-                        ret = PQOS_RETVAL_PARAM;
-                        goto os_mba_set_unlock;
-                }
-
-                if (mba_cap->u.mba->ctrl_on == 1 && !requested[i].ctrl) {
-                        LOG_ERROR("Expected MBA controller but not "
-                                  "requested!\n");
-                        ret = PQOS_RETVAL_PARAM;
+                ret = os_mba_convert(mba_cap, 0, &requested[i], &mba);
+                if (ret != PQOS_RETVAL_OK)
                         goto os_mba_set_unlock;
-                }
 
                 schmt = resctrl_schemata_alloc(cap, cpu);
                 if (schmt == NULL)
@@ -1863,12 +1978,9 @@ os_mba_set_amd(const unsigned mba_id,
                         ret = resctrl_alloc_schemata_read(requested[i].class_id,
                                                           schmt);
 
-                /* update and write schemata */
-                if (ret == PQOS_RETVAL_OK) {
-                        struct pqos_mba mba = requested[i];
-
+                /* update schemata */
+                if (ret == PQOS_RETVAL_OK)
                         ret = resctrl_schemata_mba_set(schmt, mba_id, &mba);
-                }
 
                 /* write schemata */
                 if (ret == PQOS_RETVAL_OK)
@@ -2121,40 +2233,15 @@ os_smba_set_amd(const unsigned smba_id,
 {
         int ret;
         unsigned i;
-        unsigned num_grps = 0;
         const struct pqos_cap *cap = _pqos_get_cap();
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
-        const struct pqos_capability *smba_cap = NULL;
+        const struct pqos_cap_mba *smba_cap = NULL;
 
         ASSERT(requested != NULL);
         ASSERT(num_cos != 0);
 
-        /**
-         * Check if SMBA is supported
-         */
-        ret = pqos_cap_get_type(cap, PQOS_CAP_TYPE_SMBA, &smba_cap);
-        if (ret != PQOS_RETVAL_OK)
-                return PQOS_RETVAL_RESOURCE; /* SMBA not supported */
-
-        ret = resctrl_alloc_get_grps_num(cap, &num_grps);
-        if (ret != PQOS_RETVAL_OK)
-                return ret;
-
-        if (num_cos > num_grps)
-                return PQOS_RETVAL_PARAM;
-
-        /**
-         * Check if class id's are within allowed range.
-         */
-        for (i = 0; i < num_cos; i++)
-                if (requested[i].class_id >= num_grps) {
-                        LOG_ERROR(
-                            "SMBA COS%u is out of range (COS%u is max)!\n",
-                            requested[i].class_id, num_grps - 1);
-                        return PQOS_RETVAL_PARAM;
-                }
-
-        ret = verify_smba_id(smba_id, cpu);
+        ret = os_mba_check(PQOS_CAP_TYPE_SMBA, smba_id, num_cos, requested,
+                           &smba_cap);
         if (ret != PQOS_RETVAL_OK)
                 goto os_mba_set_exit;
 
@@ -2164,20 +2251,11 @@ os_smba_set_amd(const unsigned smba_id,
 
         for (i = 0; i < num_cos; i++) {
                 struct resctrl_schemata *schmt;
+                struct pqos_mba smba;
 
-                if (smba_cap->u.smba->ctrl_on == 0 && requested[i].ctrl) {
-                        LOG_ERROR("SMBA controller requested but not "
-                                  "enabled!\n");
-                        ret = PQOS_RETVAL_PARAM;
+                ret = os_mba_convert(smba_cap, 0, &requested[i], &smba);
+                if (ret != PQOS_RETVAL_OK)
                         goto os_mba_set_unlock;
-                }
-
-                if (smba_cap->u.smba->ctrl_on == 1 && !requested[i].ctrl) {
-                        LOG_ERROR("Expected SMBA controller but not "
-                                  "requested!\n");
-                        ret = PQOS_RETVAL_PARAM;
-                        goto os_mba_set_unlock;
-                }
 
                 schmt = resctrl_schemata_alloc(cap, cpu);
                 if (schmt == NULL)
@@ -2188,12 +2266,9 @@ os_smba_set_amd(const unsigned smba_id,
                         ret = resctrl_alloc_schemata_read(requested[i].class_id,
                                                           schmt);
 
-                /* update and write schemata */
-                if (ret == PQOS_RETVAL_OK) {
-                        struct pqos_mba smba = requested[i];
-
+                /* update schemata */
+                if (ret == PQOS_RETVAL_OK)
                         ret = resctrl_schemata_smba_set(schmt, smba_id, &smba);
-                }
 
                 /* write schemata */
                 if (ret == PQOS_RETVAL_OK)
@@ -2376,3 +2451,256 @@ os_alloc_release_pid_unlock:
 
         return ret;
 }
+
+/**
+ * @brief Validates staged class of service and converts it to the value
+ *        to be written to schemata
+ *
+ * @param [in,out] entry staged class of service definition
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_alloc_txn_prepare(struct alloc_txn_entry *entry)
+{
+        int ret = PQOS_RETVAL_OK;
+        int cdp_enabled = 0;
+        const struct pqos_cap_mba *mba_cap = NULL;
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+
+        switch (entry->technology) {
+        case PQOS_TECHNOLOGY_L3CA: {
+                const struct pqos_l3ca ca = entry->u.l3ca;
+
+                ret = os_l3ca_check(entry->res_id, 1, &ca, &cdp_enabled);
+                if (ret == PQOS_RETVAL_OK)
+                        ret = os_l3ca_convert(&ca, cdp_enabled, &entry->u.l3ca);
+                break;
+        }
+        case PQOS_TECHNOLOGY_L2CA: {
+                const struct pqos_l2ca ca = entry->u.l2ca;
+
+                ret = os_l2ca_check(entry->res_id, 1, &ca, &cdp_enabled);
+                if (ret == PQOS_RETVAL_OK)
+                        ret = os_l2ca_convert(&ca, cdp_enabled, &entry->u.l2ca);
+                break;
+        }
+        case PQOS_TECHNOLOGY_MBA: {
+                const struct pqos_mba mba = entry->u.mba;
+                unsigned step = 0;
+
+                ret = os_mba_check(PQOS_CAP_TYPE_MBA, entry->res_id, 1, &mba,
+                                   &mba_cap);
+                if (ret != PQOS_RETVAL_OK)
+                        break;
+
+                /* MBA rate is rounded to throttling step on Intel only */
+                if (cpu->vendor != PQOS_VENDOR_AMD &&
+                    cpu->vendor != PQOS_VENDOR_HYGON)
+                        step = mba_cap->throttle_step;
+
+                ret = os_mba_convert(mba_cap, step, &mba, &entry->u.mba);
+                break;
+        }
+        case PQOS_TECHNOLOGY_SMBA: {
+                const struct pqos_mba smba = entry->u.mba;
+
+                ret = os_mba_check(PQOS_CAP_TYPE_SMBA, entry->res_id, 1, &smba,
+                                   &mba_cap);
+                if (ret == PQOS_RETVAL_OK)
+                        ret = os_mba_convert(mba_cap, 0, &smba, &entry->u.mba);
+                break;
+        }
+        default:
+                ret = PQOS_RETVAL_PARAM;
+                break;
+        }
+
+        return ret;
+}
+
+/**
+ * @brief Applies staged class of service to parsed schemata
+ *
+ * @param [in,out] schmt schemata of the class of service
+ * @param [in] entry staged class of service definition
+ * @param [in,out] technology technologies with modified schemata lines
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_alloc_txn_apply(struct resctrl_schemata *schmt,
+                   const struct alloc_txn_entry *entry,
+                   unsigned *technology)
+{
+        int ret;
+        int changed = 0;
+        const unsigned id = entry->res_id;
+
+        switch (entry->technology) {
+        case PQOS_TECHNOLOGY_L3CA: {
+                const struct pqos_l3ca *ca = &entry->u.l3ca;
+                struct pqos_l3ca cur;
+
+                ret = resctrl_schemata_l3ca_get(schmt, id, &cur);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+
+                if (ca->cdp)
+                        changed = !cur.cdp ||
+                                  cur.u.s.data_mask != ca->u.s.data_mask ||
+                                  cur.u.s.code_mask != ca->u.s.code_mask;
+                else
+                        changed = cur.cdp || cur.u.ways_mask != ca->u.ways_mask;
+                if (changed)
+                        ret = resctrl_schemata_l3ca_set(schmt, id, ca);
+                break;
+        }
+        case PQOS_TECHNOLOGY_L2CA: {
+                const struct pqos_l2ca *ca = &entry->u.l2ca;
+                struct pqos_l2ca cur;
+
+                ret = resctrl_schemata_l2ca_get(schmt, id, &cur);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+
+                if (ca->cdp)
+                        changed = !cur.cdp ||
+                                  cur.u.s.data_mask != ca->u.s.data_mask ||
+                                  cur.u.s.code_mask != ca->u.s.code_mask;
+                else
+                        changed = cur.cdp || cur.u.ways_mask != ca->u.ways_mask;
+                if (changed)
+                        ret = resctrl_schemata_l2ca_set(schmt, id, ca);
+                break;
+        }
+        case PQOS_TECHNOLOGY_MBA: {
+                struct pqos_mba cur;
+
+                ret = resctrl_schemata_mba_get(schmt, id, &cur);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+
+                changed = cur.mb_max != entry->u.mba.mb_max;
+                if (changed)
+                        ret = resctrl_schemata_mba_set(schmt, id,
+                                                       &entry->u.mba);
+                break;
+        }
+        case PQOS_TECHNOLOGY_SMBA: {
+                struct pqos_mba cur;
+
+                ret = resctrl_schemata_smba_get(schmt, id, &cur);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+
+                changed = cur.mb_max != entry->u.mba.mb_max;
+                if (changed)
+                        ret =
+                            resctrl_schemata_smba_set(schmt, id, &entry->u.mba);
+                break;
+        }
+        default:
+                return PQOS_RETVAL_PARAM;
+        }
+
+        if (ret == PQOS_RETVAL_OK && changed)
+                *technology |= entry->technology;
+
+        return ret;
+}
+
+/**
+ * @brief Writes staged definitions of single class of service
+ *
+ * Schemata is read and written once. Lines of technologies
+ * with no modified resource are not written.
+ *
+ * @param [in] txn allocation transaction
+ * @param [in] class_id class of service
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_alloc_txn_commit_cos(const struct pqos_alloc_txn *txn,
+                        const unsigned class_id)
+{
+        int ret;
+        unsigned i;
+        unsigned technology = 0;
+        struct resctrl_schemata *schmt;
+        const struct pqos_cap *cap = _pqos_get_cap();
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+
+        schmt = resctrl_schemata_alloc(cap, cpu);
+        if (schmt == NULL)
+                return PQOS_RETVAL_ERROR;
+
+        ret = resctrl_alloc_schemata_read(class_id, schmt);
+
+        for (i = 0; i < txn->num_entries && ret == PQOS_RETVAL_OK; i++)
+                if (txn->entries[i].class_id == class_id)
+                        ret = os_alloc_txn_apply(schmt, &txn->entries[i],
+                                                 &technology);
+
+        if (ret == PQOS_RETVAL_OK && technology != 0)
+                ret = resctrl_alloc_schemata_write(class_id, technology, schmt);
+        else if (ret == PQOS_RETVAL_OK)
+                LOG_DEBUG("COS%u schemata unchanged\n", class_id);
+
+        resctrl_schemata_free(schmt);
+
+        return ret;
+}
+
+int
+os_alloc_txn_commit(struct pqos_alloc_txn *txn)
+{
+        int ret;
+        unsigned i;
+        unsigned *classes;
+        unsigned num_classes = 0;
+
+        ASSERT(txn != NULL);
+
+        if (txn->num_entries == 0)
+                return PQOS_RETVAL_OK;
+
+        /**
+         * Validate all definitions before any schemata is modified
+         */
+        for (i = 0; i < txn->num_entries; i++) {
+                ret = os_alloc_txn_prepare(&txn->entries[i]);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+        }
+
+        classes = alloc_txn_classes(txn, &num_classes);
+        if (classes == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        ret = resctrl_lock_exclusive();
+        if (ret != PQOS_RETVAL_OK)
+                goto os_alloc_txn_commit_exit;
+
+        for (i = 0; i < num_classes; i++) {
+                if (os_alloc_txn_commit_cos(txn, classes[i]) ==
+                    PQOS_RETVAL_OK)
+                        continue;
+
+                LOG_ERROR("Failed to configure COS%u\n", classes[i]);
+                ret = alloc_txn_failed_add(txn, classes[i]);
+                if (ret == PQOS_RETVAL_OK)
+                        ret = PQOS_RETVAL_ERROR;
+        }
+
+        resctrl_lock_release();
+
+os_alloc_txn_commit_exit:
+        free(classes);
+
+        return ret;
+}
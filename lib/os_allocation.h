@@ -456,6 +456,19 @@ PQOS_LOCAL int os_alloc_assoc_set_pid(const pid_t task,
  */
 PQOS_LOCAL int os_alloc_assoc_get_pid(const pid_t task, unsigned *class_id);
 
+/**
+ * @brief OS interface to apply staged allocation transaction
+ *
+ * Schemata file of each modified class of service is written once.
+ *
+ * @param [in,out] txn allocation transaction
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_ERROR if some classes of service were not configured
+ */
+PQOS_LOCAL int os_alloc_txn_commit(struct pqos_alloc_txn *txn);
+
 #ifdef __cplusplus
 }
 #endif
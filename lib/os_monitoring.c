@@ -39,8 +39,9 @@
 #include "perf_monitoring.h"
 #include "resctrl.h"
 #include "resctrl_monitoring.h"
+#include "tid_set.h"
 
-#include <dirent.h> /**< scandir() */
+#include <dirent.h> /**< opendir() */
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h> /**< pid_t */
@@ -63,24 +64,6 @@ static const enum pqos_mon_event os_mon_event[] = {
     PQOS_MON_EVENT_CORE_ENERGY,
     PQOS_MON_EVENT_ACTIVITY};
 
-/**
- * @brief Filter directory filenames
- *
- * This function is used by the scandir function
- * to filter hidden (dot) files
- *
- * @param dir dirent structure containing directory info
- *
- * @return if directory entry should be included in scandir() output list
- * @retval 0 means don't include the entry  ("." in our case)
- * @retval 1 means include the entry
- */
-static int
-filter(const struct dirent *dir)
-{
-        return (dir->d_name[0] == '.') ? 0 : 1;
-}
-
 /**
  * @brief This function stops started events
  *
@@ -495,111 +478,6 @@ os_mon_start_cores(const unsigned num_cores,
         return ret;
 }
 
-/**
- * @brief Check if \a tid is in \a tid_map
- *
- * @param[in] tid TID number to search for
- * @param[in] tid_nr length of \a tid_map
- * @param[in] tid_map list of TIDs
- *
- * @retval 1 if found
- */
-static int
-tid_exists(const pid_t tid, const unsigned tid_nr, const pid_t *tid_map)
-{
-        unsigned i;
-
-        if (tid_map == NULL)
-                return 0;
-
-        for (i = 0; i < tid_nr; i++)
-                if (tid_map[i] == tid)
-                        return 1;
-
-        return 0;
-}
-
-/**
- * @brief Add TID to \a tid_map
- *
- * @param[in] tid TID number to add
- * @param[in] tid_nr length of \a tid_map
- * @param[in] tid_map list of TIDs
- *
- * @return Operational status
- * @retval PQOS_RETVAL_OK on success
- */
-static int
-tid_add(const pid_t tid, unsigned *tid_nr, pid_t **tid_map)
-{
-        pid_t *tids;
-
-        if (tid_exists(tid, *tid_nr, *tid_map))
-                return PQOS_RETVAL_OK;
-
-        tids = realloc(*tid_map, sizeof(pid_t) * (*tid_nr + 1));
-        if (tids == NULL) {
-                LOG_ERROR("TID map allocation error!\n");
-                return PQOS_RETVAL_ERROR;
-        }
-
-        tids[*tid_nr] = tid;
-        (*tid_nr)++;
-        *tid_map = tids;
-
-        return PQOS_RETVAL_OK;
-}
-
-/**
- * @brief Find process TID's and add them to the list
- *
- * @param[in] pid peocess id
- * @param[in,out] tid_nr number of tids
- * @param[in,out] tid_map tid mapping
- *
- * @return Operations status
- * @retval PQOS_RETVAL_OK on success
- */
-static int
-tid_find(const pid_t pid, unsigned *tid_nr, pid_t **tid_map)
-{
-        char buf[64];
-        pid_t tid;
-        int num_tasks, i;
-        struct dirent **namelist = NULL;
-        int ret = PQOS_RETVAL_OK;
-
-        snprintf(buf, sizeof(buf) - 1, "/proc/%d/task", (int)pid);
-        num_tasks = scandir(buf, &namelist, filter, NULL);
-        if (num_tasks <= 0) {
-                LOG_ERROR("Failed to read proc tasks!\n");
-                return PQOS_RETVAL_ERROR;
-        }
-
-        /**
-         * Determine if user selected a PID or TID
-         * If TID selected, only monitor events for that task
-         * otherwise monitor all tasks in the process
-         */
-        tid = atoi(namelist[0]->d_name);
-        if (pid != tid)
-                ret = tid_add(pid, tid_nr, tid_map);
-        else
-                for (i = 0; i < num_tasks; i++) {
-                        ret = tid_add((pid_t)atoi(namelist[i]->d_name), tid_nr,
-                                      tid_map);
-                        if (ret != PQOS_RETVAL_OK)
-                                break;
-                }
-
-        for (i = 0; i < num_tasks; i++)
-                free(namelist[i]);
-
-        free(namelist);
-
-        return ret;
-}
-
 /**
  * @brief Verify is PID is correct
  *
@@ -633,6 +511,7 @@ os_mon_start_pids(const unsigned num_pids,
 {
         int ret;
         unsigned i;
+        struct tid_set tids;
         pid_t *tid_map = NULL;
         unsigned tid_nr = 0;
 
@@ -661,8 +540,9 @@ os_mon_start_pids(const unsigned num_pids,
         /**
          * Get TID's for selected tasks
          */
+        tid_set_init(&tids);
         for (i = 0; i < num_pids; i++) {
-                ret = tid_find(pids[i], &tid_nr, &tid_map);
+                ret = tid_set_find(&tids, pids[i]);
                 if (ret != PQOS_RETVAL_OK)
                         goto os_mon_start_pids_exit;
         }
@@ -673,6 +553,8 @@ os_mon_start_pids(const unsigned num_pids,
                 goto os_mon_start_pids_exit;
         }
 
+        tid_map = tid_set_release(&tids, &tid_nr);
+
         group->context = context;
         group->tid_nr = tid_nr;
         group->tid_map = tid_map;
@@ -685,6 +567,7 @@ os_mon_start_pids(const unsigned num_pids,
         ret = os_mon_start_events(group);
 
 os_mon_start_pids_exit:
+        tid_set_fini(&tids);
         if (ret != PQOS_RETVAL_OK && tid_map != NULL) {
                 free(tid_map);
                 group->tid_map = NULL;
@@ -693,87 +576,48 @@ os_mon_start_pids_exit:
         return ret;
 }
 
-int
-os_mon_add_pids(const unsigned num_pids,
-                const pid_t *pids,
-                struct pqos_mon_data *group)
+/**
+ * @brief Starts monitoring of \a tids and appends them to the group
+ *
+ * @param [in,out] group monitoring structure
+ * @param [in] tids TIDs not monitored by the group yet
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_mon_tids_attach(struct pqos_mon_data *group, const struct tid_set *tids)
 {
-        int ret = PQOS_RETVAL_OK;
+        int ret;
         unsigned i;
-        pid_t *tid_map = NULL;
         pid_t *ptr;
-        unsigned tid_nr = 0;
         struct pqos_mon_data added;
         struct pqos_mon_data_internal added_intl;
         struct pqos_mon_perf_ctx *ctx;
-        unsigned num_duplicated = 0;
-
-        ASSERT(group != NULL);
-        ASSERT(num_pids > 0);
-        ASSERT(pids != NULL);
 
         memset(&added, 0, sizeof(added));
         memset(&added_intl, 0, sizeof(added_intl));
         added.intl = &added_intl;
 
-        /**
-         * Check if all PIDs exists
-         */
-        for (i = 0; i < num_pids; i++) {
-                pid_t pid = pids[i];
-
-                if (!os_mon_tid_exists(pid)) {
-                        LOG_ERROR("Task %d does not exist!\n", (int)pid);
-                        return PQOS_RETVAL_PARAM;
-                }
-        }
-
-        /**
-         * Get TID's for added tasks
-         */
-        for (i = 0; i < num_pids; i++) {
-                ret = tid_find(pids[i], &tid_nr, &tid_map);
-                if (ret != PQOS_RETVAL_OK)
-                        goto os_mon_add_pids_exit;
-        }
-
-        /**
-         * Find duplicated tids
-         */
-        for (i = 0; i < tid_nr; i++) {
-                if (tid_exists(tid_map[i], group->tid_nr, group->tid_map)) {
-                        num_duplicated++;
-                        continue;
-                }
-
-                tid_map[i - num_duplicated] = tid_map[i];
-        }
-        tid_nr -= num_duplicated;
-        if (tid_nr == 0) {
-                LOG_INFO("No new TIDs to be added\n");
-                ret = PQOS_RETVAL_OK;
-                goto os_mon_add_pids_exit;
-        }
-
         /**
          * Start monitoring for the new TIDs
          */
-        added.tid_nr = tid_nr;
-        added.tid_map = tid_map;
+        added.tid_nr = tids->num;
+        added.tid_map = tids->tids;
         added.event = group->event;
-        added.num_pids = num_pids;
+        added.num_pids = group->num_pids;
         if (group->intl->resctrl.mon_group != NULL) {
                 added.intl->resctrl.mon_group =
                     strdup(group->intl->resctrl.mon_group);
                 if (added.intl->resctrl.mon_group == NULL) {
                         ret = PQOS_RETVAL_RESOURCE;
-                        goto os_mon_add_pids_exit;
+                        goto os_mon_tids_attach_exit;
                 }
         }
 
         ret = os_mon_start_events(&added);
         if (ret != PQOS_RETVAL_OK)
-                goto os_mon_add_pids_exit;
+                goto os_mon_tids_attach_exit;
 
         /**
          * Update mon group
@@ -782,7 +626,7 @@ os_mon_add_pids(const unsigned num_pids,
                                           (group->tid_nr + added.tid_nr));
         if (ptr == NULL) {
                 ret = PQOS_RETVAL_RESOURCE;
-                goto os_mon_add_pids_exit;
+                goto os_mon_tids_attach_exit;
         }
         group->tid_map = ptr;
 
@@ -791,29 +635,17 @@ os_mon_add_pids(const unsigned num_pids,
                                                (group->tid_nr + added.tid_nr));
         if (ctx == NULL) {
                 ret = PQOS_RETVAL_RESOURCE;
-                goto os_mon_add_pids_exit;
+                goto os_mon_tids_attach_exit;
         }
         group->intl->perf.ctx = ctx;
 
-        ptr = realloc(group->pids,
-                      sizeof(group->pids[0]) * (group->num_pids + num_pids));
-        if (ptr == NULL) {
-                ret = PQOS_RETVAL_RESOURCE;
-                goto os_mon_add_pids_exit;
-        }
-        group->pids = ptr;
-
         for (i = 0; i < added.tid_nr; i++) {
                 group->tid_map[group->tid_nr] = added.tid_map[i];
                 group->intl->perf.ctx[group->tid_nr] = added.intl->perf.ctx[i];
                 group->tid_nr++;
         }
-        for (i = 0; i < num_pids; i++) {
-                group->pids[group->num_pids] = pids[i];
-                group->num_pids++;
-        }
 
-os_mon_add_pids_exit:
+os_mon_tids_attach_exit:
         if (added.intl->resctrl.mon_group != NULL) {
                 free(added.intl->resctrl.mon_group);
                 added.intl->resctrl.mon_group = NULL;
@@ -822,67 +654,54 @@ os_mon_add_pids_exit:
                 LOG_ERROR("Memory allocation error!\n");
                 os_mon_stop_events(&added);
         }
+        if (added.intl->perf.ctx != NULL)
+                free(added.intl->perf.ctx);
 
-        if (tid_map != NULL)
-                free(tid_map);
         return ret;
 }
 
-int
-os_mon_remove_pids(const unsigned num_pids,
-                   const pid_t *pids,
-                   struct pqos_mon_data *group)
+/**
+ * @brief Stops monitoring of \a tids and removes them from the group
+ *
+ * @param [in,out] group monitoring structure
+ * @param [in] tids TIDs to be removed from the group
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_mon_tids_detach(struct pqos_mon_data *group, const struct tid_set *tids)
 {
-
         int ret = PQOS_RETVAL_OK;
         unsigned i;
-        pid_t *keep_tid_map = NULL; /* List of not removed TIDs */
-        unsigned keep_tid_nr = 0;
         struct pqos_mon_data remove;
         struct pqos_mon_data_internal remove_intl;
         unsigned removed;
 
-        ASSERT(num_pids > 0);
-        ASSERT(pids != NULL);
-        ASSERT(group != NULL);
-
         memset(&remove, 0, sizeof(remove));
         memset(&remove_intl, 0, sizeof(remove_intl));
         remove.intl = &remove_intl;
 
-        /**
-         * Find TID's for not removed tasks
-         */
-        for (i = 0; i < group->num_pids; i++) {
-                /* skip PIDs on removed list */
-                if (tid_exists(group->pids[i], num_pids, pids))
-                        continue;
-
-                /* pid no longer exists */
-                if (!os_mon_tid_exists(group->pids[i]))
-                        continue;
-
-                ret = tid_find(group->pids[i], &keep_tid_nr, &keep_tid_map);
-                if (ret != PQOS_RETVAL_OK)
-                        goto os_mon_remove_pids_exit;
-        }
-
         remove.intl->perf.event = group->intl->perf.event;
         remove.intl->resctrl.event = group->intl->resctrl.event;
         remove.pids = NULL;
-        remove.num_pids = num_pids;
+        remove.num_pids = group->num_pids;
         remove.tid_map = malloc(sizeof(remove.tid_map[0]) * group->tid_nr);
-        if (remove.tid_map == NULL)
-                goto os_mon_remove_pids_exit;
+        if (remove.tid_map == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto os_mon_tids_detach_exit;
+        }
         remove.intl->perf.ctx =
             malloc(sizeof(remove.intl->perf.ctx[0]) * group->tid_nr);
-        if (remove.intl->perf.ctx == NULL)
-                goto os_mon_remove_pids_exit;
+        if (remove.intl->perf.ctx == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto os_mon_tids_detach_exit;
+        }
 
         /* Add tid's for removal */
         for (i = 0; i < group->tid_nr; i++) {
                 /* TID is not removed */
-                if (tid_exists(group->tid_map[i], keep_tid_nr, keep_tid_map))
+                if (!tid_set_contains(tids, group->tid_map[i]))
                         continue;
 
                 remove.tid_map[remove.tid_nr] = group->tid_map[i];
@@ -890,17 +709,20 @@ os_mon_remove_pids(const unsigned num_pids,
                 remove.tid_nr++;
         }
 
+        /* keep counts of removed tasks so group values do not drop */
+        if (group->intl->perf.event != 0)
+                perf_mon_retire(group, remove.intl->perf.ctx, remove.tid_nr);
+
         ret = os_mon_stop_events(&remove);
         if (ret != PQOS_RETVAL_OK)
-                goto os_mon_remove_pids_exit;
+                goto os_mon_tids_detach_exit;
 
         /**
          * Update mon group
          */
         removed = 0;
         for (i = 0; i < group->tid_nr; i++) {
-                /* TID does not exists on the not keep list */
-                if (!tid_exists(group->tid_map[i], keep_tid_nr, keep_tid_map)) {
+                if (tid_set_contains(tids, group->tid_map[i])) {
                         removed++;
                         continue;
                 }
@@ -914,9 +736,152 @@ os_mon_remove_pids(const unsigned num_pids,
         group->intl->perf.ctx =
             realloc(group->intl->perf.ctx,
                     sizeof(group->intl->perf.ctx[0]) * group->tid_nr);
+
+os_mon_tids_detach_exit:
+        if (remove.tid_map != NULL)
+                free(remove.tid_map);
+        if (remove.intl->perf.ctx != NULL)
+                free(remove.intl->perf.ctx);
+        return ret;
+}
+
+int
+os_mon_add_pids(const unsigned num_pids,
+                const pid_t *pids,
+                struct pqos_mon_data *group)
+{
+        int ret = PQOS_RETVAL_OK;
+        unsigned i;
+        pid_t *ptr;
+        struct tid_set known;
+        struct tid_set new_tids;
+
+        ASSERT(group != NULL);
+        ASSERT(num_pids > 0);
+        ASSERT(pids != NULL);
+
+        /**
+         * Check if all PIDs exists
+         */
+        for (i = 0; i < num_pids; i++) {
+                pid_t pid = pids[i];
+
+                if (!os_mon_tid_exists(pid)) {
+                        LOG_ERROR("Task %d does not exist!\n", (int)pid);
+                        return PQOS_RETVAL_PARAM;
+                }
+        }
+
+        tid_set_init(&known);
+        tid_set_init(&new_tids);
+
+        /**
+         * Get TID's for added tasks not monitored by the group yet
+         */
+        ret = tid_set_add_array(&known, group->tid_nr, group->tid_map);
+        if (ret == PQOS_RETVAL_OK)
+                ret = tid_set_diff(&known, num_pids, pids, &new_tids, NULL);
+        if (ret != PQOS_RETVAL_OK)
+                goto os_mon_add_pids_exit;
+
+        if (new_tids.num == 0) {
+                LOG_INFO("No new TIDs to be added\n");
+                ret = PQOS_RETVAL_OK;
+                goto os_mon_add_pids_exit;
+        }
+
+        ptr = realloc(group->pids,
+                      sizeof(group->pids[0]) * (group->num_pids + num_pids));
+        if (ptr == NULL) {
+                LOG_ERROR("Memory allocation error!\n");
+                ret = PQOS_RETVAL_RESOURCE;
+                goto os_mon_add_pids_exit;
+        }
+        group->pids = ptr;
+
+        ret = os_mon_tids_attach(group, &new_tids);
+        if (ret != PQOS_RETVAL_OK)
+                goto os_mon_add_pids_exit;
+
+        for (i = 0; i < num_pids; i++) {
+                group->pids[group->num_pids] = pids[i];
+                group->num_pids++;
+        }
+
+os_mon_add_pids_exit:
+        tid_set_fini(&new_tids);
+        tid_set_fini(&known);
+        return ret;
+}
+
+int
+os_mon_remove_pids(const unsigned num_pids,
+                   const pid_t *pids,
+                   struct pqos_mon_data *group)
+{
+
+        int ret = PQOS_RETVAL_OK;
+        unsigned i;
+        struct tid_set removed_pids; /* PIDs on removed list */
+        struct tid_set known;        /* TIDs monitored by the group */
+        struct tid_set vanished;     /* TIDs no longer in kept tasks */
+        pid_t *keep_pids = NULL;
+        unsigned keep_num = 0;
+        unsigned removed;
+
+        ASSERT(num_pids > 0);
+        ASSERT(pids != NULL);
+        ASSERT(group != NULL);
+
+        tid_set_init(&removed_pids);
+        tid_set_init(&known);
+        tid_set_init(&vanished);
+
+        ret = tid_set_add_array(&removed_pids, num_pids, pids);
+        if (ret != PQOS_RETVAL_OK)
+                goto os_mon_remove_pids_exit;
+
+        keep_pids = malloc(sizeof(keep_pids[0]) * (group->num_pids + 1));
+        if (keep_pids == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto os_mon_remove_pids_exit;
+        }
+
+        /**
+         * Find not removed tasks
+         */
+        for (i = 0; i < group->num_pids; i++) {
+                /* skip PIDs on removed list */
+                if (tid_set_contains(&removed_pids, group->pids[i]))
+                        continue;
+
+                /* pid no longer exists */
+                if (!os_mon_tid_exists(group->pids[i]))
+                        continue;
+
+                keep_pids[keep_num++] = group->pids[i];
+        }
+
+        /**
+         * TID's of the group that do not belong to not removed tasks
+         */
+        ret = tid_set_add_array(&known, group->tid_nr, group->tid_map);
+        if (ret == PQOS_RETVAL_OK)
+                ret = tid_set_diff(&known, keep_num, keep_pids, NULL,
+                                   &vanished);
+        if (ret != PQOS_RETVAL_OK)
+                goto os_mon_remove_pids_exit;
+
+        ret = os_mon_tids_detach(group, &vanished);
+        if (ret != PQOS_RETVAL_OK)
+                goto os_mon_remove_pids_exit;
+
+        /**
+         * Update mon group
+         */
         removed = 0;
         for (i = 0; i < group->num_pids; i++) {
-                if (tid_exists(group->pids[i], num_pids, pids)) {
+                if (tid_set_contains(&removed_pids, group->pids[i])) {
                         removed++;
                         continue;
                 }
@@ -928,11 +893,77 @@ os_mon_remove_pids(const unsigned num_pids,
             realloc(group->pids, sizeof(group->pids[0]) * group->num_pids);
 
 os_mon_remove_pids_exit:
-        if (remove.tid_map != NULL)
-                free(remove.tid_map);
-        if (remove.intl->perf.ctx != NULL)
-                free(remove.intl->perf.ctx);
-        if (keep_tid_map != NULL)
-                free(keep_tid_map);
+        if (keep_pids != NULL)
+                free(keep_pids);
+        tid_set_fini(&vanished);
+        tid_set_fini(&known);
+        tid_set_fini(&removed_pids);
+        return ret;
+}
+
+int
+os_mon_track_pids(struct pqos_mon_data *group, const int enable)
+{
+        ASSERT(group != NULL);
+
+        if (group->num_pids == 0 || group->intl == NULL) {
+                LOG_ERROR("Thread tracking requires PID monitoring group\n");
+                return PQOS_RETVAL_PARAM;
+        }
+
+        group->intl->track_pids = enable;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+os_mon_sync_pids(struct pqos_mon_data *group)
+{
+        int ret;
+        struct tid_set known;    /* TIDs monitored by the group */
+        struct tid_set added;    /* threads created since last update */
+        struct tid_set vanished; /* threads exited since last update */
+
+        ASSERT(group != NULL);
+        ASSERT(group->num_pids > 0);
+
+        tid_set_init(&known);
+        tid_set_init(&added);
+        tid_set_init(&vanished);
+
+        ret = tid_set_add_array(&known, group->tid_nr, group->tid_map);
+        if (ret == PQOS_RETVAL_OK)
+                ret = tid_set_diff(&known, group->num_pids, group->pids,
+                                   &added, &vanished);
+        if (ret != PQOS_RETVAL_OK)
+                goto os_mon_sync_pids_exit;
+
+        /**
+         * Keep counters of the last threads of exited tasks,
+         * so the group still reports their final values
+         */
+        if (vanished.num > 0 && vanished.num < group->tid_nr) {
+                LOG_DEBUG("Removing %u exited threads from the group\n",
+                          vanished.num);
+                ret = os_mon_tids_detach(group, &vanished);
+                if (ret != PQOS_RETVAL_OK)
+                        goto os_mon_sync_pids_exit;
+        }
+
+        if (added.num > 0) {
+                LOG_DEBUG("Adding %u new threads to the group\n", added.num);
+                ret = os_mon_tids_attach(group, &added);
+                /* thread may exit before its counters are started */
+                if (ret == PQOS_RETVAL_ERROR) {
+                        LOG_DEBUG("New threads not added, retrying on next "
+                                  "update\n");
+                        ret = PQOS_RETVAL_OK;
+                }
+        }
+
+os_mon_sync_pids_exit:
+        tid_set_fini(&vanished);
+        tid_set_fini(&added);
+        tid_set_fini(&known);
         return ret;
 }
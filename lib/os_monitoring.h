@@ -164,6 +164,31 @@ PQOS_LOCAL int os_mon_remove_pids(const unsigned num_pids,
                                   const pid_t *pids,
                                   struct pqos_mon_data *group);
 
+/**
+ * @brief OS interface to enable following of threads in the monitoring group
+ *
+ * @param [in,out] group a pointer to monitoring structure
+ * @param [in] enable 1 to follow threads of monitored tasks
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int os_mon_track_pids(struct pqos_mon_data *group,
+                                 const int enable);
+
+/**
+ * @brief OS interface to update threads monitored by the group
+ *
+ * Threads created by monitored tasks are added to the group and exited
+ * threads are removed from it.
+ *
+ * @param [in,out] group a pointer to monitoring structure
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int os_mon_sync_pids(struct pqos_mon_data *group);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,7 @@
 #include "types.h"
 
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/syscall.h>
 
 /**
@@ -150,3 +151,160 @@ perf_read_counter(int counter_fd, uint64_t *value)
         LOG_ERROR("Failed to read perf counter!\n");
         return PQOS_RETVAL_ERROR;
 }
+
+int
+perf_read_counter_group(int counter_fd,
+                        const unsigned num,
+                        uint64_t *values,
+                        uint64_t *time_enabled,
+                        uint64_t *time_running)
+{
+        /* nr, time_enabled, time_running, values[nr] */
+        uint64_t buf[3 + PERF_GROUP_MAX];
+        const size_t size = (3 + num) * sizeof(buf[0]);
+        unsigned i;
+
+        if (counter_fd < 0 || num == 0 || num > PERF_GROUP_MAX ||
+            values == NULL || time_enabled == NULL || time_running == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (read(counter_fd, buf, size) != (ssize_t)size || buf[0] != num) {
+                LOG_ERROR("Failed to read perf counter group!\n");
+                return PQOS_RETVAL_ERROR;
+        }
+
+        *time_enabled = buf[1];
+        *time_running = buf[2];
+        for (i = 0; i < num; i++)
+                values[i] = buf[3 + i];
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+perf_mmap_counter(int counter_fd, struct perf_event_mmap_page **page)
+{
+        void *addr;
+
+        if (counter_fd < 0 || page == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        addr = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED,
+                    counter_fd, 0);
+        if (addr == MAP_FAILED) {
+                LOG_DEBUG("Failed to map perf counter page\n");
+                return PQOS_RETVAL_ERROR;
+        }
+        *page = (struct perf_event_mmap_page *)addr;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+perf_munmap_counter(struct perf_event_mmap_page *page)
+{
+        if (page == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (munmap(page, sysconf(_SC_PAGESIZE)) != 0) {
+                LOG_ERROR("Failed to unmap perf counter page\n");
+                return PQOS_RETVAL_ERROR;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t
+perf_rdpmc(const uint32_t counter)
+{
+        uint32_t low, high;
+
+        asm volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(counter));
+
+        return ((uint64_t)high << 32) | low;
+}
+
+static inline uint64_t
+perf_rdtsc(void)
+{
+        uint32_t low, high;
+
+        asm volatile("rdtsc" : "=a"(low), "=d"(high));
+
+        return ((uint64_t)high << 32) | low;
+}
+#endif
+
+int
+perf_rdpmc_counter(const struct perf_event_mmap_page *page,
+                   uint64_t *value,
+                   uint64_t *time_enabled,
+                   uint64_t *time_running)
+{
+#if defined(__x86_64__) || defined(__i386__)
+        volatile const struct perf_event_mmap_page *pc = page;
+        uint64_t count, enabled, running;
+        uint64_t cyc = 0, time_offset = 0;
+        uint32_t time_mult = 0;
+        uint16_t time_shift = 0;
+        uint32_t seq, idx;
+
+        if (page == NULL || value == NULL || time_enabled == NULL ||
+            time_running == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        /* Seqlock protocol described in linux/perf_event.h */
+        do {
+                seq = pc->lock;
+                __sync_synchronize();
+
+                enabled = pc->time_enabled;
+                running = pc->time_running;
+                if (pc->cap_user_time && enabled != running) {
+                        cyc = perf_rdtsc();
+                        time_offset = pc->time_offset;
+                        time_mult = pc->time_mult;
+                        time_shift = pc->time_shift;
+                }
+
+                idx = pc->index;
+                count = pc->offset;
+                if (!pc->cap_user_rdpmc || idx == 0)
+                        return PQOS_RETVAL_RESOURCE;
+
+                {
+                        const unsigned shift = 64 - pc->pmc_width;
+                        int64_t pmc = (int64_t)perf_rdpmc(idx - 1);
+
+                        pmc = (int64_t)((uint64_t)pmc << shift) >> shift;
+                        count += (uint64_t)pmc;
+                }
+
+                __sync_synchronize();
+        } while (pc->lock != seq);
+
+        if (time_mult != 0) {
+                const uint64_t quot = cyc >> time_shift;
+                const uint64_t rem = cyc & (((uint64_t)1 << time_shift) - 1);
+                const uint64_t delta = time_offset + quot * time_mult +
+                                       ((rem * time_mult) >> time_shift);
+
+                enabled += delta;
+                running += delta;
+        }
+
+        *value = count;
+        *time_enabled = enabled;
+        *time_running = running;
+
+        return PQOS_RETVAL_OK;
+#else
+        UNUSED_PARAM(page);
+        UNUSED_PARAM(value);
+        UNUSED_PARAM(time_enabled);
+        UNUSED_PARAM(time_running);
+
+        return PQOS_RETVAL_RESOURCE;
+#endif
+}
@@ -43,6 +43,11 @@ extern "C" {
 #include <stdint.h>
 #include <unistd.h>
 
+/**
+ * Maximum number of events read from perf event group
+ */
+#define PERF_GROUP_MAX 8
+
 /**
  * @brief Function to setup perf event counters
  *
@@ -105,6 +110,69 @@ PQOS_LOCAL int perf_stop_counter(int counter_fd);
  */
 PQOS_LOCAL int perf_read_counter(int counter_fd, uint64_t *value);
 
+/**
+ * @brief Function to read all counters of perf event group
+ *
+ * Group leader has to be opened with PERF_FORMAT_GROUP,
+ * PERF_FORMAT_TOTAL_TIME_ENABLED and PERF_FORMAT_TOTAL_TIME_RUNNING
+ * read format.
+ *
+ * @param counter_fd fd of the group leader
+ * @param num number of events in the group
+ * @param values table to store counter values in group order
+ * @param time_enabled pointer to variable to store time enabled
+ * @param time_running pointer to variable to store time running
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int perf_read_counter_group(int counter_fd,
+                                       const unsigned num,
+                                       uint64_t *values,
+                                       uint64_t *time_enabled,
+                                       uint64_t *time_running);
+
+/**
+ * @brief Function to map perf event page of a counter
+ *
+ * @param counter_fd fd used to access the perf counter
+ * @param page pointer to store mapped perf event page
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int perf_mmap_counter(int counter_fd,
+                                 struct perf_event_mmap_page **page);
+
+/**
+ * @brief Function to unmap perf event page of a counter
+ *
+ * @param page perf event page mapped with perf_mmap_counter
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int perf_munmap_counter(struct perf_event_mmap_page *page);
+
+/**
+ * @brief Function to read a perf counter from user space with rdpmc
+ *
+ * Counter can be read only on the CPU the event is scheduled on.
+ *
+ * @param page perf event page mapped with perf_mmap_counter
+ * @param value pointer to variable to store counter value
+ * @param time_enabled pointer to variable to store time enabled
+ * @param time_running pointer to variable to store time running
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if counter can not be read with rdpmc
+ */
+PQOS_LOCAL int perf_rdpmc_counter(const struct perf_event_mmap_page *page,
+                                  uint64_t *value,
+                                  uint64_t *time_enabled,
+                                  uint64_t *time_running);
+
 #ifdef __cplusplus
 }
 #endif
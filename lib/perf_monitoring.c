@@ -40,6 +40,7 @@
 
 #include <dirent.h> /**< scandir() */
 #include <linux/perf_event.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -64,16 +65,42 @@
 #define PERF_MON_SUPPORT "/proc/sys/kernel/perf_event_paranoid"
 #endif
 
+/**
+ * Events opened as one perf event group per core/task
+ */
+#define PERF_MON_GROUP_EVENTS                                                  \
+        ((enum pqos_mon_event)(PQOS_PERF_EVENT_LLC_MISS |                      \
+                               PQOS_PERF_EVENT_LLC_REF |                       \
+                               PQOS_PERF_EVENT_CYCLES |                        \
+                               PQOS_PERF_EVENT_INSTRUCTIONS))
+
 /**
  * Monitoring event type
  */
 static int os_mon_type = 0;
 
+/**
+ * Read group counters with rdpmc when polled from the monitored core
+ */
+static int perf_mon_rdpmc = 0;
+
 /**
  * All supported events mask
  */
 static enum pqos_mon_event all_evt_mask = (enum pqos_mon_event)0;
 
+/**
+ * Events counted by perf, their values are sums over cores/tasks
+ */
+static const enum pqos_mon_event perf_mon_counters[] = {
+    PQOS_MON_EVENT_LMEM_BW,
+    PQOS_MON_EVENT_TMEM_BW,
+    PQOS_PERF_EVENT_LLC_MISS,
+    PQOS_PERF_EVENT_LLC_REF,
+    (enum pqos_mon_event)PQOS_PERF_EVENT_CYCLES,
+    (enum pqos_mon_event)PQOS_PERF_EVENT_INSTRUCTIONS,
+};
+
 /**
  * Table of structures used to store data about
  * supported monitoring events and their
@@ -442,6 +469,10 @@ perf_mon_init(const struct pqos_cpuinfo *cpu, const struct pqos_cap *cap)
         if (ret != PQOS_RETVAL_OK)
                 return ret;
 
+        perf_mon_rdpmc = getenv("RDT_PERF_RDPMC") != NULL;
+        if (perf_mon_rdpmc)
+                LOG_INFO("Perf counters read with rdpmc on monitored core\n");
+
         /* Set RDT perf attribute type */
         ret = set_mon_type();
         if (ret != PQOS_RETVAL_OK)
@@ -470,6 +501,7 @@ perf_mon_fini(void)
         unsigned i;
 
         all_evt_mask = (enum pqos_mon_event)0;
+        perf_mon_rdpmc = 0;
         for (i = 0; i < DIM(events_tab); ++i)
                 events_tab[i].supported = 0;
 
@@ -499,11 +531,71 @@ perf_mon_get_fd(struct pqos_mon_perf_ctx *ctx, const enum pqos_mon_event event)
         }
 }
 
+/**
+ * @brief Gets storage of final counter values of removed tasks
+ *
+ * @param group monitoring group
+ * @param event monitoring event
+ *
+ * @return pointer to retired value
+ * @retval NULL if event is not a counter e.g. LLC occupancy
+ */
+static uint64_t *
+perf_mon_get_retired(struct pqos_mon_data *group,
+                     const enum pqos_mon_event event)
+{
+        struct pqos_event_values *retired = &group->intl->perf.retired;
+
+        switch (event) {
+        case PQOS_MON_EVENT_LMEM_BW:
+                return &retired->mbm_local;
+        case PQOS_MON_EVENT_TMEM_BW:
+                return &retired->mbm_total;
+        case PQOS_PERF_EVENT_LLC_MISS:
+                return &retired->llc_misses;
+        case PQOS_PERF_EVENT_LLC_REF:
+                return &retired->llc_references;
+        case (enum pqos_mon_event)PQOS_PERF_EVENT_CYCLES:
+                return &retired->ipc_unhalted;
+        case (enum pqos_mon_event)PQOS_PERF_EVENT_INSTRUCTIONS:
+                return &retired->ipc_retired;
+        default:
+                return NULL;
+        }
+}
+
+/**
+ * @brief Gets position of event in perf event group
+ *
+ * @param group monitoring group
+ * @param event monitoring event
+ *
+ * @return index of event in the group
+ * @retval -1 if event is not read as part of the group
+ */
+static int
+perf_mon_grp_idx(const struct pqos_mon_data *group,
+                 const enum pqos_mon_event event)
+{
+        unsigned i;
+
+        if ((group->intl->perf.grp_event & event) == 0)
+                return -1;
+
+        for (i = 0; i < group->intl->perf.grp_num; i++)
+                if (group->intl->perf.grp_evt[i] == event)
+                        return (int)i;
+
+        return -1;
+}
+
 int
 perf_mon_start(struct pqos_mon_data *group, enum pqos_mon_event event)
 {
         int i, num_ctrs;
         struct perf_mon_supported_event *se;
+        struct perf_event_attr attr;
+        int grouped;
 
         ASSERT(group != NULL);
         ASSERT(group->intl != NULL);
@@ -523,6 +615,17 @@ perf_mon_start(struct pqos_mon_data *group, enum pqos_mon_event event)
         if (se == NULL)
                 return PQOS_RETVAL_ERROR;
 
+        /**
+         * Core PMU events are scheduled together and read with one syscall
+         */
+        attr = se->attrs;
+        grouped = (event & PERF_MON_GROUP_EVENTS) != 0 &&
+                  group->intl->perf.grp_num < PERF_MON_GROUP_MAX;
+        if (grouped)
+                attr.read_format = PERF_FORMAT_GROUP |
+                                   PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                   PERF_FORMAT_TOTAL_TIME_RUNNING;
+
         /**
          * For each core/task assign fd to read counter
          */
@@ -532,6 +635,7 @@ perf_mon_start(struct pqos_mon_data *group, enum pqos_mon_event event)
                 int *fd;
                 int core = -1;
                 pid_t tid = -1;
+                int group_fd = -1;
 
                 if (group->num_cores > 0)
                         core = group->cores[i];
@@ -541,17 +645,49 @@ perf_mon_start(struct pqos_mon_data *group, enum pqos_mon_event event)
                 fd = perf_mon_get_fd(ctx, event);
                 if (fd == NULL)
                         return PQOS_RETVAL_ERROR;
+
+                if (grouped && group->intl->perf.grp_num > 0) {
+                        const int *leader_fd =
+                            perf_mon_get_fd(ctx, group->intl->perf.grp_evt[0]);
+
+                        group_fd = *leader_fd;
+                } else if (grouped) {
+                        memset(ctx->grp_raw, 0, sizeof(ctx->grp_raw));
+                        ctx->grp_enabled = 0;
+                        ctx->grp_running = 0;
+                }
+
                 /*
                  * If monitoring cores, pass core list
                  * Otherwise, pass list of TID's
                  */
-                ret = perf_setup_counter(&se->attrs, tid, core, -1, 0, fd);
+                ret = perf_setup_counter(&attr, tid, core, group_fd, 0, fd);
                 if (ret != PQOS_RETVAL_OK) {
                         LOG_ERROR("Failed to start perf "
                                   "counters for %s\n",
                                   se->desc);
                         return PQOS_RETVAL_ERROR;
                 }
+
+                if (grouped) {
+                        const unsigned idx = group->intl->perf.grp_num;
+
+                        ctx->grp_page[idx] = NULL;
+                        if (perf_mon_rdpmc && core >= 0)
+                                (void)perf_mmap_counter(*fd,
+                                                        &ctx->grp_page[idx]);
+                }
+        }
+
+        if (grouped) {
+                const unsigned idx = group->intl->perf.grp_num;
+
+                if (idx == 0)
+                        group->intl->perf.grp_scale = 1.0;
+                group->intl->perf.grp_evt[idx] = event;
+                group->intl->perf.grp_val[idx] = 0;
+                group->intl->perf.grp_num++;
+                group->intl->perf.grp_event |= event;
         }
 
         return PQOS_RETVAL_OK;
@@ -561,6 +697,8 @@ int
 perf_mon_stop(struct pqos_mon_data *group, enum pqos_mon_event event)
 {
         int i, num_ctrs;
+        int idx;
+        enum pqos_mon_event remaining;
 
         ASSERT(group != NULL);
         ASSERT(group->intl != NULL);
@@ -576,8 +714,13 @@ perf_mon_stop(struct pqos_mon_data *group, enum pqos_mon_event event)
         else
                 return PQOS_RETVAL_ERROR;
 
+        idx = perf_mon_grp_idx(group, event);
+        remaining = (enum pqos_mon_event)(group->intl->perf.grp_event & ~event);
+
         /**
-         * For each counter, close associated file descriptor
+         * For each counter, close associated file descriptor.
+         * Group leader is closed together with the last group member,
+         * otherwise remaining members would be detached from the group.
          */
         for (i = 0; i < num_ctrs; i++) {
                 struct pqos_mon_perf_ctx *ctx = &group->intl->perf.ctx[i];
@@ -586,7 +729,32 @@ perf_mon_stop(struct pqos_mon_data *group, enum pqos_mon_event event)
                 if (fd == NULL)
                         return PQOS_RETVAL_ERROR;
 
+                if (idx == 0 && remaining)
+                        continue;
+
+                if (idx >= 0 && ctx->grp_page[idx] != NULL) {
+                        perf_munmap_counter(ctx->grp_page[idx]);
+                        ctx->grp_page[idx] = NULL;
+                }
                 perf_shutdown_counter(*fd);
+
+                if (idx > 0 && !remaining) {
+                        const int *leader_fd =
+                            perf_mon_get_fd(ctx, group->intl->perf.grp_evt[0]);
+
+                        if (ctx->grp_page[0] != NULL) {
+                                perf_munmap_counter(ctx->grp_page[0]);
+                                ctx->grp_page[0] = NULL;
+                        }
+                        perf_shutdown_counter(*leader_fd);
+                }
+        }
+
+        if (idx >= 0) {
+                group->intl->perf.grp_event = remaining;
+                group->intl->perf.grp_pending &= ~event;
+                if (!remaining)
+                        group->intl->perf.grp_num = 0;
         }
 
         return PQOS_RETVAL_OK;
@@ -609,6 +777,165 @@ get_delta(const uint64_t old_value, const uint64_t new_value)
                 return new_value - old_value;
 }
 
+/**
+ * @brief Accumulates perf event group counters read from a core/task
+ *
+ * Counter deltas are scaled for multiplexing and added to group values.
+ *
+ * @param group monitoring group
+ * @param ctx perf poll context of the core/task
+ * @param raw counter values in group order
+ * @param enabled time enabled
+ * @param running time running
+ * @param [out] delta_enabled time enabled since previous read
+ * @param [out] delta_running time running since previous read
+ */
+static void
+perf_mon_grp_update(struct pqos_mon_data *group,
+                    struct pqos_mon_perf_ctx *ctx,
+                    const uint64_t *raw,
+                    uint64_t enabled,
+                    uint64_t running,
+                    uint64_t *delta_enabled,
+                    uint64_t *delta_running)
+{
+        unsigned j;
+
+        /*
+         * rdpmc without cap_user_time reports times of last
+         * schedule in, which may lag behind previous read()
+         */
+        if (enabled < ctx->grp_enabled || running < ctx->grp_running) {
+                enabled = ctx->grp_enabled;
+                running = ctx->grp_running;
+        }
+        *delta_enabled = enabled - ctx->grp_enabled;
+        *delta_running = running - ctx->grp_running;
+
+        for (j = 0; j < group->intl->perf.grp_num; j++) {
+                uint64_t delta = raw[j] - ctx->grp_raw[j];
+
+                if (*delta_running > 0 && *delta_running < *delta_enabled)
+                        delta = (uint64_t)((double)delta *
+                                           (double)*delta_enabled /
+                                           (double)*delta_running);
+
+                group->intl->perf.grp_val[j] += delta;
+                ctx->grp_raw[j] = raw[j];
+        }
+
+        ctx->grp_enabled = enabled;
+        ctx->grp_running = running;
+}
+
+/**
+ * @brief Reads perf event group counters with rdpmc
+ *
+ * @param ctx perf poll context
+ * @param num number of events in the group
+ * @param values table to store counter values in group order
+ * @param time_enabled pointer to variable to store time enabled
+ * @param time_running pointer to variable to store time running
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if group has to be read with read()
+ */
+static int
+perf_mon_rdpmc_group(const struct pqos_mon_perf_ctx *ctx,
+                     const unsigned num,
+                     uint64_t *values,
+                     uint64_t *time_enabled,
+                     uint64_t *time_running)
+{
+        unsigned i;
+
+        for (i = 0; i < num; i++) {
+                uint64_t enabled, running;
+                int ret;
+
+                if (ctx->grp_page[i] == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+
+                ret = perf_rdpmc_counter(ctx->grp_page[i], &values[i],
+                                         &enabled, &running);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+
+                /* group events are scheduled together */
+                if (i == 0) {
+                        *time_enabled = enabled;
+                        *time_running = running;
+                }
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Reads perf event groups of all cores/tasks
+ *
+ * Counter deltas are scaled by time enabled over time running to compensate
+ * for counter multiplexing.
+ *
+ * @param group monitoring group
+ * @param num_ctrs number of cores/tasks
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+perf_mon_poll_group(struct pqos_mon_data *group, const int num_ctrs)
+{
+        const unsigned num = group->intl->perf.grp_num;
+        uint64_t total_enabled = 0;
+        uint64_t total_running = 0;
+        int i;
+
+        for (i = 0; i < num_ctrs; i++) {
+                struct pqos_mon_perf_ctx *ctx = &group->intl->perf.ctx[i];
+                const int *fd =
+                    perf_mon_get_fd(ctx, group->intl->perf.grp_evt[0]);
+                uint64_t raw[PERF_MON_GROUP_MAX];
+                uint64_t enabled, running;
+                uint64_t delta_enabled, delta_running;
+                int ret = PQOS_RETVAL_RESOURCE;
+
+                /*
+                 * rdpmc reads PMU of the current CPU only, so it is used
+                 * when polling thread runs on the monitored core. Thread
+                 * may migrate during the read, values read on another CPU
+                 * are discarded.
+                 */
+                if (perf_mon_rdpmc && group->num_cores > 0 &&
+                    sched_getcpu() == (int)group->cores[i]) {
+                        ret = perf_mon_rdpmc_group(ctx, num, raw, &enabled,
+                                                   &running);
+                        if (ret == PQOS_RETVAL_OK &&
+                            sched_getcpu() != (int)group->cores[i])
+                                ret = PQOS_RETVAL_RESOURCE;
+                }
+                if (ret != PQOS_RETVAL_OK)
+                        ret = perf_read_counter_group(*fd, num, raw, &enabled,
+                                                      &running);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+
+                perf_mon_grp_update(group, ctx, raw, enabled, running,
+                                    &delta_enabled, &delta_running);
+                total_enabled += delta_enabled;
+                total_running += delta_running;
+        }
+
+        if (total_enabled > 0)
+                group->intl->perf.grp_scale =
+                    (double)total_running / (double)total_enabled;
+
+        group->intl->perf.grp_pending = group->intl->perf.grp_event;
+
+        return PQOS_RETVAL_OK;
+}
+
 int
 perf_mon_poll(struct pqos_mon_data *group, enum pqos_mon_event event)
 {
@@ -616,6 +943,7 @@ perf_mon_poll(struct pqos_mon_data *group, enum pqos_mon_event event)
         int i, num_ctrs;
         uint64_t value = 0;
         uint64_t old_value;
+        int idx;
 
         ASSERT(group != NULL);
         ASSERT(group->intl != NULL);
@@ -632,9 +960,30 @@ perf_mon_poll(struct pqos_mon_data *group, enum pqos_mon_event event)
                 return PQOS_RETVAL_ERROR;
 
         /**
-         * For each task read counter and sum of all counter values
+         * Group events are read together by the first of them polled
          */
-        for (i = 0; i < num_ctrs; i++) {
+        idx = perf_mon_grp_idx(group, event);
+        if (idx >= 0) {
+                if ((group->intl->perf.grp_pending & event) == 0) {
+                        ret = perf_mon_poll_group(group, num_ctrs);
+                        if (ret != PQOS_RETVAL_OK)
+                                return ret;
+                }
+                group->intl->perf.grp_pending &= ~event;
+                value = group->intl->perf.grp_val[idx];
+        }
+
+        /**
+         * For each task read counter and sum of all counter values,
+         * including final values of removed tasks
+         */
+        if (idx < 0) {
+                const uint64_t *retired = perf_mon_get_retired(group, event);
+
+                if (retired != NULL)
+                        value = *retired;
+        }
+        for (i = 0; idx < 0 && i < num_ctrs; i++) {
                 struct pqos_mon_perf_ctx *ctx = &group->intl->perf.ctx[i];
                 uint64_t counter_value;
                 int *fd = perf_mon_get_fd(ctx, event);
@@ -698,6 +1047,51 @@ perf_mon_poll(struct pqos_mon_data *group, enum pqos_mon_event event)
         return PQOS_RETVAL_OK;
 }
 
+void
+perf_mon_retire(struct pqos_mon_data *group,
+                struct pqos_mon_perf_ctx *ctx,
+                const unsigned num_ctx)
+{
+        const unsigned num = group->intl->perf.grp_num;
+        unsigned i, j;
+
+        ASSERT(group != NULL);
+        ASSERT(ctx != NULL || num_ctx == 0);
+
+        for (i = 0; i < num_ctx; i++) {
+                for (j = 0; j < DIM(perf_mon_counters); j++) {
+                        const enum pqos_mon_event evt = perf_mon_counters[j];
+                        uint64_t *retired = perf_mon_get_retired(group, evt);
+                        const int *fd = perf_mon_get_fd(&ctx[i], evt);
+                        uint64_t value;
+
+                        if ((group->intl->perf.event & evt) == 0 ||
+                            perf_mon_grp_idx(group, evt) >= 0)
+                                continue;
+
+                        if (perf_read_counter(*fd, &value) == PQOS_RETVAL_OK)
+                                *retired += value;
+                }
+
+                /* group values are accumulated as deltas */
+                if (num > 0) {
+                        const int *fd = perf_mon_get_fd(
+                            &ctx[i], group->intl->perf.grp_evt[0]);
+                        uint64_t raw[PERF_MON_GROUP_MAX];
+                        uint64_t enabled, running;
+                        uint64_t delta_enabled, delta_running;
+
+                        if (perf_read_counter_group(*fd, num, raw, &enabled,
+                                                    &running) ==
+                            PQOS_RETVAL_OK)
+                                perf_mon_grp_update(group, &ctx[i], raw,
+                                                    enabled, running,
+                                                    &delta_enabled,
+                                                    &delta_running);
+                }
+        }
+}
+
 int
 perf_mon_is_event_supported(const enum pqos_mon_event event)
 {
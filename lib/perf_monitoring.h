@@ -43,6 +43,7 @@ extern "C" {
 #endif
 
 #include "pqos.h"
+#include "monitoring.h"
 #include "types.h"
 
 #define PERF_MON_PATH   "/sys/devices/intel_cqm"
@@ -119,6 +120,20 @@ PQOS_LOCAL int perf_mon_stop(struct pqos_mon_data *group,
 PQOS_LOCAL int perf_mon_poll(struct pqos_mon_data *group,
                              const enum pqos_mon_event event);
 
+/**
+ * @brief Keeps final counter values of tasks removed from the group
+ *
+ * Counters of removed tasks are read one last time and accumulated in the
+ * group, so event values of the group do not drop when tasks exit.
+ *
+ * @param [in,out] group monitoring group
+ * @param [in] ctx perf poll contexts of removed tasks
+ * @param [in] num_ctx number of removed tasks
+ */
+PQOS_LOCAL void perf_mon_retire(struct pqos_mon_data *group,
+                                struct pqos_mon_perf_ctx *ctx,
+                                const unsigned num_ctx);
+
 /**
  * @brief Check if event is supported by perf
  *
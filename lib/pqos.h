@@ -240,17 +240,62 @@ struct pqos_config {
  * @retval PQOS_RETVAL_OK on success
  * @note   If you require system wide interface enforcement you can do so by
  *         setting the "RDT_IFACE" environment variable.
+ * @note   Setting the "RDT_PERF_RDPMC" environment variable enables reading
+ *         of perf core counters with rdpmc when monitoring group is polled
+ *         from the monitored core.
+ * @note   Setting the "RDT_SNAPSHOT" environment variable enables snapshot
+ *         of discovered capabilities and CPU topology reused by subsequent
+ *         initializations on unchanged system. Snapshot is stored in /run
+ *         or in the directory given as the variable value (absolute path).
+ * @note   Setting the "RDT_ASSOC_REVALIDATE_MS" environment variable makes
+ *         core association cached by MSR and MMIO interfaces to be read
+ *         again from hardware when older than given number of milliseconds.
+ * @note   Setting the "RDT_MBM_SAMPLER" environment variable makes MSR
+ *         interface sample MBM counters in a background thread often enough
+ *         to not miss counter wrap at maximum socket bandwidth given in GB/s
+ *         as the variable value (1000 GB/s by default). Polled MBM values
+ *         are then accumulated and never overflow.
  */
 int pqos_init(const struct pqos_config *config);
 
 /**
  * @brief Shuts down PQoS module
  *
+ * All monitoring samplers must be stopped with pqos_mon_sampler_stop()
+ * before shutdown.
+ *
  * @return Operations status
  * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_BUSY if a monitoring sampler is running
  */
 int pqos_fini(void);
 
+/**
+ * Resctrl filesystem lock statistics
+ */
+struct pqos_resctrl_lock_stats {
+        uint64_t acquired;    /**< number of lock acquisitions */
+        uint64_t contended;   /**< acquisitions that had to wait */
+        uint64_t wait_us;     /**< total wait time in microseconds */
+        uint64_t max_wait_us; /**< longest wait in microseconds */
+};
+
+/**
+ * @brief Retrieves resctrl filesystem lock statistics
+ *
+ * Statistics are collected by all threads of the process since the library
+ * was loaded and can be read at any time, also before pqos_init().
+ * Wait time includes waiting for other threads and for other processes
+ * holding the lock.
+ *
+ * @param [out] stats lock statistics
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if resctrl is not supported by the OS
+ */
+int pqos_resctrl_lock_stats_get(struct pqos_resctrl_lock_stats *stats);
+
 /*
  * =======================================
  * Query capabilities
@@ -944,6 +989,19 @@ struct pqos_event_values {
         uint64_t llc_references_delta; /**< LLC references - delta */
 };
 
+/**
+ * Timing of counter reads of monitoring group in last poll
+ */
+struct pqos_mon_poll_time {
+        uint64_t begin;     /**< CLOCK_MONOTONIC before counter reads, ns */
+        uint64_t end;       /**< CLOCK_MONOTONIC after counter reads, ns */
+        uint64_t tsc_begin; /**< TSC before counter reads, 0 if unavailable */
+        uint64_t tsc_end;   /**< TSC after counter reads, 0 if unavailable */
+        uint64_t interval;  /**< time elapsed since counter reads of previous
+                                 poll, ns, 0 after first poll */
+        uint64_t latency;   /**< time spent reading counters, ns */
+};
+
 /**
  * The structure to store region aware monitoring data for all of the events
  */
@@ -1202,6 +1260,8 @@ int pqos_mon_start_pids(const unsigned num_pids,
  *
  * @return Operations status
  * @retval PQOS_RETVAL_OK on success
+ *
+ * @see pqos_mon_track_pids() to follow threads created after start
  */
 int pqos_mon_start_pids2(const unsigned num_pids,
                          const pid_t *pids,
@@ -1237,6 +1297,27 @@ int pqos_mon_remove_pids(const unsigned num_pids,
                          const pid_t *pids,
                          struct pqos_mon_data *group);
 
+/**
+ * @brief Enables or disables following of threads in PID monitoring group
+ *
+ * With tracking enabled, threads created by monitored processes after
+ * monitoring has started are added to the group and threads that exited
+ * are removed from it. Task lists are compared on each pqos_mon_poll()
+ * call and membership changes are applied in one batch before counters
+ * are read. Counts of exited threads are kept in the group, so event
+ * values do not drop when threads exit.
+ *
+ * Supported for groups started with pqos_mon_start_pids2() on OS interface.
+ *
+ * @param [in,out] group a pointer to monitoring structure
+ * @param [in] enable 1 to follow threads, 0 to stop following them
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if not supported by selected interface
+ */
+int pqos_mon_track_pids(struct pqos_mon_data *group, const int enable);
+
 /**
  * @brief Starts uncore monitoring of selected \a sockets
  *
@@ -1303,10 +1384,14 @@ int pqos_mon_start_dev(const uint16_t segment,
 /**
  * @brief Stops resource monitoring data for selected monitoring group
  *
+ * Sampler polling the group has to be stopped first with
+ * pqos_mon_sampler_stop().
+ *
  * @param [in] group monitoring context for selected number of cores
  *
  * @return Operations status
  * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_BUSY if the group is polled by a sampler
  */
 int pqos_mon_stop(struct pqos_mon_data *group);
 
@@ -1322,6 +1407,249 @@ int pqos_mon_stop(struct pqos_mon_data *group);
  */
 int pqos_mon_poll(struct pqos_mon_data **groups, const unsigned num_groups);
 
+/**
+ * Maximum number of group members stored in published group data
+ */
+#define PQOS_MON_PUB_MAX_IDS 16
+
+/**
+ * Monitoring group data published by pqos_mon_poll()
+ */
+struct pqos_mon_pub_group {
+        enum pqos_mon_event event; /**< monitored events */
+        unsigned num_cores;        /**< number of cores in the group */
+        unsigned num_pids;         /**< number of pids in the group */
+        unsigned num_channels;     /**< number of channels in the group */
+        /** first cores, pids or channels of the group */
+        uint64_t ids[PQOS_MON_PUB_MAX_IDS];
+        uint64_t timestamp; /**< poll time, CLOCK_REALTIME in ns */
+        uint64_t interval;  /**< time since previous poll in ns */
+        uint64_t polls;     /**< number of polls published */
+        struct pqos_event_values values; /**< RMID events value */
+        /** RMID events' values for memory regions */
+        struct pqos_region_aware_event_values region_values;
+        struct pqos_mon_mem_region regions; /**< memory regions */
+};
+
+/**
+ * @brief Starts publishing of polled monitoring data
+ *
+ * Creates memory mapped file \a path with one cache line aligned slot per
+ * monitoring group. Each following pqos_mon_poll() writes values of
+ * polled groups into their slots. Slots are protected by sequence
+ * counters, so readers never block the publisher. The file is readable
+ * by all users and can be consumed with pqos_mon_pub_open() without
+ * initializing the library. Existing file is replaced.
+ *
+ * @param [in] path file to publish data in, e.g. under /dev/shm
+ * @param [in] max_groups maximum number of published monitoring groups
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_BUSY if publishing is already started
+ */
+int pqos_mon_publish_start(const char *path, const unsigned max_groups);
+
+/**
+ * @brief Stops publishing of polled monitoring data
+ *
+ * The file is left in place with the last published values.
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_mon_publish_stop(void);
+
+/**
+ * Published monitoring data opened for reading
+ */
+struct pqos_mon_pub;
+
+/**
+ * @brief Opens monitoring data published by another process
+ *
+ * Does not require the library to be initialized.
+ *
+ * @param [in] path file monitoring data is published in
+ * @param [out] pub published data handle
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_ERROR if file is not valid published data
+ */
+int pqos_mon_pub_open(const char *path, struct pqos_mon_pub **pub);
+
+/**
+ * @brief Closes published monitoring data
+ *
+ * @param [in] pub published data handle
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_mon_pub_close(struct pqos_mon_pub *pub);
+
+/**
+ * @brief Retrieves number of group slots in published monitoring data
+ *
+ * @param [in] pub published data handle
+ * @param [out] num_slots number of group slots
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_mon_pub_num_slots(const struct pqos_mon_pub *pub,
+                           unsigned *num_slots);
+
+/**
+ * @brief Reads consistent copy of published monitoring group data
+ *
+ * @param [in] pub published data handle
+ * @param [in] slot group slot index
+ * @param [out] group published group data
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_UNAVAILABLE if slot holds no group
+ * @retval PQOS_RETVAL_BUSY if slot kept being updated while reading
+ */
+int pqos_mon_pub_read(const struct pqos_mon_pub *pub,
+                      const unsigned slot,
+                      struct pqos_mon_pub_group *group);
+
+/**
+ * Monitoring group sample taken by background sampler
+ */
+struct pqos_mon_sample {
+        uint64_t seq;       /**< sample sequence number */
+        uint64_t timestamp; /**< poll time, CLOCK_MONOTONIC in ns */
+        int status;         /**< pqos_mon_poll() status */
+        /** timing of counter reads */
+        struct pqos_mon_poll_time poll_time;
+        struct pqos_event_values values; /**< RMID events value */
+        /** RMID events' values for memory regions */
+        struct pqos_region_aware_event_values region_values;
+};
+
+/**
+ * Background sampler configuration
+ */
+struct pqos_mon_sampler_config {
+        unsigned period_us; /**< sampling period in microseconds */
+        unsigned history;   /**< samples kept per group, 0 for default 64,
+                                 rounded up to power of 2 */
+        int lcore;          /**< core to run sampling thread on,
+                                 negative for no pinning */
+        /**
+         * Called from sampling thread after each poll with sequence number
+         * of the new samples. Can be NULL.
+         */
+        void (*callback)(void *context, const uint64_t seq);
+        void *context; /**< passed to \a callback */
+};
+
+/**
+ * Background sampler handle
+ */
+struct pqos_mon_sampler;
+
+/**
+ * @brief Starts background sampling of monitoring groups
+ *
+ * Sampling thread owned by the library polls \a groups every period and
+ * stores timestamped samples in per group rings holding the last
+ * \a history samples. Samples are read with pqos_mon_sampler_read()
+ * from any number of threads without blocking the sampler. New samples
+ * are signalled by eventfd from pqos_mon_sampler_eventfd() and by
+ * configured callback.
+ *
+ * Groups must not be polled by the application until the sampler is
+ * stopped. pqos_mon_stop() fails with PQOS_RETVAL_BUSY for groups being
+ * sampled.
+ *
+ * @param [in] groups table of monitoring group pointers to be sampled
+ * @param [in] num_groups number of monitoring groups in the table
+ * @param [in] cfg sampler configuration
+ * @param [out] sampler sampler handle
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_mon_sampler_start(struct pqos_mon_data **groups,
+                           const unsigned num_groups,
+                           const struct pqos_mon_sampler_config *cfg,
+                           struct pqos_mon_sampler **sampler);
+
+/**
+ * @brief Stops background sampling and releases the sampler
+ *
+ * Must not be called from sampler callback.
+ *
+ * @param [in] sampler sampler handle
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_mon_sampler_stop(struct pqos_mon_sampler *sampler);
+
+/**
+ * @brief Retrieves eventfd signalled after each sampler poll
+ *
+ * The descriptor is non-blocking and becomes readable when new samples
+ * are available. Reading it resets the counter. It is closed by
+ * pqos_mon_sampler_stop().
+ *
+ * @param [in] sampler sampler handle
+ * @param [out] fd event file descriptor
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if not supported by the OS
+ */
+int pqos_mon_sampler_eventfd(const struct pqos_mon_sampler *sampler,
+                             int *fd);
+
+/**
+ * @brief Retrieves sequence number of next sample
+ *
+ * Sequence numbers start from 0 and are shared by all groups of the
+ * sampler. Last \a n samples start at \a seq - \a n.
+ *
+ * @param [in] sampler sampler handle
+ * @param [out] seq sequence number the next sample will get
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_mon_sampler_seq(const struct pqos_mon_sampler *sampler,
+                         uint64_t *seq);
+
+/**
+ * @brief Reads samples of monitoring group
+ *
+ * Reads samples starting from sequence number \a seq. Samples no longer
+ * kept in history are skipped, so \a seq of returned samples may not
+ * follow requested one. Never blocks the sampling thread.
+ *
+ * @param [in] sampler sampler handle
+ * @param [in] group index of monitoring group in table sampler was
+ *             started with
+ * @param [in,out] seq sequence number of first sample to read, updated to
+ *                 sequence number following the last read sample
+ * @param [out] samples table to store samples in
+ * @param [in] max_samples size of \a samples table
+ * @param [out] num_samples number of samples read
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_mon_sampler_read(const struct pqos_mon_sampler *sampler,
+                          const unsigned group,
+                          uint64_t *seq,
+                          struct pqos_mon_sample *samples,
+                          const unsigned max_samples,
+                          unsigned *num_samples);
+
 /*
  * =======================================
  * Allocation Technology
@@ -1349,6 +1677,27 @@ int pqos_alloc_assoc_set(const unsigned lcore, const unsigned class_id);
  */
 int pqos_alloc_assoc_get(const unsigned lcore, unsigned *class_id);
 
+/**
+ * @brief Revalidates cached core association against hardware
+ *
+ * On MSR and MMIO interfaces association of cores with class of service
+ * and RMID is cached by the library and updated on every change it makes.
+ * This re-reads association of all cores and reports cores modified
+ * outside of the library since last check.
+ *
+ * @param [in] max_cores size of \a cores table
+ * @param [out] num_cores number of cores with changed association
+ * @param [out] cores table to store first \a max_cores changed cores,
+ *              can be NULL if \a max_cores is 0
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if not supported by the interface
+ */
+int pqos_assoc_revalidate(const unsigned max_cores,
+                          unsigned *num_cores,
+                          unsigned *cores);
+
 /**
  * @brief OS interface to associate \a task
  *        with given class of service
@@ -1697,6 +2046,124 @@ int pqos_mba_get(const unsigned mba_id,
                  unsigned *num_cos,
                  struct pqos_mba *mba_tab);
 
+/*
+ * =======================================
+ * Allocation transaction
+ * =======================================
+ */
+
+/**
+ * Staged allocation configuration
+ */
+struct pqos_alloc_txn;
+
+/**
+ * @brief Starts new allocation transaction
+ *
+ * L3 CAT, L2 CAT, MBA and SMBA class of service definitions for any
+ * resource ids are staged in the transaction with pqos_alloc_txn_*_set()
+ * and applied together with pqos_alloc_txn_commit(). On OS interface
+ * schemata file of each class of service is written once per commit.
+ *
+ * @param [out] txn new allocation transaction,
+ *              to be released with pqos_alloc_txn_end()
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_alloc_txn_begin(struct pqos_alloc_txn **txn);
+
+/**
+ * @brief Stages L3 cache allocation classes of service
+ *
+ * @param [in,out] txn allocation transaction
+ * @param [in] l3cat_id L3 CAT resource id
+ * @param [in] num_cos number of classes of service at \a ca
+ * @param [in] ca table with class of service definitions
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_alloc_txn_l3ca_set(struct pqos_alloc_txn *txn,
+                            const unsigned l3cat_id,
+                            const unsigned num_cos,
+                            const struct pqos_l3ca *ca);
+
+/**
+ * @brief Stages L2 cache allocation classes of service
+ *
+ * @param [in,out] txn allocation transaction
+ * @param [in] l2id unique L2 cache identifier
+ * @param [in] num_cos number of classes of service at \a ca
+ * @param [in] ca table with class of service definitions
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_alloc_txn_l2ca_set(struct pqos_alloc_txn *txn,
+                            const unsigned l2id,
+                            const unsigned num_cos,
+                            const struct pqos_l2ca *ca);
+
+/**
+ * @brief Stages memory bandwidth allocation classes of service
+ *
+ * Definitions with smba flag set are staged for SMBA.
+ *
+ * @param [in,out] txn allocation transaction
+ * @param [in] mba_id MBA resource id
+ * @param [in] num_cos number of classes of service at \a requested
+ * @param [in] requested table with class of service definitions
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_alloc_txn_mba_set(struct pqos_alloc_txn *txn,
+                           const unsigned mba_id,
+                           const unsigned num_cos,
+                           const struct pqos_mba *requested);
+
+/**
+ * @brief Applies staged class of service definitions
+ *
+ * On OS interface all definitions are validated before any class of
+ * service is modified. Other interfaces apply definitions one by one.
+ * Classes that could not be configured are reported by
+ * pqos_alloc_txn_get_failed(). Transaction can be committed once.
+ *
+ * @param [in,out] txn allocation transaction
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_ERROR if some classes of service were not configured
+ */
+int pqos_alloc_txn_commit(struct pqos_alloc_txn *txn);
+
+/**
+ * @brief Reads classes of service that failed to be configured on commit
+ *
+ * @param [in] txn allocation transaction
+ * @param [in] max_num_cos maximum number of classes to read
+ * @param [out] num_cos number of classes read
+ * @param [out] class_ids table to store class ids
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_alloc_txn_get_failed(const struct pqos_alloc_txn *txn,
+                              const unsigned max_num_cos,
+                              unsigned *num_cos,
+                              unsigned *class_ids);
+
+/**
+ * @brief Releases allocation transaction
+ *
+ * Definitions not committed are discarded.
+ *
+ * @param [in] txn allocation transaction
+ */
+void pqos_alloc_txn_end(struct pqos_alloc_txn *txn);
+
 /*
  * =======================================
  * IO RDT Allocation
@@ -2293,6 +2760,66 @@ int pqos_mon_get_region_value(const struct pqos_mon_data *const group,
  */
 int pqos_mon_get_ipc(const struct pqos_mon_data *const group, double *value);
 
+/*
+ * @brief Retrieves a rate of monitoring event from a group.
+ *
+ * Counter delta of the last poll is divided by the time elapsed between
+ * counter reads of the group in the last two polls. Memory bandwidth is
+ * given in bytes per second, LLC misses and references in events per
+ * second. For PQOS_PERF_EVENT_IPC the IPC value of the same interval is
+ * returned.
+ *
+ * @note Update event values using \a pqos_mon_poll
+ *
+ * @param [in] group monitoring group
+ * @param [in] event_id event being monitored
+ * @param [out] rate event rate
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_UNAVAILABLE if group was not polled twice yet
+ */
+int pqos_mon_get_rate(const struct pqos_mon_data *const group,
+                      const enum pqos_mon_event event_id,
+                      double *rate);
+
+/*
+ * @brief Retrieves timing of counter reads from a monitoring group.
+ *
+ * Timestamps are taken immediately before and after counters of the group
+ * are read in pqos_mon_poll(), so latency shows time spent in the
+ * monitoring interface.
+ *
+ * @param [in] group monitoring group
+ * @param [out] poll_time timing of counter reads in the last poll
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_UNAVAILABLE if group was not polled yet
+ */
+int pqos_mon_get_poll_time(const struct pqos_mon_data *const group,
+                           struct pqos_mon_poll_time *poll_time);
+
+/*
+ * @brief Retrieves perf counter multiplexing scale from a monitoring group.
+ *
+ * Scale is the ratio of time perf counters were running to time they were
+ * enabled over the last poll interval. Values below 1 mean that counters
+ * were multiplexed and IPC, LLC misses and LLC references were
+ * extrapolated.
+ *
+ * @note Update event values using \a pqos_mon_poll
+ *
+ * @param [in] group monitoring group
+ * @param [out] value multiplexing scale, 1.0 if counters were not multiplexed
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if group events are not read using perf
+ */
+int pqos_mon_get_perf_scale(const struct pqos_mon_data *const group,
+                            double *value);
+
 /**
  * @brief Retrieves an AET telemetry floating-point value from a monitoring
  *        group.
@@ -39,75 +39,154 @@
 
 #include <errno.h>
 #include <fcntl.h>
-#include <signal.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
 #include <sys/mount.h>
+#include <time.h>
 #include <unistd.h>
 
-static int resctrl_lock_fd = -1; /**< File descriptor to the lockfile */
+/** Timeout of resctrl file lock acquisition */
+#define RESCTRL_LOCK_TIMEOUT_US 100000
+/** Limits of backoff between file lock attempts */
+#define RESCTRL_LOCK_BACKOFF_MIN_US 10
+#define RESCTRL_LOCK_BACKOFF_MAX_US 10000
 
 /**
- * @brief Handle SIGALRM
+ * Resctrl directory is opened on first lock and kept open until the library
+ * is shut down or resctrl filesystem is remounted.
  */
-static void
-resctrl_lock_signalhandler(int signal)
+static int resctrl_lock_fd = -1;
+
+/**
+ * File lock is held on behalf of all threads of the process, threads are
+ * serialized with the read-write lock.
+ */
+static pthread_rwlock_t resctrl_lock_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_mutex_t resctrl_lock_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned resctrl_lock_holders = 0; /**< threads holding the lock */
+static struct pqos_resctrl_lock_stats resctrl_lock_stats;
+
+/**
+ * @brief Gives current time for lock wait statistics
+ *
+ * @return monotonic time in microseconds
+ */
+static uint64_t
+resctrl_lock_time(void)
 {
-        UNUSED_PARAM(signal);
-        /* File lock timeout */
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
 }
 
 /**
- * @brief Obtain lock on resctrl filesystem
+ * @brief Obtain file lock on resctrl filesystem
+ *
+ * Lock is tried without blocking and retried with exponential backoff
+ * until timeout, so that no signal is needed to interrupt the wait.
  *
  * @param[in] type lock type
+ * @param[in,out] start time the wait started, set on first failed attempt
  *
  * @return Operational status
  * @retval PQOS_RETVAL_OK on success
  */
 static int
-resctrl_lock(const int type)
+resctrl_lock_file(const int type, uint64_t *start)
 {
-        struct sigaction sa;
-        int ret = PQOS_RETVAL_ERROR;
+        unsigned backoff = RESCTRL_LOCK_BACKOFF_MIN_US;
+        unsigned waited = 0;
 
         ASSERT(type == LOCK_SH || type == LOCK_EX);
 
-        resctrl_lock_fd = open(RESCTRL_PATH, O_DIRECTORY);
         if (resctrl_lock_fd < 0) {
-                LOG_ERROR("Could not open %s directory\n", RESCTRL_PATH);
-                return PQOS_RETVAL_ERROR;
+                resctrl_lock_fd = open(RESCTRL_PATH, O_DIRECTORY | O_CLOEXEC);
+                if (resctrl_lock_fd < 0) {
+                        LOG_ERROR("Could not open %s directory\n",
+                                  RESCTRL_PATH);
+                        return PQOS_RETVAL_ERROR;
+                }
         }
 
-        /* Handle SIGALRM */
-        sigaction(SIGALRM, NULL, &sa);
-        sa.sa_handler = resctrl_lock_signalhandler;
-        sa.sa_flags = 0;
-        sigaction(SIGALRM, &sa, NULL);
+        while (flock(resctrl_lock_fd, type | LOCK_NB) != 0) {
+                if (errno != EWOULDBLOCK && errno != EINTR) {
+                        LOG_ERROR("Failed to acquire lock on resctrl "
+                                  "filesystem - %m\n");
+                        return PQOS_RETVAL_ERROR;
+                }
+
+                if (waited >= RESCTRL_LOCK_TIMEOUT_US) {
+                        LOG_ERROR("Failed to acquire lock on resctrl "
+                                  "filesystem - timeout occurred\n");
+                        return PQOS_RETVAL_ERROR;
+                }
 
-        /* Set alarm when 100ms timeout occurs */
-        ualarm(100000, 0);
+                if (*start == 0)
+                        *start = resctrl_lock_time();
 
-        if (flock(resctrl_lock_fd, type) == 0) {
-                ret = PQOS_RETVAL_OK;
-                goto resctrl_lock_exit;
+                usleep(backoff);
+                waited += backoff;
+                backoff *= 2;
+                if (backoff > RESCTRL_LOCK_BACKOFF_MAX_US)
+                        backoff = RESCTRL_LOCK_BACKOFF_MAX_US;
         }
 
-        if (errno == EINTR)
-                LOG_ERROR("Failed to acquire lock on resctrl filesystem - "
-                          "timeout occurred\n");
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Obtain lock on resctrl filesystem
+ *
+ * First thread to get the lock takes the file lock, last one to release
+ * it drops the file lock.
+ *
+ * @param[in] type lock type
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+resctrl_lock(const int type)
+{
+        uint64_t start = 0;
+        int ret = PQOS_RETVAL_OK;
+        int busy;
+
+        if (type == LOCK_SH)
+                busy = pthread_rwlock_tryrdlock(&resctrl_lock_rwlock) != 0;
         else
-                LOG_ERROR("Failed to acquire lock on resctrl filesystem - "
-                          "%m\n");
+                busy = pthread_rwlock_trywrlock(&resctrl_lock_rwlock) != 0;
+        if (busy) {
+                start = resctrl_lock_time();
+                if (type == LOCK_SH)
+                        pthread_rwlock_rdlock(&resctrl_lock_rwlock);
+                else
+                        pthread_rwlock_wrlock(&resctrl_lock_rwlock);
+        }
 
-        close(resctrl_lock_fd);
-        resctrl_lock_fd = -1;
+        pthread_mutex_lock(&resctrl_lock_mutex);
+        if (resctrl_lock_holders == 0)
+                ret = resctrl_lock_file(type, &start);
+        if (ret == PQOS_RETVAL_OK) {
+                resctrl_lock_holders++;
+                resctrl_lock_stats.acquired++;
+        }
+        if (start != 0) {
+                const uint64_t wait = resctrl_lock_time() - start;
 
-resctrl_lock_exit:
-        /* disable alarm */
-        ualarm(0, 0);
-        sa.sa_handler = SIG_DFL;
+                resctrl_lock_stats.contended++;
+                resctrl_lock_stats.wait_us += wait;
+                if (wait > resctrl_lock_stats.max_wait_us)
+                        resctrl_lock_stats.max_wait_us = wait;
+        }
+        pthread_mutex_unlock(&resctrl_lock_mutex);
+
+        if (ret != PQOS_RETVAL_OK)
+                pthread_rwlock_unlock(&resctrl_lock_rwlock);
 
         return ret;
 }
@@ -127,20 +206,67 @@ resctrl_lock_exclusive(void)
 int
 resctrl_lock_release(void)
 {
-        if (resctrl_lock_fd < 0) {
+        pthread_mutex_lock(&resctrl_lock_mutex);
+        if (resctrl_lock_holders == 0 || resctrl_lock_fd < 0) {
+                pthread_mutex_unlock(&resctrl_lock_mutex);
                 LOG_ERROR("Resctrl filesystem not locked\n");
                 return PQOS_RETVAL_ERROR;
         }
 
-        if (flock(resctrl_lock_fd, LOCK_UN) != 0)
+        if (--resctrl_lock_holders == 0 &&
+            flock(resctrl_lock_fd, LOCK_UN) != 0)
                 LOG_WARN("Failed to release lock on resctrl filesystem\n");
+        pthread_mutex_unlock(&resctrl_lock_mutex);
 
-        close(resctrl_lock_fd);
-        resctrl_lock_fd = -1;
+        pthread_rwlock_unlock(&resctrl_lock_rwlock);
 
         return PQOS_RETVAL_OK;
 }
 
+/**
+ * @brief Closes resctrl directory if not locked
+ *
+ * Directory opened before resctrl filesystem is mounted refers to the mount
+ * point and open directory prevents the filesystem from being unmounted.
+ */
+static void
+resctrl_lock_close(void)
+{
+        pthread_mutex_lock(&resctrl_lock_mutex);
+        if (resctrl_lock_holders == 0 && resctrl_lock_fd >= 0) {
+                close(resctrl_lock_fd);
+                resctrl_lock_fd = -1;
+        }
+        pthread_mutex_unlock(&resctrl_lock_mutex);
+}
+
+void
+resctrl_lock_stats_get(struct pqos_resctrl_lock_stats *stats)
+{
+        ASSERT(stats != NULL);
+
+        pthread_mutex_lock(&resctrl_lock_mutex);
+        *stats = resctrl_lock_stats;
+        pthread_mutex_unlock(&resctrl_lock_mutex);
+}
+
+void
+resctrl_lock_fini(void)
+{
+        struct pqos_resctrl_lock_stats stats;
+
+        resctrl_lock_close();
+
+        resctrl_lock_stats_get(&stats);
+        if (stats.contended > 0)
+                LOG_INFO("Resctrl lock waited %llu of %llu times, "
+                         "%llu us in total, %llu us at most\n",
+                         (unsigned long long)stats.contended,
+                         (unsigned long long)stats.acquired,
+                         (unsigned long long)stats.wait_us,
+                         (unsigned long long)stats.max_wait_us);
+}
+
 int
 resctrl_mount(const enum pqos_cdp_config l3_cdp_cfg,
               const enum pqos_cdp_config l2_cdp_cfg,
@@ -177,6 +303,8 @@ resctrl_mount(const enum pqos_cdp_config l3_cdp_cfg,
                 options = buf;
         }
 
+        resctrl_lock_close();
+
         if (mount("resctrl", RESCTRL_PATH, "resctrl", 0, options) != 0) {
                 LOG_DEBUG("resctrl mount failed with error %d - %m\n", errno);
                 return PQOS_RETVAL_ERROR;
@@ -188,6 +316,8 @@ resctrl_mount(const enum pqos_cdp_config l3_cdp_cfg,
 int
 resctrl_umount(void)
 {
+        resctrl_lock_close();
+
         if (umount2(RESCTRL_PATH, 0) != 0) {
                 LOG_ERROR("Could not umount resctrl filesystem!\n");
                 return PQOS_RETVAL_ERROR;
@@ -46,6 +46,7 @@ extern "C" {
 #include "types.h"
 
 #include <limits.h> /**< CHAR_BIT*/
+#include <stdint.h>
 
 #ifndef RESCTRL_PATH
 #define RESCTRL_PATH "/sys/fs/resctrl"
@@ -91,6 +92,18 @@ PQOS_LOCAL int resctrl_lock_exclusive(void);
  */
 PQOS_LOCAL int resctrl_lock_release(void);
 
+/**
+ * @brief Gives resctrl filesystem lock statistics
+ *
+ * @param [out] stats lock statistics
+ */
+PQOS_LOCAL void resctrl_lock_stats_get(struct pqos_resctrl_lock_stats *stats);
+
+/**
+ * @brief Closes resctrl directory used for locking and logs lock statistics
+ */
+PQOS_LOCAL void resctrl_lock_fini(void);
+
 /**
  * @brief Mount the resctrl file system with given CDP option
  *
@@ -42,6 +42,7 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -54,10 +55,20 @@
  * Local data structures
  * ---------------------------------------
  */
+/** Written on init/fini only, under exclusive API lock */
 static int supported_events = 0;
 
+/** Used when mon groups are created, under exclusive resctrl lock */
 static unsigned resctrl_mon_counter = 0;
 
+/**
+ * Generation of mon group directories, bumped on each mkdir/rmdir.
+ * Used to invalidate cached lists of COS holding a mon group.
+ * Polls of different groups restore core association concurrently under
+ * shared locks, so it is accessed with atomics only.
+ */
+static unsigned resctrl_mon_dir_gen = 1;
+
 /**
  * @brief Filter directory filenames
  *
@@ -400,34 +411,30 @@ resctrl_mon_cpumask_read(const unsigned class_id,
 }
 
 /**
- * @brief Read counter value
+ * @brief Obtain path to counter file
  *
  * @param [in] class_id COS id
  * @param [in] resctrl_group mon group name
  * @param [in] l3id l3id to read from
  * @param [in] event resctrl mon event
- * @param [out] value counter value
+ * @param [out] path Buffer to store path
+ * @param [in] path_size buffer size
  *
  * @return Operational status
  * @retval PQOS_RETVAL_OK on success
  */
-PQOS_STATIC int
-resctrl_mon_read_counter(const unsigned class_id,
+static int
+resctrl_mon_counter_path(const unsigned class_id,
                          const char *resctrl_group,
                          const unsigned l3id,
                          const enum pqos_mon_event event,
-                         uint64_t *value)
+                         char *path,
+                         const unsigned path_size)
 {
         char buf[128];
         const char *name;
-        char path[PATH_MAX];
-        FILE *fd;
-        unsigned long long counter;
         int len;
 
-        ASSERT(resctrl_group != NULL);
-        ASSERT(value != NULL);
-
         switch (event) {
         case PQOS_MON_EVENT_L3_OCCUP:
                 name = "llc_occupancy";
@@ -444,15 +451,50 @@ resctrl_mon_read_counter(const unsigned class_id,
                 break;
         }
 
-        *value = 0;
-
         if (resctrl_mon_group_path(class_id, resctrl_group, NULL, buf,
                                    sizeof(buf)) != PQOS_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
-        len = snprintf(path, sizeof(path), "%s/mon_data/mon_L3_%02u/%s", buf,
-                       l3id, name);
-        if (len < 0 || len >= (int)sizeof(path))
+        len = snprintf(path, path_size, "%s/mon_data/mon_L3_%02u/%s", buf, l3id,
+                       name);
+        if (len < 0 || len >= (int)path_size)
                 return PQOS_RETVAL_ERROR;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Read counter value
+ *
+ * @param [in] class_id COS id
+ * @param [in] resctrl_group mon group name
+ * @param [in] l3id l3id to read from
+ * @param [in] event resctrl mon event
+ * @param [out] value counter value
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_STATIC int
+resctrl_mon_read_counter(const unsigned class_id,
+                         const char *resctrl_group,
+                         const unsigned l3id,
+                         const enum pqos_mon_event event,
+                         uint64_t *value)
+{
+        char path[PATH_MAX];
+        FILE *fd;
+        unsigned long long counter;
+        int ret;
+
+        ASSERT(resctrl_group != NULL);
+        ASSERT(value != NULL);
+
+        *value = 0;
+
+        ret = resctrl_mon_counter_path(class_id, resctrl_group, l3id, event,
+                                       path, sizeof(path));
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
         fd = pqos_fopen(path, "r");
         if (fd == NULL)
                 return PQOS_RETVAL_ERROR;
@@ -463,6 +505,187 @@ resctrl_mon_read_counter(const unsigned class_id,
         return PQOS_RETVAL_OK;
 }
 
+/**
+ * @brief Read counter value from open counter file
+ *
+ * File is read from offset 0 so the same descriptor can be reused on
+ * every poll. Counter files reporting "Unavailable" or "Error" give 0.
+ *
+ * @param [in] fd counter file descriptor
+ * @param [out] value counter value
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if file can not be read
+ */
+PQOS_STATIC int
+resctrl_mon_fd_read(const int fd, uint64_t *value)
+{
+        char buf[32];
+        ssize_t len;
+        ssize_t i;
+        uint64_t counter = 0;
+
+        do {
+                len = pread(fd, buf, sizeof(buf), 0);
+        } while (len == -1 && errno == EINTR);
+        if (len <= 0)
+                return PQOS_RETVAL_RESOURCE;
+
+        *value = 0;
+
+        for (i = 0; i < len && buf[i] >= '0' && buf[i] <= '9'; i++) {
+                const unsigned digit = buf[i] - '0';
+
+                if (counter > (UINT64_MAX - 1 - digit) / 10)
+                        return PQOS_RETVAL_OK;
+                counter = counter * 10 + digit;
+        }
+
+        if (i > 0)
+                *value = counter;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Close counter files of the group
+ *
+ * @param [in] group monitoring structure
+ * @param [in] class_id COS id of files to close
+ * @param [in] all close files of all COS ids
+ */
+static void
+resctrl_mon_fd_close(struct pqos_mon_data *group,
+                     const unsigned class_id,
+                     const int all)
+{
+        struct pqos_mon_resctrl_fd *fds = group->intl->resctrl.fds;
+        unsigned num_fds = group->intl->resctrl.num_fds;
+        unsigned i = 0;
+
+        while (i < num_fds) {
+                if (!all && fds[i].class_id != class_id) {
+                        i++;
+                        continue;
+                }
+
+                close(fds[i].fd);
+                fds[i] = fds[--num_fds];
+        }
+
+        group->intl->resctrl.num_fds = num_fds;
+        if (num_fds == 0) {
+                free(fds);
+                group->intl->resctrl.fds = NULL;
+        }
+}
+
+/**
+ * @brief Open counter file and keep it open for next polls
+ *
+ * @param [in] group monitoring structure
+ * @param [in] class_id COS id
+ * @param [in] l3id l3id to read from
+ * @param [in] event resctrl mon event
+ *
+ * @return Counter file entry
+ * @retval NULL on error
+ */
+static struct pqos_mon_resctrl_fd *
+resctrl_mon_fd_open(struct pqos_mon_data *group,
+                    const unsigned class_id,
+                    const unsigned l3id,
+                    const enum pqos_mon_event event)
+{
+        struct pqos_mon_resctrl_fd *fds;
+        char path[PATH_MAX];
+        int fd;
+
+        if (resctrl_mon_counter_path(class_id, group->intl->resctrl.mon_group,
+                                     l3id, event, path,
+                                     sizeof(path)) != PQOS_RETVAL_OK)
+                return NULL;
+
+        fd = pqos_open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+                return NULL;
+
+        fds = realloc(group->intl->resctrl.fds,
+                      (group->intl->resctrl.num_fds + 1) * sizeof(*fds));
+        if (fds == NULL) {
+                close(fd);
+                return NULL;
+        }
+        group->intl->resctrl.fds = fds;
+
+        fds = &fds[group->intl->resctrl.num_fds++];
+        fds->class_id = class_id;
+        fds->l3id = l3id;
+        fds->event = event;
+        fds->fd = fd;
+
+        return fds;
+}
+
+/**
+ * @brief Read group counter value using cached counter file
+ *
+ * Counter file is opened on first read. Descriptor that can no longer be
+ * read, e.g. mon group was removed and created again, is reopened.
+ *
+ * @param [in] group monitoring structure
+ * @param [in] class_id COS id
+ * @param [in] l3id l3id to read from
+ * @param [in] event resctrl mon event
+ * @param [out] value counter value
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+resctrl_mon_read_counter_fd(struct pqos_mon_data *group,
+                            const unsigned class_id,
+                            const unsigned l3id,
+                            const enum pqos_mon_event event,
+                            uint64_t *value)
+{
+        struct pqos_mon_resctrl_fd *entry = NULL;
+        unsigned i;
+        int ret;
+
+        for (i = 0; i < group->intl->resctrl.num_fds; i++) {
+                struct pqos_mon_resctrl_fd *fds = &group->intl->resctrl.fds[i];
+
+                if (fds->class_id == class_id && fds->l3id == l3id &&
+                    fds->event == event) {
+                        entry = fds;
+                        break;
+                }
+        }
+
+        if (entry != NULL) {
+                ret = resctrl_mon_fd_read(entry->fd, value);
+                if (ret == PQOS_RETVAL_OK)
+                        return ret;
+
+                /* stale descriptor */
+                close(entry->fd);
+                group->intl->resctrl.num_fds--;
+                *entry = group->intl->resctrl.fds[group->intl->resctrl.num_fds];
+        }
+
+        entry = resctrl_mon_fd_open(group, class_id, l3id, event);
+        if (entry == NULL)
+                return PQOS_RETVAL_ERROR;
+
+        ret = resctrl_mon_fd_read(entry->fd, value);
+        if (ret != PQOS_RETVAL_OK)
+                return PQOS_RETVAL_ERROR;
+
+        return ret;
+}
+
 /**
  * @brief Build PERF_PKG domain path for a telemetry file
  */
@@ -618,6 +841,58 @@ resctrl_mon_read_exit:
         return ret;
 }
 
+/**
+ * @brief Read group counter value from monitored l3ids
+ *
+ * Counter files are kept open between polls.
+ *
+ * @param [in] group monitoring structure
+ * @param [in] class_id COS id
+ * @param [in] event resctrl monitoring event
+ * @param [out] value counter value
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+resctrl_mon_read_group_counters(struct pqos_mon_data *group,
+                                const unsigned class_id,
+                                const enum pqos_mon_event event,
+                                uint64_t *value)
+{
+        int ret = PQOS_RETVAL_OK;
+        unsigned *l3cat_ids = group->intl->resctrl.l3id;
+        unsigned l3cat_id_num = group->intl->resctrl.num_l3id;
+        unsigned i;
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+
+        ASSERT(value != NULL);
+
+        *value = 0;
+
+        if (l3cat_ids == NULL) {
+                l3cat_ids = pqos_cpu_get_l3cat_ids(cpu, &l3cat_id_num);
+                if (l3cat_ids == NULL)
+                        return PQOS_RETVAL_ERROR;
+        }
+
+        for (i = 0; i < l3cat_id_num; i++) {
+                uint64_t counter;
+
+                ret = resctrl_mon_read_counter_fd(group, class_id, l3cat_ids[i],
+                                                  event, &counter);
+                if (ret != PQOS_RETVAL_OK)
+                        break;
+
+                *value += counter;
+        }
+
+        if (l3cat_ids != group->intl->resctrl.l3id)
+                free(l3cat_ids);
+
+        return ret;
+}
+
 /**
  * @brief Obtain max threshold occupancy
  *
@@ -783,6 +1058,7 @@ resctrl_mon_mkdir(const unsigned class_id, const char *name)
                           path, err, strerror(err));
                 return PQOS_RETVAL_BUSY;
         }
+        __atomic_add_fetch(&resctrl_mon_dir_gen, 1, __ATOMIC_RELEASE);
 
         return PQOS_RETVAL_OK;
 }
@@ -809,6 +1085,7 @@ resctrl_mon_rmdir(const unsigned class_id, const char *name)
 
         if (rmdir(path) == -1 && errno != ENOENT)
                 return PQOS_RETVAL_ERROR;
+        __atomic_add_fetch(&resctrl_mon_dir_gen, 1, __ATOMIC_RELEASE);
 
         return PQOS_RETVAL_OK;
 }
@@ -914,7 +1191,7 @@ resctrl_mon_assoc_set(const unsigned lcore, const char *name)
  * @return Operational status
  * @retval PQOS_RETVAL_OK on success
  */
-static int
+PQOS_STATIC int
 resctrl_mon_assoc_restore(const unsigned lcore, const char *name)
 {
         int ret;
@@ -947,6 +1224,126 @@ resctrl_mon_assoc_restore(const unsigned lcore, const char *name)
         return ret;
 }
 
+/**
+ * @brief Build list of COS ids holding \a group mon group directory
+ *
+ * @param [in] group monitoring group
+ * @param [in] max_cos number of COS
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+resctrl_mon_assoc_cos_scan(struct pqos_mon_data *group, const unsigned max_cos)
+{
+        const char *mon_group = group->intl->resctrl.mon_group;
+        unsigned *assoc_cos = group->intl->resctrl.assoc_cos;
+        /* taken before the scan so that concurrent changes force a rescan */
+        const unsigned gen =
+            __atomic_load_n(&resctrl_mon_dir_gen, __ATOMIC_ACQUIRE);
+        unsigned num = 0;
+        unsigned cos;
+
+        if (assoc_cos == NULL) {
+                assoc_cos = calloc(max_cos, sizeof(*assoc_cos));
+                if (assoc_cos == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+                group->intl->resctrl.assoc_cos = assoc_cos;
+        }
+
+        for (cos = 0; cos < max_cos; cos++) {
+                char path[128];
+                int ret;
+
+                ret = resctrl_mon_group_path(cos, mon_group, NULL, path,
+                                             sizeof(path));
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+                if (pqos_dir_exists(path))
+                        assoc_cos[num++] = cos;
+        }
+
+        group->intl->resctrl.num_assoc_cos = num;
+        group->intl->resctrl.assoc_gen = gen;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Restore association of group cores to monitoring group
+ *
+ * Kernel drops core from the mon group when core COS association changes.
+ * Cores still present in the mon group cpus masks need no further checking,
+ * so the full association scan is done only for cores that went missing.
+ *
+ * @param [in] group monitoring group
+ * @param [in] max_cos number of COS
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_STATIC int
+resctrl_mon_assoc_restore_group(struct pqos_mon_data *group,
+                                const unsigned max_cos)
+{
+        const char *mon_group = group->intl->resctrl.mon_group;
+        struct resctrl_cpumask mask;
+        int rescan = 1;
+        unsigned restored = 0;
+        unsigned i;
+        int ret;
+
+        if (group->num_cores == 0)
+                return PQOS_RETVAL_OK;
+
+resctrl_mon_assoc_restore_group_scan:
+        if (group->intl->resctrl.assoc_cos == NULL ||
+            group->intl->resctrl.assoc_gen !=
+                __atomic_load_n(&resctrl_mon_dir_gen, __ATOMIC_ACQUIRE)) {
+                ret = resctrl_mon_assoc_cos_scan(group, max_cos);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+        }
+
+        memset(&mask, 0, sizeof(mask));
+        for (i = 0; i < group->intl->resctrl.num_assoc_cos; i++) {
+                const unsigned cos = group->intl->resctrl.assoc_cos[i];
+                struct resctrl_cpumask cos_mask;
+                unsigned j;
+
+                ret = resctrl_mon_cpumask_read(cos, mon_group, &cos_mask);
+                if (ret != PQOS_RETVAL_OK) {
+                        /* directory removed behind our back */
+                        if (!rescan)
+                                return ret;
+                        rescan = 0;
+                        group->intl->resctrl.assoc_gen = 0;
+                        goto resctrl_mon_assoc_restore_group_scan;
+                }
+
+                for (j = 0; j < sizeof(mask.tab); j++)
+                        mask.tab[j] |= cos_mask.tab[j];
+        }
+
+        for (i = 0; i < group->num_cores; i++) {
+                const unsigned lcore = group->cores[i];
+
+                if (resctrl_cpumask_get(lcore, &mask))
+                        continue;
+
+                ret = resctrl_mon_assoc_restore(lcore, mon_group);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+                restored++;
+        }
+
+        /* restore may have created mon group under new COS */
+        if (restored > 0)
+                group->intl->resctrl.assoc_gen = 0;
+
+        return PQOS_RETVAL_OK;
+}
+
 int
 resctrl_mon_assoc_get_pid(const pid_t task,
                           char *name,
@@ -1640,6 +2037,8 @@ resctrl_mon_stop(struct pqos_mon_data *group)
 
         ASSERT(group != NULL);
 
+        resctrl_mon_fd_close(group, 0, 1);
+
         ret = resctrl_alloc_get_grps_num(cap, &max_cos);
         if (ret != PQOS_RETVAL_OK)
                 return ret;
@@ -1730,6 +2129,12 @@ resctrl_mon_stop(struct pqos_mon_data *group)
 
         group->intl->resctrl.num_pkgids = 0;
 
+        if (group->intl->resctrl.assoc_cos != NULL) {
+                free(group->intl->resctrl.assoc_cos);
+                group->intl->resctrl.assoc_cos = NULL;
+        }
+        group->intl->resctrl.num_assoc_cos = 0;
+
 resctrl_mon_stop_exit:
         return ret;
 }
@@ -1827,6 +2232,8 @@ resctrl_mon_purge(struct pqos_mon_data *group)
                         group->intl->resctrl.values_storage.mbm_total += value;
                 }
 
+                resctrl_mon_fd_close(group, cos, 0);
+
                 ret = resctrl_mon_rmdir(cos, name);
                 if (ret != PQOS_RETVAL_OK) {
                         LOG_WARN("Failed to remove empty mon group %s: %m\n",
@@ -1860,7 +2267,6 @@ resctrl_mon_poll(struct pqos_mon_data *group, const enum pqos_mon_event event)
         uint64_t value = 0;
         unsigned max_cos;
         unsigned cos;
-        unsigned i;
         uint64_t old_value;
         const struct pqos_cap *cap = _pqos_get_cap();
 
@@ -1874,12 +2280,9 @@ resctrl_mon_poll(struct pqos_mon_data *group, const enum pqos_mon_event event)
          * When core COS assoc changes then kernel resets monitoring group
          * assoc. We need to restore monitoring assoc for cores
          */
-        for (i = 0; i < group->num_cores; i++) {
-                ret = resctrl_mon_assoc_restore(group->cores[i],
-                                                group->intl->resctrl.mon_group);
-                if (ret != PQOS_RETVAL_OK)
-                        goto resctrl_mon_poll_exit;
-        }
+        ret = resctrl_mon_assoc_restore_group(group, max_cos);
+        if (ret != PQOS_RETVAL_OK)
+                goto resctrl_mon_poll_exit;
 
         /* PERF_PKG telemetry events use a different read path */
         if (event == PQOS_MON_EVENT_CORE_ENERGY ||
@@ -1960,10 +2363,7 @@ resctrl_mon_poll(struct pqos_mon_data *group, const enum pqos_mon_event event)
                 if (!pqos_dir_exists(buf))
                         continue;
 
-                ret = resctrl_mon_read_counters(
-                    cos, group->intl->resctrl.mon_group,
-                    group->intl->resctrl.l3id, group->intl->resctrl.num_l3id,
-                    event, &val);
+                ret = resctrl_mon_read_group_counters(group, cos, event, &val);
                 if (ret != PQOS_RETVAL_OK)
                         goto resctrl_mon_poll_exit;
 
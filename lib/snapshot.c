@@ -0,0 +1,655 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "snapshot.h"
+
+#include "cpu_registers.h"
+#include "log.h"
+#include "machine.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SNAPSHOT_MAGIC    "PQOSSNP"
+#define SNAPSHOT_VERSION  2
+#define SNAPSHOT_KEY_SIZE 1024
+#define SNAPSHOT_ALIGN    8
+#define SNAPSHOT_MAX_SIZE (64 * 1024 * 1024)
+
+#define SNAPSHOT_BOOT_ID  "/proc/sys/kernel/random/boot_id"
+#define SNAPSHOT_UCODE    "/sys/devices/system/cpu/cpu0/microcode/version"
+#define SNAPSHOT_ONLINE   "/sys/devices/system/cpu/online"
+#define SNAPSHOT_MOUNTS   "/proc/mounts"
+
+/**
+ * QoS configuration registers recorded in the snapshot
+ */
+enum snapshot_cfg {
+        SNAPSHOT_CFG_L3 = 0, /**< PQOS_MSR_L3_QOS_CFG */
+        SNAPSHOT_CFG_L2,     /**< PQOS_MSR_L2_QOS_CFG */
+        SNAPSHOT_CFG_IO,     /**< PQOS_MSR_L3_IO_QOS_CFG */
+        SNAPSHOT_CFG_NUM
+};
+
+/**
+ * Snapshot file header
+ */
+struct snapshot_header {
+        char magic[8];
+        uint32_t version;     /**< snapshot format version */
+        uint32_t lib_version; /**< PQOS_VERSION */
+        uint32_t size;        /**< size of the snapshot including header */
+        uint32_t checksum;    /**< checksum of data following the header */
+        char key[SNAPSHOT_KEY_SIZE];
+        uint64_t cfg[SNAPSHOT_CFG_NUM]; /**< QoS configuration registers */
+        uint32_t cpu_offset; /**< offset of struct pqos_cpuinfo */
+        uint32_t cpu_size;   /**< size of struct pqos_cpuinfo */
+        uint32_t cap_offset; /**< offset of first capability entry */
+        uint32_t cap_num;    /**< number of capability entries */
+};
+
+/**
+ * Capability entry, followed by capability structure
+ */
+struct snapshot_cap_entry {
+        uint32_t type; /**< enum pqos_cap_type */
+        uint32_t size; /**< size of capability structure */
+};
+
+static char m_path[PATH_MAX];          /**< snapshot file, empty if disabled */
+static char m_key[SNAPSHOT_KEY_SIZE];  /**< key of the running system */
+static void *m_map = NULL;             /**< mapped valid snapshot */
+static size_t m_map_size = 0;          /**< size of the mapping */
+static enum pqos_interface m_interface; /**< interface of the snapshot */
+
+static size_t
+snapshot_align(const size_t size)
+{
+        return (size + SNAPSHOT_ALIGN - 1) & ~((size_t)SNAPSHOT_ALIGN - 1);
+}
+
+/**
+ * @brief FNV-1a checksum
+ */
+static uint32_t
+snapshot_checksum(const uint8_t *data, const size_t size)
+{
+        uint32_t hash = 2166136261u;
+        size_t i;
+
+        for (i = 0; i < size; i++) {
+                hash ^= data[i];
+                hash *= 16777619u;
+        }
+
+        return hash;
+}
+
+/**
+ * @brief Reads first line of \a path into \a buf
+ *
+ * Missing file results in empty string.
+ */
+static void
+snapshot_read_line(const char *path, char *buf, const size_t size)
+{
+        FILE *fd = fopen(path, "r");
+
+        buf[0] = '\0';
+        if (fd == NULL)
+                return;
+
+        if (fgets(buf, (int)size, fd) == NULL)
+                buf[0] = '\0';
+        buf[strcspn(buf, "\n")] = '\0';
+        fclose(fd);
+}
+
+/**
+ * @brief Reads resctrl mount options, empty string if not mounted
+ */
+static void
+snapshot_read_resctrl(char *buf, const size_t size)
+{
+        char line[1024];
+        FILE *fd = fopen(SNAPSHOT_MOUNTS, "r");
+
+        buf[0] = '\0';
+        if (fd == NULL)
+                return;
+
+        while (fgets(line, sizeof(line), fd) != NULL) {
+                char *save = NULL;
+                char *type, *opts;
+
+                if (strtok_r(line, " ", &save) == NULL ||
+                    strtok_r(NULL, " ", &save) == NULL)
+                        continue;
+                type = strtok_r(NULL, " ", &save);
+                opts = strtok_r(NULL, " ", &save);
+                if (type == NULL || opts == NULL ||
+                    strcmp(type, "resctrl") != 0)
+                        continue;
+
+                snprintf(buf, size, "%s", opts);
+                break;
+        }
+
+        fclose(fd);
+}
+
+static const char *
+snapshot_iface_name(const enum pqos_interface interface)
+{
+        switch (interface) {
+        case PQOS_INTER_MSR:
+                return "msr";
+        case PQOS_INTER_OS:
+                return "os";
+        case PQOS_INTER_OS_RESCTRL_MON:
+                return "os-resctrl-mon";
+        case PQOS_INTER_MMIO:
+                return "mmio";
+        default:
+                return NULL;
+        }
+}
+
+/**
+ * @brief Builds key describing the running system
+ */
+static void
+snapshot_build_key(const enum pqos_interface interface)
+{
+        struct cpuid_out leaf1;
+        char ucode[64];
+        char boot_id[64];
+        char online[256];
+        char resctrl[512];
+
+        lcpuid(0x1, 0, &leaf1);
+        snapshot_read_line(SNAPSHOT_UCODE, ucode, sizeof(ucode));
+        snapshot_read_line(SNAPSHOT_BOOT_ID, boot_id, sizeof(boot_id));
+        snapshot_read_line(SNAPSHOT_ONLINE, online, sizeof(online));
+        snapshot_read_resctrl(resctrl, sizeof(resctrl));
+
+        memset(m_key, 0, sizeof(m_key));
+        snprintf(m_key, sizeof(m_key),
+                 "iface=%s cpu=%x ucode=%s boot=%s online=%s resctrl=%s "
+                 "probe_msr=%d",
+                 snapshot_iface_name(interface), leaf1.eax, ucode, boot_id,
+                 online, resctrl, getenv("RDT_PROBE_MSR") != NULL);
+}
+
+/**
+ * @brief Reads QoS configuration registers on the boot CPU
+ *
+ * CDP, L2 CDP and I/O RDT can be toggled by other processes without
+ * changing the key, so enable state is recorded next to it. Registers are
+ * only read when the feature is supported according to \a cap. Resctrl
+ * mount options in the key cover OS interface.
+ *
+ * @param [in] cpu CPU topology
+ * @param [in] cap capabilities
+ * @param [out] cfg register values, 0 when not read
+ */
+static void
+snapshot_read_cfg(const struct pqos_cpuinfo *cpu,
+                  const struct pqos_cap *cap,
+                  uint64_t cfg[SNAPSHOT_CFG_NUM])
+{
+        int l3cdp = 0;
+        int l2cdp = 0;
+        int iordt = 0;
+        unsigned lcore;
+        unsigned i;
+
+        memset(cfg, 0, SNAPSHOT_CFG_NUM * sizeof(cfg[0]));
+
+        if ((m_interface != PQOS_INTER_MSR && m_interface != PQOS_INTER_MMIO) ||
+            cpu->num_cores == 0)
+                return;
+
+        for (i = 0; i < cap->num_cap; i++) {
+                const struct pqos_capability *c = &cap->capabilities[i];
+
+                if (c->type == PQOS_CAP_TYPE_L3CA) {
+                        l3cdp = c->u.l3ca->cdp;
+                        iordt |= c->u.l3ca->iordt;
+                } else if (c->type == PQOS_CAP_TYPE_L2CA)
+                        l2cdp = c->u.l2ca->cdp;
+                else if (c->type == PQOS_CAP_TYPE_MON)
+                        iordt |= c->u.mon->iordt;
+        }
+
+        lcore = cpu->cores[0].lcore;
+        if (l3cdp)
+                msr_read(lcore, PQOS_MSR_L3_QOS_CFG, &cfg[SNAPSHOT_CFG_L3]);
+        if (l2cdp)
+                msr_read(lcore, PQOS_MSR_L2_QOS_CFG, &cfg[SNAPSHOT_CFG_L2]);
+        if (iordt)
+                msr_read(lcore, PQOS_MSR_L3_IO_QOS_CFG, &cfg[SNAPSHOT_CFG_IO]);
+}
+
+/**
+ * @brief Validates mapped snapshot
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK snapshot is valid
+ */
+static int
+snapshot_validate(const uint8_t *data, const size_t size)
+{
+        const struct snapshot_header *hdr =
+            (const struct snapshot_header *)data;
+        const struct pqos_cpuinfo *cpu;
+        size_t offset;
+        uint32_t i;
+
+        if (size < sizeof(*hdr) ||
+            memcmp(hdr->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+            hdr->version != SNAPSHOT_VERSION ||
+            hdr->lib_version != PQOS_VERSION || hdr->size != size)
+                return PQOS_RETVAL_ERROR;
+
+        if (memcmp(hdr->key, m_key, sizeof(m_key)) != 0) {
+                LOG_INFO("Snapshot does not match the system\n");
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        if (snapshot_checksum(data + sizeof(*hdr), size - sizeof(*hdr)) !=
+            hdr->checksum)
+                return PQOS_RETVAL_ERROR;
+
+        /* CPU topology */
+        if (hdr->cpu_offset > size || hdr->cpu_size > size - hdr->cpu_offset ||
+            hdr->cpu_size < sizeof(*cpu) || hdr->cpu_offset % SNAPSHOT_ALIGN)
+                return PQOS_RETVAL_ERROR;
+        cpu = (const struct pqos_cpuinfo *)(data + hdr->cpu_offset);
+        if (hdr->cpu_size != sizeof(*cpu) + (size_t)cpu->num_cores *
+                                                sizeof(cpu->cores[0]))
+                return PQOS_RETVAL_ERROR;
+
+        /* capabilities */
+        offset = hdr->cap_offset;
+        for (i = 0; i < hdr->cap_num; i++) {
+                const struct snapshot_cap_entry *entry;
+                size_t expected;
+
+                if (offset % SNAPSHOT_ALIGN || offset > size ||
+                    size - offset < sizeof(*entry))
+                        return PQOS_RETVAL_ERROR;
+                entry = (const struct snapshot_cap_entry *)(data + offset);
+                offset += sizeof(*entry);
+                if (entry->size > size - offset)
+                        return PQOS_RETVAL_ERROR;
+
+                switch (entry->type) {
+                case PQOS_CAP_TYPE_MON: {
+                        const struct pqos_cap_mon *mon =
+                            (const struct pqos_cap_mon *)(data + offset);
+
+                        if (entry->size < sizeof(*mon))
+                                return PQOS_RETVAL_ERROR;
+                        expected = sizeof(*mon) + (size_t)mon->num_events *
+                                                      sizeof(mon->events[0]);
+                        break;
+                }
+                case PQOS_CAP_TYPE_L3CA:
+                        expected = sizeof(struct pqos_cap_l3ca);
+                        break;
+                case PQOS_CAP_TYPE_L2CA:
+                        expected = sizeof(struct pqos_cap_l2ca);
+                        break;
+                case PQOS_CAP_TYPE_MBA:
+                case PQOS_CAP_TYPE_SMBA:
+                        expected = sizeof(struct pqos_cap_mba);
+                        break;
+                default:
+                        return PQOS_RETVAL_ERROR;
+                }
+                if (entry->size != expected)
+                        return PQOS_RETVAL_ERROR;
+
+                offset += snapshot_align(entry->size);
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+snapshot_open(const enum pqos_interface interface)
+{
+#ifdef __linux__
+        const char *env = getenv("RDT_SNAPSHOT");
+#else
+        const char *env = NULL; /* system key sources are Linux specific */
+#endif
+        const char *name = snapshot_iface_name(interface);
+        const char *dir = SNAPSHOT_DIR;
+        struct stat st;
+        void *map;
+        int fd;
+        int ret;
+
+        snapshot_close();
+        m_path[0] = '\0';
+
+        if (env == NULL || name == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        if (env[0] == '/')
+                dir = env;
+        if (snprintf(m_path, sizeof(m_path), "%s/libpqos-snapshot-%s.bin",
+                     dir, name) >= (int)sizeof(m_path)) {
+                m_path[0] = '\0';
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        m_interface = interface;
+        snapshot_build_key(interface);
+
+        fd = open(m_path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0)
+                return PQOS_RETVAL_RESOURCE;
+
+        /* only trust snapshot owned and writable by us */
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+            st.st_uid != geteuid() || (st.st_mode & (S_IWGRP | S_IWOTH)) ||
+            st.st_size <= 0 || st.st_size > SNAPSHOT_MAX_SIZE) {
+                close(fd);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+                return PQOS_RETVAL_RESOURCE;
+
+        ret = snapshot_validate((const uint8_t *)map, (size_t)st.st_size);
+        if (ret != PQOS_RETVAL_OK) {
+                if (ret == PQOS_RETVAL_ERROR)
+                        LOG_WARN("Invalid snapshot %s\n", m_path);
+                munmap(map, (size_t)st.st_size);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        m_map = map;
+        m_map_size = (size_t)st.st_size;
+        LOG_INFO("Loaded snapshot %s\n", m_path);
+
+        return PQOS_RETVAL_OK;
+}
+
+void
+snapshot_close(void)
+{
+        if (m_map != NULL)
+                munmap(m_map, m_map_size);
+        m_map = NULL;
+        m_map_size = 0;
+}
+
+struct pqos_cpuinfo *
+snapshot_get_cpuinfo(void)
+{
+        const struct snapshot_header *hdr =
+            (const struct snapshot_header *)m_map;
+        struct pqos_cpuinfo *cpu;
+
+        if (m_map == NULL)
+                return NULL;
+
+        cpu = (struct pqos_cpuinfo *)malloc(hdr->cpu_size);
+        if (cpu == NULL)
+                return NULL;
+
+        memcpy(cpu, (const uint8_t *)m_map + hdr->cpu_offset, hdr->cpu_size);
+        cpu->mem_size = hdr->cpu_size;
+
+        return cpu;
+}
+
+int
+snapshot_get_cap(struct pqos_cap **cap)
+{
+        const struct snapshot_header *hdr =
+            (const struct snapshot_header *)m_map;
+        struct pqos_cap *_cap;
+        size_t offset;
+        size_t sz;
+        uint32_t i;
+
+        if (m_map == NULL || cap == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        sz = sizeof(*_cap) + hdr->cap_num * sizeof(_cap->capabilities[0]);
+        _cap = (struct pqos_cap *)calloc(1, sz);
+        if (_cap == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        _cap->mem_size = (unsigned)sz;
+        _cap->version = PQOS_VERSION;
+
+        offset = hdr->cap_offset;
+        for (i = 0; i < hdr->cap_num; i++) {
+                const struct snapshot_cap_entry *entry =
+                    (const struct snapshot_cap_entry *)((const uint8_t *)m_map +
+                                                        offset);
+                struct pqos_capability *c = &_cap->capabilities[i];
+
+                offset += sizeof(*entry);
+                c->type = (enum pqos_cap_type)entry->type;
+                c->u.generic_ptr = malloc(entry->size);
+                if (c->u.generic_ptr == NULL)
+                        break;
+                memcpy(c->u.generic_ptr, (const uint8_t *)m_map + offset,
+                       entry->size);
+                _cap->num_cap++;
+                offset += snapshot_align(entry->size);
+        }
+
+        if (_cap->num_cap != hdr->cap_num) {
+                for (i = 0; i < _cap->num_cap; i++)
+                        free(_cap->capabilities[i].u.generic_ptr);
+                free(_cap);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        *cap = _cap;
+        return PQOS_RETVAL_OK;
+}
+
+int
+snapshot_check_cfg(void)
+{
+        const struct snapshot_header *hdr =
+            (const struct snapshot_header *)m_map;
+        uint64_t cfg[SNAPSHOT_CFG_NUM];
+        struct pqos_cap *cap = NULL;
+        unsigned i;
+        int ret;
+
+        ret = snapshot_get_cap(&cap);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        snapshot_read_cfg(
+            (const struct pqos_cpuinfo *)((const uint8_t *)m_map +
+                                          hdr->cpu_offset),
+            cap, cfg);
+
+        for (i = 0; i < cap->num_cap; i++)
+                free(cap->capabilities[i].u.generic_ptr);
+        free(cap);
+
+        if (memcmp(hdr->cfg, cfg, sizeof(cfg)) != 0) {
+                LOG_INFO("Snapshot does not match QoS configuration\n");
+                snapshot_close();
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Retrieves size of capability structure
+ */
+static size_t
+snapshot_cap_size(const struct pqos_capability *c)
+{
+        switch (c->type) {
+        case PQOS_CAP_TYPE_MON:
+                return sizeof(*c->u.mon) +
+                       c->u.mon->num_events * sizeof(c->u.mon->events[0]);
+        case PQOS_CAP_TYPE_L3CA:
+                return sizeof(*c->u.l3ca);
+        case PQOS_CAP_TYPE_L2CA:
+                return sizeof(*c->u.l2ca);
+        case PQOS_CAP_TYPE_MBA:
+        case PQOS_CAP_TYPE_SMBA:
+                return sizeof(*c->u.mba);
+        default:
+                return 0;
+        }
+}
+
+int
+snapshot_store(const struct pqos_cpuinfo *cpu, const struct pqos_cap *cap)
+{
+        struct snapshot_header *hdr;
+        char tmp_path[PATH_MAX + 8];
+        uint8_t *data;
+        size_t size, offset, cpu_size;
+        unsigned i;
+        int fd;
+        int ret = PQOS_RETVAL_OK;
+
+        if (m_path[0] == '\0' || m_map != NULL)
+                return PQOS_RETVAL_OK;
+
+        if (cpu == NULL || cap == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        cpu_size = sizeof(*cpu) + cpu->num_cores * sizeof(cpu->cores[0]);
+        size = snapshot_align(sizeof(*hdr)) + snapshot_align(cpu_size);
+        for (i = 0; i < cap->num_cap; i++) {
+                const size_t cap_size =
+                    snapshot_cap_size(&cap->capabilities[i]);
+
+                if (cap_size == 0)
+                        return PQOS_RETVAL_PARAM;
+                size += sizeof(struct snapshot_cap_entry) +
+                        snapshot_align(cap_size);
+        }
+
+        data = (uint8_t *)calloc(1, size);
+        if (data == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        hdr = (struct snapshot_header *)data;
+        memcpy(hdr->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        hdr->version = SNAPSHOT_VERSION;
+        hdr->lib_version = PQOS_VERSION;
+        hdr->size = (uint32_t)size;
+        memcpy(hdr->key, m_key, sizeof(m_key));
+        snapshot_read_cfg(cpu, cap, hdr->cfg);
+
+        offset = snapshot_align(sizeof(*hdr));
+        hdr->cpu_offset = (uint32_t)offset;
+        hdr->cpu_size = (uint32_t)cpu_size;
+        memcpy(data + offset, cpu, cpu_size);
+        ((struct pqos_cpuinfo *)(data + offset))->mem_size = (unsigned)cpu_size;
+        offset += snapshot_align(cpu_size);
+
+        hdr->cap_offset = (uint32_t)offset;
+        hdr->cap_num = cap->num_cap;
+        for (i = 0; i < cap->num_cap; i++) {
+                const struct pqos_capability *c = &cap->capabilities[i];
+                struct snapshot_cap_entry *entry =
+                    (struct snapshot_cap_entry *)(data + offset);
+
+                entry->type = (uint32_t)c->type;
+                entry->size = (uint32_t)snapshot_cap_size(c);
+                offset += sizeof(*entry);
+                memcpy(data + offset, c->u.generic_ptr, entry->size);
+                offset += snapshot_align(entry->size);
+        }
+
+        hdr->checksum =
+            snapshot_checksum(data + sizeof(*hdr), size - sizeof(*hdr));
+
+        /* write to temporary file and atomically replace the snapshot */
+        snprintf(tmp_path, sizeof(tmp_path), "%s.%d", m_path, (int)getpid());
+        fd = open(tmp_path,
+                  O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR);
+        if (fd < 0) {
+                LOG_WARN("Unable to create snapshot %s: %s\n", tmp_path,
+                         strerror(errno));
+                free(data);
+                return PQOS_RETVAL_ERROR;
+        }
+
+        if (write(fd, data, size) != (ssize_t)size)
+                ret = PQOS_RETVAL_ERROR;
+        if (close(fd) != 0)
+                ret = PQOS_RETVAL_ERROR;
+        if (ret == PQOS_RETVAL_OK && rename(tmp_path, m_path) != 0)
+                ret = PQOS_RETVAL_ERROR;
+        if (ret != PQOS_RETVAL_OK) {
+                LOG_WARN("Unable to write snapshot %s\n", m_path);
+                unlink(tmp_path);
+        } else
+                LOG_INFO("Stored snapshot %s\n", m_path);
+
+        free(data);
+        return ret;
+}
+
+void
+snapshot_invalidate(void)
+{
+        if (m_path[0] == '\0')
+                return;
+
+        if (unlink(m_path) == 0)
+                LOG_INFO("Removed snapshot %s\n", m_path);
+}
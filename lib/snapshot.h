@@ -0,0 +1,138 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Persistent capability and topology snapshot
+ *
+ * Opt-in cache of discovered capabilities and CPU topology. The snapshot
+ * is a single file written atomically and mapped on load. It is only used
+ * if its key matches the running system: library version, interface, CPU
+ * signature, microcode revision, kernel boot id, online CPUs and resctrl
+ * mount options. On MSR and MMIO interfaces CDP, L2 CDP and I/O RDT enable
+ * state read from the boot CPU has to match as well.
+ */
+
+#ifndef __PQOS_SNAPSHOT_H__
+#define __PQOS_SNAPSHOT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pqos.h"
+#include "types.h"
+
+/**
+ * Default snapshot directory
+ */
+#define SNAPSHOT_DIR "/run"
+
+/**
+ * @brief Opens snapshot for the interface
+ *
+ * Snapshot is enabled by "RDT_SNAPSHOT" environment variable. If its value
+ * is an absolute path then it is used as snapshot directory, otherwise
+ * SNAPSHOT_DIR is used.
+ *
+ * @param [in] interface selected interface
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK valid snapshot loaded
+ * @retval PQOS_RETVAL_RESOURCE snapshot disabled, missing or stale
+ */
+PQOS_LOCAL int snapshot_open(const enum pqos_interface interface);
+
+/**
+ * @brief Releases snapshot loaded by snapshot_open()
+ */
+PQOS_LOCAL void snapshot_close(void);
+
+/**
+ * @brief Retrieves copy of CPU topology from loaded snapshot
+ *
+ * @return CPU topology structure to be released with free()
+ * @retval NULL snapshot not loaded or on error
+ */
+PQOS_LOCAL struct pqos_cpuinfo *snapshot_get_cpuinfo(void);
+
+/**
+ * @brief Retrieves copy of capabilities from loaded snapshot
+ *
+ * @param [out] cap capability structure, each capability and the structure
+ *              itself are to be released with free()
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE snapshot not loaded
+ */
+PQOS_LOCAL int snapshot_get_cap(struct pqos_cap **cap);
+
+/**
+ * @brief Checks QoS configuration recorded in loaded snapshot
+ *
+ * Compares CDP, L2 CDP and I/O RDT enable state of the running system with
+ * the snapshot and releases the snapshot on mismatch. Has to be called
+ * after machine_init() and before snapshot_get_cap().
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK snapshot matches the configuration
+ * @retval PQOS_RETVAL_RESOURCE snapshot not loaded or released
+ */
+PQOS_LOCAL int snapshot_check_cfg(void);
+
+/**
+ * @brief Writes snapshot of capabilities and CPU topology
+ *
+ * Does nothing if snapshot is disabled or was loaded by snapshot_open().
+ *
+ * @param [in] cpu CPU topology structure
+ * @param [in] cap capability structure
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int snapshot_store(const struct pqos_cpuinfo *cpu,
+                              const struct pqos_cap *cap);
+
+/**
+ * @brief Removes snapshot file
+ *
+ * Called whenever library changes state reported by capabilities
+ * e.g. CDP or MBA CTRL.
+ */
+PQOS_LOCAL void snapshot_invalidate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_SNAPSHOT_H__ */
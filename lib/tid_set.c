@@ -0,0 +1,345 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tid_set.h"
+
+#include "log.h"
+#include "pqos.h"
+
+#include <dirent.h> /**< scandir() */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Minimal hash table size (log2)
+ */
+#define TID_SET_MIN_BITS 4
+
+/**
+ * @brief Hashes task id into table of 2^bits slots
+ *
+ * @param [in] tid task id
+ * @param [in] bits log2 of hash table size
+ *
+ * @return slot number
+ */
+static unsigned
+tid_hash(const pid_t tid, const unsigned bits)
+{
+        return (unsigned)(((uint32_t)tid * UINT32_C(2654435761)) >>
+                          (32 - bits));
+}
+
+/**
+ * @brief Finds slot of \a tid or first empty slot on its probe sequence
+ *
+ * @param [in] set TID set
+ * @param [in] tid task id
+ *
+ * @return slot number
+ */
+static unsigned
+tid_slot(const struct tid_set *set, const pid_t tid)
+{
+        const unsigned mask = (1U << set->bits) - 1;
+        unsigned slot = tid_hash(tid, set->bits);
+
+        while (set->slots[slot] != 0 && set->tids[set->slots[slot] - 1] != tid)
+                slot = (slot + 1) & mask;
+
+        return slot;
+}
+
+/**
+ * @brief Resizes hash table to 2^bits slots
+ *
+ * @param [in,out] set TID set
+ * @param [in] bits log2 of new hash table size
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+tid_set_rehash(struct tid_set *set, const unsigned bits)
+{
+        unsigned *slots;
+        unsigned i;
+
+        slots = calloc(1U << bits, sizeof(slots[0]));
+        if (slots == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        free(set->slots);
+        set->slots = slots;
+        set->bits = bits;
+
+        for (i = 0; i < set->num; i++)
+                set->slots[tid_slot(set, set->tids[i])] = i + 1;
+
+        return PQOS_RETVAL_OK;
+}
+
+void
+tid_set_init(struct tid_set *set)
+{
+        ASSERT(set != NULL);
+
+        memset(set, 0, sizeof(*set));
+}
+
+void
+tid_set_fini(struct tid_set *set)
+{
+        ASSERT(set != NULL);
+
+        free(set->tids);
+        free(set->slots);
+        memset(set, 0, sizeof(*set));
+}
+
+int
+tid_set_contains(const struct tid_set *set, const pid_t tid)
+{
+        ASSERT(set != NULL);
+
+        if (set->num == 0)
+                return 0;
+
+        return set->slots[tid_slot(set, tid)] != 0;
+}
+
+int
+tid_set_add(struct tid_set *set, const pid_t tid)
+{
+        unsigned slot;
+        int ret;
+
+        ASSERT(set != NULL);
+
+        if (tid_set_contains(set, tid))
+                return PQOS_RETVAL_OK;
+
+        if (set->num == set->max) {
+                unsigned max = set->max == 0 ? 16 : set->max * 2;
+                pid_t *tids = realloc(set->tids, sizeof(tids[0]) * max);
+
+                if (tids == NULL) {
+                        LOG_ERROR("TID map allocation error!\n");
+                        return PQOS_RETVAL_RESOURCE;
+                }
+                set->tids = tids;
+                set->max = max;
+        }
+
+        /* keep load factor below 1/2 */
+        if (set->slots == NULL || (set->num + 1) * 2 > (1U << set->bits)) {
+                unsigned bits = set->bits < TID_SET_MIN_BITS ? TID_SET_MIN_BITS
+                                                             : set->bits + 1;
+
+                ret = tid_set_rehash(set, bits);
+                if (ret != PQOS_RETVAL_OK) {
+                        LOG_ERROR("TID map allocation error!\n");
+                        return ret;
+                }
+        }
+
+        slot = tid_slot(set, tid);
+        set->tids[set->num++] = tid;
+        set->slots[slot] = set->num;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+tid_set_add_array(struct tid_set *set, const unsigned num, const pid_t *tids)
+{
+        unsigned i;
+
+        ASSERT(set != NULL);
+        ASSERT(tids != NULL || num == 0);
+
+        for (i = 0; i < num; i++) {
+                int ret = tid_set_add(set, tids[i]);
+
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Filter directory filenames
+ *
+ * This function is used by the scandir function
+ * to filter hidden (dot) files
+ *
+ * @param dir dirent structure containing directory info
+ *
+ * @return if directory entry should be included in scandir() output list
+ * @retval 0 means don't include the entry  ("." in our case)
+ * @retval 1 means include the entry
+ */
+static int
+filter(const struct dirent *dir)
+{
+        return (dir->d_name[0] == '.') ? 0 : 1;
+}
+
+/**
+ * @brief Adds TIDs of the task to the set
+ *
+ * @param [in,out] set TID set
+ * @param [in] pid task id
+ * @param [in] missing_ok do not report error if task does not exist
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+tid_set_scan(struct tid_set *set, const pid_t pid, const int missing_ok)
+{
+        char buf[64];
+        pid_t tid;
+        int num_tasks, i;
+        struct dirent **namelist = NULL;
+        int ret = PQOS_RETVAL_OK;
+
+        snprintf(buf, sizeof(buf) - 1, "/proc/%d/task", (int)pid);
+        num_tasks = scandir(buf, &namelist, filter, NULL);
+        if (num_tasks <= 0) {
+                if (missing_ok)
+                        return PQOS_RETVAL_OK;
+                LOG_ERROR("Failed to read proc tasks!\n");
+                return PQOS_RETVAL_ERROR;
+        }
+
+        /**
+         * Determine if user selected a PID or TID
+         * If TID selected, only monitor events for that task
+         * otherwise monitor all tasks in the process
+         */
+        tid = atoi(namelist[0]->d_name);
+        if (pid != tid)
+                ret = tid_set_add(set, pid);
+        else
+                for (i = 0; i < num_tasks; i++) {
+                        tid = (pid_t)atoi(namelist[i]->d_name);
+                        ret = tid_set_add(set, tid);
+                        if (ret != PQOS_RETVAL_OK)
+                                break;
+                }
+
+        for (i = 0; i < num_tasks; i++)
+                free(namelist[i]);
+
+        free(namelist);
+
+        return ret;
+}
+
+int
+tid_set_find(struct tid_set *set, const pid_t pid)
+{
+        ASSERT(set != NULL);
+
+        return tid_set_scan(set, pid, 0);
+}
+
+int
+tid_set_diff(const struct tid_set *known,
+             const unsigned num_pids,
+             const pid_t *pids,
+             struct tid_set *added,
+             struct tid_set *vanished)
+{
+        struct tid_set current;
+        unsigned i;
+        int ret = PQOS_RETVAL_OK;
+
+        ASSERT(known != NULL);
+        ASSERT(pids != NULL || num_pids == 0);
+
+        tid_set_init(&current);
+
+        for (i = 0; i < num_pids; i++) {
+                ret = tid_set_scan(&current, pids[i], 1);
+                if (ret != PQOS_RETVAL_OK)
+                        goto tid_set_diff_exit;
+        }
+
+        if (added != NULL)
+                for (i = 0; i < current.num; i++) {
+                        if (tid_set_contains(known, current.tids[i]))
+                                continue;
+                        ret = tid_set_add(added, current.tids[i]);
+                        if (ret != PQOS_RETVAL_OK)
+                                goto tid_set_diff_exit;
+                }
+
+        if (vanished != NULL)
+                for (i = 0; i < known->num; i++) {
+                        if (tid_set_contains(&current, known->tids[i]))
+                                continue;
+                        ret = tid_set_add(vanished, known->tids[i]);
+                        if (ret != PQOS_RETVAL_OK)
+                                goto tid_set_diff_exit;
+                }
+
+tid_set_diff_exit:
+        tid_set_fini(&current);
+
+        return ret;
+}
+
+pid_t *
+tid_set_release(struct tid_set *set, unsigned *num)
+{
+        pid_t *tids;
+
+        ASSERT(set != NULL);
+        ASSERT(num != NULL);
+
+        tids = set->tids;
+        *num = set->num;
+        if (set->num == 0) {
+                free(tids);
+                tids = NULL;
+        }
+
+        set->tids = NULL;
+        tid_set_fini(set);
+
+        return tids;
+}
@@ -0,0 +1,164 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Set of task ids used by PID monitoring
+ *
+ * TIDs are kept in insertion order and indexed by an open addressing
+ * hash table, so that membership checks and insertions take constant
+ * amortized time.
+ */
+
+#ifndef __PQOS_TID_SET_H__
+#define __PQOS_TID_SET_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "types.h"
+
+#include <sys/types.h>
+
+/**
+ * Set of task ids
+ */
+struct tid_set {
+        unsigned num;    /**< number of TIDs in the set */
+        unsigned max;    /**< capacity of \a tids */
+        pid_t *tids;     /**< TIDs in order of insertion */
+        unsigned bits;   /**< log2 of hash table size */
+        unsigned *slots; /**< hash table of \a tids indexes + 1 */
+};
+
+/**
+ * @brief Initializes empty TID set
+ *
+ * @param [out] set TID set
+ */
+PQOS_LOCAL void tid_set_init(struct tid_set *set);
+
+/**
+ * @brief Releases memory used by TID set
+ *
+ * @param [in,out] set TID set
+ */
+PQOS_LOCAL void tid_set_fini(struct tid_set *set);
+
+/**
+ * @brief Checks if \a tid is in the set
+ *
+ * @param [in] set TID set
+ * @param [in] tid task id
+ *
+ * @retval 1 if found
+ */
+PQOS_LOCAL int tid_set_contains(const struct tid_set *set, const pid_t tid);
+
+/**
+ * @brief Adds \a tid to the set
+ *
+ * @param [in,out] set TID set
+ * @param [in] tid task id
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success, also when \a tid already in the set
+ * @retval PQOS_RETVAL_RESOURCE on memory allocation error
+ */
+PQOS_LOCAL int tid_set_add(struct tid_set *set, const pid_t tid);
+
+/**
+ * @brief Adds table of TIDs to the set
+ *
+ * @param [in,out] set TID set
+ * @param [in] num number of TIDs in \a tids
+ * @param [in] tids table of TIDs
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int
+tid_set_add_array(struct tid_set *set, const unsigned num, const pid_t *tids);
+
+/**
+ * @brief Adds TIDs of the task to the set
+ *
+ * If \a pid is a thread group leader all its threads are added,
+ * otherwise only \a pid is added.
+ *
+ * @param [in,out] set TID set
+ * @param [in] pid task id
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_ERROR task list could not be read
+ */
+PQOS_LOCAL int tid_set_find(struct tid_set *set, const pid_t pid);
+
+/**
+ * @brief Compares current TIDs of tasks with \a known set
+ *
+ * Task directories of \a pids are read once. Tasks that no longer exist
+ * contribute no TIDs.
+ *
+ * @param [in] known set of already tracked TIDs
+ * @param [in] num_pids number of tasks in \a pids
+ * @param [in] pids tasks to read TIDs for
+ * @param [out] added place to store TIDs not in \a known, may be NULL
+ * @param [out] vanished place to store TIDs of \a known that are gone,
+ *              may be NULL
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int tid_set_diff(const struct tid_set *known,
+                            const unsigned num_pids,
+                            const pid_t *pids,
+                            struct tid_set *added,
+                            struct tid_set *vanished);
+
+/**
+ * @brief Takes over table of TIDs and releases the set
+ *
+ * @param [in,out] set TID set
+ * @param [out] num place to store number of TIDs
+ *
+ * @return Table of TIDs to be freed by the caller
+ * @retval NULL if set is empty
+ */
+PQOS_LOCAL pid_t *tid_set_release(struct tid_set *set, unsigned *num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_TID_SET_H__ */
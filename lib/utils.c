@@ -44,32 +44,399 @@
 #include "cpuinfo.h"
 #include "pqos.h"
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define TOPO_OBJ_SOCKET     0
-#define TOPO_OBJ_L2_CLUSTER 2
-#define TOPO_OBJ_L3_CLUSTER 3
+/**
+ * Object ids up to this value are resolved through a direct map
+ */
+#define TOPO_MAP_MAX 65536
+
+/**
+ * Marks unused direct map entry
+ */
+#define TOPO_NONE UINT_MAX
+
+/**
+ * Logical cores grouped by topology object.
+ * Cores of the object at position n of \a ids are stored in
+ * cores[offset[n]] .. cores[offset[n + 1] - 1].
+ */
+struct topo_list {
+        unsigned num_ids;  /**< number of distinct object ids */
+        unsigned *ids;     /**< object ids, in order of first appearance */
+        unsigned *offset;  /**< num_ids + 1 offsets into \a cores */
+        unsigned *cores;   /**< logical cores grouped by object */
+        unsigned map_size; /**< number of entries in \a map */
+        unsigned *map;     /**< object id to position in \a ids */
+};
+
+/**
+ * Topology index built once at initialization time
+ */
+struct topo_index {
+        const struct pqos_cpuinfo *cpu;     /**< indexed topology */
+        unsigned num_lcores;                /**< entries in \a lcore */
+        const struct pqos_coreinfo **lcore; /**< lcore to core info map */
+        struct topo_list obj[TOPO_OBJ_NUM]; /**< cores per object type */
+};
+
+/**
+ * Index of the library's own CPU topology
+ */
+static struct topo_index *m_topo = NULL;
+
+/**
+ * @brief Retrieves topology object id of the core
+ *
+ * @param [in] core core information
+ * @param [in] type topology object type
+ *
+ * @return Topology object id
+ */
+static unsigned
+topo_obj_id(const struct pqos_coreinfo *core, const enum pqos_topo_obj type)
+{
+        switch (type) {
+        case TOPO_OBJ_SOCKET:
+                return core->socket;
+        case TOPO_OBJ_NUMA:
+                return core->numa;
+        case TOPO_OBJ_L2_CLUSTER:
+                return core->l2_id;
+        case TOPO_OBJ_L3_CLUSTER:
+                return core->l3_id;
+        case TOPO_OBJ_L3CAT:
+                return core->l3cat_id;
+        case TOPO_OBJ_MBA:
+                return core->mba_id;
+        case TOPO_OBJ_SMBA:
+        default:
+                return core->smba_id;
+        }
+}
+
+/**
+ * @brief Finds position of the object on the list
+ *
+ * @param [in] list topology object list
+ * @param [in] id topology object id
+ *
+ * @return Position of the object
+ * @retval TOPO_NONE object not found
+ */
+static unsigned
+topo_list_find(const struct topo_list *list, const unsigned id)
+{
+        unsigned i;
+
+        if (list->map != NULL) {
+                if (id >= list->map_size)
+                        return TOPO_NONE;
+                return list->map[id];
+        }
+
+        for (i = 0; i < list->num_ids; i++)
+                if (list->ids[i] == id)
+                        return i;
+
+        return TOPO_NONE;
+}
+
+static void
+topo_list_free(struct topo_list *list)
+{
+        free(list->ids);
+        free(list->offset);
+        free(list->cores);
+        free(list->map);
+        memset(list, 0, sizeof(*list));
+}
+
+/**
+ * @brief Groups cores of the topology by object type
+ *
+ * @param [in] cpu CPU topology
+ * @param [in] type topology object type
+ * @param [out] list topology object list
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+topo_list_build(const struct pqos_cpuinfo *cpu,
+                const enum pqos_topo_obj type,
+                struct topo_list *list)
+{
+        unsigned *fill = NULL;
+        unsigned max_id = 0;
+        unsigned i;
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                unsigned id = topo_obj_id(&cpu->cores[i], type);
+
+                if (id > max_id)
+                        max_id = id;
+        }
+
+        list->ids = malloc(sizeof(list->ids[0]) * cpu->num_cores);
+        list->offset = calloc(cpu->num_cores + 1, sizeof(list->offset[0]));
+        list->cores = malloc(sizeof(list->cores[0]) * cpu->num_cores);
+        if (max_id < TOPO_MAP_MAX) {
+                list->map_size = max_id + 1;
+                list->map = malloc(sizeof(list->map[0]) * list->map_size);
+        }
+        if (list->ids == NULL || list->offset == NULL || list->cores == NULL ||
+            (list->map_size > 0 && list->map == NULL))
+                goto topo_list_error;
+
+        for (i = 0; i < list->map_size; i++)
+                list->map[i] = TOPO_NONE;
+
+        /* count cores per object */
+        for (i = 0; i < cpu->num_cores; i++) {
+                unsigned id = topo_obj_id(&cpu->cores[i], type);
+                unsigned pos = topo_list_find(list, id);
+
+                if (pos == TOPO_NONE) {
+                        pos = list->num_ids++;
+                        list->ids[pos] = id;
+                        if (list->map != NULL)
+                                list->map[id] = pos;
+                }
+                list->offset[pos + 1]++;
+        }
+
+        for (i = 0; i < list->num_ids; i++)
+                list->offset[i + 1] += list->offset[i];
+
+        /* place cores, keeping topology order within the object */
+        fill = malloc(sizeof(fill[0]) * (list->num_ids + 1));
+        if (fill == NULL)
+                goto topo_list_error;
+        memcpy(fill, list->offset, sizeof(fill[0]) * (list->num_ids + 1));
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                unsigned id = topo_obj_id(&cpu->cores[i], type);
+                unsigned pos = topo_list_find(list, id);
+
+                list->cores[fill[pos]++] = cpu->cores[i].lcore;
+        }
+
+        free(fill);
+        return PQOS_RETVAL_OK;
+
+topo_list_error:
+        topo_list_free(list);
+        return PQOS_RETVAL_RESOURCE;
+}
+
+/**
+ * @brief Retrieves index built for the topology
+ *
+ * @param [in] cpu CPU topology
+ *
+ * @return Topology index
+ * @retval NULL topology is not indexed
+ */
+static const struct topo_index *
+topo_get(const struct pqos_cpuinfo *cpu)
+{
+        if (m_topo != NULL && m_topo->cpu == cpu)
+                return m_topo;
+
+        return NULL;
+}
+
+/**
+ * @brief Returns allocated copy of the object ids
+ *
+ * @param [in] list topology object list
+ * @param [out] count place to put number of objects
+ *
+ * @return Allocated object id array
+ * @retval NULL on error
+ */
+static unsigned *
+topo_copy_ids(const struct topo_list *list, unsigned *count)
+{
+        unsigned *ids;
+
+        ids = (unsigned *)malloc(sizeof(ids[0]) * list->num_ids);
+        if (ids == NULL)
+                return NULL;
+
+        memcpy(ids, list->ids, sizeof(ids[0]) * list->num_ids);
+
+        *count = list->num_ids;
+        return ids;
+}
+
+/**
+ * @brief Retrieves first core of the object
+ *
+ * @param [in] list topology object list
+ * @param [in] id topology object id
+ * @param [out] lcore place to store core id
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+topo_get_one(const struct topo_list *list, const unsigned id, unsigned *lcore)
+{
+        unsigned pos = topo_list_find(list, id);
+
+        if (pos == TOPO_NONE)
+                return PQOS_RETVAL_ERROR;
+
+        *lcore = list->cores[list->offset[pos]];
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Retrieves core information using the index
+ *
+ * @param [in] topo topology index
+ * @param [in] lcore logical core id
+ *
+ * @return Core information
+ * @retval NULL core not found
+ */
+static const struct pqos_coreinfo *
+topo_core_info(const struct topo_index *topo, const unsigned lcore)
+{
+        if (lcore >= topo->num_lcores)
+                return NULL;
+
+        return topo->lcore[lcore];
+}
 
 int
-_pqos_utils_init(int interface)
+_pqos_utils_init(int interface, const struct pqos_cpuinfo *cpu)
 {
+        struct topo_index *topo;
+        unsigned max_lcore = 0;
+        unsigned i;
+        int ret = PQOS_RETVAL_OK;
+
         UNUSED_PARAM(interface);
 
+        if (cpu == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        _pqos_utils_fini();
+
+        topo = calloc(1, sizeof(*topo));
+        if (topo == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        topo->cpu = cpu;
+
+        for (i = 0; i < cpu->num_cores; i++)
+                if (cpu->cores[i].lcore > max_lcore)
+                        max_lcore = cpu->cores[i].lcore;
+
+        topo->num_lcores = max_lcore + 1;
+        topo->lcore = calloc(topo->num_lcores, sizeof(topo->lcore[0]));
+        if (topo->lcore == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto utils_init_exit;
+        }
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                const struct pqos_coreinfo *core = &cpu->cores[i];
+
+                /* keep first entry in case of duplicates */
+                if (topo->lcore[core->lcore] == NULL)
+                        topo->lcore[core->lcore] = core;
+        }
+
+        for (i = 0; i < TOPO_OBJ_NUM && ret == PQOS_RETVAL_OK; i++)
+                ret = topo_list_build(cpu, (enum pqos_topo_obj)i,
+                                      &topo->obj[i]);
+
+utils_init_exit:
+        if (ret != PQOS_RETVAL_OK) {
+                for (i = 0; i < TOPO_OBJ_NUM; i++)
+                        topo_list_free(&topo->obj[i]);
+                free(topo->lcore);
+                free(topo);
+                return ret;
+        }
+
+        m_topo = topo;
         return PQOS_RETVAL_OK;
 }
 
+void
+_pqos_utils_fini(void)
+{
+        unsigned i;
+
+        if (m_topo == NULL)
+                return;
+
+        for (i = 0; i < TOPO_OBJ_NUM; i++)
+                topo_list_free(&m_topo->obj[i]);
+        free(m_topo->lcore);
+        free(m_topo);
+        m_topo = NULL;
+}
+
+const unsigned *
+pqos_cpu_get_ids_span(const struct pqos_cpuinfo *cpu,
+                      const enum pqos_topo_obj type,
+                      unsigned *count)
+{
+        const struct topo_index *topo = topo_get(cpu);
+
+        if (topo == NULL || count == NULL || type >= TOPO_OBJ_NUM)
+                return NULL;
+
+        *count = topo->obj[type].num_ids;
+        return topo->obj[type].ids;
+}
+
+const unsigned *
+pqos_cpu_get_cores_span(const struct pqos_cpuinfo *cpu,
+                        const enum pqos_topo_obj type,
+                        const unsigned id,
+                        unsigned *count)
+{
+        const struct topo_index *topo = topo_get(cpu);
+        const struct topo_list *list;
+        unsigned pos;
+
+        if (topo == NULL || count == NULL || type >= TOPO_OBJ_NUM)
+                return NULL;
+
+        list = &topo->obj[type];
+        pos = topo_list_find(list, id);
+        if (pos == TOPO_NONE)
+                return NULL;
+
+        *count = list->offset[pos + 1] - list->offset[pos];
+        return &list->cores[list->offset[pos]];
+}
+
 unsigned *
 pqos_cpu_get_mba_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
 {
         unsigned mba_id_count = 0, i = 0;
         unsigned *mba_ids = NULL;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(count != NULL);
         if (cpu == NULL || count == NULL)
                 return NULL;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_copy_ids(&topo->obj[TOPO_OBJ_MBA], count);
+
         mba_ids = (unsigned *)malloc(sizeof(mba_ids[0]) * cpu->num_cores);
         if (mba_ids == NULL)
                 return NULL;
@@ -101,12 +468,17 @@ pqos_cpu_get_smba_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
 {
         unsigned smba_id_count = 0, i = 0;
         unsigned *smba_ids = NULL;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(count != NULL);
         if (cpu == NULL || count == NULL)
                 return NULL;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_copy_ids(&topo->obj[TOPO_OBJ_SMBA], count);
+
         smba_ids = (unsigned *)malloc(sizeof(smba_ids[0]) * cpu->num_cores);
         if (smba_ids == NULL)
                 return NULL;
@@ -138,12 +510,17 @@ pqos_cpu_get_l3cat_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
 {
         unsigned l3cat_count = 0, i = 0;
         unsigned *l3cat_ids = NULL;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(count != NULL);
         if (cpu == NULL || count == NULL)
                 return NULL;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_copy_ids(&topo->obj[TOPO_OBJ_L3CAT], count);
+
         l3cat_ids = (unsigned *)malloc(sizeof(l3cat_ids[0]) * cpu->num_cores);
         if (l3cat_ids == NULL)
                 return NULL;
@@ -175,12 +552,17 @@ pqos_cpu_get_sockets(const struct pqos_cpuinfo *cpu, unsigned *count)
 {
         unsigned scount = 0, i = 0;
         unsigned *sockets = NULL;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(count != NULL);
         if (cpu == NULL || count == NULL)
                 return NULL;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_copy_ids(&topo->obj[TOPO_OBJ_SOCKET], count);
+
         sockets = (unsigned *)malloc(sizeof(sockets[0]) * cpu->num_cores);
         if (sockets == NULL)
                 return NULL;
@@ -212,9 +594,14 @@ pqos_cpu_get_numa(const struct pqos_cpuinfo *cpu, unsigned *count)
 {
         unsigned ncount = 0, i = 0;
         unsigned *numa = NULL;
+        const struct topo_index *topo;
 
         if (cpu == NULL || count == NULL)
                 return NULL;
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_copy_ids(&topo->obj[TOPO_OBJ_NUMA], count);
+
         numa = (unsigned *)malloc(sizeof(numa[0]) * cpu->num_cores);
         if (numa == NULL)
                 return NULL;
@@ -244,12 +631,17 @@ pqos_cpu_get_l2ids(const struct pqos_cpuinfo *cpu, unsigned *count)
 {
         unsigned l2count = 0, i = 0;
         unsigned *l2ids = NULL;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(count != NULL);
         if (cpu == NULL || count == NULL)
                 return NULL;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_copy_ids(&topo->obj[TOPO_OBJ_L2_CLUSTER], count);
+
         l2ids = (unsigned *)malloc(sizeof(l2ids[0]) * cpu->num_cores);
         if (l2ids == NULL)
                 return NULL;
@@ -281,12 +673,17 @@ pqos_cpu_get_l3_clusters(const struct pqos_cpuinfo *cpu, unsigned *count)
 {
         unsigned l3c_count = 0, i = 0;
         unsigned *l3_clusters = NULL;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(count != NULL);
         if (cpu == NULL || count == NULL)
                 return NULL;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_copy_ids(&topo->obj[TOPO_OBJ_L3_CLUSTER], count);
+
         l3_clusters =
             (unsigned *)malloc(sizeof(l3_clusters[0]) * cpu->num_cores);
 
@@ -320,9 +717,6 @@ pqos_cpu_get_l3_clusters(const struct pqos_cpuinfo *cpu, unsigned *count)
  *
  * @param [in] cpu CPU topology
  * @param [in] type CPU topology object type to search cores for
- *             TOPO_OBJ_SOCKET - sockets
- *             TOPO_OBJ_L2_CLUSTER - L2 cache clusters
- *             TOPO_OBJ_L3_CLUSTER - L3 cache clusters
  * @param [in] id CPU topology object ID to search cores for
  * @param [out] count place to put number of objects found
  *
@@ -331,28 +725,40 @@ pqos_cpu_get_l3_clusters(const struct pqos_cpuinfo *cpu, unsigned *count)
  */
 static unsigned *
 __get_cores_per_topology_obj(const struct pqos_cpuinfo *cpu,
-                             const int type,
+                             const enum pqos_topo_obj type,
                              const unsigned id,
                              unsigned *count)
 {
         unsigned num = 0, i = 0;
         unsigned *core_list = NULL;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(count != NULL);
         if (cpu == NULL || count == NULL)
                 return NULL;
 
+        topo = topo_get(cpu);
+        if (topo != NULL) {
+                const unsigned *span =
+                    pqos_cpu_get_cores_span(cpu, type, id, &num);
+
+                if (span == NULL || num == 0)
+                        return NULL;
+                core_list = (unsigned *)malloc(num * sizeof(core_list[0]));
+                if (core_list == NULL)
+                        return NULL;
+                memcpy(core_list, span, num * sizeof(core_list[0]));
+                *count = num;
+                return core_list;
+        }
+
         core_list = (unsigned *)malloc(cpu->num_cores * sizeof(core_list[0]));
         if (core_list == NULL)
                 return NULL;
 
         for (i = 0; i < cpu->num_cores; i++)
-                if ((type == TOPO_OBJ_L3_CLUSTER &&
-                     id == cpu->cores[i].l3_id) ||
-                    (type == TOPO_OBJ_L2_CLUSTER &&
-                     id == cpu->cores[i].l2_id) ||
-                    (type == TOPO_OBJ_SOCKET && id == cpu->cores[i].socket))
+                if (topo_obj_id(&cpu->cores[i], type) == id)
                         core_list[num++] = cpu->cores[i].lcore;
 
         if (num == 0) {
@@ -386,12 +792,17 @@ const struct pqos_coreinfo *
 pqos_cpu_get_core_info(const struct pqos_cpuinfo *cpu, unsigned lcore)
 {
         unsigned i;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
 
         if (cpu == NULL)
                 return NULL;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_core_info(topo, lcore);
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].lcore == lcore)
                         return &cpu->cores[i];
@@ -405,6 +816,7 @@ pqos_cpu_get_one_core(const struct pqos_cpuinfo *cpu,
                       unsigned *lcore)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(lcore != NULL);
@@ -412,6 +824,10 @@ pqos_cpu_get_one_core(const struct pqos_cpuinfo *cpu,
         if (cpu == NULL || lcore == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_get_one(&topo->obj[TOPO_OBJ_SOCKET], socket, lcore);
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].socket == socket) {
                         *lcore = cpu->cores[i].lcore;
@@ -427,6 +843,7 @@ pqos_cpu_get_one_by_numaid(const struct pqos_cpuinfo *cpu,
                            unsigned *lcore)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(lcore != NULL);
@@ -434,6 +851,10 @@ pqos_cpu_get_one_by_numaid(const struct pqos_cpuinfo *cpu,
         if (cpu == NULL || lcore == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_get_one(&topo->obj[TOPO_OBJ_NUMA], numaid, lcore);
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].numa == numaid) {
                         *lcore = cpu->cores[i].lcore;
@@ -449,6 +870,7 @@ pqos_cpu_get_one_by_l3cat_id(const struct pqos_cpuinfo *cpu,
                              unsigned *lcore)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(lcore != NULL);
@@ -456,6 +878,11 @@ pqos_cpu_get_one_by_l3cat_id(const struct pqos_cpuinfo *cpu,
         if (cpu == NULL || lcore == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_get_one(&topo->obj[TOPO_OBJ_L3CAT],
+                                    l3cat_id, lcore);
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].l3cat_id == l3cat_id) {
                         *lcore = cpu->cores[i].lcore;
@@ -471,6 +898,7 @@ pqos_cpu_get_one_by_mba_id(const struct pqos_cpuinfo *cpu,
                            unsigned *lcore)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(lcore != NULL);
@@ -478,6 +906,10 @@ pqos_cpu_get_one_by_mba_id(const struct pqos_cpuinfo *cpu,
         if (cpu == NULL || lcore == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_get_one(&topo->obj[TOPO_OBJ_MBA], mba_id, lcore);
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].mba_id == mba_id) {
                         *lcore = cpu->cores[i].lcore;
@@ -493,6 +925,7 @@ pqos_cpu_get_one_by_smba_id(const struct pqos_cpuinfo *cpu,
                             unsigned *lcore)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(lcore != NULL);
@@ -500,6 +933,10 @@ pqos_cpu_get_one_by_smba_id(const struct pqos_cpuinfo *cpu,
         if (cpu == NULL || lcore == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_get_one(&topo->obj[TOPO_OBJ_SMBA], smba_id, lcore);
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].smba_id == smba_id) {
                         *lcore = cpu->cores[i].lcore;
@@ -515,6 +952,7 @@ pqos_cpu_get_one_by_l3id(const struct pqos_cpuinfo *cpu,
                          unsigned *lcore)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(lcore != NULL);
@@ -522,6 +960,11 @@ pqos_cpu_get_one_by_l3id(const struct pqos_cpuinfo *cpu,
         if (cpu == NULL || lcore == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_get_one(&topo->obj[TOPO_OBJ_L3_CLUSTER],
+                                    l3id, lcore);
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].l3_id == l3id) {
                         *lcore = cpu->cores[i].lcore;
@@ -537,6 +980,7 @@ pqos_cpu_get_one_by_l2id(const struct pqos_cpuinfo *cpu,
                          unsigned *lcore)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         ASSERT(lcore != NULL);
@@ -544,6 +988,11 @@ pqos_cpu_get_one_by_l2id(const struct pqos_cpuinfo *cpu,
         if (cpu == NULL || lcore == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL)
+                return topo_get_one(&topo->obj[TOPO_OBJ_L2_CLUSTER],
+                                    l2id, lcore);
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].l2_id == l2id) {
                         *lcore = cpu->cores[i].lcore;
@@ -557,11 +1006,19 @@ int
 pqos_cpu_check_core(const struct pqos_cpuinfo *cpu, const unsigned lcore)
 {
         unsigned i;
+        const struct topo_index *topo;
 
         ASSERT(cpu != NULL);
         if (cpu == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL) {
+                if (topo_core_info(topo, lcore) == NULL)
+                        return PQOS_RETVAL_ERROR;
+                return PQOS_RETVAL_OK;
+        }
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].lcore == lcore)
                         return PQOS_RETVAL_OK;
@@ -575,10 +1032,22 @@ pqos_cpu_get_socketid(const struct pqos_cpuinfo *cpu,
                       unsigned *socket)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         if (cpu == NULL || socket == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL) {
+                const struct pqos_coreinfo *core;
+
+                core = topo_core_info(topo, lcore);
+                if (core == NULL)
+                        return PQOS_RETVAL_ERROR;
+                *socket = core->socket;
+                return PQOS_RETVAL_OK;
+        }
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].lcore == lcore) {
                         *socket = cpu->cores[i].socket;
@@ -594,10 +1063,22 @@ pqos_cpu_get_numaid(const struct pqos_cpuinfo *cpu,
                     unsigned *numa)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         if (cpu == NULL || numa == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL) {
+                const struct pqos_coreinfo *core;
+
+                core = topo_core_info(topo, lcore);
+                if (core == NULL)
+                        return PQOS_RETVAL_ERROR;
+                *numa = core->numa;
+                return PQOS_RETVAL_OK;
+        }
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].lcore == lcore) {
                         *numa = cpu->cores[i].numa;
@@ -613,10 +1094,22 @@ pqos_cpu_get_clusterid(const struct pqos_cpuinfo *cpu,
                        unsigned *cluster)
 {
         unsigned i = 0;
+        const struct topo_index *topo;
 
         if (cpu == NULL || cluster == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        topo = topo_get(cpu);
+        if (topo != NULL) {
+                const struct pqos_coreinfo *core;
+
+                core = topo_core_info(topo, lcore);
+                if (core == NULL)
+                        return PQOS_RETVAL_ERROR;
+                *cluster = core->l3_id;
+                return PQOS_RETVAL_OK;
+        }
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].lcore == lcore) {
                         *cluster = cpu->cores[i].l3_id;
@@ -45,15 +45,74 @@ extern "C" {
 #include "pqos.h"
 #include "types.h"
 
+/**
+ * CPU topology object types
+ */
+enum pqos_topo_obj {
+        TOPO_OBJ_SOCKET = 0,     /**< CPU sockets */
+        TOPO_OBJ_NUMA,           /**< NUMA nodes */
+        TOPO_OBJ_L2_CLUSTER,     /**< L2 cache clusters */
+        TOPO_OBJ_L3_CLUSTER,     /**< L3 cache clusters */
+        TOPO_OBJ_L3CAT,          /**< L3 CAT domains */
+        TOPO_OBJ_MBA,            /**< MBA domains */
+        TOPO_OBJ_SMBA,           /**< SMBA domains */
+        TOPO_OBJ_NUM             /**< number of object types */
+};
+
 /**
  * @brief Initializes utils module
  *
+ * Builds topology index used to serve \a cpu lookups in constant time.
+ * Topologies other than \a cpu are served by scanning the core list.
+ *
  * @param interface option, MSR or OS
+ * @param [in] cpu library's CPU topology
  *
  * @return Operational status
  * @retval PQOS_RETVAL_OK success
  */
-PQOS_LOCAL int _pqos_utils_init(int interface);
+PQOS_LOCAL int _pqos_utils_init(int interface, const struct pqos_cpuinfo *cpu);
+
+/**
+ * @brief Shuts down utils module and releases topology index
+ */
+PQOS_LOCAL void _pqos_utils_fini(void);
+
+/**
+ * @brief Retrieves distinct topology object ids without allocation
+ *
+ * Returned array is owned by the library and is valid until \a pqos_fini.
+ *
+ * @param [in] cpu CPU topology passed to \a _pqos_utils_init
+ * @param [in] type topology object type
+ * @param [out] count place to store number of object ids
+ *
+ * @return Pointer to object ids
+ * @retval NULL topology is not indexed
+ */
+PQOS_LOCAL const unsigned *
+pqos_cpu_get_ids_span(const struct pqos_cpuinfo *cpu,
+                      const enum pqos_topo_obj type,
+                      unsigned *count);
+
+/**
+ * @brief Retrieves cores belonging to topology object without allocation
+ *
+ * Returned array is owned by the library and is valid until \a pqos_fini.
+ *
+ * @param [in] cpu CPU topology passed to \a _pqos_utils_init
+ * @param [in] type topology object type
+ * @param [in] id topology object id
+ * @param [out] count place to store number of cores
+ *
+ * @return Pointer to logical core ids
+ * @retval NULL topology is not indexed or object not found
+ */
+PQOS_LOCAL const unsigned *
+pqos_cpu_get_cores_span(const struct pqos_cpuinfo *cpu,
+                        const enum pqos_topo_obj type,
+                        const unsigned id,
+                        unsigned *count);
 
 /**
  * @brief Retrieves L3 MON I/O RDT status
@@ -1545,6 +1545,8 @@ static const char help_printf_short[] =
     "          [-T] [--mon-top]\n"
     "          [-o FILE] [--mon-file=FILE]\n"
     "          [-u TYPE] [--mon-file-type=TYPE]\n"
+    "          [--mon-publish=FILE]\n"
+    "          [--mon-rt[=CORE]] [--mon-rt-prio=PRIO]\n"
     "          [-r] [--mon-reset]\n"
     "          [-P] [--percent-llc]\n"
     "       %s [-e CLASSDEF] [--alloc-class=CLASSDEF]\n"
@@ -1666,7 +1668,17 @@ static const char help_printf_long[] =
     "  -o FILE, --mon-file=FILE    output monitored data in a FILE\n"
     "  -u TYPE, --mon-file-type=TYPE\n"
     "          select output file format type for monitored data.\n"
-    "          TYPE is one of: text (default), xml or csv.\n"
+    "          TYPE is one of: text (default), xml, csv or bin.\n"
+    "  --mon-publish=FILE\n"
+    "          publish monitored data in memory mapped FILE readable by\n"
+    "          other processes, e.g. /dev/shm/pqos-mon.\n"
+    "  --mon-rt[=CORE]\n"
+    "          sample on deadlines in a separate thread pinned to CORE,\n"
+    "          output is written by another thread. Missed deadlines\n"
+    "          are reported.\n"
+    "  --mon-rt-prio=PRIO\n"
+    "          run real-time sampling thread with SCHED_FIFO priority\n"
+    "          PRIO, implies --mon-rt.\n"
     "  -i N, --mon-interval=N      set sampling interval to Nx100ms,\n"
     "                              default 10 = 10 x 100ms = 1s.\n"
     "  -T, --mon-top               top like monitoring output\n"
@@ -1944,6 +1956,15 @@ print_lib_version(const struct pqos_cap *p_cap)
 #define OPTION_DUMP_RMID_UPSCALING   1033
 #define OPTION_PRINT_IO_DEVS         1034
 #define OPTION_PRINT_IO_DEV          1035
+#define OPTION_MON_PUBLISH           1036
+#define OPTION_MON_RT                1037
+#define OPTION_MON_RT_PRIO           1038
+
+/**
+ * Buffer of standard output, monitoring output of single interval
+ * is written with one write()
+ */
+static char stdout_buf[64 * 1024];
 
 static struct option long_cmd_opts[] = {
     /* clang-format off */
@@ -1965,6 +1986,9 @@ static struct option long_cmd_opts[] = {
     {"mon-top",               no_argument,       0, 'T'},
     {"mon-file",              required_argument, 0, 'o'},
     {"mon-file-type",         required_argument, 0, 'u'},
+    {"mon-publish",           required_argument, 0, OPTION_MON_PUBLISH},
+    {"mon-rt",                optional_argument, 0, OPTION_MON_RT},
+    {"mon-rt-prio",           required_argument, 0, OPTION_MON_RT_PRIO},
     {"mon-reset",             optional_argument, 0, 'r'},
     {"disable-mon-ipc",       no_argument,       0, OPTION_DISABLE_MON_IPC},
     {"disable-mon-llc_miss",  no_argument,       0,
@@ -2031,6 +2055,9 @@ main(int argc, char **argv)
 
         m_cmd_name = argv[0];
 
+        /* must be set before anything is written to stdout */
+        setvbuf(stdout, stdout_buf, _IOFBF, sizeof(stdout_buf));
+
         memset(&cfg, 0, sizeof(cfg));
 
         while ((cmd = getopt_long(argc, argv,
@@ -2105,6 +2132,15 @@ main(int argc, char **argv)
                 case 'u':
                         selfn_monitor_file_type(optarg);
                         break;
+                case OPTION_MON_PUBLISH:
+                        selfn_monitor_publish(optarg);
+                        break;
+                case OPTION_MON_RT:
+                        selfn_monitor_rt(optarg);
+                        break;
+                case OPTION_MON_RT_PRIO:
+                        selfn_monitor_rt_prio(optarg);
+                        break;
                 case 'e':
                         selfn_allocation_class(optarg);
                         break;
@@ -34,10 +34,15 @@
  * @brief Platform QoS utility - monitoring module
  *
  */
+#ifdef __linux__
+#define _GNU_SOURCE /**< pthread_setaffinity_np() */
+#endif
+
 #include "monitor.h"
 
 #include "common.h"
 #include "main.h"
+#include "monitor_bin.h"
 #include "monitor_csv.h"
 #include "monitor_text.h"
 #include "monitor_utils.h"
@@ -49,20 +54,25 @@
 
 #include <ctype.h>
 #include <dirent.h> /**< for dir list*/
+#include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h> /**< terminal ioctl */
+#include <sys/mman.h>  /**< mlockall() */
 #include <sys/stat.h>
 #ifdef __linux__
 #include <sys/timerfd.h> /**< timerfd_create() */
 #endif
 #include <sys/types.h> /**< open() */
-#include <time.h>      /**< localtime() */
+#include <time.h>      /**< localtime_r() */
 #include <unistd.h>
 
 #define PQOS_MON_EVENT_ALL                                                     \
@@ -210,16 +220,42 @@ static char *sel_output_file = NULL;
  */
 static char *sel_output_type = NULL;
 
+/**
+ * Maintains file to publish monitored data in
+ */
+static char *sel_publish_file = NULL;
+
+/**
+ * Real-time monitoring mode, selected with --mon-rt
+ */
+static int sel_mon_rt = 0;
+
+/**
+ * Core to pin real-time sampling thread to, -1 leaves it unpinned
+ */
+static int sel_mon_rt_core = -1;
+
+/**
+ * SCHED_FIFO priority of real-time sampling thread, 0 keeps default policy
+ */
+static int sel_mon_rt_prio = 0;
+
 /**
  * Stop monitoring indicator for infinite monitoring loop
  */
-static int stop_monitoring_loop = 0;
+static volatile sig_atomic_t stop_monitoring_loop = 0;
 
 /**
  * File descriptor for writing monitored data into
  */
 static FILE *fp_monitor = NULL;
 
+/**
+ * Buffer of monitoring output file, output of single interval
+ * is written with one write()
+ */
+static char fp_monitor_buf[64 * 1024];
+
 /**
  * Maintains process statistics. It is used for getting N pids to be displayed
  * in top-pid monitoring mode.
@@ -283,6 +319,12 @@ monitor_mixed_mode(void)
                 (sel_monitor_type & MON_GROUP_TYPE_CHANNEL) != 0);
 }
 
+int
+monitor_rt_mode(void)
+{
+        return sel_mon_rt;
+}
+
 /**
  * @brief Function to safely translate an unsigned int
  *        value to a string
@@ -1382,6 +1424,39 @@ selfn_monitor_file(const char *arg)
         selfn_strdup(&sel_output_file, arg);
 }
 
+void
+selfn_monitor_publish(const char *arg)
+{
+        selfn_strdup(&sel_publish_file, arg);
+}
+
+void
+selfn_monitor_rt(const char *arg)
+{
+        uint64_t core;
+
+        sel_mon_rt = 1;
+        if (arg == NULL)
+                return;
+
+        core = strtouint64(arg);
+        if (core > INT_MAX)
+                parse_error(arg, "Invalid core value!\n");
+        sel_mon_rt_core = (int)core;
+}
+
+void
+selfn_monitor_rt_prio(const char *arg)
+{
+        uint64_t prio = strtouint64(arg);
+
+        if (prio < (uint64_t)sched_get_priority_min(SCHED_FIFO) ||
+            prio > (uint64_t)sched_get_priority_max(SCHED_FIFO))
+                parse_error(arg, "Invalid real-time priority!\n");
+        sel_mon_rt = 1;
+        sel_mon_rt_prio = (int)prio;
+}
+
 void
 selfn_monitor_set_llc_percent(void)
 {
@@ -1729,7 +1804,8 @@ monitor_setup(const struct pqos_cpuinfo *cpu_info,
 
         if (strcasecmp(sel_output_type, "text") != 0 &&
             strcasecmp(sel_output_type, "xml") != 0 &&
-            strcasecmp(sel_output_type, "csv") != 0) {
+            strcasecmp(sel_output_type, "csv") != 0 &&
+            strcasecmp(sel_output_type, "bin") != 0) {
                 printf("Invalid selection of file output type '%s'!\n",
                        sel_output_type);
                 return -1;
@@ -1739,10 +1815,12 @@ monitor_setup(const struct pqos_cpuinfo *cpu_info,
          * Set up file descriptor for monitored data
          */
         if (sel_output_file == NULL) {
+                /* fully buffered by main() */
                 fp_monitor = stdout;
         } else {
                 if (strcasecmp(sel_output_type, "xml") == 0 ||
-                    strcasecmp(sel_output_type, "csv") == 0)
+                    strcasecmp(sel_output_type, "csv") == 0 ||
+                    strcasecmp(sel_output_type, "bin") == 0)
                         fp_monitor = safe_fopen(sel_output_file, "w+");
                 else
                         fp_monitor = safe_fopen(sel_output_file, "a");
@@ -1752,6 +1830,14 @@ monitor_setup(const struct pqos_cpuinfo *cpu_info,
                                sel_output_file);
                         return -1;
                 }
+                setvbuf(fp_monitor, fp_monitor_buf, _IOFBF,
+                        sizeof(fp_monitor_buf));
+        }
+
+        if (strcasecmp(sel_output_type, "bin") == 0 &&
+            isatty(fileno(fp_monitor))) {
+                printf("Binary output cannot be written to a terminal!\n");
+                return -1;
         }
 
         /**
@@ -3088,10 +3174,10 @@ cleanup_pslist:
 }
 
 /**
- * @brief Compare LLC occupancy in two monitoring data sets
+ * @brief Compare LLC occupancy in two monitoring records
  *
- * @param a monitoring data A
- * @param b monitoring data B
+ * @param a monitoring record A
+ * @param b monitoring record B
  *
  * @return LLC monitoring data compare status for descending order
  * @retval 0 if \a  = \b
@@ -3101,24 +3187,26 @@ cleanup_pslist:
 static int
 mon_qsort_llc_cmp_desc(const void *a, const void *b)
 {
-        const struct pqos_mon_data *const *app =
-            (const struct pqos_mon_data *const *)a;
-        const struct pqos_mon_data *const *bpp =
-            (const struct pqos_mon_data *const *)b;
-        const struct pqos_mon_data *ap = *app;
-        const struct pqos_mon_data *bp = *bpp;
+        const struct monitor_record *const *app =
+            (const struct monitor_record *const *)a;
+        const struct monitor_record *const *bpp =
+            (const struct monitor_record *const *)b;
+        const double llc_a =
+            monitor_utils_get_value(*app, PQOS_MON_EVENT_L3_OCCUP);
+        const double llc_b =
+            monitor_utils_get_value(*bpp, PQOS_MON_EVENT_L3_OCCUP);
         /**
          * This (b-a) is to get descending order
          * otherwise it would be (a-b)
          */
-        return (int)(((int64_t)bp->values.llc) - ((int64_t)ap->values.llc));
+        return (llc_b > llc_a) - (llc_b < llc_a);
 }
 
 /**
- * @brief Compare core id in two monitoring data sets
+ * @brief Compare core id in two monitoring records
  *
- * @param a monitoring data A
- * @param b monitoring data B
+ * @param a monitoring record A
+ * @param b monitoring record B
  *
  * @return Core id compare status for ascending order
  * @retval 0 if \a  = \b
@@ -3128,12 +3216,12 @@ mon_qsort_llc_cmp_desc(const void *a, const void *b)
 static int
 mon_qsort_coreid_cmp_asc(const void *a, const void *b)
 {
-        const struct pqos_mon_data *const *app =
-            (const struct pqos_mon_data *const *)a;
-        const struct pqos_mon_data *const *bpp =
-            (const struct pqos_mon_data *const *)b;
-        const struct pqos_mon_data *ap = *app;
-        const struct pqos_mon_data *bp = *bpp;
+        const struct monitor_record *const *app =
+            (const struct monitor_record *const *)a;
+        const struct monitor_record *const *bpp =
+            (const struct monitor_record *const *)b;
+        const struct pqos_mon_data *ap = (*app)->group;
+        const struct pqos_mon_data *bp = (*bpp)->group;
         /**
          * This (a-b) is to get ascending order
          * otherwise it would be (b-a)
@@ -3142,12 +3230,12 @@ mon_qsort_coreid_cmp_asc(const void *a, const void *b)
 }
 
 /**
- * @brief Compare monitoring data for mixed (core + I/O) mode
+ * @brief Compare monitoring records for mixed (core + I/O) mode
  *
  * Cores come first (sorted by core id ascending); channels follow.
  *
- * @param a monitoring data A
- * @param b monitoring data B
+ * @param a monitoring record A
+ * @param b monitoring record B
  *
  * @return Compare status for mixed ascending order
  * @retval -1 if a is a core entry and b is a channel entry
@@ -3159,9 +3247,9 @@ static int
 mon_qsort_mixed_cmp_asc(const void *a, const void *b)
 {
         const struct pqos_mon_data *ap =
-            *(const struct pqos_mon_data *const *)a;
+            (*(const struct monitor_record *const *)a)->group;
         const struct pqos_mon_data *bp =
-            *(const struct pqos_mon_data *const *)b;
+            (*(const struct monitor_record *const *)b)->group;
 
         /* Core entries come before channel entries */
         if (ap->num_cores > 0 && bp->num_channels > 0)
@@ -3178,6 +3266,35 @@ mon_qsort_mixed_cmp_asc(const void *a, const void *b)
         return 0;
 }
 
+/**
+ * @brief Sorts monitoring records with insertion sort
+ *
+ * Order of monitoring records changes little between intervals, so sorting
+ * array left from previous interval is close to linear and needs no memory.
+ *
+ * @param array array of pointers to monitoring records
+ * @param num number of elements in \a array
+ * @param cmp compare function
+ */
+static void
+mon_sort(const struct monitor_record **array,
+         const unsigned num,
+         int (*cmp)(const void *, const void *))
+{
+        unsigned i;
+
+        for (i = 1; i < num; i++) {
+                const struct monitor_record *data = array[i];
+                unsigned j = i;
+
+                while (j > 0 && cmp(&array[j - 1], &data) > 0) {
+                        array[j] = array[j - 1];
+                        j--;
+                }
+                array[j] = data;
+        }
+}
+
 /**
  * @brief CTRL-C handler for infinite monitoring loop
  *
@@ -3191,49 +3308,458 @@ monitoring_ctrlc(int signo)
 }
 
 /**
- * @brief Initializes two arrays with pointers to PQoS monitoring structures
+ * @brief Initializes arrays of PQoS monitoring structures and records
  *
  * Function does the following things:
- * - figures size of the array to allocate
- * - allocates memory for the two arrays
- * - initializes allocated arrays with data from core or pid table
- * - saves array pointers in \a parray1 and \a parray2
- * - both arrays have identical content
+ * - figures size of the arrays to allocate
+ * - allocates memory for the arrays
+ * - initializes group array with data from core or pid table
+ * - binds each record to its group and each row to its record
+ * - saves array pointers in \a pgrps, \a precs and \a prows
  *
- * @param parray1 pointer to an array of pointers to PQoS monitoring structures
- * @param parray2 pointer to an array of pointers to PQoS monitoring structures
+ * @param pgrps pointer to an array of pointers to PQoS monitoring structures
+ * @param precs pointer to an array of monitoring records, poll order
+ * @param prows pointer to an array of pointers to records, display order
  *
  * @return Number of elements in each of the tables
  */
 static unsigned
-get_mon_arrays(struct pqos_mon_data ***parray1, struct pqos_mon_data ***parray2)
+get_mon_arrays(struct pqos_mon_data ***pgrps,
+               struct monitor_record **precs,
+               const struct monitor_record ***prows)
 {
         unsigned i;
-        struct pqos_mon_data **p1, **p2;
-
-        ASSERT(parray1 != NULL && parray2 != NULL);
-
-        p1 = malloc(sizeof(p1[0]) * sel_monitor_num);
-        p2 = malloc(sizeof(p2[0]) * sel_monitor_num);
-        if (p1 == NULL || p2 == NULL) {
-                if (p1)
-                        free(p1);
-                if (p2)
-                        free(p2);
+        struct pqos_mon_data **grps;
+        struct monitor_record *recs;
+        const struct monitor_record **rows;
+
+        ASSERT(pgrps != NULL && precs != NULL && prows != NULL);
+
+        grps = malloc(sizeof(grps[0]) * sel_monitor_num);
+        recs = calloc(sel_monitor_num, sizeof(recs[0]));
+        rows = malloc(sizeof(rows[0]) * sel_monitor_num);
+        if (grps == NULL || recs == NULL || rows == NULL) {
+                free(grps);
+                free(recs);
+                free(rows);
                 printf("Error with memory allocation");
                 exit(EXIT_FAILURE);
         }
 
         for (i = 0; i < sel_monitor_num; i++) {
-                p1[i] = sel_monitor_group[i].data;
-                p2[i] = p1[i];
+                grps[i] = sel_monitor_group[i].data;
+                recs[i].group = grps[i];
+                recs[i].idx = i;
+                rows[i] = &recs[i];
         }
 
-        *parray1 = p1;
-        *parray2 = p2;
+        *pgrps = grps;
+        *precs = recs;
+        *prows = rows;
         return sel_monitor_num;
 }
 
+/**
+ * Monitoring output callbacks of selected output type
+ */
+struct monitor_output {
+        void (*begin)(FILE *fp,
+                      const int num_mem_regions,
+                      const int *region_num);
+        void (*header)(FILE *fp,
+                       const char *timestamp,
+                       const int num_mem_regions,
+                       const int *region_num);
+        void (*row)(FILE *fp,
+                    const char *timestamp,
+                    const struct monitor_record *rec);
+        void (*footer)(FILE *fp);
+        void (*end)(FILE *fp);
+};
+
+/**
+ * Number of intervals buffered between real-time sampler and writer
+ */
+#define MON_RT_RING_SIZE 64
+
+/**
+ * Stack size prefaulted by real-time sampling thread
+ */
+#define MON_RT_STACK_PREFAULT (64 * 1024)
+
+/**
+ * Single interval sampled in real-time mode
+ */
+struct mon_rt_interval {
+        struct monitor_record *recs; /**< group records, poll order */
+};
+
+/**
+ * Real-time monitoring state shared by sampling and writer threads
+ */
+static struct {
+        struct pqos_mon_data **grps; /**< groups in poll order */
+        unsigned num;                /**< number of groups */
+        int region_mode;             /**< values read per memory region */
+        struct mon_rt_interval ring[MON_RT_RING_SIZE];
+        unsigned head;     /**< written by sampler only */
+        unsigned tail;     /**< written by writer only */
+        sem_t ready;       /**< posted for each interval and at exit */
+        int done;          /**< sampler finished */
+        int failed;        /**< sampler failed to poll */
+        unsigned missed;   /**< missed sampling deadlines */
+        unsigned dropped;  /**< intervals dropped on full ring */
+        unsigned overflow; /**< polls with counter overflow */
+} mon_rt;
+
+/**
+ * @brief Adds nanoseconds to a timespec
+ *
+ * @param ts timespec to update
+ * @param ns nanoseconds to add
+ */
+static void
+mon_rt_ts_add(struct timespec *ts, const long ns)
+{
+        ts->tv_sec += ns / 1000000000L;
+        ts->tv_nsec += ns % 1000000000L;
+        if (ts->tv_nsec >= 1000000000L) {
+                ts->tv_sec++;
+                ts->tv_nsec -= 1000000000L;
+        }
+}
+
+/**
+ * @brief Checks if timespec \a a is before \a b
+ */
+static int
+mon_rt_ts_before(const struct timespec *a, const struct timespec *b)
+{
+        if (a->tv_sec != b->tv_sec)
+                return a->tv_sec < b->tv_sec;
+        return a->tv_nsec < b->tv_nsec;
+}
+
+/**
+ * @brief Stores records of polled groups in free ring entry and wakes
+ *        the writer
+ *
+ * Records hold resolved values only, so the writer never reads groups
+ * updated by the sampler. Sampler never waits for the writer, interval
+ * is dropped on full ring.
+ */
+static void
+mon_rt_push(void)
+{
+        const unsigned head = mon_rt.head;
+        struct mon_rt_interval *entry;
+        unsigned i;
+
+        if (head - __atomic_load_n(&mon_rt.tail, __ATOMIC_ACQUIRE) >=
+            MON_RT_RING_SIZE) {
+                __atomic_add_fetch(&mon_rt.dropped, 1, __ATOMIC_RELAXED);
+                return;
+        }
+
+        entry = &mon_rt.ring[head % MON_RT_RING_SIZE];
+        for (i = 0; i < mon_rt.num; i++) {
+                struct monitor_record *rec = &entry->recs[i];
+
+                monitor_utils_get_record(mon_rt.grps[i], i, mon_rt.region_mode,
+                                         rec);
+                rec->missed =
+                    __atomic_load_n(&mon_rt.missed, __ATOMIC_RELAXED);
+                rec->dropped =
+                    __atomic_load_n(&mon_rt.dropped, __ATOMIC_RELAXED);
+        }
+
+        __atomic_store_n(&mon_rt.head, head + 1, __ATOMIC_RELEASE);
+        sem_post(&mon_rt.ready);
+}
+
+/**
+ * @brief Applies CPU affinity and scheduling policy to sampling thread
+ */
+static void
+mon_rt_setup_thread(void)
+{
+        if (sel_mon_rt_core >= 0) {
+#ifdef __linux__
+                cpu_set_t cpuset;
+
+                CPU_ZERO(&cpuset);
+                if (sel_mon_rt_core < CPU_SETSIZE)
+                        CPU_SET(sel_mon_rt_core, &cpuset);
+                if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset),
+                                           &cpuset) != 0)
+                        fprintf(stderr,
+                                "Failed to pin sampling thread to core %d\n",
+                                sel_mon_rt_core);
+#else
+                fprintf(stderr, "Sampling thread pinning not supported\n");
+#endif
+        }
+
+        if (sel_mon_rt_prio > 0) {
+                struct sched_param param;
+                int ret;
+
+                memset(&param, 0, sizeof(param));
+                param.sched_priority = sel_mon_rt_prio;
+                ret = pthread_setschedparam(pthread_self(), SCHED_FIFO,
+                                            &param);
+                if (ret != 0)
+                        fprintf(stderr,
+                                "Failed to set SCHED_FIFO priority %d: %s\n",
+                                sel_mon_rt_prio, strerror(ret));
+        }
+}
+
+/**
+ * @brief Real-time sampling thread
+ *
+ * Polls monitoring groups on absolute deadlines of the monitoring interval.
+ * Deadlines that already passed on wake up are counted as missed and
+ * skipped, so sampling stays aligned to the original period.
+ *
+ * @param arg unused
+ *
+ * @return NULL
+ */
+static void *
+mon_rt_sampler(void *arg)
+{
+        const long period = sel_mon_interval * 100000000L;
+        volatile char stack[MON_RT_STACK_PREFAULT];
+        struct timespec next, now;
+        int first_measurement = 1;
+        long runtime = 0;
+        unsigned i;
+
+        UNUSED_ARG(arg);
+
+        /* fault in stack pages before entering the sampling loop */
+        for (i = 0; i < sizeof(stack); i += 256)
+                stack[i] = 0;
+
+        mon_rt_setup_thread();
+
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        while (!stop_monitoring_loop) {
+                int ret = pqos_mon_poll(mon_rt.grps, mon_rt.num);
+
+                if (ret == PQOS_RETVAL_OVERFLOW)
+                        __atomic_add_fetch(&mon_rt.overflow, 1,
+                                           __ATOMIC_RELAXED);
+                else if (ret != PQOS_RETVAL_OK) {
+                        mon_rt.failed = 1;
+                        break;
+                } else {
+                        /* first poll has no baseline for rates */
+                        if (!first_measurement)
+                                mon_rt_push();
+                        first_measurement = 0;
+                }
+
+                /* timeout */
+                if (sel_timeout != TIMEOUT_INFINITE &&
+                    runtime / 1000l >= sel_timeout)
+                        break;
+
+                mon_rt_ts_add(&next, period);
+                runtime += sel_mon_interval * 100l;
+
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                while (mon_rt_ts_before(&next, &now)) {
+                        mon_rt_ts_add(&next, period);
+                        runtime += sel_mon_interval * 100l;
+                        __atomic_add_fetch(&mon_rt.missed, 1,
+                                           __ATOMIC_RELAXED);
+                }
+
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next,
+                                       NULL) == EINTR)
+                        if (stop_monitoring_loop)
+                                break;
+        }
+
+        __atomic_store_n(&mon_rt.done, 1, __ATOMIC_RELEASE);
+        sem_post(&mon_rt.ready);
+
+        return NULL;
+}
+
+/**
+ * @brief Reports sampling problems not reported yet
+ *
+ * @param [in,out] reported counters reported so far
+ * @param timestamp time of the last written interval
+ */
+static void
+mon_rt_report(unsigned reported[3], const char *timestamp)
+{
+        const unsigned missed =
+            __atomic_load_n(&mon_rt.missed, __ATOMIC_RELAXED);
+        const unsigned dropped =
+            __atomic_load_n(&mon_rt.dropped, __ATOMIC_RELAXED);
+        const unsigned overflow =
+            __atomic_load_n(&mon_rt.overflow, __ATOMIC_RELAXED);
+
+        if (missed != reported[0])
+                fprintf(stderr, "%s missed %u sampling deadline(s)\n",
+                        timestamp, missed - reported[0]);
+        if (dropped != reported[1])
+                fprintf(stderr, "%s dropped %u interval(s), output too slow\n",
+                        timestamp, dropped - reported[1]);
+        if (overflow != reported[2])
+                fprintf(stderr, "%s MBM counter overflow\n", timestamp);
+
+        reported[0] = missed;
+        reported[1] = dropped;
+        reported[2] = overflow;
+}
+
+/**
+ * @brief Real-time monitoring loop
+ *
+ * Sampling runs in a separate thread woken up on absolute deadlines.
+ * Calling thread formats and writes intervals handed over through
+ * a ring of monitoring records, so output never delays sampling.
+ *
+ * @param output output callbacks
+ * @param mon_grps groups in poll order
+ * @param mon_rows records in display order
+ * @param mon_number number of groups
+ * @param display_num number of groups to display
+ * @param region_mode values are read per memory region
+ */
+static void
+monitor_rt_loop(const struct monitor_output *output,
+                struct pqos_mon_data **mon_grps,
+                const struct monitor_record **mon_rows,
+                const unsigned mon_number,
+                const unsigned display_num,
+                const int region_mode)
+{
+        struct monitor_record *recs = NULL;
+        const struct monitor_record **rows = NULL;
+        unsigned *order = NULL;
+        unsigned reported[3] = {0, 0, 0};
+        char cb_time[64] = "";
+        time_t cb_time_sec = (time_t)-1;
+        pthread_t thread;
+        unsigned i;
+        int ret;
+
+        memset(&mon_rt, 0, sizeof(mon_rt));
+        mon_rt.grps = mon_grps;
+        mon_rt.num = mon_number;
+        mon_rt.region_mode = region_mode;
+
+        recs = calloc(MON_RT_RING_SIZE * mon_number, sizeof(recs[0]));
+        rows = calloc(mon_number, sizeof(rows[0]));
+        order = calloc(mon_number, sizeof(order[0]));
+        if (recs == NULL || rows == NULL || order == NULL) {
+                printf("Error with memory allocation");
+                goto monitor_rt_exit;
+        }
+
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+                fprintf(stderr, "Failed to lock memory: %s\n",
+                        strerror(errno));
+
+        /* prefault ring entries */
+        memset(recs, 0, MON_RT_RING_SIZE * mon_number * sizeof(recs[0]));
+        for (i = 0; i < MON_RT_RING_SIZE; i++)
+                mon_rt.ring[i].recs = &recs[i * mon_number];
+
+        /* display order of records in poll order */
+        for (i = 0; i < mon_number; i++)
+                order[i] = mon_rows[i]->idx;
+
+        if (sem_init(&mon_rt.ready, 0, 0) != 0) {
+                fprintf(stderr, "Failed to initialize semaphore\n");
+                goto monitor_rt_exit;
+        }
+
+        ret = pthread_create(&thread, NULL, mon_rt_sampler, NULL);
+        if (ret != 0) {
+                fprintf(stderr, "Failed to create sampling thread: %s\n",
+                        strerror(ret));
+                sem_destroy(&mon_rt.ready);
+                goto monitor_rt_exit;
+        }
+
+        for (;;) {
+                int done;
+
+                if (sem_wait(&mon_rt.ready) != 0)
+                        continue;
+
+                /* intervals pushed before done are visible after it */
+                done = __atomic_load_n(&mon_rt.done, __ATOMIC_ACQUIRE);
+
+                while (mon_rt.tail !=
+                       __atomic_load_n(&mon_rt.head, __ATOMIC_ACQUIRE)) {
+                        struct mon_rt_interval *entry =
+                            &mon_rt.ring[mon_rt.tail % MON_RT_RING_SIZE];
+                        const time_t entry_time =
+                            (time_t)(entry->recs[0].timestamp / 1000000000ULL);
+
+                        for (i = 0; i < mon_number; i++)
+                                rows[i] = &entry->recs[order[i]];
+                        if (sel_mon_top_like)
+                                mon_sort(rows, mon_number,
+                                         mon_qsort_llc_cmp_desc);
+
+                        if (entry_time != cb_time_sec) {
+                                struct tm tm;
+
+                                if (localtime_r(&entry_time, &tm) != NULL)
+                                        strftime(cb_time, sizeof(cb_time) - 1,
+                                                 "%Y-%m-%d %H:%M:%S", &tm);
+                                else
+                                        strncpy(cb_time, "error",
+                                                sizeof(cb_time) - 1);
+                                cb_time_sec = entry_time;
+                        }
+
+                        output->header(fp_monitor, cb_time,
+                                       sel_mon_mem_region.num_mem_regions,
+                                       sel_mon_mem_region.region_num);
+                        for (i = 0; i < display_num; i++)
+                                output->row(fp_monitor, cb_time, rows[i]);
+                        output->footer(fp_monitor);
+                        fflush(fp_monitor);
+
+                        __atomic_store_n(&mon_rt.tail, mon_rt.tail + 1,
+                                         __ATOMIC_RELEASE);
+                }
+
+                mon_rt_report(reported, cb_time);
+                if (done)
+                        break;
+        }
+
+        pthread_join(thread, NULL);
+        sem_destroy(&mon_rt.ready);
+
+        if (mon_rt.failed)
+                printf("Failed to poll monitoring data!\n");
+        if (mon_rt.missed > 0 || mon_rt.dropped > 0)
+                fprintf(stderr,
+                        "Real-time sampling: %u missed deadline(s), "
+                        "%u dropped interval(s)\n",
+                        mon_rt.missed, mon_rt.dropped);
+
+        munlockall();
+
+monitor_rt_exit:
+        free(order);
+        free(rows);
+        free(recs);
+}
+
 void
 monitor_loop(void)
 {
@@ -3242,7 +3768,9 @@ monitor_loop(void)
         const int istty = isatty(fileno(fp_monitor));
         unsigned cache_size;
         unsigned mon_number = 0, display_num = 0;
-        struct pqos_mon_data **mon_data = NULL, **mon_grps = NULL;
+        struct pqos_mon_data **mon_grps = NULL;
+        struct monitor_record *mon_recs = NULL;
+        const struct monitor_record **mon_rows = NULL;
         long runtime = 0;
         int first_measurement = 1; /**< flag to skip first poll output */
 #ifdef __linux__
@@ -3255,27 +3783,18 @@ monitor_loop(void)
         int retval;
         struct itimerspec timer_spec;
         enum pqos_interface interface;
+        int region_mode;
+        char cb_time[64] = "";
+        time_t cb_time_sec = (time_t)-1;
 
-        struct {
-                void (*begin)(FILE *fp,
-                              const int num_mem_regions,
-                              const int *region_num);
-                void (*header)(FILE *fp,
-                               const char *timestamp,
-                               const int num_mem_regions,
-                               const int *region_num);
-                void (*row)(FILE *fp,
-                            const char *timestamp,
-                            const struct pqos_mon_data *data);
-                void (*footer)(FILE *fp);
-                void (*end)(FILE *fp);
-        } output;
+        struct monitor_output output;
 
         retval = pqos_inter_get(&interface);
         if (retval != PQOS_RETVAL_OK) {
                 printf("Unable to retrieve PQoS interface!\n");
                 return;
         }
+        region_mode = (interface == PQOS_INTER_MMIO);
 
         if (strcasecmp(sel_output_type, "text") == 0) {
                 output.begin = monitor_text_begin;
@@ -3305,6 +3824,12 @@ monitor_loop(void)
                 output.row = monitor_xml_row;
                 output.footer = monitor_xml_footer;
                 output.end = monitor_xml_end;
+        } else if (strcasecmp(sel_output_type, "bin") == 0) {
+                output.begin = monitor_bin_begin;
+                output.header = monitor_bin_header;
+                output.row = monitor_bin_row;
+                output.footer = monitor_bin_footer;
+                output.end = monitor_bin_end;
         } else {
                 printf("Invalid selection of output file type '%s'!\n",
                        sel_output_type);
@@ -3333,9 +3858,15 @@ monitor_loop(void)
                 return;
         }
 
-        mon_number = get_mon_arrays(&mon_grps, &mon_data);
+        mon_number = get_mon_arrays(&mon_grps, &mon_recs, &mon_rows);
         display_num = mon_number;
 
+        if (sel_publish_file != NULL &&
+            pqos_mon_publish_start(sel_publish_file, mon_number) !=
+                PQOS_RETVAL_OK)
+                fprintf(stderr, "Failed to publish monitoring data in %s\n",
+                        sel_publish_file);
+
         /**
          * Capture ctrl-c to gracefully stop the loop
          */
@@ -3375,12 +3906,24 @@ monitor_loop(void)
                 stop_monitoring_loop = 1;
         }
 
+        /**
+         * Core and mixed mode orders do not change between intervals
+         */
+        if (!sel_mon_top_like && monitor_core_mode())
+                mon_sort(mon_rows, mon_number, mon_qsort_coreid_cmp_asc);
+        else if (!sel_mon_top_like && monitor_mixed_mode())
+                mon_sort(mon_rows, mon_number, mon_qsort_mixed_cmp_asc);
+
         output.begin(fp_monitor, sel_mon_mem_region.num_mem_regions,
                      sel_mon_mem_region.region_num);
+        if (sel_mon_rt) {
+                /* timer is only used by the default loop */
+                monitor_rt_loop(&output, mon_grps, mon_rows, mon_number,
+                                display_num, region_mode);
+                stop_monitoring_loop = 1;
+        }
         while (!stop_monitoring_loop) {
-                struct tm *ptm = NULL;
                 unsigned i = 0;
-                char cb_time[64];
                 int ret;
                 uint64_t timer_count = 0;
                 time_t curr_time;
@@ -3399,41 +3942,41 @@ monitor_loop(void)
                  * values are always zero on the first poll (no prior baseline).
                  */
                 if (!first_measurement) {
-                        memcpy(mon_data, mon_grps,
-                               mon_number * sizeof(mon_grps[0]));
-
+                        for (i = 0; i < mon_number; i++)
+                                monitor_utils_get_record(mon_grps[i], i,
+                                                         region_mode,
+                                                         &mon_recs[i]);
                         if (sel_mon_top_like)
-                                qsort(mon_data, mon_number, sizeof(mon_data[0]),
-                                      mon_qsort_llc_cmp_desc);
-                        else if (monitor_core_mode())
-                                qsort(mon_data, mon_number, sizeof(mon_data[0]),
-                                      mon_qsort_coreid_cmp_asc);
-                        else if (monitor_mixed_mode())
-                                qsort(mon_data, mon_number, sizeof(mon_data[0]),
-                                      mon_qsort_mixed_cmp_asc);
+                                mon_sort(mon_rows, mon_number,
+                                         mon_qsort_llc_cmp_desc);
 
                         /**
-                         * Get time string
+                         * Get time string, it changes once per second
                          */
                         curr_time = time(0);
-                        ptm = localtime(&curr_time);
-                        if (ptm != NULL)
-                                strftime(cb_time, sizeof(cb_time) - 1,
-                                         "%Y-%m-%d %H:%M:%S", ptm);
-                        else
-                                strncpy(cb_time, "error", sizeof(cb_time) - 1);
+                        if (curr_time != cb_time_sec) {
+                                struct tm tm;
+
+                                if (localtime_r(&curr_time, &tm) != NULL)
+                                        strftime(cb_time, sizeof(cb_time) - 1,
+                                                 "%Y-%m-%d %H:%M:%S", &tm);
+                                else
+                                        strncpy(cb_time, "error",
+                                                sizeof(cb_time) - 1);
+                                cb_time_sec = curr_time;
+                        }
 
                         output.header(fp_monitor, cb_time,
                                       sel_mon_mem_region.num_mem_regions,
                                       sel_mon_mem_region.region_num);
                         for (i = 0; i < display_num; i++) {
 #ifndef __clang_analyzer__
-                                const struct pqos_mon_data *data = mon_data[i];
+                                const struct monitor_record *rec = mon_rows[i];
 #else
-                                const struct pqos_mon_data *data = NULL;
+                                const struct monitor_record *rec = NULL;
 #endif
 
-                                output.row(fp_monitor, cb_time, data);
+                                output.row(fp_monitor, cb_time, rec);
                         }
                         output.footer(fp_monitor);
 
@@ -3463,9 +4006,14 @@ monitor_loop(void)
                 runtime += timer_count * sel_mon_interval * 100l;
         }
         output.end(fp_monitor);
+        fflush(fp_monitor);
+
+        if (sel_publish_file != NULL)
+                pqos_mon_publish_stop();
 
         free(mon_grps);
-        free(mon_data);
+        free(mon_recs);
+        free(mon_rows);
 }
 
 void
@@ -3484,6 +4032,9 @@ monitor_cleanup(void)
         if (sel_output_file != NULL)
                 free(sel_output_file);
         sel_output_file = NULL;
+        if (sel_publish_file != NULL)
+                free(sel_publish_file);
+        sel_publish_file = NULL;
         if (sel_output_type != NULL)
                 free(sel_output_type);
         sel_output_type = NULL;
@@ -3501,6 +4052,21 @@ monitor_get_events(void)
         return sel_events_max;
 }
 
+unsigned
+monitor_get_num_groups(void)
+{
+        return sel_monitor_num;
+}
+
+const struct pqos_mon_data *
+monitor_get_group(const unsigned idx)
+{
+        if (idx >= sel_monitor_num)
+                return NULL;
+
+        return sel_monitor_group[idx].data;
+}
+
 int
 monitor_get_num_mem_regions(void)
 {
@@ -96,6 +96,28 @@ void selfn_monitor_file_type(const char *arg);
  */
 void selfn_monitor_file(const char *arg);
 
+/**
+ * @brief Selects file to publish monitored data in
+ *
+ * @param arg string passed to --mon-publish command line option
+ */
+void selfn_monitor_publish(const char *arg);
+
+/**
+ * @brief Selects real-time monitoring mode
+ *
+ * @param arg core to run sampling thread on, passed to --mon-rt
+ *        command line option, may be NULL
+ */
+void selfn_monitor_rt(const char *arg);
+
+/**
+ * @brief Selects SCHED_FIFO priority of real-time sampling thread
+ *
+ * @param arg string passed to --mon-rt-prio command line option
+ */
+void selfn_monitor_rt_prio(const char *arg);
+
 /**
  * @brief Translates multiple monitoring request strings into
  *        internal monitoring request structures
@@ -213,6 +235,15 @@ int monitor_uncore_mode(void);
  */
 int monitor_mixed_mode(void);
 
+/**
+ * @brief Check to determine if real-time sampling mode is selected
+ *
+ * @return Real-time monitoring mode status
+ * @retval 0 monitoring loop polls groups
+ * @retval 1 sampling thread polls groups
+ */
+int monitor_rt_mode(void);
+
 /**
  * @brief Retrieve the number of memory regions selected for monitoring
  *
@@ -265,6 +296,23 @@ int monitor_get_interval(void);
  */
 enum pqos_mon_event monitor_get_events(void);
 
+/**
+ * @brief Retrieve number of monitoring groups
+ *
+ * @return number of monitoring groups
+ */
+unsigned monitor_get_num_groups(void);
+
+/**
+ * @brief Retrieve monitoring data of a group
+ *
+ * @param [in] idx group index
+ *
+ * @return monitoring data of the group
+ * @retval NULL on error
+ */
+const struct pqos_mon_data *monitor_get_group(const unsigned idx);
+
 /** Monitor LLC format */
 enum monitor_llc_format {
         LLC_FORMAT_KILOBYTES = 0, /**< LLC in kB */
@@ -0,0 +1,500 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "monitor_bin.h"
+
+#include "common.h"
+#include "monitor.h"
+#include "monitor_utils.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define INVALID_REGION_NUM -1
+
+/** Scale of memory bandwidth counter delta into MB */
+#define BIN_SCALE_MB (1.0 / (1024.0 * 1024.0))
+
+static const struct {
+        enum pqos_mon_event event;
+        const char *name;
+        const char *unit; /**< NULL for LLC selected format */
+        enum monitor_bin_kind kind;
+        double scale; /**< ignored for LLC selected format */
+        unsigned precision;
+} output[] = {
+    {PQOS_PERF_EVENT_IPC, "IPC", "", MONITOR_BIN_KIND_RATIO, 1.0, 2},
+    {PQOS_PERF_EVENT_LLC_MISS, "LLC Misses", "", MONITOR_BIN_KIND_VALUE, 1.0,
+     0},
+    {PQOS_PERF_EVENT_LLC_REF, "LLC References", "", MONITOR_BIN_KIND_VALUE,
+     1.0, 0},
+    {PQOS_MON_EVENT_L3_OCCUP, "LLC", NULL, MONITOR_BIN_KIND_VALUE, 0.0, 1},
+    {PQOS_MON_EVENT_LMEM_BW, "MBL", "MB/s", MONITOR_BIN_KIND_RATE,
+     BIN_SCALE_MB, 1},
+    {PQOS_MON_EVENT_RMEM_BW, "MBR", "MB/s", MONITOR_BIN_KIND_RATE,
+     BIN_SCALE_MB, 1},
+    {PQOS_MON_EVENT_TMEM_BW, "MBT", "MB/s", MONITOR_BIN_KIND_RATE,
+     BIN_SCALE_MB, 1},
+    {PQOS_MON_EVENT_IO_L3_OCCUP, "I/O-LLC", NULL, MONITOR_BIN_KIND_VALUE, 0.0,
+     1},
+    {PQOS_MON_EVENT_IO_TOTAL_MEM_BW, "I/O-TOTAL", "MB/s",
+     MONITOR_BIN_KIND_RATE, BIN_SCALE_MB, 1},
+    {PQOS_MON_EVENT_IO_MISS_MEM_BW, "I/O-MISS", "MB/s", MONITOR_BIN_KIND_RATE,
+     BIN_SCALE_MB, 1},
+    {PQOS_PERF_EVENT_LLC_MISS_PCIE_READ, "LLC Misses Read", "",
+     MONITOR_BIN_KIND_VALUE, 1.0, 0},
+    {PQOS_PERF_EVENT_LLC_MISS_PCIE_WRITE, "LLC Misses Write", "",
+     MONITOR_BIN_KIND_VALUE, 1.0, 0},
+    {PQOS_PERF_EVENT_LLC_REF_PCIE_READ, "LLC References Read", "",
+     MONITOR_BIN_KIND_VALUE, 1.0, 0},
+    {PQOS_PERF_EVENT_LLC_REF_PCIE_WRITE, "LLC References Write", "",
+     MONITOR_BIN_KIND_VALUE, 1.0, 0},
+    {PQOS_MON_EVENT_CORE_ENERGY, "CoreEnergy", "J", MONITOR_BIN_KIND_FLOAT,
+     1.0, 3},
+    {PQOS_MON_EVENT_ACTIVITY, "Activity", "", MONITOR_BIN_KIND_FLOAT, 1.0, 3},
+    {PQOS_MON_EVENT_POWER, "Power", "W", MONITOR_BIN_KIND_FLOAT, 1.0, 3},
+};
+
+/**
+ * Column of the binary record
+ */
+struct bin_column {
+        enum pqos_mon_event event;
+        int region_num; /**< memory region or INVALID_REGION_NUM */
+        char name[32];
+        const char *unit;
+        enum monitor_bin_kind kind;
+        double scale;
+        unsigned precision;
+        unsigned slot; /**< first value slot of the column in group data */
+};
+
+static struct {
+        struct bin_column *columns;
+        unsigned num_columns;
+        unsigned num_groups;
+        int region_mode;     /**< MMIO interface, values read per region */
+        uint64_t timestamp;  /**< timestamp of the current record */
+        unsigned missed;     /**< missed deadlines of the current record */
+        unsigned dropped;    /**< dropped intervals of the current record */
+        unsigned num_slots;  /**< interval and value slots of a group */
+        uint64_t *values;    /**< [num_groups][num_slots] */
+        uint8_t *buf;        /**< encoded record */
+        size_t buf_size;
+} bin;
+
+static uint8_t *
+put_u16(uint8_t *p, const uint16_t val)
+{
+        p[0] = (uint8_t)val;
+        p[1] = (uint8_t)(val >> 8);
+
+        return p + 2;
+}
+
+static uint8_t *
+put_u32(uint8_t *p, const uint32_t val)
+{
+        p = put_u16(p, (uint16_t)val);
+
+        return put_u16(p, (uint16_t)(val >> 16));
+}
+
+static uint8_t *
+put_u64(uint8_t *p, const uint64_t val)
+{
+        p = put_u32(p, (uint32_t)val);
+
+        return put_u32(p, (uint32_t)(val >> 32));
+}
+
+static void
+write_u16(FILE *fp, const uint16_t val)
+{
+        uint8_t b[2];
+
+        put_u16(b, val);
+        fwrite(b, sizeof(b), 1, fp);
+}
+
+static void
+write_u32(FILE *fp, const uint32_t val)
+{
+        uint8_t b[4];
+
+        put_u32(b, val);
+        fwrite(b, sizeof(b), 1, fp);
+}
+
+static void
+write_f64(FILE *fp, const double val)
+{
+        uint8_t b[8];
+        uint64_t raw;
+
+        memcpy(&raw, &val, sizeof(raw));
+        put_u64(b, raw);
+        fwrite(b, sizeof(b), 1, fp);
+}
+
+static void
+write_str(FILE *fp, const char *str)
+{
+        size_t len = strlen(str);
+
+        if (len > UINT16_MAX)
+                len = UINT16_MAX;
+
+        write_u16(fp, (uint16_t)len);
+        fwrite(str, 1, len, fp);
+}
+
+static const char *
+bin_id_name(void)
+{
+        if (monitor_mixed_mode())
+                return "Core/Channel";
+        if (monitor_core_mode())
+                return "Core";
+        if (monitor_process_mode())
+                return "PID";
+        if (monitor_iordt_mode())
+                return "Channel";
+        if (monitor_uncore_mode())
+                return "Socket";
+
+        return "";
+}
+
+/**
+ * @brief Builds list of record columns for selected events
+ *
+ * @param [in] num_mem_regions number of memory regions
+ * @param [in] region_num memory region numbers
+ *
+ * @return Operation status
+ * @retval 0 OK
+ * @retval -1 error
+ */
+static int
+bin_columns_init(const int num_mem_regions, const int *region_num)
+{
+        const enum pqos_mon_event events = monitor_get_events();
+        const char *llc_unit = "KB";
+        double llc_scale = 1.0 / 1024.0;
+        unsigned max_columns = DIM(output);
+        unsigned i;
+
+        if (monitor_get_llc_format() == LLC_FORMAT_PERCENT &&
+            (events & (PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_IO_L3_OCCUP))) {
+                unsigned cache_total;
+
+                if (monitor_utils_get_cache_size(&cache_total) !=
+                        PQOS_RETVAL_OK ||
+                    cache_total == 0) {
+                        printf("Unable to retrieve LLC size!\n");
+                        return -1;
+                }
+                llc_unit = "%";
+                llc_scale = 100.0 / (double)cache_total;
+        }
+
+        if (bin.region_mode && num_mem_regions > 0)
+                max_columns += num_mem_regions;
+
+        bin.columns = calloc(max_columns, sizeof(bin.columns[0]));
+        if (bin.columns == NULL) {
+                printf("Memory allocation error!\n");
+                return -1;
+        }
+
+        for (i = 0; i < DIM(output); i++) {
+                struct bin_column *col;
+                int j;
+
+                if ((events & output[i].event) == 0)
+                        continue;
+
+                if (bin.region_mode &&
+                    output[i].event == PQOS_MON_EVENT_TMEM_BW) {
+                        for (j = 0; j < num_mem_regions; j++) {
+                                col = &bin.columns[bin.num_columns++];
+                                col->event = output[i].event;
+                                col->region_num = region_num[j];
+                                snprintf(col->name, sizeof(col->name),
+                                         "%s-r%d", output[i].name,
+                                         region_num[j]);
+                                col->unit = output[i].unit;
+                                col->kind = output[i].kind;
+                                col->scale = output[i].scale;
+                                col->precision = output[i].precision;
+                        }
+                        continue;
+                }
+
+                col = &bin.columns[bin.num_columns++];
+                col->event = output[i].event;
+                col->region_num = INVALID_REGION_NUM;
+                snprintf(col->name, sizeof(col->name), "%s", output[i].name);
+                col->kind = output[i].kind;
+                if (output[i].unit != NULL) {
+                        col->unit = output[i].unit;
+                        col->scale = output[i].scale;
+                } else {
+                        col->unit = llc_unit;
+                        col->scale = llc_scale;
+                }
+                col->precision = output[i].precision;
+        }
+
+        /* first slot of group data holds the interval */
+        bin.num_slots = 1;
+        for (i = 0; i < bin.num_columns; i++) {
+                bin.columns[i].slot = bin.num_slots;
+                bin.num_slots +=
+                    bin.columns[i].kind == MONITOR_BIN_KIND_RATIO ? 2 : 1;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Builds record buffers
+ *
+ * @return Operation status
+ * @retval 0 OK
+ * @retval -1 memory allocation error
+ */
+static int
+bin_groups_init(void)
+{
+        const unsigned num_groups = monitor_get_num_groups();
+        const size_t num_values = (size_t)num_groups * bin.num_slots;
+
+        /* timestamp, missed and dropped counts precede group data */
+        bin.buf_size = sizeof(uint64_t) + 2 * sizeof(uint32_t) +
+                       num_values * sizeof(uint64_t);
+        bin.buf = malloc(bin.buf_size);
+        if (bin.buf == NULL)
+                goto error;
+
+        if (num_values == 0)
+                return 0;
+
+        bin.values = malloc(num_values * sizeof(bin.values[0]));
+        if (bin.values == NULL)
+                goto error;
+        bin.num_groups = num_groups;
+
+        return 0;
+
+error:
+        printf("Memory allocation error!\n");
+        return -1;
+}
+
+static void
+bin_free(void)
+{
+        free(bin.columns);
+        free(bin.values);
+        free(bin.buf);
+        memset(&bin, 0, sizeof(bin));
+}
+
+void
+monitor_bin_begin(FILE *fp, const int num_mem_regions, const int *region_num)
+{
+        enum pqos_interface iface;
+        unsigned i;
+        int ret;
+
+        ASSERT(fp != NULL);
+
+        ret = pqos_inter_get(&iface);
+        if (ret != PQOS_RETVAL_OK) {
+                printf("Unable to retrieve PQoS interface!\n");
+                return;
+        }
+
+        memset(&bin, 0, sizeof(bin));
+        bin.region_mode = (iface == PQOS_INTER_MMIO);
+
+        if (bin_columns_init(num_mem_regions, region_num) != 0 ||
+            bin_groups_init() != 0) {
+                bin_free();
+                return;
+        }
+
+        fwrite(MONITOR_BIN_MAGIC, 1, sizeof(MONITOR_BIN_MAGIC), fp);
+        write_u16(fp, MONITOR_BIN_VERSION);
+        write_u16(fp, monitor_rt_mode() ? MONITOR_BIN_FLAG_RT : 0);
+        write_u32(fp, (uint32_t)monitor_get_interval() * 100);
+        write_u32(fp, bin.num_columns);
+        write_u32(fp, bin.num_groups);
+        write_str(fp, bin_id_name());
+
+        for (i = 0; i < bin.num_columns; i++) {
+                write_str(fp, bin.columns[i].name);
+                write_str(fp, bin.columns[i].unit);
+                write_u16(fp, (uint16_t)bin.columns[i].kind);
+                write_f64(fp, bin.columns[i].scale);
+                write_u16(fp, (uint16_t)bin.columns[i].precision);
+        }
+
+        for (i = 0; i < bin.num_groups; i++) {
+                const struct pqos_mon_data *data = monitor_get_group(i);
+
+                if (data != NULL && data->context != NULL)
+                        write_str(fp, (const char *)data->context);
+                else
+                        write_str(fp, "");
+        }
+}
+
+void
+monitor_bin_header(FILE *fp,
+                   const char *timestamp,
+                   const int num_mem_regions,
+                   const int *region_num)
+{
+        struct timespec ts;
+        size_t i;
+
+        UNUSED_ARG(fp);
+        UNUSED_ARG(timestamp);
+        UNUSED_ARG(num_mem_regions);
+        UNUSED_ARG(region_num);
+
+        /* replaced by poll time of the first record written */
+        if (clock_gettime(CLOCK_REALTIME, &ts) == 0)
+                bin.timestamp = (uint64_t)ts.tv_sec * 1000000000ULL +
+                                (uint64_t)ts.tv_nsec;
+        else
+                bin.timestamp = 0;
+
+        if (bin.values == NULL)
+                return;
+
+        for (i = 0; i < (size_t)bin.num_groups * bin.num_slots; i++)
+                bin.values[i] = MONITOR_BIN_MISSING;
+}
+
+/**
+ * @brief Stores raw value of the column from monitoring record
+ *
+ * Value slots are left untouched when the value is not available.
+ *
+ * @param [in] rec monitoring record
+ * @param [in] col record column
+ * @param [out] slot value slots of the column
+ */
+static void
+bin_get_raw(const struct monitor_record *rec,
+            const struct bin_column *col,
+            uint64_t *slot)
+{
+        uint64_t raw;
+
+        if (col->event == PQOS_PERF_EVENT_IPC) {
+                slot[0] = rec->ipc_retired;
+                slot[1] = rec->ipc_unhalted;
+                return;
+        }
+
+        raw = monitor_utils_get_raw(rec, col->event, col->region_num);
+        if (raw != MONITOR_RECORD_MISSING)
+                slot[0] = raw;
+}
+
+void
+monitor_bin_row(FILE *fp,
+                const char *timestamp,
+                const struct monitor_record *rec)
+{
+        uint64_t *values;
+        unsigned i;
+
+        UNUSED_ARG(fp);
+        UNUSED_ARG(timestamp);
+        ASSERT(rec != NULL);
+
+        if (bin.values == NULL || rec->idx >= bin.num_groups)
+                return;
+
+        /* groups of the interval are polled together */
+        bin.timestamp = rec->timestamp;
+        bin.missed = rec->missed;
+        bin.dropped = rec->dropped;
+
+        values = &bin.values[(size_t)rec->idx * bin.num_slots];
+        values[0] = rec->interval;
+
+        for (i = 0; i < bin.num_columns; i++) {
+                const struct bin_column *col = &bin.columns[i];
+
+                if ((rec->group->event & col->event) == 0)
+                        continue;
+
+                bin_get_raw(rec, col, &values[col->slot]);
+        }
+}
+
+void
+monitor_bin_footer(FILE *fp)
+{
+        uint8_t *p = bin.buf;
+        size_t i;
+
+        ASSERT(fp != NULL);
+
+        if (bin.buf == NULL)
+                return;
+
+        p = put_u64(p, bin.timestamp);
+        p = put_u32(p, bin.missed);
+        p = put_u32(p, bin.dropped);
+        for (i = 0; i < (size_t)bin.num_groups * bin.num_slots; i++)
+                p = put_u64(p, bin.values[i]);
+
+        fwrite(bin.buf, 1, bin.buf_size, fp);
+}
+
+void
+monitor_bin_end(FILE *fp)
+{
+        UNUSED_ARG(fp);
+
+        bin_free();
+}
@@ -0,0 +1,157 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * Binary monitoring output
+ *
+ * All multi-byte fields are little-endian. A string is stored as u16 length
+ * followed by the characters (no terminating NUL).
+ *
+ * File header:
+ *   char magic[8]       "PQOSBIN" followed by NUL
+ *   u16  version        MONITOR_BIN_VERSION
+ *   u16  flags          MONITOR_BIN_FLAG_* of the monitoring session
+ *   u32  interval       monitoring interval in milliseconds
+ *   u32  num_columns    number of column descriptors
+ *   u32  num_groups     number of group descriptors
+ *   str  id_name        label of the group identity e.g. "Core"
+ *   column descriptor (num_columns times):
+ *     str  name         event name e.g. "MBL"
+ *     str  unit         unit of the value e.g. "MB/s", may be empty
+ *     u16  kind         MONITOR_BIN_KIND_* describing how to convert value
+ *     f64  scale        multiplier converting stored value into unit
+ *     u16  precision    number of decimal places used by text outputs
+ *   group descriptor (num_groups times):
+ *     str  identity     core list, PID, channel or socket of the group
+ *
+ * Interval record (fixed size, repeated until end of file):
+ *   u64  timestamp      nanoseconds since the Epoch
+ *   u32  missed         sampling deadlines missed so far
+ *   u32  dropped        intervals dropped so far, not output
+ *   group data (num_groups times):
+ *     u64  interval     nanoseconds between counter reads of the group
+ *     u64  value[]      one slot per column, two for MONITOR_BIN_KIND_RATIO
+ *
+ * Values are stored as read from the library: counter deltas for
+ * bandwidth, LLC misses and references, occupancy in bytes. Converting
+ * them into units is left to the reader:
+ *   MONITOR_BIN_KIND_VALUE  value * scale
+ *   MONITOR_BIN_KIND_RATE   value * scale * 1e9 / interval
+ *   MONITOR_BIN_KIND_RATIO  value[0] * scale / value[1]
+ *   MONITOR_BIN_KIND_FLOAT  value holds IEEE 754 double, value * scale
+ *
+ * Groups not output in given interval have interval set to
+ * MONITOR_BIN_MISSING. Values of events not monitored by the group are
+ * stored as MONITOR_BIN_MISSING. Missed deadlines and dropped intervals
+ * are counted in real-time mode only and are 0 otherwise.
+ */
+
+#ifndef __MONITOR_BIN_H__
+#define __MONITOR_BIN_H__
+
+#include "monitor_utils.h"
+#include "pqos.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define MONITOR_BIN_MAGIC   "PQOSBIN"
+#define MONITOR_BIN_VERSION 3
+#define MONITOR_BIN_MISSING UINT64_MAX
+
+/** Data sampled in real-time mode */
+#define MONITOR_BIN_FLAG_RT 0x1
+
+/**
+ * Conversion of stored column values into column unit
+ */
+enum monitor_bin_kind {
+        MONITOR_BIN_KIND_VALUE = 0, /**< value */
+        MONITOR_BIN_KIND_RATE = 1,  /**< value per second of interval */
+        MONITOR_BIN_KIND_RATIO = 2, /**< ratio of two values */
+        MONITOR_BIN_KIND_FLOAT = 3  /**< floating point value */
+};
+
+/**
+ * @brief Start binary output
+ *
+ * Writes file header describing columns and monitored groups
+ *
+ * @param fp file descriptor
+ * @param [in] num_mem_regions number of memory regions
+ * @param [in] region_num memory region numbers
+ */
+void monitor_bin_begin(FILE *fp,
+                       const int num_mem_regions,
+                       const int *region_num);
+
+/**
+ * @brief Start binary interval record
+ *
+ * @param fp file descriptor
+ * @param [in] timestamp data timestamp
+ * @param [in] num_mem_regions number of memory regions
+ * @param [in] region_num memory region numbers
+ */
+void monitor_bin_header(FILE *fp,
+                        const char *timestamp,
+                        const int num_mem_regions,
+                        const int *region_num);
+
+/**
+ * @brief Store monitoring data of a group in binary interval record
+ *
+ * @param fp file descriptor
+ * @param [in] timestamp data timestamp
+ * @param [in] rec monitoring record
+ */
+void monitor_bin_row(FILE *fp,
+                     const char *timestamp,
+                     const struct monitor_record *rec);
+
+/**
+ * @brief Write binary interval record
+ *
+ * @param fp file descriptor
+ */
+void monitor_bin_footer(FILE *fp);
+
+/**
+ * @brief Finalize binary output
+ *
+ * @param fp file descriptor
+ */
+void monitor_bin_end(FILE *fp);
+
+#endif /* __MONITOR_BIN_H__ */
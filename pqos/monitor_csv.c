@@ -165,6 +165,9 @@ monitor_csv_begin(FILE *fp, const int num_mem_regions, const int *region_num)
         if (events & PQOS_MON_EVENT_POWER)
                 fprintf(fp, ",Power[W]");
 
+        if (monitor_rt_mode())
+                fprintf(fp, ",Missed,Dropped");
+
         fputs("\n", fp);
 }
 
@@ -219,11 +222,34 @@ fillin_csv_column(const char *format,
         return offset;
 }
 
+/**
+ * @brief Fills in sampling problem columns in real-time mode
+ *
+ * @param [in] rec monitoring record
+ * @param data place to put formatted columns into
+ * @param sz_data available size for the columns
+ *
+ * @return Number of characters added to \a data excluding NULL
+ */
+static size_t
+fillin_csv_rt_columns(const struct monitor_record *rec,
+                      char data[],
+                      const size_t sz_data)
+{
+        if (!monitor_rt_mode())
+                return 0;
+
+        snprintf(data, sz_data - 1, ",%u,%u", rec->missed, rec->dropped);
+
+        return strlen(data);
+}
+
 void
 monitor_csv_row(FILE *fp,
                 const char *timestamp,
-                const struct pqos_mon_data *mon_data)
+                const struct monitor_record *rec)
 {
+        const struct pqos_mon_data *mon_data = rec->group;
         const size_t sz_data = 128;
         char data[sz_data];
         size_t offset = 0;
@@ -233,7 +259,7 @@ monitor_csv_row(FILE *fp,
 
         ASSERT(fp != NULL);
         ASSERT(timestamp != NULL);
-        ASSERT(mon_data != NULL);
+        ASSERT(rec != NULL);
 
         memset(data, 0, sz_data);
 
@@ -259,13 +285,14 @@ monitor_csv_row(FILE *fp,
 
         for (i = 0; i < DIM(output); i++) {
                 double value =
-                    monitor_utils_get_value(mon_data, output[i].event);
+                    monitor_utils_get_value(rec, output[i].event);
 
                 offset += fillin_csv_column(output[i].format, value,
                                             data + offset, sz_data - offset,
                                             mon_data->event & output[i].event,
                                             events & output[i].event);
         }
+        offset += fillin_csv_rt_columns(rec, data + offset, sz_data - offset);
 
         if (monitor_core_mode() || monitor_uncore_mode() ||
             monitor_iordt_mode())
@@ -287,8 +314,9 @@ monitor_csv_row(FILE *fp,
 void
 monitor_csv_region_row(FILE *fp,
                        const char *timestamp,
-                       const struct pqos_mon_data *mon_data)
+                       const struct monitor_record *rec)
 {
+        const struct pqos_mon_data *mon_data = rec->group;
         const size_t sz_data = REGION_ROW_DATA_SIZE;
         char data[sz_data];
         size_t offset = 0;
@@ -298,7 +326,7 @@ monitor_csv_region_row(FILE *fp,
 
         ASSERT(fp != NULL);
         ASSERT(timestamp != NULL);
-        ASSERT(mon_data != NULL);
+        ASSERT(rec != NULL);
 
         memset(data, 0, sz_data);
 
@@ -327,7 +355,7 @@ monitor_csv_region_row(FILE *fp,
                              j++) {
 
                                 double value = monitor_utils_get_region_value(
-                                    mon_data, output[i].event,
+                                    rec, output[i].event,
                                     mon_data->regions.region_num[j]);
 
                                 offset += fillin_csv_column(
@@ -340,13 +368,14 @@ monitor_csv_region_row(FILE *fp,
                 }
 
                 double value = monitor_utils_get_region_value(
-                    mon_data, output[i].event, INVALID_REGION_NUM);
+                    rec, output[i].event, INVALID_REGION_NUM);
 
                 offset += fillin_csv_column(output[i].format, value,
                                             data + offset, sz_data - offset,
                                             mon_data->event & output[i].event,
                                             events & output[i].event);
         }
+        offset += fillin_csv_rt_columns(rec, data + offset, sz_data - offset);
 
         if (monitor_core_mode() || monitor_uncore_mode() ||
             monitor_iordt_mode())
@@ -357,8 +386,9 @@ monitor_csv_region_row(FILE *fp,
 void
 monitor_csv_mixed_row(FILE *fp,
                       const char *timestamp,
-                      const struct pqos_mon_data *mon_data)
+                      const struct monitor_record *rec)
 {
+        const struct pqos_mon_data *mon_data = rec->group;
         const size_t sz_data = REGION_ROW_DATA_SIZE;
         char data[sz_data];
         size_t offset = 0;
@@ -370,7 +400,7 @@ monitor_csv_mixed_row(FILE *fp,
 
         ASSERT(fp != NULL);
         ASSERT(timestamp != NULL);
-        ASSERT(mon_data != NULL);
+        ASSERT(rec != NULL);
 
         memset(data, 0, sz_data);
 
@@ -409,7 +439,7 @@ monitor_csv_mixed_row(FILE *fp,
                                      j++) {
                                         double value =
                                             monitor_utils_get_region_value(
-                                                mon_data, output[i].event,
+                                                rec, output[i].event,
                                                 mon_data->regions
                                                     .region_num[j]);
 
@@ -454,7 +484,7 @@ monitor_csv_mixed_row(FILE *fp,
                         }
                 } else {
                         double value = monitor_utils_get_region_value(
-                            mon_data, output[i].event, INVALID_REGION_NUM);
+                            rec, output[i].event, INVALID_REGION_NUM);
 
                         offset += fillin_csv_column(
                             output[i].format, value, data + offset,
@@ -462,6 +492,7 @@ monitor_csv_mixed_row(FILE *fp,
                             events & output[i].event);
                 }
         }
+        offset += fillin_csv_rt_columns(rec, data + offset, sz_data - offset);
 
         fprintf(fp, "%s,\"%s\"%s\n", timestamp, (char *)mon_data->context,
                 data);
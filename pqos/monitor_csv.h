@@ -34,6 +34,7 @@
 #ifndef __MONITOR_CSV_H__
 #define __MONITOR_CSV_H__
 
+#include "monitor_utils.h"
 #include "pqos.h"
 
 /**
@@ -62,22 +63,22 @@ void monitor_csv_header(FILE *fp,
  *
  * @param fp file descriptor
  * @param [in] timestamp data timestamp
- * @param [in] data monitoring data
+ * @param [in] rec monitoring record
  */
 void monitor_csv_row(FILE *fp,
                      const char *timestamp,
-                     const struct pqos_mon_data *data);
+                     const struct monitor_record *rec);
 
 /**
  * @brief Print region monitoring data in csv format
  *
  * @param fp file descriptor
  * @param [in] timestamp data timestamp
- * @param [in] data monitoring data
+ * @param [in] rec monitoring record
  */
 void monitor_csv_region_row(FILE *fp,
                             const char *timestamp,
-                            const struct pqos_mon_data *data);
+                            const struct monitor_record *rec);
 
 /**
  * @brief Print combined core and I/O monitoring data in CSV format (MMIO)
@@ -86,11 +87,11 @@ void monitor_csv_region_row(FILE *fp,
  *
  * @param fp file descriptor
  * @param [in] timestamp data timestamp
- * @param [in] data monitoring data
+ * @param [in] rec monitoring record
  */
 void monitor_csv_mixed_row(FILE *fp,
                            const char *timestamp,
-                           const struct pqos_mon_data *data);
+                           const struct monitor_record *rec);
 
 /**
  * @brief Print CSV footer
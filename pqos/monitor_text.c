@@ -77,6 +77,26 @@ static struct {
     {.event = PQOS_MON_EVENT_POWER, .unit = 1, .format = " %11.3f"},
 };
 
+/**
+ * Sampling problems reported with the interval, real-time mode only
+ */
+static struct {
+        unsigned missed;  /**< sampling deadlines missed so far */
+        unsigned dropped; /**< intervals dropped so far */
+} text_rt;
+
+/**
+ * @brief Stores sampling problems of the interval being output
+ *
+ * @param [in] rec monitoring record
+ */
+static void
+monitor_text_rt_update(const struct monitor_record *rec)
+{
+        text_rt.missed = rec->missed;
+        text_rt.dropped = rec->dropped;
+}
+
 static void
 monitor_text_region_header(FILE *fp,
                            const int num_mem_regions,
@@ -243,8 +263,9 @@ fillin_text_column(const char *format,
 void
 monitor_text_row(FILE *fp,
                  const char *timestamp,
-                 const struct pqos_mon_data *mon_data)
+                 const struct monitor_record *rec)
 {
+        const struct pqos_mon_data *mon_data = rec->group;
         const size_t sz_data = 256;
         char data[sz_data];
         size_t offset = 0;
@@ -253,9 +274,10 @@ monitor_text_row(FILE *fp,
         unsigned i;
 
         ASSERT(fp != NULL);
-        ASSERT(mon_data != NULL);
+        ASSERT(rec != NULL);
         UNUSED_ARG(timestamp);
 
+        monitor_text_rt_update(rec);
         memset(data, 0, sz_data);
 
 #ifdef PQOS_RMID_CUSTOM
@@ -279,7 +301,7 @@ monitor_text_row(FILE *fp,
 
         for (i = 0; i < DIM(output); i++) {
                 double value =
-                    monitor_utils_get_value(mon_data, output[i].event) /
+                    monitor_utils_get_value(rec, output[i].event) /
                     output[i].unit;
 
                 offset += fillin_text_column(output[i].format, value,
@@ -307,8 +329,9 @@ monitor_text_row(FILE *fp,
 void
 monitor_text_region_row(FILE *fp,
                         const char *timestamp,
-                        const struct pqos_mon_data *mon_data)
+                        const struct monitor_record *rec)
 {
+        const struct pqos_mon_data *mon_data = rec->group;
         const size_t sz_data = REGION_ROW_DATA_SIZE;
         char data[sz_data];
         size_t offset = 0;
@@ -317,9 +340,10 @@ monitor_text_region_row(FILE *fp,
         int j = 0;
 
         ASSERT(fp != NULL);
-        ASSERT(mon_data != NULL);
+        ASSERT(rec != NULL);
         UNUSED_ARG(timestamp);
 
+        monitor_text_rt_update(rec);
         memset(data, 0, sz_data);
 
 #ifdef PQOS_RMID_CUSTOM
@@ -348,7 +372,7 @@ monitor_text_region_row(FILE *fp,
 
                                 double value =
                                     monitor_utils_get_region_value(
-                                        mon_data, output[i].event,
+                                        rec, output[i].event,
                                         mon_data->regions.region_num[j]) /
                                     output[i].unit;
 
@@ -362,7 +386,7 @@ monitor_text_region_row(FILE *fp,
                 }
 
                 double value =
-                    monitor_utils_get_region_value(mon_data, output[i].event,
+                    monitor_utils_get_region_value(rec, output[i].event,
                                                    INVALID_REGION_NUM) /
                     output[i].unit;
 
@@ -441,8 +465,9 @@ fillin_text_na_regions_column(int num_regions,
 void
 monitor_text_mixed_row(FILE *fp,
                        const char *timestamp,
-                       const struct pqos_mon_data *mon_data)
+                       const struct monitor_record *rec)
 {
+        const struct pqos_mon_data *mon_data = rec->group;
         const size_t sz_data = REGION_ROW_DATA_SIZE;
         char data[sz_data];
         size_t offset = 0;
@@ -453,9 +478,10 @@ monitor_text_mixed_row(FILE *fp,
         int num_regions;
 
         ASSERT(fp != NULL);
-        ASSERT(mon_data != NULL);
+        ASSERT(rec != NULL);
         UNUSED_ARG(timestamp);
 
+        monitor_text_rt_update(rec);
         memset(data, 0, sz_data);
 
 #ifdef PQOS_RMID_CUSTOM
@@ -493,7 +519,7 @@ monitor_text_mixed_row(FILE *fp,
                                      j++) {
                                         double value =
                                             monitor_utils_get_region_value(
-                                                mon_data, output[i].event,
+                                                rec, output[i].event,
                                                 mon_data->regions
                                                     .region_num[j]) /
                                             output[i].unit;
@@ -526,7 +552,7 @@ monitor_text_mixed_row(FILE *fp,
                 } else {
                         double value =
                             monitor_utils_get_region_value(
-                                mon_data, output[i].event, INVALID_REGION_NUM) /
+                                rec, output[i].event, INVALID_REGION_NUM) /
                             output[i].unit;
 
                         offset += fillin_text_column(
@@ -544,6 +570,10 @@ monitor_text_footer(FILE *fp)
 {
         ASSERT(fp != NULL);
 
+        if (monitor_rt_mode())
+                fprintf(fp, "MISSED %u DROPPED %u\n", text_rt.missed,
+                        text_rt.dropped);
+
         if (!isatty(fileno(fp)))
                 fputs("\n", fp);
 }
@@ -38,6 +38,7 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #define PID_COL_CORE (39) /**< col for core number in /proc/pid/stat */
 
@@ -101,160 +102,319 @@ bytes_to_mb(const double bytes)
         return bytes / (1024.0 * 1024.0);
 }
 
-double
-monitor_utils_get_value(const struct pqos_mon_data *const group,
-                        const enum pqos_mon_event event)
+/**
+ * Events with values in monitoring record
+ */
+static const enum pqos_mon_event record_events[MONITOR_RECORD_NUM_EVENTS] = {
+    PQOS_MON_EVENT_L3_OCCUP,
+    PQOS_MON_EVENT_LMEM_BW,
+    PQOS_MON_EVENT_TMEM_BW,
+    PQOS_MON_EVENT_RMEM_BW,
+    PQOS_MON_EVENT_IO_L3_OCCUP,
+    PQOS_MON_EVENT_IO_TOTAL_MEM_BW,
+    PQOS_MON_EVENT_IO_MISS_MEM_BW,
+    PQOS_PERF_EVENT_LLC_MISS,
+    PQOS_PERF_EVENT_LLC_REF,
+    PQOS_PERF_EVENT_IPC,
+    PQOS_PERF_EVENT_LLC_MISS_PCIE_READ,
+    PQOS_PERF_EVENT_LLC_MISS_PCIE_WRITE,
+    PQOS_PERF_EVENT_LLC_REF_PCIE_READ,
+    PQOS_PERF_EVENT_LLC_REF_PCIE_WRITE,
+    PQOS_MON_EVENT_CORE_ENERGY,
+    PQOS_MON_EVENT_ACTIVITY,
+    PQOS_MON_EVENT_POWER,
+};
+
+/** Events read per memory region on MMIO interface */
+#define RECORD_REGION_EVENTS                                                   \
+        (PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_IO_L3_OCCUP |                \
+         PQOS_MON_EVENT_TMEM_BW | PQOS_MON_EVENT_IO_TOTAL_MEM_BW |            \
+         PQOS_MON_EVENT_IO_MISS_MEM_BW)
+
+/**
+ * @brief Gets index of event values in monitoring record
+ *
+ * @param event monitoring event ID
+ *
+ * @return index of event values
+ * @retval -1 if event has no values in the record
+ */
+static int
+record_event_idx(const enum pqos_mon_event event)
 {
-        int ret;
-        uint64_t delta;
-        double value;
+        unsigned i;
 
-        /** Coefficient to display the data as MB/s */
-        const double coeff = 10.0 / (double)monitor_get_interval();
+        for (i = 0; i < DIM(record_events); i++)
+                if (record_events[i] == event)
+                        return (int)i;
 
-        if ((group->event & event) == 0)
-                return 0.0;
+        return -1;
+}
 
-        switch (event) {
-        case PQOS_MON_EVENT_L3_OCCUP:
-                ret = pqos_mon_get_value(group, event, &delta, NULL);
-                if (ret == PQOS_RETVAL_OK) {
-                        enum monitor_llc_format format =
-                            monitor_get_llc_format();
-                        unsigned cache_total;
-
-                        ret = monitor_utils_get_cache_size(&cache_total);
-                        if (ret != PQOS_RETVAL_OK)
-                                break;
-
-                        switch (format) {
-                        case LLC_FORMAT_KILOBYTES:
-                                value = bytes_to_kb(delta);
-                                break;
-                        case LLC_FORMAT_PERCENT:
-                                value = delta * 100 / cache_total;
-                                break;
-                        default:
-                                printf("Incorrect llc_format: %i\n", format);
-                                ret = PQOS_RETVAL_PARAM;
-                        }
-                }
-                break;
-        case PQOS_MON_EVENT_LMEM_BW:
-        case PQOS_MON_EVENT_TMEM_BW:
-        case PQOS_MON_EVENT_RMEM_BW:
-                ret = pqos_mon_get_value(group, event, NULL, &delta);
-                if (ret == PQOS_RETVAL_OK)
-                        value = bytes_to_mb(delta) * coeff;
+/**
+ * @brief Gets index of memory region in monitoring group
+ *
+ * @param group monitoring group
+ * @param region_num memory region number
+ *
+ * @return index of memory region
+ * @retval -1 if region is not monitored by the group
+ */
+static int
+record_region_idx(const struct pqos_mon_data *group, const int region_num)
+{
+        int i;
 
+        for (i = 0; i < group->regions.num_mem_regions; i++)
+                if (group->regions.region_num[i] == region_num)
+                        return i;
+
+        return -1;
+}
+
+/**
+ * @brief Converts LLC occupancy into selected display format
+ *
+ * @param bytes LLC occupancy in bytes
+ * @param [out] value value to be displayed
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+record_llc_value(const uint64_t bytes, double *value)
+{
+        const enum monitor_llc_format format = monitor_get_llc_format();
+        unsigned cache_total;
+        int ret;
+
+        ret = monitor_utils_get_cache_size(&cache_total);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        switch (format) {
+        case LLC_FORMAT_KILOBYTES:
+                *value = bytes_to_kb(bytes);
                 break;
-        case PQOS_PERF_EVENT_LLC_MISS:
-        case PQOS_PERF_EVENT_LLC_REF:
-        case PQOS_PERF_EVENT_LLC_MISS_PCIE_READ:
-        case PQOS_PERF_EVENT_LLC_MISS_PCIE_WRITE:
-        case PQOS_PERF_EVENT_LLC_REF_PCIE_READ:
-        case PQOS_PERF_EVENT_LLC_REF_PCIE_WRITE:
-                ret = pqos_mon_get_value(group, event, NULL, &delta);
-                value = (double)delta;
-                break;
-        case PQOS_PERF_EVENT_IPC:
-                ret = pqos_mon_get_ipc(group, &value);
-                break;
-        case PQOS_MON_EVENT_CORE_ENERGY:
-        case PQOS_MON_EVENT_ACTIVITY:
-        case PQOS_MON_EVENT_POWER: {
-                double tel_val = 0.0;
-                int tel_ret = pqos_mon_get_tel_value(group, event, &tel_val);
-
-                if (tel_ret == PQOS_RETVAL_OK) {
-                        value = tel_val;
-                        ret = PQOS_RETVAL_OK;
-                } else {
-                        ret = tel_ret;
-                }
+        case LLC_FORMAT_PERCENT:
+                *value = bytes * 100 / cache_total;
                 break;
-        }
         default:
-                ret = PQOS_RETVAL_PARAM;
+                printf("Incorrect llc_format: %i\n", format);
+                return PQOS_RETVAL_PARAM;
         }
 
-        if (ret != PQOS_RETVAL_OK)
-                return 0;
+        return PQOS_RETVAL_OK;
+}
 
-        return value;
+/**
+ * @brief Reads raw value of the event from monitoring group
+ *
+ * @param [in] group monitoring group
+ * @param [in] event monitoring event ID
+ * @param [in] region_mode values are read per memory region
+ * @param [in] region_num memory region number, -1 for all regions
+ * @param [out] raw occupancy or counter delta
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+record_read_raw(const struct pqos_mon_data *group,
+                const enum pqos_mon_event event,
+                const int region_mode,
+                const int region_num,
+                uint64_t *raw)
+{
+        const int occupancy = (event & (PQOS_MON_EVENT_L3_OCCUP |
+                                        PQOS_MON_EVENT_IO_L3_OCCUP)) != 0;
+        uint64_t *value = occupancy ? raw : NULL;
+        uint64_t *delta = occupancy ? NULL : raw;
+
+        if (region_mode && (event & RECORD_REGION_EVENTS))
+                return pqos_mon_get_region_value(group, event, region_num,
+                                                 value, delta);
+
+        /* local and remote bandwidth is not available on MMIO interface */
+        if (region_mode && (event & (PQOS_MON_EVENT_LMEM_BW |
+                                     PQOS_MON_EVENT_RMEM_BW)))
+                return PQOS_RETVAL_PARAM;
+
+        /* I/O RDT events are read per memory region only */
+        if (!region_mode && (event & (PQOS_MON_EVENT_IO_L3_OCCUP |
+                                      PQOS_MON_EVENT_IO_TOTAL_MEM_BW |
+                                      PQOS_MON_EVENT_IO_MISS_MEM_BW)))
+                return PQOS_RETVAL_PARAM;
+
+        return pqos_mon_get_value(group, event, value, delta);
+}
+
+void
+monitor_utils_get_record(const struct pqos_mon_data *group,
+                         const unsigned idx,
+                         const int region_mode,
+                         struct monitor_record *rec)
+{
+        struct pqos_mon_poll_time poll_time;
+        struct timespec ts;
+        int i;
+
+        ASSERT(group != NULL);
+        ASSERT(rec != NULL);
+
+        memset(rec, 0, sizeof(*rec));
+        rec->group = group;
+        rec->idx = idx;
+
+        if (clock_gettime(CLOCK_REALTIME, &ts) == 0)
+                rec->timestamp = (uint64_t)ts.tv_sec * 1000000000ULL +
+                                 (uint64_t)ts.tv_nsec;
+
+        /* monitoring interval is given in 100ms units */
+        if (pqos_mon_get_poll_time(group, &poll_time) == PQOS_RETVAL_OK &&
+            poll_time.interval > 0)
+                rec->interval = poll_time.interval;
+        else
+                rec->interval = (uint64_t)monitor_get_interval() * 100000000ULL;
+
+        rec->ipc_retired = group->values.ipc_retired_delta;
+        rec->ipc_unhalted = group->values.ipc_unhalted_delta;
+
+        for (i = 0; i < (int)DIM(record_events); i++) {
+                const enum pqos_mon_event event = record_events[i];
+                uint64_t *raw = &rec->raw[i];
+                double *value = &rec->value[i];
+                int ret = PQOS_RETVAL_OK;
+
+                *raw = MONITOR_RECORD_MISSING;
+                if ((group->event & event) == 0)
+                        continue;
+
+                switch (event) {
+                case PQOS_PERF_EVENT_IPC:
+                        ret = pqos_mon_get_ipc(group, value);
+                        break;
+                case PQOS_MON_EVENT_CORE_ENERGY:
+                case PQOS_MON_EVENT_ACTIVITY:
+                case PQOS_MON_EVENT_POWER:
+                        ret = pqos_mon_get_tel_value(group, event, value);
+                        if (ret == PQOS_RETVAL_OK)
+                                memcpy(raw, value, sizeof(*raw));
+                        break;
+                case PQOS_MON_EVENT_L3_OCCUP:
+                case PQOS_MON_EVENT_IO_L3_OCCUP:
+                        ret = record_read_raw(group, event, region_mode, -1,
+                                              raw);
+                        if (ret == PQOS_RETVAL_OK)
+                                ret = record_llc_value(*raw, value);
+                        break;
+                case PQOS_MON_EVENT_LMEM_BW:
+                case PQOS_MON_EVENT_TMEM_BW:
+                case PQOS_MON_EVENT_RMEM_BW:
+                case PQOS_MON_EVENT_IO_TOTAL_MEM_BW:
+                case PQOS_MON_EVENT_IO_MISS_MEM_BW:
+                        /* rate over measured time between polls */
+                        ret = record_read_raw(group, event, region_mode, -1,
+                                              raw);
+                        if (ret == PQOS_RETVAL_OK)
+                                *value = bytes_to_mb(*raw) * 1e9 /
+                                         (double)rec->interval;
+                        break;
+                default:
+                        ret = record_read_raw(group, event, region_mode, -1,
+                                              raw);
+                        if (ret == PQOS_RETVAL_OK)
+                                *value = (double)*raw;
+                        break;
+                }
+
+                if (ret != PQOS_RETVAL_OK) {
+                        *raw = MONITOR_RECORD_MISSING;
+                        *value = 0.0;
+                }
+        }
+
+        for (i = 0; i < group->regions.num_mem_regions &&
+                    i < PQOS_MAX_MEM_REGIONS;
+             i++) {
+                uint64_t *raw = &rec->region_raw[i];
+
+                *raw = MONITOR_RECORD_MISSING;
+                if (!region_mode ||
+                    (group->event & PQOS_MON_EVENT_TMEM_BW) == 0)
+                        continue;
+
+                if (pqos_mon_get_region_value(group, PQOS_MON_EVENT_TMEM_BW,
+                                              group->regions.region_num[i],
+                                              NULL, raw) == PQOS_RETVAL_OK)
+                        rec->region_value[i] =
+                            bytes_to_mb(*raw) * 1e9 / (double)rec->interval;
+                else
+                        *raw = MONITOR_RECORD_MISSING;
+        }
+}
+
+double
+monitor_utils_get_value(const struct monitor_record *rec,
+                        const enum pqos_mon_event event)
+{
+        return monitor_utils_get_region_value(rec, event, -1);
 }
 
 double
-monitor_utils_get_region_value(const struct pqos_mon_data *const group,
+monitor_utils_get_region_value(const struct monitor_record *rec,
                                const enum pqos_mon_event event,
                                int region_num)
 {
-        int ret;
-        uint64_t delta;
-        double value;
+        int idx;
 
-        /** Coefficient to display the data as MB/s */
-        const double coeff = 10.0 / (double)monitor_get_interval();
+        ASSERT(rec != NULL);
 
-        if ((group->event & event) == 0)
+        if ((rec->group->event & event) == 0)
                 return 0.0;
 
-        switch (event) {
-        case PQOS_MON_EVENT_L3_OCCUP:
-        case PQOS_MON_EVENT_IO_L3_OCCUP:
-                ret = pqos_mon_get_region_value(group, event, region_num,
-                                                &delta, NULL);
-                if (ret == PQOS_RETVAL_OK) {
-                        enum monitor_llc_format format =
-                            monitor_get_llc_format();
-                        unsigned cache_total;
-
-                        ret = monitor_utils_get_cache_size(&cache_total);
-                        if (ret != PQOS_RETVAL_OK)
-                                break;
-
-                        switch (format) {
-                        case LLC_FORMAT_KILOBYTES:
-                                value = bytes_to_kb(delta);
-                                break;
-                        case LLC_FORMAT_PERCENT:
-                                value = delta * 100 / cache_total;
-                                break;
-                        default:
-                                printf("Incorrect llc_format: %i\n", format);
-                                ret = PQOS_RETVAL_PARAM;
-                        }
-                }
-                break;
-        case PQOS_MON_EVENT_TMEM_BW:
-        case PQOS_MON_EVENT_IO_TOTAL_MEM_BW:
-        case PQOS_MON_EVENT_IO_MISS_MEM_BW:
-                ret = pqos_mon_get_region_value(group, event, region_num, NULL,
-                                                &delta);
-                if (ret == PQOS_RETVAL_OK)
-                        value = bytes_to_mb(delta) * coeff;
-                break;
-        case PQOS_PERF_EVENT_LLC_MISS:
-        case PQOS_PERF_EVENT_LLC_REF:
-        case PQOS_PERF_EVENT_LLC_MISS_PCIE_READ:
-        case PQOS_PERF_EVENT_LLC_MISS_PCIE_WRITE:
-        case PQOS_PERF_EVENT_LLC_REF_PCIE_READ:
-        case PQOS_PERF_EVENT_LLC_REF_PCIE_WRITE:
-                ret = pqos_mon_get_value(group, event, NULL, &delta);
-                if (ret == PQOS_RETVAL_OK)
-                        value = (double)delta;
-                break;
-        case PQOS_PERF_EVENT_IPC:
-                ret = pqos_mon_get_ipc(group, &value);
-                break;
-        default:
-                ret = PQOS_RETVAL_PARAM;
+        if (region_num >= 0) {
+                idx = record_region_idx(rec->group, region_num);
+                if (event != PQOS_MON_EVENT_TMEM_BW || idx < 0 ||
+                    idx >= PQOS_MAX_MEM_REGIONS)
+                        return 0.0;
+
+                return rec->region_value[idx];
         }
 
-        if (ret != PQOS_RETVAL_OK)
-                return 0;
+        idx = record_event_idx(event);
+        if (idx < 0)
+                return 0.0;
+
+        return rec->value[idx];
+}
+
+uint64_t
+monitor_utils_get_raw(const struct monitor_record *rec,
+                      const enum pqos_mon_event event,
+                      int region_num)
+{
+        int idx;
+
+        ASSERT(rec != NULL);
+
+        if ((rec->group->event & event) == 0)
+                return MONITOR_RECORD_MISSING;
+
+        if (region_num >= 0) {
+                idx = record_region_idx(rec->group, region_num);
+                if (event != PQOS_MON_EVENT_TMEM_BW || idx < 0 ||
+                    idx >= PQOS_MAX_MEM_REGIONS)
+                        return MONITOR_RECORD_MISSING;
+
+                return rec->region_raw[idx];
+        }
+
+        idx = record_event_idx(event);
+        if (idx < 0)
+                return MONITOR_RECORD_MISSING;
 
-        return value;
+        return rec->raw[idx];
 }
 
 int
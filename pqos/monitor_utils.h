@@ -36,6 +36,8 @@
 
 #include "pqos.h"
 
+#include <stdint.h>
+
 /**
  * @brief Function to safely translate an unsigned int
  *        value to a string without memory allocation
@@ -62,30 +64,93 @@ int monitor_utils_uinttostr(char *buf, const int buf_len, const unsigned val);
 int
 monitor_utils_uinttohexstr(char *buf, const int buf_len, const unsigned val);
 
+/** Number of events with values in monitoring record */
+#define MONITOR_RECORD_NUM_EVENTS 17
+
+/** Raw value not available */
+#define MONITOR_RECORD_MISSING UINT64_MAX
+
+/**
+ * Values of monitoring group taken after a poll
+ *
+ * Values to be displayed, rates included, are resolved when the record is
+ * taken, so rows are formatted without access to library state of the
+ * group. Only data set at monitoring start is used from \a group: context,
+ * events, cores, channels, tasks and memory regions.
+ */
+struct monitor_record {
+        const struct pqos_mon_data *group; /**< monitoring group */
+        unsigned idx;       /**< group index, see monitor_get_group() */
+        uint64_t timestamp; /**< wall clock time of the poll in ns */
+        uint64_t interval;  /**< time between counter reads in ns */
+        /** values to be displayed, 0 if not available */
+        double value[MONITOR_RECORD_NUM_EVENTS];
+        /**
+         * occupancy, counter delta or telemetry value as IEEE 754 bits,
+         * MONITOR_RECORD_MISSING if not available
+         */
+        uint64_t raw[MONITOR_RECORD_NUM_EVENTS];
+        double region_value[PQOS_MAX_MEM_REGIONS]; /**< MBT of regions */
+        uint64_t region_raw[PQOS_MAX_MEM_REGIONS]; /**< MBT delta of regions */
+        uint64_t ipc_retired;  /**< instructions retired in the interval */
+        uint64_t ipc_unhalted; /**< unhalted cycles in the interval */
+        unsigned missed;  /**< sampling deadlines missed so far */
+        unsigned dropped; /**< intervals dropped so far */
+};
+
+/**
+ * @brief Takes monitoring record of a group
+ *
+ * To be called after the group is polled.
+ *
+ * @param [in] group monitoring group
+ * @param [in] idx group index
+ * @param [in] region_mode values are read per memory region (MMIO)
+ * @param [out] rec monitoring record
+ */
+void monitor_utils_get_record(const struct pqos_mon_data *group,
+                              const unsigned idx,
+                              const int region_mode,
+                              struct monitor_record *rec);
+
 /**
  * @brief Get monitoring value to be displayed for the event
  *
- * @param data monitoring data
+ * @param rec monitoring record
  * @param event monitoring event ID
  *
  * @return value to be displayed
  */
-double monitor_utils_get_value(const struct pqos_mon_data *const data,
+double monitor_utils_get_value(const struct monitor_record *rec,
                                const enum pqos_mon_event event);
 
 /**
  * @brief Get memory region monitoring value to be displayed for the event
  *
- * @param data monitoring data
+ * @param rec monitoring record
  * @param event monitoring event ID
- * @param region_num memory region number to be monitoring
+ * @param region_num memory region number, -1 for value of all regions
  *
  * @return value to be displayed
  */
-double monitor_utils_get_region_value(const struct pqos_mon_data *const data,
+double monitor_utils_get_region_value(const struct monitor_record *rec,
                                       const enum pqos_mon_event event,
                                       int region_num);
 
+/**
+ * @brief Get raw monitoring value of the event
+ *
+ * @param rec monitoring record
+ * @param event monitoring event ID
+ * @param region_num memory region number, -1 for value of all regions
+ *
+ * @return raw value, see struct monitor_record
+ * @retval MONITOR_RECORD_MISSING if not available
+ */
+uint64_t monitor_utils_get_raw(const struct monitor_record *rec,
+                               const enum pqos_mon_event event,
+                               int region_num);
+
 /**
  * @brief Gets total l3 cache value
  *
@@ -117,8 +117,9 @@ fillin_xml_column(const char *const format,
 void
 monitor_xml_row(FILE *fp,
                 const char *timestamp,
-                const struct pqos_mon_data *mon_data)
+                const struct monitor_record *rec)
 {
+        const struct pqos_mon_data *mon_data = rec->group;
         enum pqos_mon_event events = monitor_get_events();
         enum monitor_llc_format format = monitor_get_llc_format();
         const size_t sz_data = 256;
@@ -130,7 +131,7 @@ monitor_xml_row(FILE *fp,
 
         ASSERT(fp != NULL);
         ASSERT(timestamp != NULL);
-        ASSERT(mon_data != NULL);
+        ASSERT(rec != NULL);
 
         switch (format) {
         case LLC_FORMAT_KILOBYTES:
@@ -212,7 +213,7 @@ monitor_xml_row(FILE *fp,
 
         for (i = 0; i < DIM(output); i++) {
                 double value =
-                    monitor_utils_get_value(mon_data, output[i].event);
+                    monitor_utils_get_value(rec, output[i].event);
 
                 offset += fillin_xml_column(
                     output[i].format, value, data + offset, sz_data - offset,
@@ -251,6 +252,11 @@ monitor_xml_row(FILE *fp,
                         "\t<socket>%s</socket>\n"
                         "%s",
                         (char *)mon_data->context, data);
+        if (monitor_rt_mode())
+                fprintf(fp,
+                        "\t<missed_deadlines>%u</missed_deadlines>\n"
+                        "\t<dropped_intervals>%u</dropped_intervals>\n",
+                        rec->missed, rec->dropped);
         fprintf(fp, "%s\n", xml_child_close);
 }
 
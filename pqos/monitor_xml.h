@@ -34,6 +34,7 @@
 #ifndef __MONITOR_XML_H__
 #define __MONITOR_XML_H__
 
+#include "monitor_utils.h"
 #include "pqos.h"
 
 /**
@@ -62,11 +63,11 @@ void monitor_xml_header(FILE *fp,
  *
  * @param fp file descriptor
  * @param [in] timestamp data timestamp
- * @param [in] data monitoring data
+ * @param [in] rec monitoring record
  */
 void monitor_xml_row(FILE *fp,
                      const char *timestamp,
-                     const struct pqos_mon_data *data);
+                     const struct monitor_record *rec);
 
 /**
  * @brief Print xml footer
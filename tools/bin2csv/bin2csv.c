@@ -0,0 +1,476 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Converts binary output of pqos monitoring (-u bin) into CSV
+ *
+ * File format is described in pqos/monitor_bin.h
+ */
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BIN_MAGIC   "PQOSBIN"
+#define BIN_VERSION 3
+/** Oldest supported version, interval records without sampling problems */
+#define BIN_VERSION_MIN 2
+#define BIN_MISSING UINT64_MAX
+/** Data sampled in real-time mode, see MONITOR_BIN_FLAG_RT */
+#define BIN_FLAG_RT 0x1
+
+/**
+ * Conversion of stored column values, see enum monitor_bin_kind
+ */
+enum kind {
+        KIND_VALUE = 0,
+        KIND_RATE = 1,
+        KIND_RATIO = 2,
+        KIND_FLOAT = 3
+};
+
+struct column {
+        char *name;
+        char *unit;
+        unsigned kind;
+        double scale;
+        unsigned precision;
+        unsigned slot; /**< first value slot of the column in group data */
+};
+
+struct header {
+        unsigned version;
+        unsigned flags;
+        unsigned interval;
+        unsigned num_columns;
+        unsigned num_groups;
+        unsigned num_slots; /**< interval and value slots of a group */
+        size_t rec_hdr_size; /**< interval record fields before group data */
+        char *id_name;
+        struct column *columns;
+        char **groups;
+};
+
+static uint32_t
+get_u32(const uint8_t *p)
+{
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+               (uint32_t)p[3] << 24;
+}
+
+static uint64_t
+get_u64(const uint8_t *p)
+{
+        uint64_t val = 0;
+        int i;
+
+        for (i = 7; i >= 0; i--)
+                val = (val << 8) | p[i];
+
+        return val;
+}
+
+static double
+get_f64(const uint8_t *p)
+{
+        const uint64_t raw = get_u64(p);
+        double val;
+
+        memcpy(&val, &raw, sizeof(val));
+
+        return val;
+}
+
+static int
+read_uint(FILE *fp, const unsigned size, unsigned *val)
+{
+        uint8_t b[4];
+        unsigned i;
+
+        if (size > sizeof(b) || fread(b, 1, size, fp) != size)
+                return -1;
+
+        *val = 0;
+        for (i = size; i > 0; i--)
+                *val = (*val << 8) | b[i - 1];
+
+        return 0;
+}
+
+static int
+read_f64(FILE *fp, double *val)
+{
+        uint8_t b[8];
+
+        if (fread(b, 1, sizeof(b), fp) != sizeof(b))
+                return -1;
+
+        *val = get_f64(b);
+
+        return 0;
+}
+
+static int
+read_str(FILE *fp, char **str)
+{
+        unsigned len;
+
+        if (read_uint(fp, 2, &len) != 0)
+                return -1;
+
+        *str = malloc(len + 1);
+        if (*str == NULL)
+                return -1;
+
+        if (fread(*str, 1, len, fp) != len)
+                return -1;
+        (*str)[len] = '\0';
+
+        return 0;
+}
+
+/**
+ * @brief Reads and validates file header
+ *
+ * @param fp input file
+ * @param [out] hdr file header
+ *
+ * @return Operation status
+ * @retval 0 OK
+ * @retval -1 error
+ */
+static int
+read_header(FILE *fp, struct header *hdr)
+{
+        char magic[sizeof(BIN_MAGIC)];
+        unsigned i;
+
+        if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic) ||
+            memcmp(magic, BIN_MAGIC, sizeof(magic)) != 0) {
+                fprintf(stderr, "Not a pqos binary monitoring file\n");
+                return -1;
+        }
+
+        if (read_uint(fp, 2, &hdr->version) != 0 ||
+            read_uint(fp, 2, &hdr->flags) != 0 ||
+            read_uint(fp, 4, &hdr->interval) != 0 ||
+            read_uint(fp, 4, &hdr->num_columns) != 0 ||
+            read_uint(fp, 4, &hdr->num_groups) != 0)
+                goto error_trunc;
+
+        if (hdr->version < BIN_VERSION_MIN || hdr->version > BIN_VERSION) {
+                fprintf(stderr, "Unsupported file version %u\n",
+                        hdr->version);
+                return -1;
+        }
+
+        /* timestamp, since version 3 followed by missed and dropped */
+        hdr->rec_hdr_size = sizeof(uint64_t);
+        if (hdr->version >= 3)
+                hdr->rec_hdr_size += 2 * sizeof(uint32_t);
+
+        if (read_str(fp, &hdr->id_name) != 0)
+                goto error_trunc;
+
+        hdr->columns = calloc(hdr->num_columns, sizeof(hdr->columns[0]));
+        hdr->groups = calloc(hdr->num_groups, sizeof(hdr->groups[0]));
+        if ((hdr->num_columns > 0 && hdr->columns == NULL) ||
+            (hdr->num_groups > 0 && hdr->groups == NULL)) {
+                fprintf(stderr, "Memory allocation error\n");
+                return -1;
+        }
+
+        for (i = 0; i < hdr->num_columns; i++) {
+                struct column *col = &hdr->columns[i];
+
+                if (read_str(fp, &col->name) != 0 ||
+                    read_str(fp, &col->unit) != 0 ||
+                    read_uint(fp, 2, &col->kind) != 0 ||
+                    read_f64(fp, &col->scale) != 0 ||
+                    read_uint(fp, 2, &col->precision) != 0)
+                        goto error_trunc;
+
+                if (col->kind > KIND_FLOAT) {
+                        fprintf(stderr, "Unsupported kind %u of column %s\n",
+                                col->kind, col->name);
+                        return -1;
+                }
+        }
+
+        /* first slot of group data holds the interval */
+        hdr->num_slots = 1;
+        for (i = 0; i < hdr->num_columns; i++) {
+                hdr->columns[i].slot = hdr->num_slots;
+                hdr->num_slots += hdr->columns[i].kind == KIND_RATIO ? 2 : 1;
+        }
+
+        for (i = 0; i < hdr->num_groups; i++)
+                if (read_str(fp, &hdr->groups[i]) != 0)
+                        goto error_trunc;
+
+        return 0;
+
+error_trunc:
+        fprintf(stderr, "Truncated file header\n");
+        return -1;
+}
+
+static void
+free_header(struct header *hdr)
+{
+        unsigned i;
+
+        if (hdr->columns != NULL)
+                for (i = 0; i < hdr->num_columns; i++) {
+                        free(hdr->columns[i].name);
+                        free(hdr->columns[i].unit);
+                }
+        if (hdr->groups != NULL)
+                for (i = 0; i < hdr->num_groups; i++)
+                        free(hdr->groups[i]);
+
+        free(hdr->columns);
+        free(hdr->groups);
+        free(hdr->id_name);
+}
+
+static void
+print_csv_header(FILE *out, const struct header *hdr)
+{
+        unsigned i;
+
+        fprintf(out, "Time,%s", hdr->id_name);
+        for (i = 0; i < hdr->num_columns; i++) {
+                const struct column *col = &hdr->columns[i];
+
+                if (col->unit[0] != '\0')
+                        fprintf(out, ",%s[%s]", col->name, col->unit);
+                else
+                        fprintf(out, ",%s", col->name);
+        }
+        if (hdr->flags & BIN_FLAG_RT)
+                fprintf(out, ",Missed,Dropped");
+        fputs("\n", out);
+}
+
+/**
+ * @brief Converts stored column value into column unit
+ *
+ * @param [in] col column descriptor
+ * @param [in] data encoded group data
+ * @param [out] val converted value
+ *
+ * @return Operation status
+ * @retval 0 OK
+ * @retval -1 value is missing
+ */
+static int
+get_value(const struct column *col, const uint8_t *data, double *val)
+{
+        const uint64_t interval = get_u64(data);
+        const uint8_t *slot = data + (size_t)col->slot * sizeof(uint64_t);
+        const uint64_t raw = get_u64(slot);
+        uint64_t den;
+
+        if (raw == BIN_MISSING)
+                return -1;
+
+        switch (col->kind) {
+        case KIND_RATE:
+                if (interval == 0)
+                        return -1;
+                *val = (double)raw * col->scale * 1e9 / (double)interval;
+                break;
+        case KIND_RATIO:
+                den = get_u64(slot + sizeof(uint64_t));
+                if (den == BIN_MISSING)
+                        return -1;
+                *val = den != 0 ? (double)raw * col->scale / (double)den : 0.0;
+                break;
+        case KIND_FLOAT:
+                *val = get_f64(slot) * col->scale;
+                break;
+        default:
+                *val = (double)raw * col->scale;
+                break;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Prints single interval record as CSV rows
+ *
+ * Groups not output in the interval are skipped.
+ *
+ * @param out output file
+ * @param [in] hdr file header
+ * @param [in] rec encoded interval record
+ */
+static void
+print_csv_record(FILE *out, const struct header *hdr, const uint8_t *rec)
+{
+        const uint64_t ts = get_u64(rec);
+        const time_t sec = (time_t)(ts / 1000000000ULL);
+        const unsigned msec = (unsigned)(ts % 1000000000ULL / 1000000ULL);
+        unsigned missed = 0;
+        unsigned dropped = 0;
+        char time_str[64] = "error";
+        struct tm tm;
+        unsigned i, j;
+
+        if (localtime_r(&sec, &tm) != NULL)
+                strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S",
+                         &tm);
+
+        if (hdr->version >= 3) {
+                missed = get_u32(rec + sizeof(uint64_t));
+                dropped = get_u32(rec + sizeof(uint64_t) + sizeof(uint32_t));
+        }
+
+        rec += hdr->rec_hdr_size;
+        for (i = 0; i < hdr->num_groups; i++) {
+                const uint8_t *data =
+                    rec + (size_t)i * hdr->num_slots * sizeof(uint64_t);
+
+                /* group not output in the interval */
+                if (get_u64(data) == BIN_MISSING)
+                        continue;
+
+                fprintf(out, "%s.%03u,\"%s\"", time_str, msec, hdr->groups[i]);
+                for (j = 0; j < hdr->num_columns; j++) {
+                        const struct column *col = &hdr->columns[j];
+                        double val;
+
+                        if (get_value(col, data, &val) != 0)
+                                fputs(",", out);
+                        else
+                                fprintf(out, ",%.*f", (int)col->precision,
+                                        val);
+                }
+                if (hdr->flags & BIN_FLAG_RT)
+                        fprintf(out, ",%u,%u", missed, dropped);
+                fputs("\n", out);
+        }
+}
+
+static void
+usage(const char *app)
+{
+        printf("Usage: %s [-o FILE] [INPUT]\n"
+               "Converts pqos binary monitoring output into CSV.\n"
+               "  -o FILE  write CSV into FILE, the default is stdout\n"
+               "  -h       show this help\n"
+               "INPUT is a file produced by 'pqos -u bin', the default is "
+               "stdin\n",
+               app);
+}
+
+int
+main(int argc, char **argv)
+{
+        FILE *in = stdin;
+        FILE *out = stdout;
+        struct header hdr;
+        uint8_t *rec = NULL;
+        size_t rec_size;
+        size_t len;
+        int ret = EXIT_FAILURE;
+        int opt;
+
+        memset(&hdr, 0, sizeof(hdr));
+
+        while ((opt = getopt(argc, argv, "ho:")) != -1) {
+                switch (opt) {
+                case 'o':
+                        out = fopen(optarg, "w");
+                        if (out == NULL) {
+                                perror(optarg);
+                                return EXIT_FAILURE;
+                        }
+                        break;
+                case 'h':
+                        usage(argv[0]);
+                        return EXIT_SUCCESS;
+                default:
+                        usage(argv[0]);
+                        return EXIT_FAILURE;
+                }
+        }
+
+        if (optind < argc && strcmp(argv[optind], "-") != 0) {
+                in = fopen(argv[optind], "rb");
+                if (in == NULL) {
+                        perror(argv[optind]);
+                        goto exit;
+                }
+        }
+
+        if (read_header(in, &hdr) != 0)
+                goto exit;
+
+        rec_size = hdr.rec_hdr_size + (size_t)hdr.num_groups *
+                                           hdr.num_slots * sizeof(uint64_t);
+        rec = malloc(rec_size);
+        if (rec == NULL) {
+                fprintf(stderr, "Memory allocation error\n");
+                goto exit;
+        }
+
+        print_csv_header(out, &hdr);
+
+        while ((len = fread(rec, 1, rec_size, in)) == rec_size)
+                print_csv_record(out, &hdr, rec);
+
+        if (len != 0)
+                fprintf(stderr, "Truncated record at the end of file "
+                                "ignored\n");
+        if (ferror(in))
+                perror("Read error");
+        else
+                ret = EXIT_SUCCESS;
+
+exit:
+        free(rec);
+        free_header(&hdr);
+        if (in != NULL && in != stdin)
+                fclose(in);
+        if (out != stdout && fclose(out) != 0) {
+                perror("Write error");
+                ret = EXIT_FAILURE;
+        }
+
+        return ret;
+}
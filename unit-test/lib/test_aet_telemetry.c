@@ -46,7 +46,7 @@ _pqos_check_init(const int expect)
 static void
 expect_init_ok(void)
 {
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_value(__wrap__pqos_check_init, expect, 1);
         will_return(__wrap__pqos_check_init, PQOS_RETVAL_OK);
         expect_function_call(__wrap_lock_release);
@@ -0,0 +1,412 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "alloc_txn.h"
+#include "allocation.h"
+#include "mock_resctrl.h"
+#include "mock_resctrl_alloc.h"
+#include "os_allocation.h"
+#include "resctrl_schemata.h"
+#include "test.h"
+
+/* ======== mock ======== */
+
+/* L3 CAT definition of resource id 0 read from schemata file */
+static struct pqos_l3ca schemata_l3ca;
+
+int
+__wrap_resctrl_alloc_schemata_read(const unsigned class_id,
+                                   struct resctrl_schemata *schemata)
+{
+        check_expected(class_id);
+
+        if (schemata_l3ca.u.ways_mask != 0)
+                assert_int_equal(
+                    resctrl_schemata_l3ca_set(schemata, 0, &schemata_l3ca),
+                    PQOS_RETVAL_OK);
+
+        return mock_type(int);
+}
+
+/* ======== pqos_alloc_txn staging ======== */
+
+static void
+test_alloc_txn_param(void **state __attribute__((unused)))
+{
+        struct pqos_alloc_txn *txn;
+        struct pqos_l3ca l3ca;
+        struct pqos_mba mba;
+        unsigned class_ids[4];
+        unsigned num;
+        int ret;
+
+        memset(&l3ca, 0, sizeof(l3ca));
+        memset(&mba, 0, sizeof(mba));
+
+        ret = pqos_alloc_txn_begin(NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        ret = pqos_alloc_txn_begin(&txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_non_null(txn);
+
+        ret = pqos_alloc_txn_l3ca_set(NULL, 0, 1, &l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 0, &l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 1, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_alloc_txn_l2ca_set(txn, 0, 1, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_alloc_txn_mba_set(txn, 0, 0, &mba);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_alloc_txn_commit(NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_alloc_txn_get_failed(txn, 0, &num, class_ids);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_alloc_txn_get_failed(txn, 4, NULL, class_ids);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        /* transaction accepts no definitions once committed */
+        txn->committed = 1;
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 1, &l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_alloc_txn_commit(txn);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        pqos_alloc_txn_end(txn);
+        pqos_alloc_txn_end(NULL);
+}
+
+static void
+test_alloc_txn_stage(void **state __attribute__((unused)))
+{
+        struct pqos_alloc_txn *txn;
+        struct pqos_l3ca l3ca[2];
+        struct pqos_mba mba;
+        unsigned *classes;
+        unsigned num = 0;
+        int ret;
+
+        memset(l3ca, 0, sizeof(l3ca));
+        memset(&mba, 0, sizeof(mba));
+
+        ret = pqos_alloc_txn_begin(&txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        classes = alloc_txn_classes(txn, &num);
+        assert_null(classes);
+
+        l3ca[0].class_id = 2;
+        l3ca[0].u.ways_mask = 0xf;
+        l3ca[1].class_id = 1;
+        l3ca[1].u.ways_mask = 0xf0;
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 2, l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(txn->num_entries, 2);
+
+        /* same class and resource id replaces staged definition */
+        l3ca[0].u.ways_mask = 0x3;
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 1, l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(txn->num_entries, 2);
+        assert_int_equal(txn->entries[0].u.l3ca.u.ways_mask, 0x3);
+
+        /* other resource id */
+        ret = pqos_alloc_txn_l3ca_set(txn, 1, 1, l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(txn->num_entries, 3);
+
+        mba.class_id = 2;
+        mba.mb_max = 50;
+        mba.smba = 1;
+        ret = pqos_alloc_txn_mba_set(txn, 0, 1, &mba);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(txn->num_entries, 4);
+        assert_int_equal(txn->entries[3].technology, PQOS_TECHNOLOGY_SMBA);
+
+        classes = alloc_txn_classes(txn, &num);
+        assert_non_null(classes);
+        assert_int_equal(num, 2);
+        assert_int_equal(classes[0], 1);
+        assert_int_equal(classes[1], 2);
+        free(classes);
+
+        pqos_alloc_txn_end(txn);
+}
+
+static void
+test_alloc_txn_failed(void **state __attribute__((unused)))
+{
+        struct pqos_alloc_txn *txn;
+        unsigned class_ids[4];
+        unsigned num = 0;
+        int ret;
+
+        ret = pqos_alloc_txn_begin(&txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = pqos_alloc_txn_get_failed(txn, 4, &num, class_ids);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 0);
+
+        assert_int_equal(alloc_txn_failed_add(txn, 3), PQOS_RETVAL_OK);
+        assert_int_equal(alloc_txn_failed_add(txn, 1), PQOS_RETVAL_OK);
+        assert_int_equal(alloc_txn_failed_add(txn, 3), PQOS_RETVAL_OK);
+
+        ret = pqos_alloc_txn_get_failed(txn, 1, &num, class_ids);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        ret = pqos_alloc_txn_get_failed(txn, 4, &num, class_ids);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 2);
+        assert_int_equal(class_ids[0], 3);
+        assert_int_equal(class_ids[1], 1);
+
+        pqos_alloc_txn_end(txn);
+}
+
+/* ======== os_alloc_txn_commit ======== */
+
+static void
+test_os_alloc_txn_commit(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_alloc_txn *txn;
+        struct pqos_l3ca l3ca[2];
+        struct pqos_mba mba;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+        memset(&schemata_l3ca, 0, sizeof(schemata_l3ca));
+        memset(l3ca, 0, sizeof(l3ca));
+        memset(&mba, 0, sizeof(mba));
+
+        ret = pqos_alloc_txn_begin(&txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        l3ca[0].class_id = 1;
+        l3ca[0].u.ways_mask = 0xf;
+        l3ca[1].class_id = 2;
+        l3ca[1].u.ways_mask = 0xf0;
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 2, l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_alloc_txn_l3ca_set(txn, 1, 1, l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        mba.class_id = 1;
+        mba.mb_max = 44;
+        ret = pqos_alloc_txn_mba_set(txn, 1, 1, &mba);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        will_return(__wrap_resctrl_lock_exclusive, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_lock_release, PQOS_RETVAL_OK);
+
+        /* each class of service is read and written once */
+        expect_value(__wrap_resctrl_alloc_schemata_read, class_id, 1);
+        will_return(__wrap_resctrl_alloc_schemata_read, PQOS_RETVAL_OK);
+        expect_value(__wrap_resctrl_alloc_schemata_write, class_id, 1);
+        expect_value(__wrap_resctrl_alloc_schemata_write, technology,
+                     PQOS_TECHNOLOGY_L3CA | PQOS_TECHNOLOGY_MBA);
+        will_return(__wrap_resctrl_alloc_schemata_write, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_resctrl_alloc_schemata_read, class_id, 2);
+        will_return(__wrap_resctrl_alloc_schemata_read, PQOS_RETVAL_OK);
+        expect_value(__wrap_resctrl_alloc_schemata_write, class_id, 2);
+        expect_value(__wrap_resctrl_alloc_schemata_write, technology,
+                     PQOS_TECHNOLOGY_L3CA);
+        will_return(__wrap_resctrl_alloc_schemata_write, PQOS_RETVAL_OK);
+
+        ret = os_alloc_txn_commit(txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(txn->num_failed, 0);
+
+        /* MBA rate rounded to throttling step */
+        assert_int_equal(txn->entries[3].u.mba.mb_max, 40);
+
+        pqos_alloc_txn_end(txn);
+}
+
+static void
+test_os_alloc_txn_commit_unchanged(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_alloc_txn *txn;
+        struct pqos_l3ca l3ca;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+        memset(&l3ca, 0, sizeof(l3ca));
+
+        l3ca.class_id = 1;
+        l3ca.u.ways_mask = 0xf;
+        schemata_l3ca = l3ca;
+
+        ret = pqos_alloc_txn_begin(&txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 1, &l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        will_return(__wrap_resctrl_lock_exclusive, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_lock_release, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_resctrl_alloc_schemata_read, class_id, 1);
+        will_return(__wrap_resctrl_alloc_schemata_read, PQOS_RETVAL_OK);
+
+        ret = os_alloc_txn_commit(txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        memset(&schemata_l3ca, 0, sizeof(schemata_l3ca));
+        pqos_alloc_txn_end(txn);
+}
+
+static void
+test_os_alloc_txn_commit_failed(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_alloc_txn *txn;
+        struct pqos_l3ca l3ca[2];
+        unsigned class_ids[2];
+        unsigned num = 0;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+        memset(&schemata_l3ca, 0, sizeof(schemata_l3ca));
+        memset(l3ca, 0, sizeof(l3ca));
+
+        l3ca[0].class_id = 1;
+        l3ca[0].u.ways_mask = 0xf;
+        l3ca[1].class_id = 2;
+        l3ca[1].u.ways_mask = 0xf0;
+
+        ret = pqos_alloc_txn_begin(&txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 2, l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        will_return(__wrap_resctrl_lock_exclusive, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_lock_release, PQOS_RETVAL_OK);
+
+        /* failure of one class does not stop the others */
+        expect_value(__wrap_resctrl_alloc_schemata_read, class_id, 1);
+        will_return(__wrap_resctrl_alloc_schemata_read, PQOS_RETVAL_OK);
+        expect_value(__wrap_resctrl_alloc_schemata_write, class_id, 1);
+        expect_value(__wrap_resctrl_alloc_schemata_write, technology,
+                     PQOS_TECHNOLOGY_L3CA);
+        will_return(__wrap_resctrl_alloc_schemata_write, PQOS_RETVAL_ERROR);
+
+        expect_value(__wrap_resctrl_alloc_schemata_read, class_id, 2);
+        will_return(__wrap_resctrl_alloc_schemata_read, PQOS_RETVAL_OK);
+        expect_value(__wrap_resctrl_alloc_schemata_write, class_id, 2);
+        expect_value(__wrap_resctrl_alloc_schemata_write, technology,
+                     PQOS_TECHNOLOGY_L3CA);
+        will_return(__wrap_resctrl_alloc_schemata_write, PQOS_RETVAL_OK);
+
+        ret = os_alloc_txn_commit(txn);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        ret = pqos_alloc_txn_get_failed(txn, 2, &num, class_ids);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 1);
+        assert_int_equal(class_ids[0], 1);
+
+        pqos_alloc_txn_end(txn);
+}
+
+static void
+test_os_alloc_txn_commit_param(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_alloc_txn *txn;
+        struct pqos_l3ca l3ca;
+        struct pqos_mba mba;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+        memset(&l3ca, 0, sizeof(l3ca));
+        memset(&mba, 0, sizeof(mba));
+
+        /* nothing is written if any definition is invalid */
+        l3ca.class_id = 1;
+        l3ca.u.ways_mask = 0xf;
+        mba.class_id = 10;
+        mba.mb_max = 50;
+
+        ret = pqos_alloc_txn_begin(&txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_alloc_txn_l3ca_set(txn, 0, 1, &l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_alloc_txn_mba_set(txn, 0, 1, &mba);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = os_alloc_txn_commit(txn);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        pqos_alloc_txn_end(txn);
+
+        /* invalid resource id */
+        ret = pqos_alloc_txn_begin(&txn);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_alloc_txn_l3ca_set(txn, 5, 1, &l3ca);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = os_alloc_txn_commit(txn);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        pqos_alloc_txn_end(txn);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_alloc_txn_param),
+            cmocka_unit_test(test_alloc_txn_stage),
+            cmocka_unit_test(test_alloc_txn_failed),
+        };
+
+        const struct CMUnitTest tests_all[] = {
+            cmocka_unit_test(test_os_alloc_txn_commit),
+            cmocka_unit_test(test_os_alloc_txn_commit_unchanged),
+            cmocka_unit_test(test_os_alloc_txn_commit_failed),
+            cmocka_unit_test(test_os_alloc_txn_commit_param),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+        result += cmocka_run_group_tests(tests_all, test_init_all, test_fini);
+
+        return result;
+}
@@ -35,6 +35,7 @@
 #include "mock_cpuinfo.h"
 #include "mock_hw_allocation.h"
 #include "mock_hw_monitoring.h"
+#include "mock_msr_shadow.h"
 #include "mock_os_allocation.h"
 #include "mock_os_monitoring.h"
 #include "monitoring.h"
@@ -56,6 +57,28 @@
                 expect_function_call(__wrap_lock_release);                     \
         } while (0)
 
+#define wrap_check_init_shared(value, ret)                                     \
+        do {                                                                   \
+                /* _pqos_check_init */                                         \
+                expect_value(__wrap__pqos_check_init, expect, value);          \
+                will_return(__wrap__pqos_check_init, ret);                     \
+                /* lock_get_shared */                                          \
+                expect_function_call(__wrap_lock_get_shared);                  \
+                /* lock_release */                                             \
+                expect_function_call(__wrap_lock_release);                     \
+        } while (0)
+
+#define wrap_check_init_alloc(value, ret)                                      \
+        do {                                                                   \
+                /* _pqos_check_init */                                         \
+                expect_value(__wrap__pqos_check_init, expect, value);          \
+                will_return(__wrap__pqos_check_init, ret);                     \
+                /* lock_alloc_get */                                           \
+                expect_function_call(__wrap_lock_alloc_get);                   \
+                /* lock_alloc_release */                                       \
+                expect_function_call(__wrap_lock_alloc_release);               \
+        } while (0)
+
 static int
 setup_hw(void **state __attribute__((unused)))
 {
@@ -125,7 +148,7 @@ test_pqos_alloc_assoc_set_init(void **state __attribute__((unused)))
 {
         int ret;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assoc_set(0, 0);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -137,7 +160,7 @@ test_pqos_alloc_assoc_set_hw(void **state __attribute__((unused)))
 {
         int ret;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_alloc_assoc_set, lcore, 0);
         expect_value(__wrap_hw_alloc_assoc_set, class_id, 0);
@@ -154,7 +177,7 @@ test_pqos_alloc_assoc_set_os(void **state __attribute__((unused)))
 {
         int ret;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_alloc_assoc_set, lcore, 0);
         expect_value(__wrap_os_alloc_assoc_set, class_id, 0);
@@ -173,7 +196,7 @@ test_pqos_alloc_assoc_get_init(void **state __attribute__((unused)))
         int ret;
         unsigned class_id;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assoc_get(0, &class_id);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -194,7 +217,7 @@ test_pqos_alloc_assoc_get_hw(void **state __attribute__((unused)))
         int ret;
         unsigned id;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         /* hw_alloc_assoc_get */
         expect_value(__wrap_hw_alloc_assoc_get, lcore, 0);
@@ -213,7 +236,7 @@ test_pqos_alloc_assoc_get_os(void **state __attribute__((unused)))
         int ret;
         unsigned id;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_alloc_assoc_get, lcore, 0);
         expect_value(__wrap_os_alloc_assoc_get, class_id, &id);
@@ -225,6 +248,65 @@ test_pqos_alloc_assoc_get_os(void **state __attribute__((unused)))
         assert_int_equal(id, 5);
 }
 
+/* ======== pqos_assoc_revalidate ======== */
+
+static void
+test_pqos_assoc_revalidate_init(void **state __attribute__((unused)))
+{
+        int ret;
+        unsigned num;
+
+        wrap_check_init(1, PQOS_RETVAL_INIT);
+
+        ret = pqos_assoc_revalidate(0, &num, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_INIT);
+}
+
+static void
+test_pqos_assoc_revalidate_param(void **state __attribute__((unused)))
+{
+        int ret;
+        unsigned num;
+
+        ret = pqos_assoc_revalidate(0, NULL, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        ret = pqos_assoc_revalidate(1, &num, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+}
+
+static void
+test_pqos_assoc_revalidate_hw(void **state __attribute__((unused)))
+{
+        int ret;
+        unsigned num;
+        unsigned cores[2];
+
+        wrap_check_init(1, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_msr_shadow_revalidate, max_cores, 2);
+        expect_value(__wrap_msr_shadow_revalidate, num_cores, &num);
+        expect_value(__wrap_msr_shadow_revalidate, cores, cores);
+        will_return(__wrap_msr_shadow_revalidate, PQOS_RETVAL_OK);
+        will_return(__wrap_msr_shadow_revalidate, 1);
+
+        ret = pqos_assoc_revalidate(2, &num, cores);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 1);
+}
+
+static void
+test_pqos_assoc_revalidate_os(void **state __attribute__((unused)))
+{
+        int ret;
+        unsigned num;
+
+        wrap_check_init(1, PQOS_RETVAL_OK);
+
+        ret = pqos_assoc_revalidate(0, &num, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+}
+
 /* ======== pqos_alloc_assoc_set_pid ======== */
 
 static void
@@ -232,7 +314,7 @@ test_pqos_alloc_assoc_set_pid_init(void **state __attribute__((unused)))
 {
         int ret;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assoc_set_pid(0, 1);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -243,7 +325,7 @@ test_pqos_alloc_assoc_set_pid_hw(void **state __attribute__((unused)))
 {
         int ret;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_alloc_assoc_set_pid(1, 2);
         assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
@@ -255,7 +337,7 @@ test_pqos_alloc_assoc_set_pid_os(void **state __attribute__((unused)))
 {
         int ret;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_alloc_assoc_set_pid, task, 1);
         expect_value(__wrap_os_alloc_assoc_set_pid, class_id, 2);
@@ -274,7 +356,7 @@ test_pqos_alloc_assoc_get_pid_init(void **state __attribute__((unused)))
         int ret;
         unsigned id;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assoc_get_pid(1, &id);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -296,7 +378,7 @@ test_pqos_alloc_assoc_get_pid_hw(void **state __attribute__((unused)))
         int ret;
         unsigned id;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_alloc_assoc_get_pid(1, &id);
         assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
@@ -309,7 +391,7 @@ test_pqos_alloc_assoc_get_pid_os(void **state __attribute__((unused)))
         int ret;
         unsigned id;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_alloc_assoc_get_pid, task, 1);
         expect_value(__wrap_os_alloc_assoc_get_pid, class_id, &id);
@@ -331,17 +413,17 @@ test_pqos_alloc_assign_init(void **state __attribute__((unused)))
         unsigned id;
         unsigned core[1];
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assign(1 << PQOS_CAP_TYPE_L3CA, core, 1, &id);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assign(1 << PQOS_CAP_TYPE_L2CA, core, 1, &id);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assign(1 << PQOS_CAP_TYPE_MBA, core, 1, &id);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -398,7 +480,7 @@ test_pqos_alloc_assign_hw(void **state __attribute__((unused)))
         unsigned core_num = 1;
         unsigned technology = 1 << PQOS_CAP_TYPE_L3CA;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_alloc_assign, technology, technology);
         expect_value(__wrap_hw_alloc_assign, core_array, core_array);
@@ -421,7 +503,7 @@ test_pqos_alloc_assign_os(void **state __attribute__((unused)))
         unsigned core_num = 1;
         unsigned technology = 1 << PQOS_CAP_TYPE_L3CA;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_alloc_assign, technology, technology);
         expect_value(__wrap_os_alloc_assign, core_array, core_array);
@@ -444,7 +526,7 @@ test_pqos_alloc_release_init(void **state __attribute__((unused)))
         unsigned core_array[1];
         unsigned core_num = 1;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_release(core_array, core_num);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -471,7 +553,7 @@ test_pqos_alloc_release_os(void **state __attribute__((unused)))
         unsigned core_array[1];
         unsigned core_num = 1;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_alloc_release, core_array, core_array);
         expect_value(__wrap_os_alloc_release, core_num, core_num);
@@ -488,7 +570,7 @@ test_pqos_alloc_release_hw(void **state __attribute__((unused)))
         unsigned core_array[1];
         unsigned core_num = 1;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_alloc_release, core_array, core_array);
         expect_value(__wrap_hw_alloc_release, core_num, core_num);
@@ -509,7 +591,7 @@ test_pqos_alloc_assign_pid_init(void **state __attribute__((unused)))
         pid_t task_array[1];
         unsigned task_num = 1;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret =
             pqos_alloc_assign_pid(technology, task_array, task_num, &class_id);
@@ -525,7 +607,7 @@ test_pqos_alloc_assign_pid_hw(void **state __attribute__((unused)))
         pid_t task_array[1];
         unsigned task_num = 1;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret =
             pqos_alloc_assign_pid(technology, task_array, task_num, &class_id);
@@ -541,7 +623,7 @@ test_pqos_alloc_assign_pid_os(void **state __attribute__((unused)))
         unsigned task_num = 1;
         unsigned class_id;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_alloc_assign_pid, technology, technology);
         expect_value(__wrap_os_alloc_assign_pid, task_array, task_array);
@@ -584,7 +666,7 @@ test_pqos_alloc_release_pid_init(void **state __attribute__((unused)))
         pid_t task_array[1] = {1};
         unsigned task_num = 1;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_release_pid(task_array, task_num);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -611,7 +693,7 @@ test_pqos_alloc_release_pid_hw(void **state __attribute__((unused)))
         pid_t task_array[1];
         unsigned task_num = 1;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_alloc_release_pid(task_array, task_num);
         assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
@@ -624,7 +706,7 @@ test_pqos_alloc_release_pid_os(void **state __attribute__((unused)))
         pid_t task_array[1];
         unsigned task_num = 1;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_alloc_release_pid, task_array, task_array);
         expect_value(__wrap_os_alloc_release_pid, task_num, task_num);
@@ -829,7 +911,7 @@ test_pqos_pid_get_pid_assoc_init(void **state __attribute__((unused)))
         unsigned class_id = 1;
         unsigned count;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_pid_get_pid_assoc(class_id, &count);
         assert_null(ret);
@@ -842,7 +924,7 @@ test_pqos_pid_get_pid_assoc_hw(void **state __attribute__((unused)))
         unsigned class_id = 1;
         unsigned count;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_pid_get_pid_assoc(class_id, &count);
         assert_null(ret);
@@ -856,7 +938,7 @@ test_pqos_pid_get_pid_assoc_os(void **state __attribute__((unused)))
         unsigned count;
         unsigned pid_array[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_pid_get_pid_assoc, class_id, class_id);
         expect_value(__wrap_os_pid_get_pid_assoc, count, &count);
@@ -865,7 +947,7 @@ test_pqos_pid_get_pid_assoc_os(void **state __attribute__((unused)))
         ret = pqos_pid_get_pid_assoc(class_id, &count);
         assert_non_null(ret);
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_pid_get_pid_assoc, class_id, class_id);
         expect_value(__wrap_os_pid_get_pid_assoc, count, &count);
@@ -895,7 +977,7 @@ test_pqos_l3ca_set_init(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_l3ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ca[0].class_id = 1;
         ca[0].cdp = 0;
@@ -913,7 +995,7 @@ test_pqos_l3ca_set_hw(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_l3ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ca[0].class_id = 1;
         ca[0].cdp = 0;
@@ -936,7 +1018,7 @@ test_pqos_l3ca_set_hw_cdp(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_l3ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ca[0].class_id = 1;
         ca[0].cdp = 1;
@@ -960,7 +1042,7 @@ test_pqos_l3ca_set_os(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_l3ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ca[0].class_id = 1;
         ca[0].cdp = 0;
@@ -995,7 +1077,7 @@ test_pqos_l3ca_set_param(void **state __attribute__((unused)))
         ca[0].cdp = 0;
         ca[0].u.ways_mask = 0;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_l3ca_set(l3cat_id, num_cos, ca);
         assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
@@ -1005,7 +1087,7 @@ test_pqos_l3ca_set_param(void **state __attribute__((unused)))
         ca[0].u.s.data_mask = 0x0;
         ca[0].u.s.code_mask = 0xf0;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_l3ca_set(l3cat_id, num_cos, ca);
         assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
@@ -1015,7 +1097,7 @@ test_pqos_l3ca_set_param(void **state __attribute__((unused)))
         ca[0].u.s.data_mask = 0xf0;
         ca[0].u.s.code_mask = 0x0;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_l3ca_set(l3cat_id, num_cos, ca);
         assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
@@ -1032,7 +1114,7 @@ test_pqos_l3ca_get_init(void **state __attribute__((unused)))
         unsigned num_ca;
         struct pqos_l3ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_l3ca_get(l3cat_id, max_num_ca, &num_ca, ca);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -1047,7 +1129,7 @@ test_pqos_l3ca_get_hw(void **state __attribute__((unused)))
         unsigned num_ca;
         struct pqos_l3ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_l3ca_get, l3cat_id, l3cat_id);
         expect_value(__wrap_hw_l3ca_get, max_num_ca, max_num_ca);
@@ -1068,7 +1150,7 @@ test_pqos_l3ca_get_os(void **state __attribute__((unused)))
         unsigned num_ca;
         struct pqos_l3ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_l3ca_get, l3cat_id, l3cat_id);
         expect_value(__wrap_os_l3ca_get, max_num_ca, max_num_ca);
@@ -1107,7 +1189,7 @@ test_pqos_l3ca_get_min_cbm_bits_init(void **state __attribute__((unused)))
         int ret;
         unsigned min_cbm_bits;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_l3ca_get_min_cbm_bits(&min_cbm_bits);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -1119,7 +1201,7 @@ test_pqos_l3ca_get_min_cbm_bits_hw(void **state __attribute__((unused)))
         int ret;
         unsigned min_cbm_bits;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_l3ca_get_min_cbm_bits, min_cbm_bits,
                      &min_cbm_bits);
@@ -1135,7 +1217,7 @@ test_pqos_l3ca_get_min_cbm_bits_os(void **state __attribute__((unused)))
         int ret;
         unsigned min_cbm_bits;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_l3ca_get_min_cbm_bits, min_cbm_bits,
                      &min_cbm_bits);
@@ -1164,7 +1246,7 @@ test_pqos_l2ca_set_init(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_l2ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ca[0].class_id = 1;
         ca[0].cdp = 0;
@@ -1182,7 +1264,7 @@ test_pqos_l2ca_set_hw(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_l2ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ca[0].class_id = 1;
         ca[0].cdp = 0;
@@ -1205,7 +1287,7 @@ test_pqos_l2ca_set_hw_cdp(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_l2ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ca[0].class_id = 1;
         ca[0].cdp = 1;
@@ -1229,7 +1311,7 @@ test_pqos_l2ca_set_os(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_l2ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ca[0].class_id = 1;
         ca[0].cdp = 0;
@@ -1295,7 +1377,7 @@ test_pqos_l2ca_get_init(void **state __attribute__((unused)))
         unsigned num_ca;
         struct pqos_l2ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_l2ca_get(l2id, max_num_ca, &num_ca, ca);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -1310,7 +1392,7 @@ test_pqos_l2ca_get_hw(void **state __attribute__((unused)))
         unsigned num_ca;
         struct pqos_l2ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_l2ca_get, l2id, l2id);
         expect_value(__wrap_hw_l2ca_get, max_num_ca, max_num_ca);
@@ -1331,7 +1413,7 @@ test_pqos_l2ca_get_os(void **state __attribute__((unused)))
         unsigned num_ca;
         struct pqos_l2ca ca[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_l2ca_get, l2id, l2id);
         expect_value(__wrap_os_l2ca_get, max_num_ca, max_num_ca);
@@ -1370,7 +1452,7 @@ test_pqos_l2ca_get_min_cbm_bits_init(void **state __attribute__((unused)))
         int ret;
         unsigned min_cbm_bits;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_l2ca_get_min_cbm_bits(&min_cbm_bits);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -1382,7 +1464,7 @@ test_pqos_l2ca_get_min_cbm_bits_hw(void **state __attribute__((unused)))
         int ret;
         unsigned min_cbm_bits;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_l2ca_get_min_cbm_bits, min_cbm_bits,
                      &min_cbm_bits);
@@ -1398,7 +1480,7 @@ test_pqos_l2ca_get_min_cbm_bits_os(void **state __attribute__((unused)))
         int ret;
         unsigned min_cbm_bits;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_l2ca_get_min_cbm_bits, min_cbm_bits,
                      &min_cbm_bits);
@@ -1427,7 +1509,7 @@ test_pqos_mba_set_init(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_mba requested[1];
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
         will_return(__wrap__pqos_get_inter, PQOS_INTER_OS);
 
         requested[0].class_id = 1;
@@ -1447,7 +1529,7 @@ test_pqos_mba_set_os(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_mba requested[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         will_return(__wrap_cpuinfo_get_config, &config);
         will_return(__wrap__pqos_get_inter, PQOS_INTER_OS);
@@ -1477,7 +1559,7 @@ test_pqos_mba_set_os_ctrl(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_mba requested[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         will_return(__wrap_cpuinfo_get_config, &config);
         will_return(__wrap__pqos_get_inter, PQOS_INTER_OS);
@@ -1507,7 +1589,7 @@ test_pqos_mba_set_hw(void **state __attribute__((unused)))
         unsigned num_cos = 1;
         struct pqos_mba requested[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         will_return(__wrap_cpuinfo_get_config, &config);
         will_return(__wrap__pqos_get_inter, PQOS_INTER_OS);
@@ -1553,7 +1635,7 @@ test_pqos_mba_set_param(void **state __attribute__((unused)))
         ret = pqos_mba_set(mba_id, num_cos, NULL, NULL);
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
         will_return(__wrap_cpuinfo_get_config, &config);
         will_return(__wrap__pqos_get_inter, PQOS_INTER_OS);
 
@@ -1564,7 +1646,7 @@ test_pqos_mba_set_param(void **state __attribute__((unused)))
         ret = pqos_mba_set(mba_id, num_cos, requested, NULL);
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
         will_return(__wrap_cpuinfo_get_config, &config);
         will_return(__wrap__pqos_get_inter, PQOS_INTER_OS);
 
@@ -1587,7 +1669,7 @@ test_pqos_mba_get_init(void **state __attribute__((unused)))
         unsigned num_cos;
         struct pqos_mba mba_tab[1];
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_mba_get(mba_id, max_num_cos, &num_cos, mba_tab);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -1602,7 +1684,7 @@ test_pqos_mba_get_os(void **state __attribute__((unused)))
         unsigned num_cos;
         struct pqos_mba mba_tab[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_os_mba_get, mba_id, mba_id);
         expect_value(__wrap_os_mba_get, max_num_cos, max_num_cos);
@@ -1623,7 +1705,7 @@ test_pqos_mba_get_hw(void **state __attribute__((unused)))
         unsigned num_cos;
         struct pqos_mba mba_tab[1];
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_mba_get, mba_id, mba_id);
         expect_value(__wrap_hw_mba_get, max_num_cos, max_num_cos);
@@ -2086,6 +2168,26 @@ test_pqos_mon_stop_os(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_OK);
 }
 
+static void
+test_pqos_mon_stop_sampled(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+
+        memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        group.valid = 0x00DEAD00;
+        group.intl = &intl;
+        intl.sampled = 1;
+
+        wrap_check_init(1, PQOS_RETVAL_OK);
+
+        ret = pqos_mon_stop(&group);
+        assert_int_equal(ret, PQOS_RETVAL_BUSY);
+        assert_int_equal(group.valid, 0x00DEAD00);
+}
+
 static void
 test_pqos_mon_stop_param(void **state __attribute__((unused)))
 {
@@ -2116,7 +2218,7 @@ test_pqos_mon_poll_init(void **state __attribute__((unused)))
         group.valid = 0x00DEAD00;
         group.event = PQOS_MON_EVENT_LMEM_BW;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_shared(1, PQOS_RETVAL_INIT);
 
         ret = pqos_mon_poll(groups, num_groups);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -2127,14 +2229,17 @@ test_pqos_mon_poll(void **state __attribute__((unused)))
 {
         int ret;
         struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
         unsigned num_groups = 1;
         struct pqos_mon_data *groups[] = {&group};
 
         memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
         group.valid = 0x00DEAD00;
+        group.intl = &intl;
         group.event = PQOS_MON_EVENT_LMEM_BW;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_pqos_mon_poll_events, group, &group);
         will_return(__wrap_pqos_mon_poll_events, PQOS_RETVAL_OK);
@@ -2599,6 +2704,77 @@ test_pqos_mon_remove_pids_param(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
 }
 
+/* ======== pqos_mon_track_pids ======== */
+
+static void
+test_pqos_mon_track_pids_init(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_data group;
+
+        memset(&group, 0, sizeof(group));
+        group.valid = 0x00DEAD00;
+
+        wrap_check_init(1, PQOS_RETVAL_INIT);
+
+        ret = pqos_mon_track_pids(&group, 1);
+        assert_int_equal(ret, PQOS_RETVAL_INIT);
+}
+
+static void
+test_pqos_mon_track_pids_os(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_data group;
+
+        memset(&group, 0, sizeof(group));
+        group.valid = 0x00DEAD00;
+
+        wrap_check_init(1, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_os_mon_track_pids, group, &group);
+        expect_value(__wrap_os_mon_track_pids, enable, 1);
+        will_return(__wrap_os_mon_track_pids, PQOS_RETVAL_OK);
+
+        ret = pqos_mon_track_pids(&group, 1);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+static void
+test_pqos_mon_track_pids_hw(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_data group;
+
+        memset(&group, 0, sizeof(group));
+        group.valid = 0x00DEAD00;
+
+        wrap_check_init(1, PQOS_RETVAL_OK);
+
+        ret = pqos_mon_track_pids(&group, 1);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+}
+
+static void
+test_pqos_mon_track_pids_param(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_data group;
+
+        memset(&group, 0, sizeof(group));
+
+        ret = pqos_mon_track_pids(&group, 1);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        group.valid = 0x00DEAD00;
+
+        ret = pqos_mon_track_pids(NULL, 1);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        ret = pqos_mon_track_pids(&group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+}
+
 /* ======== pqos_mon_start_uncore ======== */
 
 static void
@@ -2693,7 +2869,7 @@ test_pqos_alloc_assoc_get_channel_init(void **state __attribute__((unused)))
         unsigned class_id = 0;
         const pqos_channel_t channel = 0x101;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assoc_get_channel(channel, &class_id);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -2706,7 +2882,7 @@ test_pqos_alloc_assoc_get_channel_os(void **state __attribute__((unused)))
         unsigned class_id = 0;
         const pqos_channel_t channel = 0x101;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_alloc_assoc_get_channel(channel, &class_id);
 
@@ -2720,7 +2896,7 @@ test_pqos_alloc_assoc_get_channel_hw(void **state __attribute__((unused)))
         unsigned class_id = 0;
         const pqos_channel_t channel = 0x101;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_alloc_assoc_get_channel, channel, channel);
         expect_value(__wrap_hw_alloc_assoc_get_channel, class_id, &class_id);
@@ -2759,7 +2935,7 @@ test_pqos_alloc_assoc_get_dev_init(void **state __attribute__((unused)))
         const unsigned vc = 1;
         unsigned class_id = 0;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assoc_get_dev(segment, bdf, vc, &class_id);
 
@@ -2775,7 +2951,7 @@ test_pqos_alloc_assoc_get_dev_os(void **state __attribute__((unused)))
         const unsigned vc = 1;
         unsigned class_id = 0;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_alloc_assoc_get_dev(segment, bdf, vc, &class_id);
 
@@ -2803,7 +2979,7 @@ test_pqos_alloc_assoc_set_channel_init(void **state __attribute__((unused)))
         unsigned class_id = 0;
         const pqos_channel_t channel = 0x101;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assoc_set_channel(channel, class_id);
 
@@ -2817,7 +2993,7 @@ test_pqos_alloc_assoc_set_channel_os(void **state __attribute__((unused)))
         unsigned class_id = 0;
         const pqos_channel_t channel = 0x101;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_alloc_assoc_set_channel(channel, class_id);
 
@@ -2831,7 +3007,7 @@ test_pqos_alloc_assoc_set_channel_hw(void **state __attribute__((unused)))
         unsigned class_id = 0;
         const pqos_channel_t channel = 0x101;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         expect_value(__wrap_hw_alloc_assoc_set_channel, channel, channel);
         expect_value(__wrap_hw_alloc_assoc_set_channel, class_id, class_id);
@@ -2864,7 +3040,7 @@ test_pqos_alloc_assoc_set_dev_init(void **state __attribute__((unused)))
         const unsigned vc = 1;
         unsigned class_id = 0;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_alloc(1, PQOS_RETVAL_INIT);
 
         ret = pqos_alloc_assoc_set_dev(segment, bdf, vc, class_id);
 
@@ -2880,7 +3056,7 @@ test_pqos_alloc_assoc_set_dev_os(void **state __attribute__((unused)))
         const unsigned vc = 1;
         unsigned class_id = 0;
 
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_alloc(1, PQOS_RETVAL_OK);
 
         ret = pqos_alloc_assoc_set_dev(segment, bdf, vc, class_id);
 
@@ -3147,11 +3323,14 @@ test_pqos_mon_get_value_param(void **state __attribute__((unused)))
         uint64_t value;
         uint64_t delta;
         struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
 
         ret = pqos_mon_get_value(NULL, PQOS_MON_EVENT_LMEM_BW, &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
 
         memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        group.intl = &intl;
 
         ret =
             pqos_mon_get_value(&group, PQOS_MON_EVENT_LMEM_BW, &value, &delta);
@@ -3168,7 +3347,7 @@ test_pqos_mon_get_value_param(void **state __attribute__((unused)))
 
         group.valid = 0x00DEAD00;
         group.event = (enum pqos_mon_event)(-1);
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, (enum pqos_mon_event)(-1), &value,
                                  &delta);
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
@@ -3208,11 +3387,11 @@ test_pqos_mon_get_value(void **state __attribute__((unused)))
         group.intl->values.pcie.llc_references.write_delta = 19;
 
         group.event = PQOS_MON_EVENT_L3_OCCUP;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, PQOS_MON_EVENT_L3_OCCUP, &value, NULL);
         assert_int_equal(ret, PQOS_RETVAL_OK);
         assert_int_equal(value, group.values.llc);
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret =
             pqos_mon_get_value(&group, PQOS_MON_EVENT_L3_OCCUP, &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -3220,23 +3399,23 @@ test_pqos_mon_get_value(void **state __attribute__((unused)))
         assert_int_equal(delta, 0);
 
         group.event = PQOS_MON_EVENT_LMEM_BW;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret =
             pqos_mon_get_value(&group, PQOS_MON_EVENT_LMEM_BW, &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
         assert_int_equal(value, group.values.mbm_local);
         assert_int_equal(delta, group.values.mbm_local_delta);
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, PQOS_MON_EVENT_LMEM_BW, &value, NULL);
         assert_int_equal(ret, PQOS_RETVAL_OK);
         assert_int_equal(value, group.values.mbm_local);
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, PQOS_MON_EVENT_LMEM_BW, NULL, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
         assert_int_equal(delta, group.values.mbm_local_delta);
 
         group.event = PQOS_MON_EVENT_TMEM_BW;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret =
             pqos_mon_get_value(&group, PQOS_MON_EVENT_TMEM_BW, &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -3244,7 +3423,7 @@ test_pqos_mon_get_value(void **state __attribute__((unused)))
         assert_int_equal(delta, group.values.mbm_total_delta);
 
         group.event = PQOS_MON_EVENT_RMEM_BW;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret =
             pqos_mon_get_value(&group, PQOS_MON_EVENT_RMEM_BW, &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -3252,7 +3431,7 @@ test_pqos_mon_get_value(void **state __attribute__((unused)))
         assert_int_equal(delta, group.values.mbm_remote_delta);
 
         group.event = PQOS_PERF_EVENT_LLC_MISS;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, PQOS_PERF_EVENT_LLC_MISS, &value,
                                  &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -3260,14 +3439,14 @@ test_pqos_mon_get_value(void **state __attribute__((unused)))
         assert_int_equal(delta, group.values.llc_misses_delta);
 
         group.event = PQOS_PERF_EVENT_LLC_REF;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret =
             pqos_mon_get_value(&group, PQOS_PERF_EVENT_LLC_REF, &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
         assert_int_equal(value, group.values.llc_references);
         assert_int_equal(delta, group.values.llc_references_delta);
         group.event = PQOS_PERF_EVENT_LLC_MISS_PCIE_READ;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, PQOS_PERF_EVENT_LLC_MISS_PCIE_READ,
                                  &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -3275,7 +3454,7 @@ test_pqos_mon_get_value(void **state __attribute__((unused)))
         assert_int_equal(delta, group.intl->values.pcie.llc_misses.read_delta);
 
         group.event = PQOS_PERF_EVENT_LLC_MISS_PCIE_WRITE;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, PQOS_PERF_EVENT_LLC_MISS_PCIE_WRITE,
                                  &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -3283,7 +3462,7 @@ test_pqos_mon_get_value(void **state __attribute__((unused)))
         assert_int_equal(delta, group.intl->values.pcie.llc_misses.write_delta);
 
         group.event = PQOS_PERF_EVENT_LLC_REF_PCIE_READ;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, PQOS_PERF_EVENT_LLC_REF_PCIE_READ,
                                  &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -3292,7 +3471,7 @@ test_pqos_mon_get_value(void **state __attribute__((unused)))
                          group.intl->values.pcie.llc_references.read_delta);
 
         group.event = PQOS_PERF_EVENT_LLC_REF_PCIE_WRITE;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_value(&group, PQOS_PERF_EVENT_LLC_REF_PCIE_WRITE,
                                  &value, &delta);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -3313,7 +3492,7 @@ test_pqos_mon_get_value_init(void **state __attribute__((unused)))
         group.valid = 0x00DEAD00;
         group.event = PQOS_MON_EVENT_LMEM_BW;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_shared(1, PQOS_RETVAL_INIT);
 
         ret =
             pqos_mon_get_value(&group, PQOS_MON_EVENT_LMEM_BW, &value, &delta);
@@ -3333,7 +3512,7 @@ test_pqos_mon_get_ipc_init(void **state __attribute__((unused)))
         group.valid = 0x00DEAD00;
         group.event = PQOS_PERF_EVENT_IPC;
 
-        wrap_check_init(1, PQOS_RETVAL_INIT);
+        wrap_check_init_shared(1, PQOS_RETVAL_INIT);
 
         ret = pqos_mon_get_ipc(&group, &value);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -3369,18 +3548,147 @@ test_pqos_mon_get_ipc(void **state __attribute__((unused)))
         int ret;
         double value;
         struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
 
         memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
         group.valid = 0x00DEAD00;
+        group.intl = &intl;
         group.values.ipc = 1;
 
         group.event = PQOS_PERF_EVENT_IPC;
-        wrap_check_init(1, PQOS_RETVAL_OK);
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
         ret = pqos_mon_get_ipc(&group, &value);
         assert_int_equal(ret, PQOS_RETVAL_OK);
         assert_int_equal(value, group.values.ipc);
 }
 
+/* ======== pqos_mon_get_rate ======== */
+
+static void
+test_pqos_mon_get_rate_param(void **state __attribute__((unused)))
+{
+        int ret;
+        double rate;
+        struct pqos_mon_data group;
+
+        ret = pqos_mon_get_rate(NULL, PQOS_MON_EVENT_LMEM_BW, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        memset(&group, 0, sizeof(group));
+        ret = pqos_mon_get_rate(&group, PQOS_MON_EVENT_LMEM_BW, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        ret = pqos_mon_get_rate(&group, PQOS_MON_EVENT_LMEM_BW, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        group.valid = 0x00DEAD00;
+        ret = pqos_mon_get_rate(&group, PQOS_MON_EVENT_LMEM_BW, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        /* occupancy is not a rate */
+        group.event = PQOS_MON_EVENT_L3_OCCUP;
+        ret = pqos_mon_get_rate(&group, PQOS_MON_EVENT_L3_OCCUP, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+}
+
+static void
+test_pqos_mon_get_rate(void **state __attribute__((unused)))
+{
+        int ret;
+        double rate;
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+
+        memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        group.valid = 0x00DEAD00;
+        group.intl = &intl;
+        group.event = PQOS_MON_EVENT_LMEM_BW | PQOS_MON_EVENT_TMEM_BW |
+                      PQOS_PERF_EVENT_LLC_MISS | PQOS_PERF_EVENT_IPC;
+        group.values.mbm_local_delta = 3000;
+        group.values.mbm_total_delta = 5000;
+        group.values.llc_misses_delta = 100;
+        group.values.ipc = 1.5;
+
+        /* first poll gives no interval */
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
+        ret = pqos_mon_get_rate(&group, PQOS_MON_EVENT_LMEM_BW, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_UNAVAILABLE);
+
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
+        ret = pqos_mon_get_rate(&group, PQOS_PERF_EVENT_IPC, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_UNAVAILABLE);
+
+        /* delayed poll, 1.5 s elapsed */
+        intl.poll_time.interval = 1500000000;
+
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
+        ret = pqos_mon_get_rate(&group, PQOS_MON_EVENT_LMEM_BW, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(rate > 1999.999 && rate < 2000.001);
+
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
+        ret = pqos_mon_get_rate(&group, PQOS_MON_EVENT_TMEM_BW, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(rate > 3333.333 && rate < 3333.334);
+
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
+        ret = pqos_mon_get_rate(&group, PQOS_PERF_EVENT_LLC_MISS, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(rate > 66.666 && rate < 66.667);
+
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
+        ret = pqos_mon_get_rate(&group, PQOS_PERF_EVENT_IPC, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(rate == 1.5);
+
+        wrap_check_init_shared(1, PQOS_RETVAL_INIT);
+        ret = pqos_mon_get_rate(&group, PQOS_MON_EVENT_LMEM_BW, &rate);
+        assert_int_equal(ret, PQOS_RETVAL_INIT);
+}
+
+/* ======== pqos_mon_get_poll_time ======== */
+
+static void
+test_pqos_mon_get_poll_time(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_poll_time poll_time;
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+
+        ret = pqos_mon_get_poll_time(NULL, &poll_time);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        group.intl = &intl;
+        ret = pqos_mon_get_poll_time(&group, &poll_time);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        group.valid = 0x00DEAD00;
+        ret = pqos_mon_get_poll_time(&group, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
+        ret = pqos_mon_get_poll_time(&group, &poll_time);
+        assert_int_equal(ret, PQOS_RETVAL_UNAVAILABLE);
+
+        intl.poll_time.begin = 100;
+        intl.poll_time.end = 150;
+        intl.poll_time.latency = 50;
+        intl.poll_time.interval = 1000;
+
+        wrap_check_init_shared(1, PQOS_RETVAL_OK);
+        ret = pqos_mon_get_poll_time(&group, &poll_time);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(poll_time.begin, 100);
+        assert_int_equal(poll_time.end, 150);
+        assert_int_equal(poll_time.latency, 50);
+        assert_int_equal(poll_time.interval, 1000);
+}
+
 static void
 test_pqos_retval_to_string(void **state __attribute__((unused)))
 {
@@ -3416,6 +3724,7 @@ main(void)
         const struct CMUnitTest tests_init[] = {
             cmocka_unit_test(test_pqos_alloc_assoc_set_init),
             cmocka_unit_test(test_pqos_alloc_assoc_get_init),
+            cmocka_unit_test(test_pqos_assoc_revalidate_init),
             cmocka_unit_test(test_pqos_alloc_assoc_set_pid_init),
             cmocka_unit_test(test_pqos_alloc_assoc_get_pid_init),
             cmocka_unit_test(test_pqos_alloc_assign_init),
@@ -3446,6 +3755,7 @@ main(void)
             cmocka_unit_test(test_pqos_mon_start_pids2_init),
             cmocka_unit_test(test_pqos_mon_add_pids_init),
             cmocka_unit_test(test_pqos_mon_remove_pids_init),
+            cmocka_unit_test(test_pqos_mon_track_pids_init),
             cmocka_unit_test(test_pqos_alloc_assoc_get_channel_init),
             cmocka_unit_test(test_pqos_alloc_assoc_get_dev_init),
             cmocka_unit_test(test_pqos_alloc_assoc_set_channel_init),
@@ -3458,6 +3768,7 @@ main(void)
         const struct CMUnitTest tests_param[] = {
             cmocka_unit_test(test_api_init_param),
             cmocka_unit_test(test_pqos_alloc_assoc_get_param_id_null),
+            cmocka_unit_test(test_pqos_assoc_revalidate_param),
             cmocka_unit_test(test_pqos_alloc_assoc_get_pid_param_id_null),
             cmocka_unit_test(test_pqos_alloc_assign_param_technology),
             cmocka_unit_test(test_pqos_alloc_assign_param_core_null),
@@ -3489,6 +3800,7 @@ main(void)
             cmocka_unit_test(test_pqos_mon_start_pids2_param),
             cmocka_unit_test(test_pqos_mon_add_pids_param),
             cmocka_unit_test(test_pqos_mon_remove_pids_param),
+            cmocka_unit_test(test_pqos_mon_track_pids_param),
             cmocka_unit_test(test_pqos_alloc_assoc_get_channel_param),
             cmocka_unit_test(test_pqos_alloc_assoc_get_dev_param),
             cmocka_unit_test(test_pqos_alloc_assoc_set_channel_param),
@@ -3496,12 +3808,14 @@ main(void)
             cmocka_unit_test(test_pqos_mon_start_uncore_param),
             cmocka_unit_test(test_pqos_mon_get_value_param),
             cmocka_unit_test(test_pqos_mon_get_ipc_param),
+            cmocka_unit_test(test_pqos_mon_get_rate_param),
             cmocka_unit_test(test_pqos_retval_to_string),
         };
 
         const struct CMUnitTest tests_hw[] = {
             cmocka_unit_test(test_pqos_alloc_assoc_set_hw),
             cmocka_unit_test(test_pqos_alloc_assoc_get_hw),
+            cmocka_unit_test(test_pqos_assoc_revalidate_hw),
             cmocka_unit_test(test_pqos_alloc_assoc_set_pid_hw),
             cmocka_unit_test(test_pqos_alloc_assoc_get_pid_hw),
             cmocka_unit_test(test_pqos_alloc_assign_hw),
@@ -3528,22 +3842,27 @@ main(void)
             cmocka_unit_test(test_pqos_mon_start_hw),
             cmocka_unit_test(test_pqos_mon_start_channels_hw),
             cmocka_unit_test(test_pqos_mon_stop_hw),
+            cmocka_unit_test(test_pqos_mon_stop_sampled),
             cmocka_unit_test(test_pqos_mon_poll),
             cmocka_unit_test(test_pqos_mon_start_pids_hw),
             cmocka_unit_test(test_pqos_mon_start_pids2_hw),
             cmocka_unit_test(test_pqos_mon_start_pid_hw),
             cmocka_unit_test(test_pqos_mon_add_pids_hw),
             cmocka_unit_test(test_pqos_mon_remove_pids_hw),
+            cmocka_unit_test(test_pqos_mon_track_pids_hw),
             cmocka_unit_test(test_pqos_alloc_assoc_get_channel_hw),
             cmocka_unit_test(test_pqos_alloc_assoc_set_channel_hw),
             cmocka_unit_test(test_pqos_mon_start_uncore_hw),
             cmocka_unit_test(test_pqos_mon_get_value),
-            cmocka_unit_test(test_pqos_mon_get_ipc)};
+            cmocka_unit_test(test_pqos_mon_get_ipc),
+            cmocka_unit_test(test_pqos_mon_get_rate),
+            cmocka_unit_test(test_pqos_mon_get_poll_time)};
 
 #ifdef __linux__
         const struct CMUnitTest tests_os[] = {
             cmocka_unit_test(test_pqos_alloc_assoc_set_os),
             cmocka_unit_test(test_pqos_alloc_assoc_get_os),
+            cmocka_unit_test(test_pqos_assoc_revalidate_os),
             cmocka_unit_test(test_pqos_alloc_assoc_set_pid_os),
             cmocka_unit_test(test_pqos_alloc_assoc_get_pid_os),
             cmocka_unit_test(test_pqos_alloc_assign_os),
@@ -3575,6 +3894,7 @@ main(void)
             cmocka_unit_test(test_pqos_mon_start_pid_os),
             cmocka_unit_test(test_pqos_mon_add_pids_os),
             cmocka_unit_test(test_pqos_mon_remove_pids_os),
+            cmocka_unit_test(test_pqos_mon_track_pids_os),
             cmocka_unit_test(test_pqos_alloc_assoc_get_channel_os),
             cmocka_unit_test(test_pqos_alloc_assoc_get_dev_os),
             cmocka_unit_test(test_pqos_alloc_assoc_set_channel_os),
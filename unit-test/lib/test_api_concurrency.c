@@ -0,0 +1,318 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Stress test of mixed concurrent API calls. Library calls are replaced
+ * with fakes that count violations of the locking rules:
+ * - allocation changes are mutually exclusive
+ * - exclusive calls run alone
+ * - a monitoring group is polled by one thread at a time
+ */
+
+#include "api.h"
+#include "mon_poll.h"
+#include "monitoring.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define NUM_GROUPS 4
+#define NUM_LOOPS  200
+
+static int m_alloc_active;
+static int m_excl_active;
+static int m_poll_active;
+static int m_violations;
+
+#define ATOMIC_INC(x) __atomic_add_fetch(&(x), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_DEC(x) __atomic_sub_fetch(&(x), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_GET(x) __atomic_load_n(&(x), __ATOMIC_SEQ_CST)
+
+/* ======== mock ======== */
+
+int
+__wrap__pqos_check_init(const int expect)
+{
+        (void)expect;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+__wrap_hw_l3ca_set(const unsigned l3cat_id,
+                   const unsigned num_cos,
+                   const struct pqos_l3ca *ca)
+{
+        (void)l3cat_id;
+        (void)num_cos;
+        (void)ca;
+
+        if (ATOMIC_INC(m_alloc_active) != 1 || ATOMIC_GET(m_excl_active))
+                ATOMIC_INC(m_violations);
+        usleep(10);
+        ATOMIC_DEC(m_alloc_active);
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+__wrap_hw_mon_reset(const struct pqos_mon_config *cfg)
+{
+        (void)cfg;
+
+        if (ATOMIC_INC(m_excl_active) != 1 || ATOMIC_GET(m_alloc_active) ||
+            ATOMIC_GET(m_poll_active))
+                ATOMIC_INC(m_violations);
+        usleep(10);
+        ATOMIC_DEC(m_excl_active);
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+__wrap_pqos_mon_poll_events(struct pqos_mon_data *group)
+{
+        int *active = (int *)group->context;
+
+        ATOMIC_INC(m_poll_active);
+        if (ATOMIC_INC(*active) != 1 || ATOMIC_GET(m_excl_active))
+                ATOMIC_INC(m_violations);
+        /* unprotected update, lost increments show up as wrong totals */
+        group->values.llc++;
+        usleep(10);
+        ATOMIC_DEC(*active);
+        ATOMIC_DEC(m_poll_active);
+
+        return PQOS_RETVAL_OK;
+}
+
+/* ======== helpers ======== */
+
+static unsigned m_cores[NUM_GROUPS][2] = {{0, 1}, {2, 3}, {4, 5}, {6, 7}};
+static struct pqos_mon_data_internal m_intl[NUM_GROUPS];
+static struct pqos_mon_data m_group[NUM_GROUPS];
+static int m_group_active[NUM_GROUPS];
+
+static void
+groups_init(void)
+{
+        unsigned i;
+
+        memset(m_intl, 0, sizeof(m_intl));
+        memset(m_group, 0, sizeof(m_group));
+        memset(m_group_active, 0, sizeof(m_group_active));
+
+        for (i = 0; i < NUM_GROUPS; i++) {
+                m_group[i].valid = 0x00DEAD00;
+                m_group[i].event = PQOS_MON_EVENT_L3_OCCUP;
+                m_group[i].cores = m_cores[i];
+                m_group[i].num_cores = DIM(m_cores[i]);
+                m_group[i].intl = &m_intl[i];
+                m_group[i].context = &m_group_active[i];
+        }
+
+        m_alloc_active = 0;
+        m_excl_active = 0;
+        m_poll_active = 0;
+        m_violations = 0;
+}
+
+struct poll_arg {
+        unsigned first;
+        unsigned num;
+};
+
+static void *
+poll_thread(void *arg)
+{
+        const struct poll_arg *pa = (const struct poll_arg *)arg;
+        struct pqos_mon_data *groups[NUM_GROUPS];
+        unsigned i;
+
+        for (i = 0; i < pa->num; i++)
+                groups[i] = &m_group[pa->first + i];
+
+        for (i = 0; i < NUM_LOOPS; i++)
+                if (pqos_mon_poll(groups, pa->num) != PQOS_RETVAL_OK)
+                        ATOMIC_INC(m_violations);
+
+        return NULL;
+}
+
+static void *
+value_thread(void *arg)
+{
+        unsigned i;
+
+        (void)arg;
+
+        for (i = 0; i < NUM_LOOPS; i++) {
+                uint64_t value;
+                int ret;
+
+                ret = pqos_mon_get_value(&m_group[i % NUM_GROUPS],
+                                         PQOS_MON_EVENT_L3_OCCUP, &value,
+                                         NULL);
+                if (ret != PQOS_RETVAL_OK)
+                        ATOMIC_INC(m_violations);
+        }
+
+        return NULL;
+}
+
+static void *
+alloc_thread(void *arg)
+{
+        struct pqos_l3ca ca;
+        unsigned i;
+
+        (void)arg;
+        memset(&ca, 0, sizeof(ca));
+        ca.u.ways_mask = 0xf;
+
+        for (i = 0; i < NUM_LOOPS; i++)
+                if (pqos_l3ca_set(i % 2, 1, &ca) != PQOS_RETVAL_OK)
+                        ATOMIC_INC(m_violations);
+
+        return NULL;
+}
+
+static void *
+reset_thread(void *arg)
+{
+        unsigned i;
+
+        (void)arg;
+
+        for (i = 0; i < NUM_LOOPS / 10; i++) {
+                if (pqos_mon_reset() != PQOS_RETVAL_OK)
+                        ATOMIC_INC(m_violations);
+                usleep(100);
+        }
+
+        return NULL;
+}
+
+static void
+run_stress(void)
+{
+        /* two disjoint sets and one overlapping both */
+        struct poll_arg pa[] = {{0, 2}, {2, 2}, {1, 2}};
+        pthread_t thread[DIM(pa) + 4];
+        unsigned num = 0;
+        unsigned i;
+        int ret;
+
+        groups_init();
+
+        ret = api_init(PQOS_INTER_MSR, PQOS_VENDOR_INTEL);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        for (i = 0; i < DIM(pa); i++)
+                assert_int_equal(pthread_create(&thread[num++], NULL,
+                                                poll_thread, &pa[i]),
+                                 0);
+        assert_int_equal(
+            pthread_create(&thread[num++], NULL, value_thread, NULL), 0);
+        assert_int_equal(
+            pthread_create(&thread[num++], NULL, alloc_thread, NULL), 0);
+        assert_int_equal(
+            pthread_create(&thread[num++], NULL, alloc_thread, NULL), 0);
+        assert_int_equal(
+            pthread_create(&thread[num++], NULL, reset_thread, NULL), 0);
+
+        for (i = 0; i < num; i++)
+                assert_int_equal(pthread_join(thread[i], NULL), 0);
+
+        assert_int_equal(m_violations, 0);
+        assert_int_equal(m_group[0].values.llc, NUM_LOOPS);
+        assert_int_equal(m_group[1].values.llc, 2 * NUM_LOOPS);
+        assert_int_equal(m_group[2].values.llc, 2 * NUM_LOOPS);
+        assert_int_equal(m_group[3].values.llc, NUM_LOOPS);
+        for (i = 0; i < NUM_GROUPS; i++)
+                assert_int_equal(m_intl[i].busy, 0);
+}
+
+/* ======== stress ======== */
+
+static void
+test_api_concurrency_serial(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        unsetenv("RDT_MON_POLL_PARALLEL");
+
+        ret = mon_poll_init(data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        run_stress();
+
+        ret = mon_poll_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+static void
+test_api_concurrency_parallel(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        setenv("RDT_MON_POLL_PARALLEL", "1", 1);
+
+        ret = mon_poll_init(data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        run_stress();
+
+        ret = mon_poll_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        unsetenv("RDT_MON_POLL_PARALLEL");
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_api_concurrency_serial),
+            cmocka_unit_test(test_api_concurrency_parallel),
+        };
+
+        result += cmocka_run_group_tests(tests, test_init_mon, test_fini);
+
+        return result;
+}
@@ -33,6 +33,8 @@
 #include "cap.h"
 #include "log.h"
 #include "mock_cap.h"
+#include "mon_sampler.h"
+#include "monitoring.h"
 #include "test.h"
 
 #include <fcntl.h>
@@ -380,6 +382,37 @@ test_pqos_fini(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_OK);
 }
 
+static void
+test_pqos_fini_sampler(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data_internal intl;
+        struct pqos_mon_data group;
+        struct pqos_mon_data *groups[] = {&group};
+        struct pqos_mon_sampler_config cfg;
+        struct pqos_mon_sampler *sampler = NULL;
+        int ret;
+
+        memset(&intl, 0, sizeof(intl));
+        memset(&group, 0, sizeof(group));
+        group.intl = &intl;
+        memset(&cfg, 0, sizeof(cfg));
+        /* sampling thread does not poll during the test */
+        cfg.period_us = 100000000;
+        cfg.lcore = -1;
+
+        ret = mon_sampler_start(groups, 1, &cfg, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_release);
+        ret = pqos_fini();
+        assert_int_equal(ret, PQOS_RETVAL_BUSY);
+
+        ret = pqos_mon_sampler_stop(sampler);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(intl.sampled, 0);
+}
+
 /* ======== pqos_cap_get ======== */
 
 static void
@@ -392,17 +425,17 @@ test_pqos_cap_get_before_init(void **state __attribute__((unused)))
         ret = pqos_cap_get(NULL, NULL);
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
 
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_function_call(__wrap_lock_release);
         ret = pqos_cap_get(&p_cap, &p_cpu);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
 
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_function_call(__wrap_lock_release);
         ret = pqos_cap_get(&p_cap, NULL);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
 
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_function_call(__wrap_lock_release);
         ret = pqos_cap_get(NULL, &p_cpu);
         assert_int_equal(ret, PQOS_RETVAL_INIT);
@@ -417,15 +450,15 @@ test_pqos_cap_get_after_init(void **state __attribute__((unused)))
 
         ret = pqos_cap_get(NULL, NULL);
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_function_call(__wrap_lock_release);
         ret = pqos_cap_get(&p_cap, &p_cpu);
         assert_int_equal(ret, PQOS_RETVAL_OK);
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_function_call(__wrap_lock_release);
         ret = pqos_cap_get(&p_cap, NULL);
         assert_int_equal(ret, PQOS_RETVAL_OK);
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_function_call(__wrap_lock_release);
         ret = pqos_cap_get(NULL, &p_cpu);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -592,6 +625,7 @@ main(void)
             cmocka_unit_test(test__pqos_cap_l2cdp_change_os_resctrl_mon),
 #endif
             cmocka_unit_test(test__pqos_cap_mba_change),
+            cmocka_unit_test(test_pqos_fini_sampler),
             cmocka_unit_test(test_pqos_fini),
         };
 
@@ -265,7 +265,8 @@ __wrap_os_cap_init(const enum pqos_interface inter __attribute__((unused)))
 }
 
 int
-__wrap__pqos_utils_init(int interface __attribute__((unused)))
+__wrap__pqos_utils_init(int interface __attribute__((unused)),
+                        const struct pqos_cpuinfo *cpu __attribute__((unused)))
 {
         function_called();
 
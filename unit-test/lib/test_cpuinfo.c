@@ -0,0 +1,159 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "machine.h"
+#include "mock_cpuinfo.h"
+#include "test.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* ======== mock ======== */
+
+void
+__wrap_lcpuid(const unsigned leaf,
+              const unsigned subleaf,
+              struct cpuid_out *out)
+{
+        int cpu = sched_getcpu();
+
+        /* called from detection threads, APICID derived from current cpu */
+        assert_true(leaf == 0xb && subleaf == 0);
+        assert_true(cpu >= 0);
+
+        memset(out, 0, sizeof(*out));
+        out->edx = (uint32_t)cpu * 2 + 1;
+}
+
+/* ======== helpers ======== */
+
+static const struct apic_info apic = {
+    .smt_mask = 0x1,
+    .smt_size = 1,
+    .core_mask = 0xe,
+    .core_smt_mask = 0xf,
+    .pkg_mask = ~0xfu,
+    .pkg_shift = 4,
+    .l2_shift = 1,
+    .l3_shift = 4,
+};
+
+/* ======== cpuinfo_detect_parallel ======== */
+
+static void
+test_cpuinfo_detect_parallel(void **state __attribute__((unused)))
+{
+        const int max_core_count = sysconf(_SC_NPROCESSORS_CONF);
+        struct pqos_coreinfo *serial;
+        struct pqos_coreinfo *parallel;
+        int num_serial, num_parallel;
+        int i;
+
+        assert_true(max_core_count > 0);
+
+        serial = calloc(max_core_count, sizeof(*serial));
+        parallel = calloc(max_core_count, sizeof(*parallel));
+        assert_non_null(serial);
+        assert_non_null(parallel);
+
+        num_serial = cpuinfo_detect_serial(&apic, serial, max_core_count);
+        num_parallel =
+            cpuinfo_detect_parallel(&apic, parallel, max_core_count);
+
+        assert_true(num_serial > 0);
+        assert_int_equal(num_parallel, num_serial);
+        assert_memory_equal(parallel, serial,
+                            num_serial * sizeof(*serial));
+
+        for (i = 0; i < num_parallel; i++) {
+                const uint32_t apicid = parallel[i].lcore * 2 + 1;
+
+                assert_int_equal(parallel[i].socket, apicid >> 4);
+                assert_int_equal(parallel[i].l3_id, apicid >> 4);
+                assert_int_equal(parallel[i].l2_id, apicid >> 1);
+                if (i > 0)
+                        assert_true(parallel[i].lcore > parallel[i - 1].lcore);
+        }
+
+        free(serial);
+        free(parallel);
+}
+
+static void
+test_cpuinfo_detect_parallel_affinity(void **state __attribute__((unused)))
+{
+        const int max_core_count = sysconf(_SC_NPROCESSORS_CONF);
+        const size_t size = CPU_ALLOC_SIZE(max_core_count);
+        struct pqos_coreinfo *cores;
+        cpu_set_t *before = CPU_ALLOC(max_core_count);
+        cpu_set_t *after = CPU_ALLOC(max_core_count);
+        int ret;
+
+        assert_non_null(before);
+        assert_non_null(after);
+        cores = calloc(max_core_count, sizeof(*cores));
+        assert_non_null(cores);
+
+        CPU_ZERO_S(size, before);
+        CPU_ZERO_S(size, after);
+
+        ret = sched_getaffinity(0, size, before);
+        assert_int_equal(ret, 0);
+
+        ret = cpuinfo_detect_parallel(&apic, cores, max_core_count);
+        assert_true(ret > 0);
+
+        /* affinity of the calling thread is not changed */
+        ret = sched_getaffinity(0, size, after);
+        assert_int_equal(ret, 0);
+        assert_true(CPU_EQUAL_S(size, before, after));
+
+        free(cores);
+        CPU_FREE(before);
+        CPU_FREE(after);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_cpuinfo_detect_parallel),
+            cmocka_unit_test(test_cpuinfo_detect_parallel_affinity),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
@@ -57,13 +57,47 @@ test_hw_alloc_reset_cos(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_OK);
 }
 
+static void
+test_hw_alloc_reset_cos_error(void **state __attribute__((unused)))
+{
+        int ret;
+        unsigned msr_start = 0xf0;
+        unsigned msr_num = 3;
+        unsigned coreid = 1;
+        unsigned msr_val = 0xf;
+        unsigned i;
+
+        /* batch stops on first failed write */
+        expect_value(__wrap_msr_write, lcore, coreid);
+        expect_value(__wrap_msr_write, reg, msr_start);
+        expect_value(__wrap_msr_write, value, msr_val);
+        will_return(__wrap_msr_write, PQOS_RETVAL_OK);
+        expect_value(__wrap_msr_write, lcore, coreid);
+        expect_value(__wrap_msr_write, reg, msr_start + 1);
+        expect_value(__wrap_msr_write, value, msr_val);
+        will_return(__wrap_msr_write, PQOS_RETVAL_ERROR);
+
+        /* every register is still reset */
+        for (i = 0; i < msr_num; ++i) {
+                expect_value(__wrap_msr_write, lcore, coreid);
+                expect_value(__wrap_msr_write, reg, msr_start + i);
+                expect_value(__wrap_msr_write, value, msr_val);
+                will_return(__wrap_msr_write, i == 1 ? PQOS_RETVAL_ERROR
+                                                     : PQOS_RETVAL_OK);
+        }
+
+        ret = hw_alloc_reset_cos(msr_start, msr_num, coreid, msr_val);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+}
+
 int
 main(void)
 {
         int result = 0;
 
         const struct CMUnitTest tests[] = {
-            cmocka_unit_test(test_hw_alloc_reset_cos)};
+            cmocka_unit_test(test_hw_alloc_reset_cos),
+            cmocka_unit_test(test_hw_alloc_reset_cos_error)};
 
         result += cmocka_run_group_tests(tests, test_init_l3ca, test_fini);
 
@@ -153,6 +153,118 @@ test_hw_mon_read_error(void **state __attribute__((unused)))
         assert_int_equal(value, 5);
 }
 
+/* ======== hw_mon_read_batch ======== */
+
+static void
+test_hw_mon_read_batch(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_poll_ctx ctx[2];
+        unsigned event = 3;
+        uint64_t values[2];
+        struct machine_msr_op ops[4];
+        unsigned i;
+
+        memset(ctx, 0, sizeof(ctx));
+        ctx[0].lcore = 2;
+        ctx[0].rmid = 1;
+        ctx[1].lcore = 5;
+        ctx[1].rmid = 4;
+
+        for (i = 0; i < 2; i++) {
+                uint64_t evtsel;
+
+                evtsel = ((uint64_t)ctx[i].rmid) &
+                         PQOS_MSR_MON_EVTSEL_RMID_MASK;
+                evtsel <<= PQOS_MSR_MON_EVTSEL_RMID_SHIFT;
+                evtsel |= ((uint64_t)event) & PQOS_MSR_MON_EVTSEL_EVTID_MASK;
+
+                /* select event */
+                expect_value(__wrap_msr_write, lcore, ctx[i].lcore);
+                expect_value(__wrap_msr_write, reg, PQOS_MSR_MON_EVTSEL);
+                expect_value(__wrap_msr_write, value, evtsel);
+                will_return(__wrap_msr_write, MACHINE_RETVAL_OK);
+
+                /* read */
+                expect_value(__wrap_msr_read, lcore, ctx[i].lcore);
+                expect_value(__wrap_msr_read, reg, PQOS_MSR_MON_QMC);
+                will_return(__wrap_msr_read, MACHINE_RETVAL_OK);
+                will_return(__wrap_msr_read, 5 + i);
+        }
+
+        ret = hw_mon_read_batch(2, ctx, event, values, ops);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(values[0], 5);
+        assert_int_equal(values[1], 6);
+}
+
+static void
+test_hw_mon_read_batch_unavailable(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_poll_ctx ctx;
+        unsigned event = 3;
+        uint64_t value;
+        uint64_t evtsel = 0;
+        struct machine_msr_op ops[2];
+
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.lcore = 2;
+        ctx.rmid = 1;
+
+        evtsel = ((uint64_t)ctx.rmid) & PQOS_MSR_MON_EVTSEL_RMID_MASK;
+        evtsel <<= PQOS_MSR_MON_EVTSEL_RMID_SHIFT;
+        evtsel |= ((uint64_t)event) & PQOS_MSR_MON_EVTSEL_EVTID_MASK;
+
+        /* batch - QMC unavailable */
+        expect_value(__wrap_msr_write, lcore, ctx.lcore);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_MON_EVTSEL);
+        expect_value(__wrap_msr_write, value, evtsel);
+        will_return(__wrap_msr_write, MACHINE_RETVAL_OK);
+
+        expect_value(__wrap_msr_read, lcore, ctx.lcore);
+        expect_value(__wrap_msr_read, reg, PQOS_MSR_MON_QMC);
+        will_return(__wrap_msr_read, MACHINE_RETVAL_OK);
+        will_return(__wrap_msr_read, PQOS_MSR_MON_QMC_UNAVAILABLE);
+
+        /* retry with hw_mon_read */
+        expect_value(__wrap_msr_write, lcore, ctx.lcore);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_MON_EVTSEL);
+        expect_value(__wrap_msr_write, value, evtsel);
+        will_return(__wrap_msr_write, MACHINE_RETVAL_OK);
+
+        expect_value(__wrap_msr_read, lcore, ctx.lcore);
+        expect_value(__wrap_msr_read, reg, PQOS_MSR_MON_QMC);
+        will_return(__wrap_msr_read, MACHINE_RETVAL_OK);
+        will_return(__wrap_msr_read, 5);
+
+        ret = hw_mon_read_batch(1, &ctx, event, &value, ops);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 5);
+}
+
+static void
+test_hw_mon_read_batch_error(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_poll_ctx ctx;
+        unsigned event = 3;
+        uint64_t value;
+        struct machine_msr_op ops[2];
+
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.lcore = 2;
+        ctx.rmid = 1;
+
+        expect_value(__wrap_msr_write, lcore, ctx.lcore);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_MON_EVTSEL);
+        expect_any(__wrap_msr_write, value);
+        will_return(__wrap_msr_write, MACHINE_RETVAL_ERROR);
+
+        ret = hw_mon_read_batch(1, &ctx, event, &value, ops);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+}
+
 int
 main(void)
 {
@@ -161,7 +273,10 @@ main(void)
         const struct CMUnitTest tests[] = {
             cmocka_unit_test(test_hw_mon_read),
             cmocka_unit_test(test_hw_mon_read_unavailable),
-            cmocka_unit_test(test_hw_mon_read_error)};
+            cmocka_unit_test(test_hw_mon_read_error),
+            cmocka_unit_test(test_hw_mon_read_batch),
+            cmocka_unit_test(test_hw_mon_read_batch_unavailable),
+            cmocka_unit_test(test_hw_mon_read_batch_error)};
 
         result += cmocka_run_group_tests(tests, NULL, NULL);
 
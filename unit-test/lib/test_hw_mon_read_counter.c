@@ -70,17 +70,51 @@ wrap_fini_mon(void **state)
 
 /* ======== mock ======== */
 
+static int m_sampled;
+
+int
+__wrap_mbm_sampler_enabled(void)
+{
+        return m_sampled;
+}
+
 int
-hw_mon_read(const unsigned lcore,
-            const pqos_rmid_t rmid,
-            const unsigned event,
-            uint64_t *value)
+__wrap_mbm_sampler_read(const struct pqos_mon_poll_ctx *ctx,
+                        const unsigned num_ctx,
+                        const enum pqos_mon_event event,
+                        uint64_t *value)
 {
-        check_expected(lcore);
-        check_expected(rmid);
+        assert_non_null(ctx);
+        check_expected(num_ctx);
         check_expected(event);
 
-        *value = mock_type(int);
+        *value = mock_type(uint64_t);
+
+        return mock_type(int);
+}
+
+int
+hw_mon_read_batch(const unsigned num_ctx,
+                  const struct pqos_mon_poll_ctx *ctx,
+                  const unsigned event,
+                  uint64_t *values,
+                  struct machine_msr_op *ops)
+{
+        unsigned i;
+
+        check_expected(num_ctx);
+        check_expected(event);
+        assert_non_null(ops);
+
+        for (i = 0; i < num_ctx; i++) {
+                const unsigned lcore = ctx[i].lcore;
+                const pqos_rmid_t rmid = ctx[i].rmid;
+
+                check_expected(lcore);
+                check_expected(rmid);
+
+                values[i] = mock_type(int);
+        }
 
         return mock_type(int);
 }
@@ -96,6 +130,8 @@ test_hw_mon_read_counter_tmem(void **state)
         struct pqos_mon_data group;
         struct pqos_mon_data_internal intl;
         struct pqos_mon_poll_ctx ctx;
+        struct machine_msr_op ops[2];
+        uint64_t values[1];
         enum pqos_mon_event event = PQOS_MON_EVENT_TMEM_BW;
         const struct pqos_monitor *pmon;
         int ret;
@@ -109,6 +145,8 @@ test_hw_mon_read_counter_tmem(void **state)
         memset(&intl, 0, sizeof(struct pqos_mon_data_internal));
         intl.hw.ctx = &ctx;
         intl.hw.num_ctx = 1;
+        intl.hw.ops = ops;
+        intl.hw.values = values;
         memset(&ctx, 0, sizeof(struct pqos_mon_poll_ctx));
         ctx.lcore = cores[0];
         ctx.cluster = 0;
@@ -117,11 +155,12 @@ test_hw_mon_read_counter_tmem(void **state)
         will_return_maybe(__wrap__pqos_get_cap, data->cap);
         will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
 
-        expect_value(hw_mon_read, lcore, cores[0]);
-        expect_value(hw_mon_read, rmid, ctx.rmid);
-        expect_value(hw_mon_read, event, 2);
-        will_return(hw_mon_read, 5);
-        will_return(hw_mon_read, PQOS_RETVAL_OK);
+        expect_value(hw_mon_read_batch, num_ctx, 1);
+        expect_value(hw_mon_read_batch, event, 2);
+        expect_value(hw_mon_read_batch, lcore, cores[0]);
+        expect_value(hw_mon_read_batch, rmid, ctx.rmid);
+        will_return(hw_mon_read_batch, 5);
+        will_return(hw_mon_read_batch, PQOS_RETVAL_OK);
 
         ret = hw_mon_read_counter(&group, event);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -130,11 +169,12 @@ test_hw_mon_read_counter_tmem(void **state)
 
         group.intl->valid_mbm_read = 1;
 
-        expect_value(hw_mon_read, lcore, cores[0]);
-        expect_value(hw_mon_read, rmid, ctx.rmid);
-        expect_value(hw_mon_read, event, 2);
-        will_return(hw_mon_read, 10);
-        will_return(hw_mon_read, PQOS_RETVAL_OK);
+        expect_value(hw_mon_read_batch, num_ctx, 1);
+        expect_value(hw_mon_read_batch, event, 2);
+        expect_value(hw_mon_read_batch, lcore, cores[0]);
+        expect_value(hw_mon_read_batch, rmid, ctx.rmid);
+        will_return(hw_mon_read_batch, 10);
+        will_return(hw_mon_read_batch, PQOS_RETVAL_OK);
 
         ret = hw_mon_read_counter(&group, event);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -151,6 +191,8 @@ test_hw_mon_read_counter_lmem(void **state)
         struct pqos_mon_data group;
         struct pqos_mon_data_internal intl;
         struct pqos_mon_poll_ctx ctx;
+        struct machine_msr_op ops[2];
+        uint64_t values[1];
         enum pqos_mon_event event = PQOS_MON_EVENT_LMEM_BW;
         const struct pqos_monitor *pmon;
         int ret;
@@ -164,6 +206,8 @@ test_hw_mon_read_counter_lmem(void **state)
         memset(&intl, 0, sizeof(struct pqos_mon_data_internal));
         intl.hw.ctx = &ctx;
         intl.hw.num_ctx = 1;
+        intl.hw.ops = ops;
+        intl.hw.values = values;
         memset(&ctx, 0, sizeof(struct pqos_mon_poll_ctx));
         ctx.lcore = cores[0];
         ctx.cluster = 0;
@@ -172,11 +216,12 @@ test_hw_mon_read_counter_lmem(void **state)
         will_return_maybe(__wrap__pqos_get_cap, data->cap);
         will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
 
-        expect_value(hw_mon_read, lcore, cores[0]);
-        expect_value(hw_mon_read, rmid, ctx.rmid);
-        expect_value(hw_mon_read, event, 3);
-        will_return(hw_mon_read, 5);
-        will_return(hw_mon_read, PQOS_RETVAL_OK);
+        expect_value(hw_mon_read_batch, num_ctx, 1);
+        expect_value(hw_mon_read_batch, event, 3);
+        expect_value(hw_mon_read_batch, lcore, cores[0]);
+        expect_value(hw_mon_read_batch, rmid, ctx.rmid);
+        will_return(hw_mon_read_batch, 5);
+        will_return(hw_mon_read_batch, PQOS_RETVAL_OK);
 
         ret = hw_mon_read_counter(&group, event);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -185,11 +230,12 @@ test_hw_mon_read_counter_lmem(void **state)
 
         group.intl->valid_mbm_read = 1;
 
-        expect_value(hw_mon_read, lcore, cores[0]);
-        expect_value(hw_mon_read, rmid, ctx.rmid);
-        expect_value(hw_mon_read, event, 3);
-        will_return(hw_mon_read, 10);
-        will_return(hw_mon_read, PQOS_RETVAL_OK);
+        expect_value(hw_mon_read_batch, num_ctx, 1);
+        expect_value(hw_mon_read_batch, event, 3);
+        expect_value(hw_mon_read_batch, lcore, cores[0]);
+        expect_value(hw_mon_read_batch, rmid, ctx.rmid);
+        will_return(hw_mon_read_batch, 10);
+        will_return(hw_mon_read_batch, PQOS_RETVAL_OK);
 
         ret = hw_mon_read_counter(&group, event);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -206,6 +252,8 @@ test_hw_mon_read_counter_llc(void **state)
         struct pqos_mon_data group;
         struct pqos_mon_data_internal intl;
         struct pqos_mon_poll_ctx ctx;
+        struct machine_msr_op ops[2];
+        uint64_t values[1];
         enum pqos_mon_event event = PQOS_MON_EVENT_L3_OCCUP;
         const struct pqos_monitor *pmon;
         int ret;
@@ -219,6 +267,8 @@ test_hw_mon_read_counter_llc(void **state)
         memset(&intl, 0, sizeof(struct pqos_mon_data_internal));
         intl.hw.ctx = &ctx;
         intl.hw.num_ctx = 1;
+        intl.hw.ops = ops;
+        intl.hw.values = values;
         memset(&ctx, 0, sizeof(struct pqos_mon_poll_ctx));
         ctx.lcore = cores[0];
         ctx.cluster = 0;
@@ -227,17 +277,83 @@ test_hw_mon_read_counter_llc(void **state)
         will_return_maybe(__wrap__pqos_get_cap, data->cap);
         will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
 
-        expect_value(hw_mon_read, lcore, cores[0]);
-        expect_value(hw_mon_read, rmid, ctx.rmid);
-        expect_value(hw_mon_read, event, 1);
-        will_return(hw_mon_read, 5);
-        will_return(hw_mon_read, PQOS_RETVAL_OK);
+        expect_value(hw_mon_read_batch, num_ctx, 1);
+        expect_value(hw_mon_read_batch, event, 1);
+        expect_value(hw_mon_read_batch, lcore, cores[0]);
+        expect_value(hw_mon_read_batch, rmid, ctx.rmid);
+        will_return(hw_mon_read_batch, 5);
+        will_return(hw_mon_read_batch, PQOS_RETVAL_OK);
 
         ret = hw_mon_read_counter(&group, event);
         assert_int_equal(ret, PQOS_RETVAL_OK);
         assert_int_equal(group.values.llc, 5 * pmon->scale_factor);
 }
 
+static void
+test_hw_mon_read_counter_sampled(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned cores[] = {1};
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+        struct pqos_mon_poll_ctx ctx;
+        enum pqos_mon_event event = PQOS_MON_EVENT_TMEM_BW;
+        const struct pqos_monitor *pmon;
+        int ret;
+
+        pqos_cap_get_event(data->cap, event, &pmon);
+
+        memset(&group, 0, sizeof(struct pqos_mon_data));
+        group.intl = &intl;
+        group.num_cores = DIM(cores);
+        group.cores = cores;
+        memset(&intl, 0, sizeof(struct pqos_mon_data_internal));
+        intl.hw.ctx = &ctx;
+        intl.hw.num_ctx = 1;
+        memset(&ctx, 0, sizeof(struct pqos_mon_poll_ctx));
+        ctx.lcore = cores[0];
+        ctx.rmid = 2;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        m_sampled = 1;
+
+        /* accumulated values exceed counter length */
+        expect_value(__wrap_mbm_sampler_read, num_ctx, 1);
+        expect_value(__wrap_mbm_sampler_read, event, event);
+        will_return(__wrap_mbm_sampler_read, (1ULL << 24) + 5);
+        will_return(__wrap_mbm_sampler_read, PQOS_RETVAL_OK);
+
+        ret = hw_mon_read_counter(&group, event);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group.values.mbm_total, (1ULL << 24) + 5);
+        assert_int_equal(group.values.mbm_total_delta, 0);
+
+        group.intl->valid_mbm_read = 1;
+
+        expect_value(__wrap_mbm_sampler_read, num_ctx, 1);
+        expect_value(__wrap_mbm_sampler_read, event, event);
+        will_return(__wrap_mbm_sampler_read, (3ULL << 24) + 10);
+        will_return(__wrap_mbm_sampler_read, PQOS_RETVAL_OK);
+
+        ret = hw_mon_read_counter(&group, event);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group.values.mbm_total, (3ULL << 24) + 10);
+        assert_int_equal(group.values.mbm_total_delta,
+                         ((2ULL << 24) + 5) * pmon->scale_factor);
+
+        expect_value(__wrap_mbm_sampler_read, num_ctx, 1);
+        expect_value(__wrap_mbm_sampler_read, event, event);
+        will_return(__wrap_mbm_sampler_read, 0);
+        will_return(__wrap_mbm_sampler_read, PQOS_RETVAL_ERROR);
+
+        ret = hw_mon_read_counter(&group, event);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        m_sampled = 0;
+}
+
 int
 main(void)
 {
@@ -246,7 +362,8 @@ main(void)
         const struct CMUnitTest tests[] = {
             cmocka_unit_test(test_hw_mon_read_counter_tmem),
             cmocka_unit_test(test_hw_mon_read_counter_lmem),
-            cmocka_unit_test(test_hw_mon_read_counter_llc)};
+            cmocka_unit_test(test_hw_mon_read_counter_llc),
+            cmocka_unit_test(test_hw_mon_read_counter_sampled)};
 
         result += cmocka_run_group_tests(tests, wrap_init_mon, wrap_fini_mon);
 
@@ -38,6 +38,8 @@
 #include "perf_monitoring.h"
 #include "test.h"
 
+#include <unistd.h>
+
 /* ======== mock for master forwarding wrappers ======== */
 
 int
@@ -617,6 +619,51 @@ test_hw_mon_poll(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
 }
 
+/* ======== pqos_mon_poll_events ======== */
+
+static void
+test_pqos_mon_poll_events_time(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+        struct pqos_mon_poll_time *poll_time = &intl.poll_time;
+        uint64_t begin;
+        int ret;
+
+        memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        group.intl = &intl;
+        group.event = PQOS_MON_EVENT_L3_OCCUP;
+        intl.hw.event = PQOS_MON_EVENT_L3_OCCUP;
+
+        will_return(__wrap__pqos_get_inter, PQOS_INTER_MSR);
+        expect_value(hw_mon_read_counter, event, PQOS_MON_EVENT_L3_OCCUP);
+        will_return(hw_mon_read_counter, PQOS_RETVAL_OK);
+
+        ret = pqos_mon_poll_events(&group);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(poll_time->begin > 0);
+        assert_true(poll_time->end >= poll_time->begin);
+        assert_int_equal(poll_time->latency, poll_time->end - poll_time->begin);
+        assert_int_equal(poll_time->interval, 0);
+        begin = poll_time->begin;
+
+        usleep(1000);
+
+        will_return(__wrap__pqos_get_inter, PQOS_INTER_MSR);
+        expect_value(hw_mon_read_counter, event, PQOS_MON_EVENT_L3_OCCUP);
+        will_return(hw_mon_read_counter, PQOS_RETVAL_OK);
+
+        ret = pqos_mon_poll_events(&group);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(poll_time->begin >= begin + 1000000);
+        assert_true(poll_time->interval >= 1000000);
+#if defined(__x86_64__) || defined(__i386__)
+        assert_true(poll_time->tsc_end >= poll_time->tsc_begin);
+        assert_true(poll_time->tsc_begin > 0);
+#endif
+}
+
 /* ======== hw_mon_start_channels ======== */
 
 static void
@@ -798,6 +845,7 @@ main(void)
             cmocka_unit_test(test_hw_mon_start_mbm),
             cmocka_unit_test(test_hw_mon_start_perf),
             cmocka_unit_test(test_hw_mon_poll),
+            cmocka_unit_test(test_pqos_mon_poll_events_time),
             cmocka_unit_test(test_mon_reset_iordt_disable),
             cmocka_unit_test(test_mon_reset_iordt_enable),
             cmocka_unit_test(test_mon_reset_iordt_unsupported),
@@ -0,0 +1,196 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "id_pool.h"
+#include "test.h"
+
+/* ======== id_pool_init ======== */
+
+static void
+test_id_pool_init(void **state __attribute__((unused)))
+{
+        struct id_pool pool;
+        unsigned i;
+        int ret;
+
+        ret = id_pool_init(&pool, 100);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(pool.num, 100);
+
+        for (i = 0; i < 100; i++)
+                assert_false(id_pool_is_used(&pool, i));
+
+        id_pool_fini(&pool);
+        assert_null(pool.ref);
+        assert_null(pool.used);
+
+        /* fini of released pool */
+        id_pool_fini(&pool);
+}
+
+/* ======== id_pool_get ======== */
+
+static void
+test_id_pool_get(void **state __attribute__((unused)))
+{
+        struct id_pool pool;
+        int ret;
+
+        ret = id_pool_init(&pool, 100);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        id_pool_get(&pool, 0);
+        id_pool_get(&pool, 64);
+        id_pool_get(&pool, 64);
+        id_pool_get(&pool, 99);
+        /* out of range */
+        id_pool_get(&pool, 100);
+
+        assert_true(id_pool_is_used(&pool, 0));
+        assert_false(id_pool_is_used(&pool, 1));
+        assert_false(id_pool_is_used(&pool, 63));
+        assert_true(id_pool_is_used(&pool, 64));
+        assert_true(id_pool_is_used(&pool, 99));
+        assert_false(id_pool_is_used(&pool, 100));
+
+        id_pool_fini(&pool);
+}
+
+/* ======== id_pool_put ======== */
+
+static void
+test_id_pool_put(void **state __attribute__((unused)))
+{
+        struct id_pool pool;
+        int ret;
+
+        ret = id_pool_init(&pool, 100);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        id_pool_get(&pool, 64);
+        id_pool_get(&pool, 64);
+
+        id_pool_put(&pool, 64);
+        assert_true(id_pool_is_used(&pool, 64));
+
+        id_pool_put(&pool, 64);
+        assert_false(id_pool_is_used(&pool, 64));
+
+        /* out of range */
+        id_pool_put(&pool, 100);
+
+        id_pool_fini(&pool);
+}
+
+/* ======== id_pool_find_free ======== */
+
+static void
+test_id_pool_find_free(void **state __attribute__((unused)))
+{
+        struct id_pool pool;
+        unsigned id;
+        unsigned i;
+        int ret;
+
+        ret = id_pool_init(&pool, 200);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = id_pool_find_free(&pool, 1, 199, &id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(id, 1);
+
+        for (i = 0; i < 130; i++)
+                id_pool_get(&pool, i);
+        id_pool_get(&pool, 131);
+
+        ret = id_pool_find_free(&pool, 1, 199, &id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(id, 130);
+
+        ret = id_pool_find_free(&pool, 131, 199, &id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(id, 132);
+
+        ret = id_pool_find_free(&pool, 0, 129, &id);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        ret = id_pool_find_free(&pool, 131, 131, &id);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        id_pool_fini(&pool);
+}
+
+static void
+test_id_pool_find_free_range(void **state __attribute__((unused)))
+{
+        struct id_pool pool;
+        unsigned id;
+        unsigned i;
+        int ret;
+
+        ret = id_pool_init(&pool, 64);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        for (i = 0; i < 64; i++)
+                id_pool_get(&pool, i);
+
+        ret = id_pool_find_free(&pool, 0, 63, &id);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        /* ids out of pool range are free */
+        ret = id_pool_find_free(&pool, 0, 100, &id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(id, 64);
+
+        ret = id_pool_find_free(&pool, 10, 5, &id);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        id_pool_fini(&pool);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_id_pool_init),
+            cmocka_unit_test(test_id_pool_get),
+            cmocka_unit_test(test_id_pool_put),
+            cmocka_unit_test(test_id_pool_find_free),
+            cmocka_unit_test(test_id_pool_find_free_range),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
@@ -90,6 +90,30 @@ __wrap_pthread_mutex_unlock(pthread_mutex_t *mutex)
         return mock();
 }
 
+int
+__wrap_pthread_rwlock_rdlock(pthread_rwlock_t *rwlock)
+{
+        assert_non_null(rwlock);
+        function_called();
+        return mock();
+}
+
+int
+__wrap_pthread_rwlock_wrlock(pthread_rwlock_t *rwlock)
+{
+        assert_non_null(rwlock);
+        function_called();
+        return mock();
+}
+
+int
+__wrap_pthread_rwlock_unlock(pthread_rwlock_t *rwlock)
+{
+        assert_non_null(rwlock);
+        function_called();
+        return mock();
+}
+
 int
 __wrap_access(const char *pathname, int mode)
 {
@@ -324,13 +348,35 @@ test_lock_get(void **state __attribute__((unused)))
         assert_int_equal(lock_init(), 0);
 
         /* lock_get / lock_release */
+        expect_function_call(__wrap_pthread_rwlock_wrlock);
+        will_return(__wrap_pthread_rwlock_wrlock, 0);
+        lock_get();
+
+        expect_function_call(__wrap_pthread_rwlock_unlock);
+        will_return(__wrap_pthread_rwlock_unlock, 0);
+        lock_release();
+
+        /* lock_get_shared / lock_release */
+        expect_function_call(__wrap_pthread_rwlock_rdlock);
+        will_return(__wrap_pthread_rwlock_rdlock, 0);
+        lock_get_shared();
+
+        expect_function_call(__wrap_pthread_rwlock_unlock);
+        will_return(__wrap_pthread_rwlock_unlock, 0);
+        lock_release();
+
+        /* lock_alloc_get / lock_alloc_release */
+        expect_function_call(__wrap_pthread_rwlock_rdlock);
+        will_return(__wrap_pthread_rwlock_rdlock, 0);
         expect_function_call(__wrap_pthread_mutex_lock);
         will_return(__wrap_pthread_mutex_lock, 0);
-        lock_get();
+        lock_alloc_get();
 
         expect_function_call(__wrap_pthread_mutex_unlock);
         will_return(__wrap_pthread_mutex_unlock, 0);
-        lock_release();
+        expect_function_call(__wrap_pthread_rwlock_unlock);
+        will_return(__wrap_pthread_rwlock_unlock, 0);
+        lock_alloc_release();
 
         /* fini ok */
         expect_function_call(__wrap_close);
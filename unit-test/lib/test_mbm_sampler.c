@@ -0,0 +1,253 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mbm_sampler.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#define RMID_NUM     33
+#define COUNTER_MASK ((1ULL << 24) - 1)
+
+/* counter values, called from sampling thread */
+static uint64_t m_raw[RMID_NUM];
+static uint64_t m_step;
+static unsigned m_reads[RMID_NUM];
+
+/* ======== mock ======== */
+
+int
+__wrap_hw_mon_read_batch(const unsigned num_ctx,
+                         const struct pqos_mon_poll_ctx *ctx,
+                         const unsigned event,
+                         uint64_t *values,
+                         struct machine_msr_op *ops)
+{
+        unsigned i;
+
+        (void)event;
+        (void)ops;
+
+        for (i = 0; i < num_ctx; i++) {
+                const pqos_rmid_t rmid = ctx[i].rmid;
+
+                m_raw[rmid] = (m_raw[rmid] +
+                               __atomic_load_n(&m_step, __ATOMIC_SEQ_CST)) &
+                              COUNTER_MASK;
+                values[i] = m_raw[rmid];
+                __atomic_add_fetch(&m_reads[rmid], 1, __ATOMIC_SEQ_CST);
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/* ======== helpers ======== */
+
+static void
+sampler_init(void **state, const char *bw)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        memset(m_raw, 0, sizeof(m_raw));
+        memset(m_reads, 0, sizeof(m_reads));
+        m_step = 0;
+
+        setenv("RDT_MBM_SAMPLER", bw, 1);
+        ret = mbm_sampler_init(data->cpu, data->cap);
+        unsetenv("RDT_MBM_SAMPLER");
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(mbm_sampler_enabled(), 1);
+}
+
+/* ======== mbm_sampler_init ======== */
+
+static void
+test_mbm_sampler_disabled(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_mon_poll_ctx ctx = {.lcore = 0, .rmid = 1};
+        uint64_t value;
+        int ret;
+
+        unsetenv("RDT_MBM_SAMPLER");
+
+        ret = mbm_sampler_init(data->cpu, data->cap);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(mbm_sampler_enabled(), 0);
+        assert_int_equal(mbm_sampler_period(), 0);
+
+        ret = mbm_sampler_add(&ctx, 1, PQOS_MON_EVENT_LMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = mbm_sampler_read(&ctx, 1, PQOS_MON_EVENT_LMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        mbm_sampler_fini();
+}
+
+static void
+test_mbm_sampler_period(void **state)
+{
+        /* 2^24 bytes wrap at 1 GB/s in 16.7 ms */
+        sampler_init(state, "1");
+        assert_int_equal(mbm_sampler_period(), 4194);
+        mbm_sampler_fini();
+
+        /* limited to 1 ms */
+        sampler_init(state, "");
+        assert_int_equal(mbm_sampler_period(), 1000);
+        mbm_sampler_fini();
+
+        assert_int_equal(mbm_sampler_enabled(), 0);
+        assert_int_equal(mbm_sampler_period(), 0);
+}
+
+/* ======== mbm_sampler_read ======== */
+
+static void
+test_mbm_sampler_wrap(void **state)
+{
+        struct pqos_mon_poll_ctx ctx = {.lcore = 0, .rmid = 1};
+        uint64_t value;
+        int ret;
+
+        sampler_init(state, "1");
+
+        m_raw[1] = COUNTER_MASK - 0xf;
+        ret = mbm_sampler_add(&ctx, 1, PQOS_MON_EVENT_LMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        __atomic_store_n(&m_step, 0x20, __ATOMIC_SEQ_CST);
+        ret = mbm_sampler_read(&ctx, 1, PQOS_MON_EVENT_LMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        /* every read after the base adds one step */
+        assert_int_equal(value, (uint64_t)(m_reads[1] - 1) * 0x20);
+
+        /* total bandwidth is not sampled */
+        ret = mbm_sampler_read(&ctx, 1, PQOS_MON_EVENT_TMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        mbm_sampler_fini();
+}
+
+static void
+test_mbm_sampler_refcnt(void **state)
+{
+        struct pqos_mon_poll_ctx ctx[] = {{.lcore = 0, .rmid = 1},
+                                          {.lcore = 4, .rmid = 1}};
+        struct pqos_mon_poll_ctx ctx_inval = {.lcore = 0, .rmid = 100};
+        uint64_t value;
+        int ret;
+
+        sampler_init(state, "1");
+
+        ret = mbm_sampler_add(&ctx_inval, 1, PQOS_MON_EVENT_TMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        /* remote bandwidth samples local and total */
+        ret = mbm_sampler_add(ctx, DIM(ctx), PQOS_MON_EVENT_RMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = mbm_sampler_add(ctx, 1, PQOS_MON_EVENT_TMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = mbm_sampler_read(ctx, DIM(ctx), PQOS_MON_EVENT_LMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = mbm_sampler_read(ctx, DIM(ctx), PQOS_MON_EVENT_TMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        mbm_sampler_remove(ctx, DIM(ctx), PQOS_MON_EVENT_RMEM_BW);
+        ret = mbm_sampler_read(ctx, 1, PQOS_MON_EVENT_TMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = mbm_sampler_read(ctx, 1, PQOS_MON_EVENT_LMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = mbm_sampler_read(&ctx[1], 1, PQOS_MON_EVENT_TMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        mbm_sampler_reset();
+        ret = mbm_sampler_read(ctx, 1, PQOS_MON_EVENT_TMEM_BW, &value);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        mbm_sampler_fini();
+}
+
+/* ======== sampling thread ======== */
+
+static void
+test_mbm_sampler_thread(void **state)
+{
+        struct pqos_mon_poll_ctx ctx = {.lcore = 0, .rmid = 2};
+        unsigned reads;
+        uint64_t value;
+        unsigned i;
+        int ret;
+
+        sampler_init(state, "");
+        /* counter wraps every 4 reads */
+        __atomic_store_n(&m_step, 1ULL << 22, __ATOMIC_SEQ_CST);
+
+        ret = mbm_sampler_add(&ctx, 1, PQOS_MON_EVENT_LMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        for (i = 0; i < 1000; i++) {
+                if (__atomic_load_n(&m_reads[2], __ATOMIC_SEQ_CST) > 20)
+                        break;
+                usleep(1000);
+        }
+
+        ret = mbm_sampler_read(&ctx, 1, PQOS_MON_EVENT_LMEM_BW, &value);
+        reads = __atomic_load_n(&m_reads[2], __ATOMIC_SEQ_CST);
+        mbm_sampler_fini();
+
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(reads > 20);
+        /* every read after the base adds one step */
+        assert_int_equal(value, (uint64_t)(reads - 1) << 22);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_mbm_sampler_disabled),
+            cmocka_unit_test(test_mbm_sampler_period),
+            cmocka_unit_test(test_mbm_sampler_wrap),
+            cmocka_unit_test(test_mbm_sampler_refcnt),
+            cmocka_unit_test(test_mbm_sampler_thread),
+        };
+
+        result += cmocka_run_group_tests(tests, test_init_mon, test_fini);
+
+        return result;
+}
@@ -0,0 +1,307 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mmio.h"
+#include "test.h"
+
+#define CMRC_ADDR  0x10000000ULL
+#define CMRC_PAGES 1
+
+#define MMRC_ADDR  0x20000000ULL
+#define MMRC_PAGES 5
+
+static uint64_t m_block[CMRC_PAGES * PAGE_SIZE / sizeof(uint64_t)];
+static uint64_t m_mbm_block[MMRC_PAGES * PAGE_SIZE / sizeof(uint64_t)];
+
+/* ======== mock ======== */
+
+uint8_t *
+__wrap_pqos_mmap_read(uint64_t address, const uint64_t size)
+{
+        check_expected(address);
+        check_expected(size);
+
+        return mock_ptr_type(uint8_t *);
+}
+
+uint8_t *
+__wrap_pqos_mmap_write(uint64_t address, const uint64_t size)
+{
+        check_expected(address);
+        check_expected(size);
+
+        return mock_ptr_type(uint8_t *);
+}
+
+void
+__wrap_pqos_munmap(void *mem, const uint64_t size)
+{
+        check_expected(mem);
+        check_expected(size);
+}
+
+/**
+ * @brief Builds ERDT with a single CPU agent exposing CMRC block
+ */
+static void
+erdt_init(struct pqos_erdt_info *erdt, struct pqos_cpu_agent_info *agent)
+{
+        memset(agent, 0, sizeof(*agent));
+        agent->cmrc.block_base_addr = CMRC_ADDR;
+        agent->cmrc.block_size = CMRC_PAGES;
+        agent->cmrc.clump_size = 4;
+        agent->cmrc.clump_stride = 64;
+
+        memset(erdt, 0, sizeof(*erdt));
+        erdt->num_cpu_agents = 1;
+        erdt->cpu_agents = agent;
+}
+
+/* ======== mmio_map_init ======== */
+
+static void
+test_mmio_map_init_reuse(void **state __attribute__((unused)))
+{
+        struct pqos_erdt_info erdt;
+        struct pqos_cpu_agent_info agent;
+        l3_cmt_rmid_t val[2];
+        int ret;
+
+        erdt_init(&erdt, &agent);
+        m_block[0] = 0x11;
+        m_block[1] = 0x22;
+
+        /* block is mapped once at init */
+        expect_value(__wrap_pqos_mmap_read, address, CMRC_ADDR);
+        expect_value(__wrap_pqos_mmap_read, size, CMRC_PAGES * PAGE_SIZE);
+        will_return(__wrap_pqos_mmap_read, m_block);
+
+        ret = mmio_map_init(&erdt);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* reads are served from the mapping, no map/unmap per call */
+        ret = get_l3_cmt_rmid_range_v1(&agent.cmrc, 0, 1, val);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(val[0], 0x11);
+        assert_int_equal(val[1], 0x22);
+
+        ret = get_l3_cmt_rmid_range_v1(&agent.cmrc, 1, 1, val);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(val[0], 0x22);
+
+        expect_value(__wrap_pqos_munmap, mem, m_block);
+        expect_value(__wrap_pqos_munmap, size, CMRC_PAGES * PAGE_SIZE);
+
+        mmio_map_fini();
+}
+
+static void
+test_mmio_map_init_duplicate(void **state __attribute__((unused)))
+{
+        struct pqos_erdt_info erdt;
+        struct pqos_cpu_agent_info agents[2];
+        int ret;
+
+        erdt_init(&erdt, &agents[0]);
+        agents[1] = agents[0];
+        erdt.num_cpu_agents = 2;
+
+        /* block shared by two agents is mapped once */
+        expect_value(__wrap_pqos_mmap_read, address, CMRC_ADDR);
+        expect_value(__wrap_pqos_mmap_read, size, CMRC_PAGES * PAGE_SIZE);
+        will_return(__wrap_pqos_mmap_read, m_block);
+
+        ret = mmio_map_init(&erdt);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_pqos_munmap, mem, m_block);
+        expect_value(__wrap_pqos_munmap, size, CMRC_PAGES * PAGE_SIZE);
+
+        mmio_map_fini();
+}
+
+static void
+test_mmio_map_init_map_error(void **state __attribute__((unused)))
+{
+        struct pqos_erdt_info erdt;
+        struct pqos_cpu_agent_info agent;
+        l3_cmt_rmid_t val;
+        int ret;
+
+        erdt_init(&erdt, &agent);
+        m_block[0] = 0x33;
+
+        /* block that failed to map at init is mapped on each access */
+        expect_value(__wrap_pqos_mmap_read, address, CMRC_ADDR);
+        expect_value(__wrap_pqos_mmap_read, size, CMRC_PAGES * PAGE_SIZE);
+        will_return(__wrap_pqos_mmap_read, NULL);
+
+        ret = mmio_map_init(&erdt);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_pqos_mmap_read, address, CMRC_ADDR);
+        expect_value(__wrap_pqos_mmap_read, size, CMRC_PAGES * PAGE_SIZE);
+        will_return(__wrap_pqos_mmap_read, m_block);
+        expect_value(__wrap_pqos_munmap, mem, m_block);
+        expect_value(__wrap_pqos_munmap, size, CMRC_PAGES * PAGE_SIZE);
+
+        ret = get_l3_cmt_rmid_range_v1(&agent.cmrc, 0, 0, &val);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(val, 0x33);
+
+        /* nothing left to unmap */
+        mmio_map_fini();
+}
+
+/* ======== mmio_map_fini ======== */
+
+static void
+test_mmio_map_fini(void **state __attribute__((unused)))
+{
+        struct pqos_cpu_agent_info agent;
+        struct pqos_erdt_info erdt;
+        l3_cmt_rmid_t val;
+        int ret;
+
+        erdt_init(&erdt, &agent);
+
+        expect_value(__wrap_pqos_mmap_read, address, CMRC_ADDR);
+        expect_value(__wrap_pqos_mmap_read, size, CMRC_PAGES * PAGE_SIZE);
+        will_return(__wrap_pqos_mmap_read, m_block);
+
+        ret = mmio_map_init(&erdt);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_pqos_munmap, mem, m_block);
+        expect_value(__wrap_pqos_munmap, size, CMRC_PAGES * PAGE_SIZE);
+
+        mmio_map_fini();
+
+        /* after teardown block is mapped and unmapped per access */
+        expect_value(__wrap_pqos_mmap_read, address, CMRC_ADDR);
+        expect_value(__wrap_pqos_mmap_read, size, CMRC_PAGES * PAGE_SIZE);
+        will_return(__wrap_pqos_mmap_read, m_block);
+        expect_value(__wrap_pqos_munmap, mem, m_block);
+        expect_value(__wrap_pqos_munmap, size, CMRC_PAGES * PAGE_SIZE);
+
+        ret = get_l3_cmt_rmid_range_v1(&agent.cmrc, 0, 0, &val);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* second teardown is a no-op */
+        mmio_map_fini();
+}
+
+/* ======== get_l3_cmt_rmid_range_v1 ======== */
+
+static void
+test_get_l3_cmt_rmid_range_v1_clumps(void **state __attribute__((unused)))
+{
+        struct pqos_erdt_info erdt;
+        struct pqos_cpu_agent_info agent;
+        l3_cmt_rmid_t val[4];
+        int ret;
+
+        erdt_init(&erdt, &agent);
+        memset(m_block, 0, sizeof(m_block));
+        /* 4 RMIDs per clump, clumps 64 bytes apart */
+        m_block[2] = 0x2;
+        m_block[3] = 0x3;
+        m_block[8] = 0x4;
+        m_block[9] = 0x5;
+
+        expect_value(__wrap_pqos_mmap_read, address, CMRC_ADDR);
+        expect_value(__wrap_pqos_mmap_read, size, CMRC_PAGES * PAGE_SIZE);
+        will_return(__wrap_pqos_mmap_read, m_block);
+        expect_value(__wrap_pqos_munmap, mem, m_block);
+        expect_value(__wrap_pqos_munmap, size, CMRC_PAGES * PAGE_SIZE);
+
+        ret = get_l3_cmt_rmid_range_v1(&agent.cmrc, 2, 5, val);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(val[0], 0x2);
+        assert_int_equal(val[1], 0x3);
+        assert_int_equal(val[2], 0x4);
+        assert_int_equal(val[3], 0x5);
+}
+
+/* ======== get_l3_mbm_region_rmid_range_v1 ======== */
+
+static void
+test_get_l3_mbm_rmid_range_v1_blocks(void **state __attribute__((unused)))
+{
+        struct pqos_erdt_mmrc mmrc;
+        l3_mbm_rmid_t val[4];
+        const unsigned region_offset = MBM_REGION_SIZE / sizeof(uint64_t);
+        const unsigned block_offset = 4 * PAGE_SIZE / sizeof(uint64_t);
+        int ret;
+
+        memset(&mmrc, 0, sizeof(mmrc));
+        mmrc.reg_block_base_addr = MMRC_ADDR;
+        mmrc.reg_block_size = MMRC_PAGES;
+
+        memset(m_mbm_block, 0, sizeof(m_mbm_block));
+        /* RMIDs 6-7 and 8-9 are located in different 4 page blocks */
+        m_mbm_block[region_offset + 6] = 0x6;
+        m_mbm_block[region_offset + 7] = 0x7;
+        m_mbm_block[block_offset + region_offset] = 0x8;
+        m_mbm_block[block_offset + region_offset + 1] = 0x9;
+
+        expect_value(__wrap_pqos_mmap_read, address, MMRC_ADDR);
+        expect_value(__wrap_pqos_mmap_read, size, MMRC_PAGES * PAGE_SIZE);
+        will_return(__wrap_pqos_mmap_read, m_mbm_block);
+        expect_value(__wrap_pqos_munmap, mem, m_mbm_block);
+        expect_value(__wrap_pqos_munmap, size, MMRC_PAGES * PAGE_SIZE);
+
+        ret = get_l3_mbm_region_rmid_range_v1(&mmrc, 1, 6, 9, val);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(val[0], 0x6);
+        assert_int_equal(val[1], 0x7);
+        assert_int_equal(val[2], 0x8);
+        assert_int_equal(val[3], 0x9);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_mmio_map_init_reuse),
+            cmocka_unit_test(test_mmio_map_init_duplicate),
+            cmocka_unit_test(test_mmio_map_init_map_error),
+            cmocka_unit_test(test_mmio_map_fini),
+            cmocka_unit_test(test_get_l3_cmt_rmid_range_v1_clumps),
+            cmocka_unit_test(test_get_l3_mbm_rmid_range_v1_blocks)};
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
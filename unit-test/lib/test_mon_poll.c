@@ -0,0 +1,274 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mon_poll.h"
+#include "monitoring.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* ======== mock ======== */
+
+/** groups being polled by workers */
+static unsigned m_polling = 0;
+/** thread calling mon_poll() */
+static pthread_t m_caller;
+
+int
+__wrap_pqos_mon_poll_events(struct pqos_mon_data *group)
+{
+        /* called from worker threads, count polls in group values */
+        group->values.llc++;
+
+        /* groups marked serial are polled alone by the calling thread */
+        if (group->values.mbm_remote) {
+                assert_int_equal(
+                    __atomic_load_n(&m_polling, __ATOMIC_SEQ_CST), 0);
+                assert_true(pthread_equal(pthread_self(), m_caller));
+        } else if (!pthread_equal(pthread_self(), m_caller)) {
+                __atomic_add_fetch(&m_polling, 1, __ATOMIC_SEQ_CST);
+                usleep(1000);
+                __atomic_sub_fetch(&m_polling, 1, __ATOMIC_SEQ_CST);
+        }
+
+        return group->context == NULL ? PQOS_RETVAL_OK : PQOS_RETVAL_ERROR;
+}
+
+/* ======== helpers ======== */
+
+static void
+poll_groups(const int expect_ret)
+{
+        unsigned cores0[] = {0, 1};
+        unsigned cores1[] = {2, 3};
+        unsigned i;
+        struct pqos_mon_data group[3];
+        struct pqos_mon_data *groups[3];
+        int ret;
+
+        memset(group, 0, sizeof(group));
+        group[0].cores = cores0;
+        group[0].num_cores = DIM(cores0);
+        group[1].cores = cores1;
+        group[1].num_cores = DIM(cores1);
+        /* task group */
+        group[2].tid_nr = 1;
+        if (expect_ret != PQOS_RETVAL_OK)
+                group[1].context = (void *)&group[1];
+
+        for (i = 0; i < DIM(groups); i++)
+                groups[i] = &group[i];
+
+        ret = mon_poll(groups, DIM(groups));
+        assert_int_equal(ret, expect_ret);
+        ret = mon_poll(groups, DIM(groups));
+        assert_int_equal(ret, expect_ret);
+
+        for (i = 0; i < DIM(group); i++)
+                assert_int_equal(group[i].values.llc, 2);
+}
+
+/* ======== mon_poll ======== */
+
+static void
+test_mon_poll_serial(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        unsetenv("RDT_MON_POLL_PARALLEL");
+
+        ret = mon_poll_init(data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        poll_groups(PQOS_RETVAL_OK);
+        poll_groups(PQOS_RETVAL_ERROR);
+
+        ret = mon_poll_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+static void
+test_mon_poll_parallel(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        setenv("RDT_MON_POLL_PARALLEL", "1", 1);
+
+        ret = mon_poll_init(data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        poll_groups(PQOS_RETVAL_OK);
+        poll_groups(PQOS_RETVAL_ERROR);
+
+        ret = mon_poll_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        unsetenv("RDT_MON_POLL_PARALLEL");
+}
+
+static void
+test_mon_poll_parallel_span(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned cores0[] = {0, 1};
+        unsigned cores1[] = {4, 5};
+        unsigned span[] = {3, 4};
+        pid_t pids[] = {1};
+        struct pqos_mon_data group[4];
+        struct pqos_mon_data *groups[4];
+        unsigned i;
+        int ret;
+
+        setenv("RDT_MON_POLL_PARALLEL", "1", 1);
+        m_caller = pthread_self();
+
+        ret = mon_poll_init(data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        memset(group, 0, sizeof(group));
+        group[0].cores = cores0;
+        group[0].num_cores = DIM(cores0);
+        group[1].cores = cores1;
+        group[1].num_cores = DIM(cores1);
+        /* cores of both sockets */
+        group[2].cores = span;
+        group[2].num_cores = DIM(span);
+        group[2].values.mbm_remote = 1;
+        /* task group */
+        group[3].pids = pids;
+        group[3].num_pids = DIM(pids);
+
+        for (i = 0; i < DIM(groups); i++)
+                groups[i] = &group[i];
+
+        /* table of groups grows between polls */
+        ret = mon_poll(groups, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = mon_poll(groups, DIM(groups));
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        assert_int_equal(group[0].values.llc, 2);
+        assert_int_equal(group[1].values.llc, 2);
+        assert_int_equal(group[2].values.llc, 1);
+        assert_int_equal(group[3].values.llc, 1);
+
+        ret = mon_poll_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        unsetenv("RDT_MON_POLL_PARALLEL");
+}
+
+/* ======== mon_poll_lock ======== */
+
+struct lock_arg {
+        struct pqos_mon_data *group;
+        int locked;
+};
+
+static void *
+lock_thread(void *arg)
+{
+        struct lock_arg *la = (struct lock_arg *)arg;
+
+        mon_poll_lock(&la->group, 1);
+        __atomic_store_n(&la->locked, 1, __ATOMIC_SEQ_CST);
+        mon_poll_unlock(&la->group, 1);
+
+        return NULL;
+}
+
+static void
+test_mon_poll_lock(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data_internal intl[3];
+        struct pqos_mon_data group[3];
+        struct pqos_mon_data *groups[3];
+        struct lock_arg la;
+        pthread_t thread;
+        unsigned i;
+
+        memset(intl, 0, sizeof(intl));
+        memset(group, 0, sizeof(group));
+        for (i = 0; i < DIM(group); i++) {
+                group[i].intl = &intl[i];
+                groups[i] = &group[i];
+        }
+
+        /* disjoint sets do not block each other */
+        mon_poll_lock(&groups[0], 2);
+        mon_poll_lock(&groups[2], 1);
+        assert_int_equal(intl[0].busy, 1);
+        assert_int_equal(intl[1].busy, 1);
+        assert_int_equal(intl[2].busy, 1);
+        mon_poll_unlock(&groups[2], 1);
+        assert_int_equal(intl[2].busy, 0);
+
+        /* overlapping set waits for the group to be released */
+        la.group = &group[1];
+        la.locked = 0;
+        assert_int_equal(pthread_create(&thread, NULL, lock_thread, &la), 0);
+        usleep(10000);
+        assert_int_equal(__atomic_load_n(&la.locked, __ATOMIC_SEQ_CST), 0);
+
+        mon_poll_unlock(&groups[0], 2);
+        assert_int_equal(pthread_join(thread, NULL), 0);
+        assert_int_equal(la.locked, 1);
+        assert_int_equal(intl[1].busy, 0);
+
+        /* single group lock */
+        mon_poll_lock_group(&group[0]);
+        assert_int_equal(intl[0].busy, 1);
+        mon_poll_unlock_group(&group[0]);
+        assert_int_equal(intl[0].busy, 0);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_mon_poll_serial),
+            cmocka_unit_test(test_mon_poll_parallel),
+            cmocka_unit_test(test_mon_poll_parallel_span),
+            cmocka_unit_test(test_mon_poll_lock),
+        };
+
+        result += cmocka_run_group_tests(tests, test_init_mon, test_fini);
+
+        return result;
+}
@@ -0,0 +1,360 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mon_pub.h"
+#include "monitoring.h"
+#include "test.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define NUM_SLOTS 2
+
+static char m_dir[] = "/tmp/test_mon_pub.XXXXXX";
+static char m_path[sizeof(m_dir) + 8];
+
+/* ======== helpers ======== */
+
+static int
+test_mon_pub_setup(void **state)
+{
+        (void)state;
+
+        if (mkdtemp(m_dir) == NULL)
+                return -1;
+        snprintf(m_path, sizeof(m_path), "%s/pub", m_dir);
+
+        return 0;
+}
+
+static int
+test_mon_pub_teardown(void **state)
+{
+        (void)state;
+
+        unlink(m_path);
+        rmdir(m_dir);
+
+        return 0;
+}
+
+static void
+group_init(struct pqos_mon_data *group, unsigned *cores, unsigned num_cores)
+{
+        memset(group, 0, sizeof(*group));
+        group->intl = calloc(1, sizeof(*group->intl));
+        assert_non_null(group->intl);
+        group->event = PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_LMEM_BW;
+        group->cores = cores;
+        group->num_cores = num_cores;
+}
+
+/* ======== mon_pub_start ======== */
+
+static void
+test_mon_pub_start(void **state)
+{
+        struct pqos_mon_pub *pub;
+        unsigned num_slots;
+        int ret;
+
+        (void)state;
+
+        ret = mon_pub_start(m_path, NUM_SLOTS);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = mon_pub_start(m_path, NUM_SLOTS);
+        assert_int_equal(ret, PQOS_RETVAL_BUSY);
+
+        ret = pqos_mon_pub_open(m_path, &pub);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_mon_pub_num_slots(pub, &num_slots);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num_slots, NUM_SLOTS);
+
+        /* slots are cache line aligned */
+        assert_int_equal(sizeof(struct mon_pub_header) % MON_PUB_ALIGN, 0);
+        assert_int_equal(sizeof(struct mon_pub_slot) % MON_PUB_ALIGN, 0);
+
+        mon_pub_stop();
+
+        /* last data stays readable after publisher is gone */
+        ret = pqos_mon_pub_num_slots(pub, &num_slots);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        pqos_mon_pub_close(pub);
+}
+
+/* ======== pqos_mon_pub_open ======== */
+
+static void
+test_mon_pub_open_invalid(void **state)
+{
+        struct pqos_mon_pub *pub;
+        int fd;
+        int ret;
+
+        (void)state;
+
+        ret = pqos_mon_pub_open(m_path, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        fd = open(m_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        assert_true(fd >= 0);
+        assert_int_equal(ftruncate(fd, 4096), 0);
+        close(fd);
+
+        ret = pqos_mon_pub_open(m_path, &pub);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        unlink(m_path);
+        ret = pqos_mon_pub_open(m_path, &pub);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+}
+
+/* ======== mon_pub_write ======== */
+
+static void
+test_mon_pub_write(void **state)
+{
+        unsigned cores1[] = {1, 2};
+        unsigned cores2[] = {5};
+        unsigned cores3[] = {7};
+        struct pqos_mon_data group1, group2, group3;
+        struct pqos_mon_data *groups[] = {&group1, &group2, &group3};
+        struct pqos_mon_pub_group data;
+        struct pqos_mon_pub *pub;
+        int ret;
+
+        (void)state;
+
+        group_init(&group1, cores1, 2);
+        group_init(&group2, cores2, 1);
+        group_init(&group3, cores3, 1);
+        group1.values.llc = 100;
+        group2.values.mbm_local_delta = 200;
+
+        ret = mon_pub_start(m_path, NUM_SLOTS);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_mon_pub_open(m_path, &pub);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = pqos_mon_pub_read(pub, 0, &data);
+        assert_int_equal(ret, PQOS_RETVAL_UNAVAILABLE);
+        ret = pqos_mon_pub_read(pub, NUM_SLOTS, &data);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        /* no slot left for third group */
+        mon_pub_write(groups, 3);
+        assert_int_equal(group1.intl->pub_slot, 1);
+        assert_int_equal(group2.intl->pub_slot, 2);
+        assert_int_equal(group3.intl->pub_slot, 0);
+
+        ret = pqos_mon_pub_read(pub, 0, &data);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(data.event, group1.event);
+        assert_int_equal(data.num_cores, 2);
+        assert_int_equal(data.ids[0], 1);
+        assert_int_equal(data.ids[1], 2);
+        assert_int_equal(data.values.llc, 100);
+        assert_int_equal(data.polls, 1);
+        assert_int_equal(data.interval, 0);
+        assert_true(data.timestamp > 0);
+
+        mon_pub_write(groups, 2);
+        ret = pqos_mon_pub_read(pub, 1, &data);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(data.ids[0], 5);
+        assert_int_equal(data.values.mbm_local_delta, 200);
+        assert_int_equal(data.polls, 2);
+
+        /* slot of stopped group is reused */
+        mon_pub_remove(&group1);
+        ret = pqos_mon_pub_read(pub, 0, &data);
+        assert_int_equal(ret, PQOS_RETVAL_UNAVAILABLE);
+        mon_pub_write(&groups[2], 1);
+        assert_int_equal(group3.intl->pub_slot, 1);
+        ret = pqos_mon_pub_read(pub, 0, &data);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(data.ids[0], 7);
+        assert_int_equal(data.polls, 1);
+
+        /* reset releases all slots */
+        mon_pub_reset();
+        ret = pqos_mon_pub_read(pub, 1, &data);
+        assert_int_equal(ret, PQOS_RETVAL_UNAVAILABLE);
+        mon_pub_write(&groups[1], 1);
+        assert_int_equal(group2.intl->pub_slot, 1);
+
+        mon_pub_stop();
+        pqos_mon_pub_close(pub);
+
+        free(group1.intl);
+        free(group2.intl);
+        free(group3.intl);
+}
+
+/* ======== pqos_mon_pub_read ======== */
+
+static void
+test_mon_pub_read_busy(void **state)
+{
+        unsigned cores[] = {0};
+        struct pqos_mon_data group;
+        struct pqos_mon_data *groups[] = {&group};
+        struct pqos_mon_pub_group data;
+        struct pqos_mon_pub *pub;
+        struct mon_pub_slot *slot;
+        void *addr;
+        int fd;
+        int ret;
+
+        (void)state;
+
+        group_init(&group, cores, 1);
+
+        ret = mon_pub_start(m_path, NUM_SLOTS);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        mon_pub_write(groups, 1);
+
+        ret = pqos_mon_pub_open(m_path, &pub);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* publisher stuck in the middle of slot write */
+        fd = open(m_path, O_RDWR);
+        assert_true(fd >= 0);
+        addr = mmap(NULL, sizeof(struct mon_pub_header) + sizeof(*slot),
+                    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        assert_true(addr != MAP_FAILED);
+        slot = (struct mon_pub_slot *)((struct mon_pub_header *)addr + 1);
+        slot->seq++;
+
+        ret = pqos_mon_pub_read(pub, 0, &data);
+        assert_int_equal(ret, PQOS_RETVAL_BUSY);
+
+        slot->seq++;
+        ret = pqos_mon_pub_read(pub, 0, &data);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        munmap(addr, sizeof(struct mon_pub_header) + sizeof(*slot));
+        pqos_mon_pub_close(pub);
+        mon_pub_stop();
+        free(group.intl);
+}
+
+static int m_stop;
+
+static void *
+writer_thread(void *arg)
+{
+        struct pqos_mon_data *group = (struct pqos_mon_data *)arg;
+        uint64_t i;
+
+        for (i = 1; !__atomic_load_n(&m_stop, __ATOMIC_SEQ_CST); i++) {
+                group->values.llc = i;
+                group->values.mbm_local = i;
+                group->values.mbm_total = i;
+                mon_pub_write(&group, 1);
+                usleep(1);
+        }
+
+        return NULL;
+}
+
+static void
+test_mon_pub_read_consistent(void **state)
+{
+        unsigned cores[] = {0};
+        struct pqos_mon_data group;
+        struct pqos_mon_pub_group data;
+        struct pqos_mon_pub *pub;
+        pthread_t thread;
+        unsigned reads = 0;
+        unsigned i;
+        int ret;
+
+        (void)state;
+
+        group_init(&group, cores, 1);
+
+        ret = mon_pub_start(m_path, NUM_SLOTS);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = pqos_mon_pub_open(m_path, &pub);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        m_stop = 0;
+        assert_int_equal(pthread_create(&thread, NULL, writer_thread, &group),
+                         0);
+
+        for (i = 0; i < 1000000 && reads < 1000; i++) {
+                ret = pqos_mon_pub_read(pub, 0, &data);
+                if (ret != PQOS_RETVAL_OK)
+                        continue;
+
+                /* values of one poll are never mixed with another one */
+                assert_int_equal(data.values.llc, data.values.mbm_local);
+                assert_int_equal(data.values.llc, data.values.mbm_total);
+                assert_int_equal(data.values.llc, data.polls);
+                reads++;
+        }
+
+        __atomic_store_n(&m_stop, 1, __ATOMIC_SEQ_CST);
+        pthread_join(thread, NULL);
+        assert_true(reads > 0);
+
+        pqos_mon_pub_close(pub);
+        mon_pub_stop();
+        free(group.intl);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_mon_pub_start),
+            cmocka_unit_test(test_mon_pub_open_invalid),
+            cmocka_unit_test(test_mon_pub_write),
+            cmocka_unit_test(test_mon_pub_read_busy),
+            cmocka_unit_test(test_mon_pub_read_consistent),
+        };
+
+        result += cmocka_run_group_tests(tests, test_mon_pub_setup,
+                                         test_mon_pub_teardown);
+
+        return result;
+}
@@ -0,0 +1,382 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mon_sampler.h"
+#include "monitoring.h"
+#include "test.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define NUM_GROUPS 2
+/* long enough for sampling thread not to poll during the test */
+#define PERIOD_IDLE 100000000
+
+static uint64_t m_polls;
+static int m_poll_ret = PQOS_RETVAL_OK;
+static unsigned m_callbacks;
+static int m_callback_cpu;
+
+/* ======== mock ======== */
+
+int
+__wrap_pqos_mon_poll(struct pqos_mon_data **groups, const unsigned num_groups)
+{
+        const uint64_t value = ++m_polls;
+        unsigned i;
+
+        if (m_poll_ret != PQOS_RETVAL_OK)
+                return m_poll_ret;
+
+        for (i = 0; i < num_groups; i++) {
+                groups[i]->intl->poll_time.begin = value;
+                groups[i]->values.llc = value + i;
+                groups[i]->values.mbm_local = value + i;
+                groups[i]->values.mbm_total = value + i;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/* ======== helpers ======== */
+
+static struct pqos_mon_data_internal m_intl[NUM_GROUPS];
+static struct pqos_mon_data m_group[NUM_GROUPS] = {{.intl = &m_intl[0]},
+                                                   {.intl = &m_intl[1]}};
+static struct pqos_mon_data *m_groups[NUM_GROUPS] = {&m_group[0],
+                                                     &m_group[1]};
+
+static struct pqos_mon_sampler *
+sampler_start(const unsigned period_us, const unsigned history)
+{
+        struct pqos_mon_sampler_config cfg;
+        struct pqos_mon_sampler *sampler = NULL;
+        int ret;
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.period_us = period_us;
+        cfg.history = history;
+        cfg.lcore = -1;
+
+        m_polls = 0;
+        m_poll_ret = PQOS_RETVAL_OK;
+
+        ret = mon_sampler_start(m_groups, NUM_GROUPS, &cfg, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_non_null(sampler);
+        assert_int_equal(m_intl[0].sampled, 1);
+        assert_int_equal(m_intl[1].sampled, 1);
+
+        return sampler;
+}
+
+/* ======== pqos_mon_sampler_start ======== */
+
+static void
+test_mon_sampler_start_param(void **state)
+{
+        struct pqos_mon_sampler_config cfg;
+        struct pqos_mon_sampler *sampler;
+        int ret;
+
+        (void)state;
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.period_us = 1000;
+
+        ret = pqos_mon_sampler_start(NULL, 1, &cfg, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_mon_sampler_start(m_groups, 0, &cfg, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_mon_sampler_start(m_groups, 1, NULL, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_mon_sampler_start(m_groups, 1, &cfg, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        cfg.period_us = 0;
+        ret = pqos_mon_sampler_start(m_groups, 1, &cfg, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        cfg.period_us = 1000;
+        cfg.history = MON_SAMPLER_MAX_HISTORY + 1;
+        ret = pqos_mon_sampler_start(m_groups, 1, &cfg, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        /* groups not started */
+        cfg.history = 0;
+        ret = pqos_mon_sampler_start(m_groups, 1, &cfg, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+}
+
+/* ======== pqos_mon_sampler_read ======== */
+
+static void
+test_mon_sampler_read(void **state)
+{
+        struct pqos_mon_sampler *sampler;
+        struct pqos_mon_sample samples[8];
+        unsigned num;
+        uint64_t seq;
+        int ret;
+
+        (void)state;
+
+        sampler = sampler_start(PERIOD_IDLE, 0);
+
+        seq = 0;
+        ret = pqos_mon_sampler_read(sampler, 0, &seq, samples, 8, &num);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 0);
+        assert_int_equal(seq, 0);
+
+        mon_sampler_poll(sampler);
+        mon_sampler_poll(sampler);
+
+        ret = pqos_mon_sampler_seq(sampler, &seq);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(seq, 2);
+
+        seq = 0;
+        ret = pqos_mon_sampler_read(sampler, 1, &seq, samples, 8, &num);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 2);
+        assert_int_equal(seq, 2);
+        assert_int_equal(samples[0].seq, 0);
+        assert_int_equal(samples[0].values.llc, 2);
+        assert_int_equal(samples[0].status, PQOS_RETVAL_OK);
+        assert_int_equal(samples[1].seq, 1);
+        assert_int_equal(samples[1].values.llc, 3);
+        assert_int_equal(samples[1].poll_time.begin, 2);
+        assert_true(samples[1].timestamp >= samples[0].timestamp);
+
+        /* reading ahead of the sampler */
+        seq = 3;
+        ret = pqos_mon_sampler_read(sampler, 0, &seq, samples, 8, &num);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        ret = pqos_mon_sampler_read(sampler, NUM_GROUPS, &seq, samples, 8,
+                                    &num);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+
+        /* failed poll gives no sample */
+        m_poll_ret = PQOS_RETVAL_ERROR;
+        mon_sampler_poll(sampler);
+        ret = pqos_mon_sampler_seq(sampler, &seq);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(seq, 2);
+
+        ret = pqos_mon_sampler_stop(sampler);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(m_intl[0].sampled, 0);
+        assert_int_equal(m_intl[1].sampled, 0);
+}
+
+static void
+test_mon_sampler_history(void **state)
+{
+        struct pqos_mon_sampler *sampler;
+        struct pqos_mon_sample samples[8];
+        unsigned num;
+        unsigned i;
+        uint64_t seq;
+        int ret;
+
+        (void)state;
+
+        /* history rounded up to 4 samples */
+        sampler = sampler_start(PERIOD_IDLE, 3);
+        for (i = 0; i < 10; i++)
+                mon_sampler_poll(sampler);
+
+        /* lost samples are skipped, oldest entry may be rewritten */
+        seq = 0;
+        ret = pqos_mon_sampler_read(sampler, 0, &seq, samples, 8, &num);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 3);
+        assert_int_equal(seq, 10);
+        assert_int_equal(samples[0].seq, 7);
+        assert_int_equal(samples[0].values.llc, 8);
+        assert_int_equal(samples[2].seq, 9);
+
+        /* look back two samples, one at a time */
+        seq = 8;
+        ret = pqos_mon_sampler_read(sampler, 0, &seq, samples, 1, &num);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 1);
+        assert_int_equal(seq, 9);
+        assert_int_equal(samples[0].seq, 8);
+
+        ret = pqos_mon_sampler_read(sampler, 0, &seq, samples, 1, &num);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 1);
+        assert_int_equal(seq, 10);
+        assert_int_equal(samples[0].seq, 9);
+
+        pqos_mon_sampler_stop(sampler);
+}
+
+static void
+sampler_callback(void *context, const uint64_t seq)
+{
+        (void)seq;
+
+        if (context != &m_callbacks)
+                return;
+
+        /* core the first sample was taken on */
+        if (__atomic_add_fetch(&m_callbacks, 1, __ATOMIC_SEQ_CST) == 1)
+                m_callback_cpu = sched_getcpu();
+}
+
+static void
+test_mon_sampler_thread(void **state)
+{
+        struct pqos_mon_sampler_config cfg;
+        struct pqos_mon_sampler *sampler = NULL;
+        struct pqos_mon_sample samples[64];
+        struct pollfd pfd;
+        uint64_t count;
+        uint64_t seq = 0;
+        unsigned num;
+        int ret;
+
+        (void)state;
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.period_us = 1000;
+        cfg.lcore = 0;
+        cfg.callback = sampler_callback;
+        cfg.context = &m_callbacks;
+
+        m_callbacks = 0;
+        m_callback_cpu = -1;
+        m_poll_ret = PQOS_RETVAL_OK;
+        ret = mon_sampler_start(m_groups, NUM_GROUPS, &cfg, &sampler);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = pqos_mon_sampler_eventfd(sampler, &pfd.fd);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        pfd.events = POLLIN;
+        assert_int_equal(poll(&pfd, 1, 5000), 1);
+        assert_int_equal(read(pfd.fd, &count, sizeof(count)), sizeof(count));
+        assert_true(count >= 1);
+
+        ret = pqos_mon_sampler_read(sampler, 0, &seq, samples, 64, &num);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(num >= 1);
+        assert_int_equal(samples[0].seq, 0);
+
+        ret = pqos_mon_sampler_stop(sampler);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_true(m_callbacks >= 1);
+        assert_int_equal(m_callback_cpu, 0);
+}
+
+static int m_stop;
+
+static void *
+producer_thread(void *arg)
+{
+        struct pqos_mon_sampler *sampler = (struct pqos_mon_sampler *)arg;
+
+        while (!__atomic_load_n(&m_stop, __ATOMIC_SEQ_CST))
+                mon_sampler_poll(sampler);
+
+        return NULL;
+}
+
+static void
+test_mon_sampler_read_consistent(void **state)
+{
+        struct pqos_mon_sampler *sampler;
+        struct pqos_mon_sample samples[4];
+        pthread_t thread;
+        uint64_t seq = 0;
+        uint64_t last = 0;
+        unsigned reads = 0;
+        unsigned num;
+        unsigned i, j;
+
+        (void)state;
+
+        sampler = sampler_start(PERIOD_IDLE, 4);
+
+        m_stop = 0;
+        assert_int_equal(
+            pthread_create(&thread, NULL, producer_thread, sampler), 0);
+
+        for (i = 0; i < 1000000 && reads < 10000; i++) {
+                int ret = pqos_mon_sampler_read(sampler, 1, &seq, samples, 4,
+                                                &num);
+
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                for (j = 0; j < num; j++) {
+                        /* samples are never torn nor out of order */
+                        assert_int_equal(samples[j].values.llc,
+                                         samples[j].values.mbm_local);
+                        assert_int_equal(samples[j].values.llc,
+                                         samples[j].values.mbm_total);
+                        assert_int_equal(samples[j].values.llc,
+                                         samples[j].seq + 2);
+                        assert_true(reads == 0 || samples[j].seq > last);
+                        last = samples[j].seq;
+                        reads++;
+                }
+        }
+
+        __atomic_store_n(&m_stop, 1, __ATOMIC_SEQ_CST);
+        pthread_join(thread, NULL);
+        assert_true(reads > 0);
+
+        pqos_mon_sampler_stop(sampler);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_mon_sampler_start_param),
+            cmocka_unit_test(test_mon_sampler_read),
+            cmocka_unit_test(test_mon_sampler_history),
+            cmocka_unit_test(test_mon_sampler_thread),
+            cmocka_unit_test(test_mon_sampler_read_consistent),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
@@ -0,0 +1,472 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu_registers.h"
+#include "msr_shadow.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+/* ======== helpers ======== */
+
+static uint64_t
+assoc_value(const unsigned lcore)
+{
+        return (((uint64_t)(lcore % 2)) << PQOS_MSR_ASSOC_QECOS_SHIFT) | lcore;
+}
+
+static void
+expect_read(const unsigned lcore, const int ret, const uint64_t value)
+{
+        expect_value(__wrap_msr_read, lcore, lcore);
+        expect_value(__wrap_msr_read, reg, PQOS_MSR_ASSOC);
+        will_return(__wrap_msr_read, ret);
+        if (ret == PQOS_RETVAL_OK)
+                will_return(__wrap_msr_read, value);
+}
+
+static void
+shadow_init(struct pqos_cpuinfo *cpu)
+{
+        unsigned i;
+
+        for (i = 0; i < cpu->num_cores; i++)
+                cpu->cores[i].smba_id = cpu->cores[i].mba_id;
+
+        for (i = 0; i < cpu->num_cores; i++)
+                expect_read(cpu->cores[i].lcore, PQOS_RETVAL_OK,
+                            assoc_value(cpu->cores[i].lcore));
+
+        assert_int_equal(msr_shadow_init(cpu), PQOS_RETVAL_OK);
+}
+
+/* ======== msr_shadow_init ======== */
+
+static void
+test_msr_shadow_init(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        uint64_t value;
+        unsigned i;
+        int ret;
+
+        shadow_init(data->cpu);
+
+        /* no hardware access */
+        for (i = 0; i < data->cpu->num_cores; i++) {
+                const unsigned lcore = data->cpu->cores[i].lcore;
+
+                ret = msr_shadow_assoc_read(lcore, &value);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(value, assoc_value(lcore));
+        }
+
+        msr_shadow_fini();
+}
+
+static void
+test_msr_shadow_init_error(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        uint64_t value;
+        int ret;
+
+        expect_read(0, PQOS_RETVAL_ERROR, 0);
+
+        ret = msr_shadow_init(data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* value read from hardware on first use */
+        expect_read(2, PQOS_RETVAL_OK, 0x100000002ULL);
+        ret = msr_shadow_assoc_read(2, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 0x100000002ULL);
+
+        ret = msr_shadow_assoc_read(2, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 0x100000002ULL);
+
+        msr_shadow_fini();
+}
+
+/* ======== msr_shadow_assoc_read ======== */
+
+static void
+test_msr_shadow_assoc_read_uninitialized(void **state __attribute__((unused)))
+{
+        uint64_t value;
+        int ret;
+
+        expect_read(1, PQOS_RETVAL_OK, 5);
+        ret = msr_shadow_assoc_read(1, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 5);
+
+        expect_read(1, PQOS_RETVAL_ERROR, 0);
+        ret = msr_shadow_assoc_read(1, &value);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+}
+
+static void
+test_msr_shadow_assoc_read_interval(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        uint64_t value;
+        int ret;
+
+        setenv("RDT_ASSOC_REVALIDATE_MS", "1", 1);
+        shadow_init(data->cpu);
+        unsetenv("RDT_ASSOC_REVALIDATE_MS");
+
+        usleep(2000);
+
+        /* expired value is read again */
+        expect_read(3, PQOS_RETVAL_OK, 7);
+        ret = msr_shadow_assoc_read(3, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 7);
+
+        msr_shadow_fini();
+}
+
+/* ======== msr_shadow_assoc_write ======== */
+
+static void
+test_msr_shadow_assoc_write(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        uint64_t value;
+        int ret;
+
+        shadow_init(data->cpu);
+
+        expect_value(__wrap_msr_write, lcore, 1);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_ASSOC);
+        expect_value(__wrap_msr_write, value, 0x300000004ULL);
+        will_return(__wrap_msr_write, PQOS_RETVAL_OK);
+
+        ret = msr_shadow_assoc_write(1, 0x300000004ULL);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = msr_shadow_assoc_read(1, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 0x300000004ULL);
+
+        msr_shadow_fini();
+}
+
+static void
+test_msr_shadow_assoc_write_error(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        uint64_t value;
+        int ret;
+
+        shadow_init(data->cpu);
+
+        expect_value(__wrap_msr_write, lcore, 1);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_ASSOC);
+        expect_value(__wrap_msr_write, value, 0x300000004ULL);
+        will_return(__wrap_msr_write, PQOS_RETVAL_ERROR);
+
+        ret = msr_shadow_assoc_write(1, 0x300000004ULL);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        /* register state is unknown after failed write */
+        expect_read(1, PQOS_RETVAL_OK, assoc_value(1));
+        ret = msr_shadow_assoc_read(1, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, assoc_value(1));
+
+        msr_shadow_fini();
+}
+
+/* ======== msr_shadow_revalidate ======== */
+
+static void
+test_msr_shadow_revalidate(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned cores[2];
+        unsigned num = 0;
+        uint64_t value;
+        unsigned i;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        ret = msr_shadow_revalidate(0, &num, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+
+        shadow_init(data->cpu);
+
+        /* core 2 and 5 changed outside of the library */
+        for (i = 0; i < data->cpu->num_cores; i++) {
+                const unsigned lcore = data->cpu->cores[i].lcore;
+                uint64_t val = assoc_value(lcore);
+
+                if (lcore == 2 || lcore == 5)
+                        val = 9;
+                expect_read(lcore, PQOS_RETVAL_OK, val);
+        }
+
+        ret = msr_shadow_revalidate(1, &num, cores);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 2);
+        assert_int_equal(cores[0], 2);
+
+        ret = msr_shadow_assoc_read(5, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 9);
+
+        /* no changes since last check */
+        for (i = 0; i < data->cpu->num_cores; i++) {
+                const unsigned lcore = data->cpu->cores[i].lcore;
+
+                expect_read(lcore, PQOS_RETVAL_OK,
+                            lcore == 2 || lcore == 5 ? 9
+                                                     : assoc_value(lcore));
+        }
+
+        ret = msr_shadow_revalidate(0, &num, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(num, 0);
+
+        msr_shadow_fini();
+}
+
+static void
+test_msr_shadow_revalidate_error(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned num = 0;
+        uint64_t value;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        shadow_init(data->cpu);
+
+        expect_read(0, PQOS_RETVAL_ERROR, 0);
+        ret = msr_shadow_revalidate(0, &num, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        /* cached values are dropped */
+        expect_read(4, PQOS_RETVAL_OK, 1);
+        ret = msr_shadow_assoc_read(4, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 1);
+
+        msr_shadow_fini();
+}
+
+/* ======== msr_shadow_rmid_pool ======== */
+
+static void
+test_msr_shadow_rmid_pool(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const struct id_pool *pool;
+        uint64_t value;
+        unsigned i;
+        int ret;
+
+        assert_null(msr_shadow_rmid_pool(0));
+
+        shadow_init(data->cpu);
+
+        pool = msr_shadow_rmid_pool(0);
+        assert_non_null(pool);
+        for (i = 0; i < 8; i++)
+                assert_int_equal(id_pool_is_used(pool, i), i < 4);
+
+        pool = msr_shadow_rmid_pool(1);
+        assert_non_null(pool);
+        for (i = 0; i < 8; i++)
+                assert_int_equal(id_pool_is_used(pool, i), i >= 4);
+
+        assert_null(msr_shadow_rmid_pool(2));
+
+        /* core 1 moved to RMID 9 */
+        expect_value(__wrap_msr_write, lcore, 1);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_ASSOC);
+        expect_value(__wrap_msr_write, value, 9);
+        will_return(__wrap_msr_write, PQOS_RETVAL_OK);
+
+        ret = msr_shadow_assoc_write(1, 9);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        pool = msr_shadow_rmid_pool(0);
+        assert_non_null(pool);
+        assert_false(id_pool_is_used(pool, 1));
+        assert_true(id_pool_is_used(pool, 9));
+
+        /* association of core 1 unknown after failed write */
+        expect_value(__wrap_msr_write, lcore, 1);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_ASSOC);
+        expect_value(__wrap_msr_write, value, 1);
+        will_return(__wrap_msr_write, PQOS_RETVAL_ERROR);
+
+        ret = msr_shadow_assoc_write(1, 1);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+        assert_null(msr_shadow_rmid_pool(0));
+        assert_non_null(msr_shadow_rmid_pool(1));
+
+        /* pool restored once association is read again */
+        expect_read(1, PQOS_RETVAL_OK, 1);
+        ret = msr_shadow_assoc_read(1, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        pool = msr_shadow_rmid_pool(0);
+        assert_non_null(pool);
+        assert_true(id_pool_is_used(pool, 1));
+        assert_false(id_pool_is_used(pool, 9));
+
+        msr_shadow_fini();
+        assert_null(msr_shadow_rmid_pool(0));
+}
+
+static void
+test_msr_shadow_rmid_pool_init_error(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        expect_read(0, PQOS_RETVAL_ERROR, 0);
+
+        ret = msr_shadow_init(data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        assert_null(msr_shadow_rmid_pool(0));
+        assert_null(msr_shadow_rmid_pool(1));
+
+        msr_shadow_fini();
+}
+
+static void
+test_msr_shadow_rmid_pool_interval(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+
+        setenv("RDT_ASSOC_REVALIDATE_MS", "1000", 1);
+        shadow_init(data->cpu);
+        unsetenv("RDT_ASSOC_REVALIDATE_MS");
+
+        assert_null(msr_shadow_rmid_pool(0));
+        assert_null(msr_shadow_cos_pool(TOPO_OBJ_L3CAT, 0));
+
+        msr_shadow_fini();
+}
+
+/* ======== msr_shadow_cos_pool ======== */
+
+static void
+test_msr_shadow_cos_pool(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const enum pqos_topo_obj types[] = {TOPO_OBJ_L3CAT, TOPO_OBJ_MBA,
+                                            TOPO_OBJ_SMBA};
+        const struct id_pool *pool;
+        unsigned i;
+
+        assert_null(msr_shadow_cos_pool(TOPO_OBJ_L3CAT, 0));
+
+        shadow_init(data->cpu);
+
+        assert_true(msr_shadow_cos_aligned());
+
+        for (i = 0; i < DIM(types); i++) {
+                pool = msr_shadow_cos_pool(types[i], 1);
+                assert_non_null(pool);
+                assert_true(id_pool_is_used(pool, 0));
+                assert_true(id_pool_is_used(pool, 1));
+                assert_false(id_pool_is_used(pool, 2));
+        }
+
+        /* cores 4 and 5 */
+        pool = msr_shadow_cos_pool(TOPO_OBJ_L2_CLUSTER, 2);
+        assert_non_null(pool);
+        assert_true(id_pool_is_used(pool, 0));
+        assert_true(id_pool_is_used(pool, 1));
+
+        assert_null(msr_shadow_cos_pool(TOPO_OBJ_L2_CLUSTER, 4));
+        assert_null(msr_shadow_cos_pool(TOPO_OBJ_SOCKET, 0));
+
+        msr_shadow_fini();
+}
+
+static void
+test_msr_shadow_cos_aligned(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+
+        /* MBA domain spans both L3 CAT domains */
+        data->cpu->cores[7].mba_id = 0;
+        shadow_init(data->cpu);
+        data->cpu->cores[7].mba_id = 1;
+
+        assert_false(msr_shadow_cos_aligned());
+
+        msr_shadow_fini();
+        assert_false(msr_shadow_cos_aligned());
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_msr_shadow_assoc_read_uninitialized),
+        };
+
+        const struct CMUnitTest tests_all[] = {
+            cmocka_unit_test(test_msr_shadow_init),
+            cmocka_unit_test(test_msr_shadow_init_error),
+            cmocka_unit_test(test_msr_shadow_assoc_read_interval),
+            cmocka_unit_test(test_msr_shadow_assoc_write),
+            cmocka_unit_test(test_msr_shadow_assoc_write_error),
+            cmocka_unit_test(test_msr_shadow_revalidate),
+            cmocka_unit_test(test_msr_shadow_revalidate_error),
+            cmocka_unit_test(test_msr_shadow_rmid_pool),
+            cmocka_unit_test(test_msr_shadow_rmid_pool_init_error),
+            cmocka_unit_test(test_msr_shadow_rmid_pool_interval),
+            cmocka_unit_test(test_msr_shadow_cos_pool),
+            cmocka_unit_test(test_msr_shadow_cos_aligned),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+        result += cmocka_run_group_tests(tests_all, test_init_all, test_fini);
+
+        return result;
+}
@@ -32,6 +32,7 @@
 
 #include "monitoring.h"
 #include "os_monitoring.h"
+#include "perf_monitoring.h"
 #include "test.h"
 
 #include <dirent.h>
@@ -75,6 +76,23 @@ os_mon_tid_exists(const pid_t pid)
         return pid != 0xDEAD;
 }
 
+int __wrap_perf_read_counter(int counter_fd, uint64_t *value);
+
+int
+__wrap_perf_read_counter(int counter_fd, uint64_t *value)
+{
+        check_expected(counter_fd);
+        assert_non_null(value);
+
+        *value = mock_type(uint64_t);
+
+        return PQOS_RETVAL_OK;
+}
+
+/* threads of task 1 other than the leader */
+static pid_t task1_threads[4];
+static unsigned task1_num_threads;
+
 int
 __wrap_scandir(const char *restrict dirp,
                struct dirent ***restrict namelist,
@@ -85,16 +103,24 @@ __wrap_scandir(const char *restrict dirp,
         if (strncmp(dirp, "/proc", 5) == 0) {
                 int ret;
                 pid_t pid = 0;
+                unsigned num = 1;
+                unsigned i;
 
                 ret = sscanf(dirp, "/proc/%d/task", &pid);
                 if (ret != 1 || pid == 0 || pid == 0xDEAD)
                         return -1;
 
-                *namelist = malloc(sizeof(struct dirent *));
-                *namelist[0] = malloc(sizeof(struct dirent) + 10);
-                sprintf((*namelist)[0]->d_name, "%d", pid);
+                if (pid == 1)
+                        num += task1_num_threads;
+
+                *namelist = malloc(sizeof(struct dirent *) * num);
+                for (i = 0; i < num; i++) {
+                        (*namelist)[i] = malloc(sizeof(struct dirent) + 10);
+                        sprintf((*namelist)[i]->d_name, "%d",
+                                i == 0 ? pid : task1_threads[i - 1]);
+                }
 
-                return 1;
+                return num;
         }
 
         return -1;
@@ -617,6 +643,235 @@ test_os_mon_remove_pids(void **state)
         }
 }
 
+/* ======== os_mon_track_pids ======== */
+
+static void
+test_os_mon_track_pids(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+        pid_t pids[] = {1};
+        int ret;
+
+        memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        group.intl = &intl;
+
+        /* core monitoring group */
+        ret = os_mon_track_pids(&group, 1);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        assert_int_equal(intl.track_pids, 0);
+
+        group.num_pids = 1;
+        group.pids = pids;
+
+        ret = os_mon_track_pids(&group, 1);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(intl.track_pids, 1);
+
+        ret = os_mon_track_pids(&group, 0);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(intl.track_pids, 0);
+}
+
+/* ======== os_mon_sync_pids ======== */
+
+static void
+test_os_mon_sync_pids(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        /* init monitoring group */
+        memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        group.intl = &intl;
+
+        /* start monitoring */
+        {
+                unsigned num_pids = 1;
+                pid_t pids[] = {1};
+                enum pqos_mon_event event = PQOS_MON_EVENT_L3_OCCUP;
+
+                task1_num_threads = 0;
+
+                expect_value(os_mon_start_events, group, &group);
+                will_return(os_mon_start_events, PQOS_RETVAL_OK);
+
+                ret = os_mon_start_pids(num_pids, pids, event, NULL, &group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+        }
+
+        /* no changes */
+        {
+                ret = os_mon_sync_pids(&group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.num_pids, 1);
+                assert_int_equal(group.tid_nr, 1);
+        }
+
+        /* new threads */
+        {
+                task1_threads[0] = 10;
+                task1_threads[1] = 11;
+                task1_num_threads = 2;
+
+                expect_any(os_mon_start_events, group);
+                will_return(os_mon_start_events, PQOS_RETVAL_OK);
+
+                ret = os_mon_sync_pids(&group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.num_pids, 1);
+                assert_int_equal(group.tid_nr, 3);
+                assert_int_equal(group.tid_map[1], 10);
+                assert_int_equal(group.tid_map[2], 11);
+        }
+
+        /* one thread exited, another one created */
+        {
+                task1_threads[0] = 12;
+
+                expect_any(os_mon_stop_events, group);
+                will_return(os_mon_stop_events, PQOS_RETVAL_OK);
+                expect_any(os_mon_start_events, group);
+                will_return(os_mon_start_events, PQOS_RETVAL_OK);
+
+                ret = os_mon_sync_pids(&group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.num_pids, 1);
+                assert_int_equal(group.tid_nr, 3);
+                assert_int_equal(group.tid_map[0], 1);
+                assert_int_equal(group.tid_map[1], 11);
+                assert_int_equal(group.tid_map[2], 12);
+        }
+
+        /* new thread exited before counters were started */
+        {
+                task1_threads[2] = 13;
+                task1_num_threads = 3;
+
+                expect_any(os_mon_start_events, group);
+                will_return(os_mon_start_events, PQOS_RETVAL_ERROR);
+
+                ret = os_mon_sync_pids(&group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.tid_nr, 3);
+        }
+
+        /* all threads exited */
+        {
+                task1_num_threads = 0;
+
+                expect_any(os_mon_stop_events, group);
+                will_return(os_mon_stop_events, PQOS_RETVAL_OK);
+
+                ret = os_mon_sync_pids(&group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.num_pids, 1);
+                assert_int_equal(group.tid_nr, 1);
+                assert_int_equal(group.tid_map[0], 1);
+        }
+
+        /* stop monitoring */
+        {
+                expect_value(os_mon_stop_events, group, &group);
+                will_return(os_mon_stop_events, PQOS_RETVAL_OK);
+
+                ret = os_mon_stop(&group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_null(group.tid_map);
+                assert_null(group.pids);
+        }
+}
+
+static void
+test_os_mon_sync_pids_exited(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        group.intl = &intl;
+
+        /* start monitoring of task 1 with thread 10 */
+        {
+                pid_t pids[] = {1};
+
+                task1_threads[0] = 10;
+                task1_num_threads = 1;
+
+                expect_value(os_mon_start_events, group, &group);
+                will_return(os_mon_start_events, PQOS_RETVAL_OK);
+
+                ret = os_mon_start_pids(1, pids, PQOS_PERF_EVENT_LLC_MISS,
+                                        NULL, &group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.tid_nr, 2);
+
+                group.event = PQOS_PERF_EVENT_LLC_MISS;
+                intl.perf.event = PQOS_PERF_EVENT_LLC_MISS;
+                intl.perf.ctx[0].fd_llc_misses = 100;
+                intl.perf.ctx[1].fd_llc_misses = 101;
+        }
+
+        /* first poll */
+        {
+                expect_value(__wrap_perf_read_counter, counter_fd, 100);
+                will_return(__wrap_perf_read_counter, 1000);
+                expect_value(__wrap_perf_read_counter, counter_fd, 101);
+                will_return(__wrap_perf_read_counter, 500);
+
+                ret = perf_mon_poll(&group, PQOS_PERF_EVENT_LLC_MISS);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.values.llc_misses, 1500);
+        }
+
+        /* thread 10 exited, its final count is kept */
+        {
+                task1_num_threads = 0;
+
+                expect_value(__wrap_perf_read_counter, counter_fd, 101);
+                will_return(__wrap_perf_read_counter, 600);
+                expect_any(os_mon_stop_events, group);
+                will_return(os_mon_stop_events, PQOS_RETVAL_OK);
+
+                ret = os_mon_sync_pids(&group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.tid_nr, 1);
+        }
+
+        /* second poll, delta does not wrap */
+        {
+                expect_value(__wrap_perf_read_counter, counter_fd, 100);
+                will_return(__wrap_perf_read_counter, 1100);
+
+                ret = perf_mon_poll(&group, PQOS_PERF_EVENT_LLC_MISS);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(group.values.llc_misses, 1700);
+                assert_int_equal(group.values.llc_misses_delta, 200);
+        }
+
+        /* stop monitoring */
+        {
+                expect_value(os_mon_stop_events, group, &group);
+                will_return(os_mon_stop_events, PQOS_RETVAL_OK);
+
+                ret = os_mon_stop(&group);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+        }
+}
+
 int
 main(void)
 {
@@ -639,6 +894,9 @@ main(void)
             cmocka_unit_test(test_os_mon_start_pids),
             cmocka_unit_test(test_os_mon_add_pids),
             cmocka_unit_test(test_os_mon_remove_pids),
+            cmocka_unit_test(test_os_mon_track_pids),
+            cmocka_unit_test(test_os_mon_sync_pids),
+            cmocka_unit_test(test_os_mon_sync_pids_exited),
         };
 
         result += cmocka_run_group_tests(tests, test_init_mon, test_fini);
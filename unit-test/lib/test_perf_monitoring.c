@@ -201,6 +201,85 @@ __wrap_perf_read_counter(int counter_fd, uint64_t *value)
         return ret;
 }
 
+int
+__wrap_perf_read_counter_group(int counter_fd,
+                               const unsigned num,
+                               uint64_t *values,
+                               uint64_t *time_enabled,
+                               uint64_t *time_running)
+{
+        int ret;
+        unsigned i;
+
+        check_expected(counter_fd);
+        check_expected(num);
+        assert_non_null(values);
+        assert_non_null(time_enabled);
+        assert_non_null(time_running);
+
+        ret = mock_type(int);
+        if (ret == PQOS_RETVAL_OK) {
+                *time_enabled = mock_type(uint64_t);
+                *time_running = mock_type(uint64_t);
+                for (i = 0; i < num; i++)
+                        values[i] = mock_type(uint64_t);
+        }
+
+        return ret;
+}
+
+int
+__wrap_perf_mmap_counter(int counter_fd, struct perf_event_mmap_page **page)
+{
+        int ret;
+
+        check_expected(counter_fd);
+        assert_non_null(page);
+
+        ret = mock_type(int);
+        if (ret == PQOS_RETVAL_OK)
+                *page = mock_ptr_type(struct perf_event_mmap_page *);
+
+        return ret;
+}
+
+int
+__wrap_perf_munmap_counter(struct perf_event_mmap_page *page)
+{
+        check_expected(page);
+
+        return mock_type(int);
+}
+
+int
+__wrap_perf_rdpmc_counter(const struct perf_event_mmap_page *page,
+                          uint64_t *value,
+                          uint64_t *time_enabled,
+                          uint64_t *time_running)
+{
+        int ret;
+
+        check_expected(page);
+        assert_non_null(value);
+        assert_non_null(time_enabled);
+        assert_non_null(time_running);
+
+        ret = mock_type(int);
+        if (ret == PQOS_RETVAL_OK) {
+                *time_enabled = mock_type(uint64_t);
+                *time_running = mock_type(uint64_t);
+                *value = mock_type(uint64_t);
+        }
+
+        return ret;
+}
+
+int
+__wrap_sched_getcpu(void)
+{
+        return mock_type(int);
+}
+
 static int
 _perf_mon_init(void **state __attribute__((unused)))
 {
@@ -213,6 +292,16 @@ _perf_mon_init(void **state __attribute__((unused)))
         return 0;
 }
 
+static int
+_perf_mon_init_rdpmc(void **state __attribute__((unused)))
+{
+        setenv("RDT_PERF_RDPMC", "1", 1);
+        _perf_mon_init(state);
+        unsetenv("RDT_PERF_RDPMC");
+
+        return 0;
+}
+
 static int
 _perf_mon_fini(void **state __attribute__((unused)))
 {
@@ -773,6 +862,288 @@ test_perf_mon_poll_pid_param(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_ERROR);
 }
 
+/* ======== perf event group ======== */
+
+static void
+test_perf_mon_group(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_data grp;
+        struct pqos_mon_data_internal intl;
+        unsigned cores[] = {1};
+        const unsigned cores_num = DIM(cores);
+        struct pqos_mon_perf_ctx ctx[cores_num];
+        const enum pqos_mon_event cyc =
+            (enum pqos_mon_event)PQOS_PERF_EVENT_CYCLES;
+        const enum pqos_mon_event inst =
+            (enum pqos_mon_event)PQOS_PERF_EVENT_INSTRUCTIONS;
+
+        memset(&grp, 0, sizeof(grp));
+        memset(&intl, 0, sizeof(intl));
+        memset(ctx, 0, sizeof(struct pqos_mon_perf_ctx) * cores_num);
+        grp.intl = &intl;
+        grp.num_cores = cores_num;
+        grp.cores = cores;
+        grp.intl->perf.ctx = ctx;
+
+        /* cycles opened as group leader */
+        expect_not_value(__wrap_perf_setup_counter, attr, 0);
+        expect_value(__wrap_perf_setup_counter, pid, -1);
+        expect_value(__wrap_perf_setup_counter, cpu, cores[0]);
+        expect_value(__wrap_perf_setup_counter, group_fd, -1);
+        expect_value(__wrap_perf_setup_counter, flags, 0);
+        will_return(__wrap_perf_setup_counter, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_setup_counter, 0xDEAD);
+
+        ret = perf_mon_start(&grp, cyc);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* instructions attached to leader */
+        expect_not_value(__wrap_perf_setup_counter, attr, 0);
+        expect_value(__wrap_perf_setup_counter, pid, -1);
+        expect_value(__wrap_perf_setup_counter, cpu, cores[0]);
+        expect_value(__wrap_perf_setup_counter, group_fd, 0xDEAD);
+        expect_value(__wrap_perf_setup_counter, flags, 0);
+        will_return(__wrap_perf_setup_counter, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_setup_counter, 0xBEEF);
+
+        ret = perf_mon_start(&grp, inst);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(grp.intl->perf.grp_num, 2);
+
+        /* single read of the group, counters running half of the time */
+        expect_value(__wrap_perf_read_counter_group, counter_fd, 0xDEAD);
+        expect_value(__wrap_perf_read_counter_group, num, 2);
+        will_return(__wrap_perf_read_counter_group, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_read_counter_group, 200);
+        will_return(__wrap_perf_read_counter_group, 100);
+        will_return(__wrap_perf_read_counter_group, 1000);
+        will_return(__wrap_perf_read_counter_group, 500);
+
+        ret = perf_mon_poll(&grp, cyc);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = perf_mon_poll(&grp, inst);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(grp.values.ipc_unhalted, 2000);
+        assert_int_equal(grp.values.ipc_retired, 1000);
+        assert_true(grp.intl->perf.grp_scale == 0.5);
+
+        /* leader closed together with last member */
+        ret = perf_mon_stop(&grp, cyc);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_perf_shutdown_counter, counter_fd, 0xBEEF);
+        will_return(__wrap_perf_shutdown_counter, PQOS_RETVAL_OK);
+        expect_value(__wrap_perf_shutdown_counter, counter_fd, 0xDEAD);
+        will_return(__wrap_perf_shutdown_counter, PQOS_RETVAL_OK);
+
+        ret = perf_mon_stop(&grp, inst);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(grp.intl->perf.grp_event, 0);
+}
+
+/* ======== rdpmc ======== */
+
+#define RDPMC_PAGE_CYC  ((struct perf_event_mmap_page *)0x1000)
+#define RDPMC_PAGE_INST ((struct perf_event_mmap_page *)0x2000)
+
+static unsigned rdpmc_cores[] = {1};
+static struct pqos_mon_perf_ctx rdpmc_ctx[DIM(rdpmc_cores)];
+static struct pqos_mon_data_internal rdpmc_intl;
+static struct pqos_mon_data rdpmc_grp;
+
+static const enum pqos_mon_event rdpmc_cyc =
+    (enum pqos_mon_event)PQOS_PERF_EVENT_CYCLES;
+static const enum pqos_mon_event rdpmc_inst =
+    (enum pqos_mon_event)PQOS_PERF_EVENT_INSTRUCTIONS;
+
+/**
+ * Group of cycles and instructions with mapped perf event pages
+ */
+static struct pqos_mon_data *
+rdpmc_group(void)
+{
+        memset(&rdpmc_grp, 0, sizeof(rdpmc_grp));
+        memset(&rdpmc_intl, 0, sizeof(rdpmc_intl));
+        memset(rdpmc_ctx, 0, sizeof(rdpmc_ctx));
+        rdpmc_grp.intl = &rdpmc_intl;
+        rdpmc_grp.num_cores = DIM(rdpmc_cores);
+        rdpmc_grp.cores = rdpmc_cores;
+        rdpmc_intl.perf.ctx = rdpmc_ctx;
+        rdpmc_intl.perf.grp_num = 2;
+        rdpmc_intl.perf.grp_evt[0] = rdpmc_cyc;
+        rdpmc_intl.perf.grp_evt[1] = rdpmc_inst;
+        rdpmc_intl.perf.grp_event = rdpmc_cyc | rdpmc_inst;
+        rdpmc_ctx[0].fd_cyc = 0xDEAD;
+        rdpmc_ctx[0].fd_inst = 0xBEEF;
+        rdpmc_ctx[0].grp_page[0] = RDPMC_PAGE_CYC;
+        rdpmc_ctx[0].grp_page[1] = RDPMC_PAGE_INST;
+
+        return &rdpmc_grp;
+}
+
+static void
+expect_rdpmc(const struct perf_event_mmap_page *page,
+             const uint64_t enabled,
+             const uint64_t running,
+             const uint64_t value)
+{
+        expect_value(__wrap_perf_rdpmc_counter, page, page);
+        will_return(__wrap_perf_rdpmc_counter, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_rdpmc_counter, enabled);
+        will_return(__wrap_perf_rdpmc_counter, running);
+        will_return(__wrap_perf_rdpmc_counter, value);
+}
+
+static void
+expect_group_read(void)
+{
+        expect_value(__wrap_perf_read_counter_group, counter_fd, 0xDEAD);
+        expect_value(__wrap_perf_read_counter_group, num, 2);
+        will_return(__wrap_perf_read_counter_group, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_read_counter_group, 200);
+        will_return(__wrap_perf_read_counter_group, 200);
+        will_return(__wrap_perf_read_counter_group, 30);
+        will_return(__wrap_perf_read_counter_group, 10);
+}
+
+static void
+rdpmc_poll(struct pqos_mon_data *grp,
+           const uint64_t unhalted,
+           const uint64_t retired)
+{
+        int ret;
+
+        ret = perf_mon_poll(grp, rdpmc_cyc);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = perf_mon_poll(grp, rdpmc_inst);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(grp->values.ipc_unhalted, unhalted);
+        assert_int_equal(grp->values.ipc_retired, retired);
+}
+
+static void
+test_perf_mon_rdpmc_start_stop(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_data *grp = rdpmc_group();
+
+        memset(&rdpmc_intl.perf, 0, sizeof(rdpmc_intl.perf));
+        rdpmc_intl.perf.ctx = rdpmc_ctx;
+
+        /* perf event page mapped for each group event */
+        expect_not_value(__wrap_perf_setup_counter, attr, 0);
+        expect_value(__wrap_perf_setup_counter, pid, -1);
+        expect_value(__wrap_perf_setup_counter, cpu, 1);
+        expect_value(__wrap_perf_setup_counter, group_fd, -1);
+        expect_value(__wrap_perf_setup_counter, flags, 0);
+        will_return(__wrap_perf_setup_counter, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_setup_counter, 0xDEAD);
+        expect_value(__wrap_perf_mmap_counter, counter_fd, 0xDEAD);
+        will_return(__wrap_perf_mmap_counter, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_mmap_counter, RDPMC_PAGE_CYC);
+
+        ret = perf_mon_start(grp, rdpmc_cyc);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_not_value(__wrap_perf_setup_counter, attr, 0);
+        expect_value(__wrap_perf_setup_counter, pid, -1);
+        expect_value(__wrap_perf_setup_counter, cpu, 1);
+        expect_value(__wrap_perf_setup_counter, group_fd, 0xDEAD);
+        expect_value(__wrap_perf_setup_counter, flags, 0);
+        will_return(__wrap_perf_setup_counter, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_setup_counter, 0xBEEF);
+        expect_value(__wrap_perf_mmap_counter, counter_fd, 0xBEEF);
+        will_return(__wrap_perf_mmap_counter, PQOS_RETVAL_OK);
+        will_return(__wrap_perf_mmap_counter, RDPMC_PAGE_INST);
+
+        ret = perf_mon_start(grp, rdpmc_inst);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_ptr_equal(rdpmc_ctx[0].grp_page[0], RDPMC_PAGE_CYC);
+        assert_ptr_equal(rdpmc_ctx[0].grp_page[1], RDPMC_PAGE_INST);
+
+        /* pages unmapped before counters are closed */
+        ret = perf_mon_stop(grp, rdpmc_cyc);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_perf_munmap_counter, page, RDPMC_PAGE_INST);
+        will_return(__wrap_perf_munmap_counter, PQOS_RETVAL_OK);
+        expect_value(__wrap_perf_shutdown_counter, counter_fd, 0xBEEF);
+        will_return(__wrap_perf_shutdown_counter, PQOS_RETVAL_OK);
+        expect_value(__wrap_perf_munmap_counter, page, RDPMC_PAGE_CYC);
+        will_return(__wrap_perf_munmap_counter, PQOS_RETVAL_OK);
+        expect_value(__wrap_perf_shutdown_counter, counter_fd, 0xDEAD);
+        will_return(__wrap_perf_shutdown_counter, PQOS_RETVAL_OK);
+
+        ret = perf_mon_stop(grp, rdpmc_inst);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_null(rdpmc_ctx[0].grp_page[0]);
+        assert_null(rdpmc_ctx[0].grp_page[1]);
+}
+
+static void
+test_perf_mon_rdpmc_poll(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data *grp = rdpmc_group();
+
+        /* polled on the monitored core, no read() */
+        will_return(__wrap_sched_getcpu, 1);
+        expect_rdpmc(RDPMC_PAGE_CYC, 200, 100, 1000);
+        expect_rdpmc(RDPMC_PAGE_INST, 200, 100, 500);
+        will_return(__wrap_sched_getcpu, 1);
+
+        rdpmc_poll(grp, 2000, 1000);
+}
+
+static void
+test_perf_mon_rdpmc_poll_other_core(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data *grp = rdpmc_group();
+
+        will_return(__wrap_sched_getcpu, 3);
+        expect_group_read();
+
+        rdpmc_poll(grp, 30, 10);
+}
+
+static void
+test_perf_mon_rdpmc_poll_migrated(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data *grp = rdpmc_group();
+
+        /* thread migrated during rdpmc, values are discarded */
+        will_return(__wrap_sched_getcpu, 1);
+        expect_rdpmc(RDPMC_PAGE_CYC, 200, 100, 1000);
+        expect_rdpmc(RDPMC_PAGE_INST, 200, 100, 500);
+        will_return(__wrap_sched_getcpu, 2);
+        expect_group_read();
+
+        rdpmc_poll(grp, 30, 10);
+}
+
+static void
+test_perf_mon_rdpmc_poll_unavailable(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data *grp = rdpmc_group();
+
+        /* event not scheduled on PMU */
+        will_return(__wrap_sched_getcpu, 1);
+        expect_value(__wrap_perf_rdpmc_counter, page, RDPMC_PAGE_CYC);
+        will_return(__wrap_perf_rdpmc_counter, PQOS_RETVAL_RESOURCE);
+        expect_group_read();
+
+        rdpmc_poll(grp, 30, 10);
+
+        /* page not mapped */
+        grp = rdpmc_group();
+        rdpmc_ctx[0].grp_page[1] = NULL;
+        will_return(__wrap_sched_getcpu, 1);
+        expect_rdpmc(RDPMC_PAGE_CYC, 200, 100, 1000);
+        expect_group_read();
+
+        rdpmc_poll(grp, 30, 10);
+}
+
 int
 main(void)
 {
@@ -794,6 +1165,7 @@ main(void)
             cmocka_unit_test(test_perf_mon_stop_param),
             cmocka_unit_test(test_perf_mon_poll_core),
             cmocka_unit_test(test_perf_mon_poll_param),
+            cmocka_unit_test(test_perf_mon_group),
         };
 
         const struct CMUnitTest tests_pid[] = {
@@ -803,11 +1175,21 @@ main(void)
             cmocka_unit_test(test_perf_mon_poll_pid_param),
         };
 
+        const struct CMUnitTest tests_rdpmc[] = {
+            cmocka_unit_test(test_perf_mon_rdpmc_start_stop),
+            cmocka_unit_test(test_perf_mon_rdpmc_poll),
+            cmocka_unit_test(test_perf_mon_rdpmc_poll_other_core),
+            cmocka_unit_test(test_perf_mon_rdpmc_poll_migrated),
+            cmocka_unit_test(test_perf_mon_rdpmc_poll_unavailable),
+        };
+
         result += cmocka_run_group_tests(tests_init, NULL, _perf_mon_fini);
         result +=
             cmocka_run_group_tests(tests_core, _perf_mon_init, _perf_mon_fini);
         result +=
             cmocka_run_group_tests(tests_pid, _perf_mon_init, _perf_mon_fini);
+        result += cmocka_run_group_tests(tests_rdpmc, _perf_mon_init_rdpmc,
+                                         _perf_mon_fini);
 
         return result;
 }
@@ -53,7 +53,7 @@ test_pqos_inter_get_os(void **state __attribute__((unused)))
         _pqos_set_inter(PQOS_INTER_OS);
         assert_int_equal(__real__pqos_get_inter(), PQOS_INTER_OS);
 
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_value(__wrap__pqos_check_init, expect, 1);
         will_return(__wrap__pqos_check_init, PQOS_RETVAL_OK);
         expect_function_call(__wrap_lock_release);
@@ -74,7 +74,7 @@ test_pqos_inter_get_msr(void **state __attribute__((unused)))
         _pqos_set_inter(PQOS_INTER_MSR);
         assert_int_equal(__real__pqos_get_inter(), PQOS_INTER_MSR);
 
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_value(__wrap__pqos_check_init, expect, 1);
         will_return(__wrap__pqos_check_init, PQOS_RETVAL_OK);
         expect_function_call(__wrap_lock_release);
@@ -92,7 +92,7 @@ test_pqos_inter_get_init(void **state __attribute__((unused)))
         int ret;
         enum pqos_interface interface;
 
-        expect_function_call(__wrap_lock_get);
+        expect_function_call(__wrap_lock_get_shared);
         expect_value(__wrap__pqos_check_init, expect, 1);
         will_return(__wrap__pqos_check_init, PQOS_RETVAL_INIT);
         expect_function_call(__wrap_lock_release);
@@ -33,6 +33,11 @@
 #include "resctrl.h"
 #include "test.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
 /* ======== mock ======== */
 
 int
@@ -63,6 +68,61 @@ __wrap_umount2(const char *target, int flags)
         return mock_type(int);
 }
 
+int __real_open(const char *path, int flags, ...);
+
+int
+__wrap_open(const char *path, int flags, ...)
+{
+        if (strcmp(path, RESCTRL_PATH) != 0)
+                return __real_open(path, flags);
+
+        check_expected(path);
+        assert_true(flags & O_CLOEXEC);
+
+        return mock_type(int);
+}
+
+int
+__wrap_flock(int fd, int operation)
+{
+        int ret;
+
+        assert_true(fd >= 0);
+        check_expected(operation);
+
+        ret = mock_type(int);
+        if (ret != 0)
+                errno = EWOULDBLOCK;
+
+        return ret;
+}
+
+static unsigned m_slept;
+
+int
+__wrap_usleep(useconds_t usec)
+{
+        m_slept += usec;
+
+        return 0;
+}
+
+/* ======== helpers ======== */
+
+static void
+expect_open(void)
+{
+        expect_string(__wrap_open, path, RESCTRL_PATH);
+        will_return(__wrap_open, open("/", O_RDONLY | O_DIRECTORY));
+}
+
+static void
+expect_flock(const int operation, const int ret)
+{
+        expect_value(__wrap_flock, operation, operation);
+        will_return(__wrap_flock, ret);
+}
+
 /* ======== resctrl_mount ======== */
 
 static void
@@ -286,6 +346,142 @@ test_resctrl_cpumask_write_zero(void **state __attribute__((unused)))
         fclose(fd);
 }
 
+/* ======== resctrl_lock ======== */
+
+static void
+test_resctrl_lock(void **state __attribute__((unused)))
+{
+        int ret;
+
+        /* directory is opened once */
+        expect_open();
+        expect_flock(LOCK_SH | LOCK_NB, 0);
+        ret = resctrl_lock_shared();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* file lock is held on behalf of all holders */
+        ret = resctrl_lock_shared();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = resctrl_lock_release();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_flock(LOCK_UN, 0);
+        ret = resctrl_lock_release();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_flock(LOCK_EX | LOCK_NB, 0);
+        ret = resctrl_lock_exclusive();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_flock(LOCK_UN, 0);
+        ret = resctrl_lock_release();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = resctrl_lock_release();
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        resctrl_lock_fini();
+}
+
+static void
+test_resctrl_lock_backoff(void **state __attribute__((unused)))
+{
+        struct pqos_resctrl_lock_stats before;
+        struct pqos_resctrl_lock_stats after;
+        int ret;
+
+        resctrl_lock_stats_get(&before);
+
+        m_slept = 0;
+        expect_open();
+        expect_flock(LOCK_EX | LOCK_NB, -1);
+        expect_flock(LOCK_EX | LOCK_NB, -1);
+        expect_flock(LOCK_EX | LOCK_NB, -1);
+        expect_flock(LOCK_EX | LOCK_NB, 0);
+        ret = resctrl_lock_exclusive();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(m_slept, 10 + 20 + 40);
+
+        expect_flock(LOCK_UN, 0);
+        ret = resctrl_lock_release();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* statistics are readable through public API */
+        ret = pqos_resctrl_lock_stats_get(NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        ret = pqos_resctrl_lock_stats_get(&after);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(after.acquired, before.acquired + 1);
+        assert_int_equal(after.contended, before.contended + 1);
+        assert_true(after.wait_us >= before.wait_us);
+
+        resctrl_lock_fini();
+}
+
+static void
+test_resctrl_lock_timeout(void **state __attribute__((unused)))
+{
+        struct pqos_resctrl_lock_stats before;
+        struct pqos_resctrl_lock_stats after;
+        int ret;
+
+        resctrl_lock_stats_get(&before);
+
+        m_slept = 0;
+        expect_open();
+        expect_value_count(__wrap_flock, operation, LOCK_SH | LOCK_NB, 20);
+        will_return_count(__wrap_flock, -1, 20);
+        ret = resctrl_lock_shared();
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+        /* backoff doubles from 10 us up to 10 ms */
+        assert_int_equal(m_slept, 10230 + 9 * 10000);
+
+        resctrl_lock_stats_get(&after);
+        assert_int_equal(after.acquired, before.acquired);
+        assert_int_equal(after.contended, before.contended + 1);
+
+        /* lock is usable after timeout, directory is kept open */
+        expect_flock(LOCK_SH | LOCK_NB, 0);
+        ret = resctrl_lock_shared();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_flock(LOCK_UN, 0);
+        ret = resctrl_lock_release();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        resctrl_lock_fini();
+}
+
+static void
+test_resctrl_lock_umount(void **state __attribute__((unused)))
+{
+        int ret;
+
+        expect_open();
+        expect_flock(LOCK_SH | LOCK_NB, 0);
+        ret = resctrl_lock_shared();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        expect_flock(LOCK_UN, 0);
+        ret = resctrl_lock_release();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* directory is closed to allow umount */
+        expect_string(__wrap_umount2, target, "/sys/fs/resctrl");
+        will_return(__wrap_umount2, 0);
+        ret = resctrl_umount();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_open();
+        expect_flock(LOCK_SH | LOCK_NB, 0);
+        ret = resctrl_lock_shared();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        expect_flock(LOCK_UN, 0);
+        ret = resctrl_lock_release();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        resctrl_lock_fini();
+}
+
 int
 main(void)
 {
@@ -303,6 +499,10 @@ main(void)
             cmocka_unit_test(test_resctrl_cpumask_read),
             cmocka_unit_test(test_resctrl_cpumask_write),
             cmocka_unit_test(test_resctrl_cpumask_write_zero),
+            cmocka_unit_test(test_resctrl_lock),
+            cmocka_unit_test(test_resctrl_lock_backoff),
+            cmocka_unit_test(test_resctrl_lock_timeout),
+            cmocka_unit_test(test_resctrl_lock_umount),
         };
 
         result += cmocka_run_group_tests(tests, NULL, NULL);
@@ -30,12 +30,16 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "mock_common.h"
 #include "mock_resctrl_monitoring.h"
+#include "monitoring.h"
+#include "resctrl.h"
 #include "resctrl_monitoring.h"
 #include "test.h"
 
 #include <errno.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 /* ======== mock ======== */
 
@@ -56,6 +60,34 @@ __wrap_rmdir(const char *path)
         return mock_type(int);
 }
 
+int
+resctrl_mon_cpumask_read(const unsigned class_id,
+                         const char *resctrl_group,
+                         struct resctrl_cpumask *mask)
+{
+        const struct resctrl_cpumask *cpus;
+        int ret;
+
+        check_expected(class_id);
+        check_expected(resctrl_group);
+
+        ret = mock_type(int);
+        cpus = mock_ptr_type(const struct resctrl_cpumask *);
+        if (ret == PQOS_RETVAL_OK)
+                *mask = *cpus;
+
+        return ret;
+}
+
+int
+resctrl_mon_assoc_restore(const unsigned lcore, const char *name)
+{
+        check_expected(lcore);
+        check_expected(name);
+
+        return mock_type(int);
+}
+
 /* ======== resctrl_mon_mkdir ======== */
 static void
 test_resctrl_mon_mkdir(void **state __attribute__((unused)))
@@ -180,6 +212,266 @@ test_resctrl_mon_read_counter_error(void **state __attribute__((unused)))
         assert_int_equal(value, 0);
 }
 
+/* ======== resctrl_mon_fd_read ======== */
+
+/**
+ * @brief Creates temporary counter file with \a content
+ */
+static int
+counter_file(const char *content)
+{
+        char path[] = "/tmp/test_resctrl_mon_XXXXXX";
+        int fd = mkstemp(path);
+
+        assert_int_not_equal(fd, -1);
+        unlink(path);
+        if (content != NULL)
+                assert_int_equal(write(fd, content, strlen(content)),
+                                 strlen(content));
+
+        return fd;
+}
+
+static void
+test_resctrl_mon_fd_read(void **state __attribute__((unused)))
+{
+        int ret;
+        int fd;
+        uint64_t value;
+
+        fd = counter_file("123456789012\n");
+
+        /* file is re-read from the beginning */
+        ret = resctrl_mon_fd_read(fd, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 123456789012);
+
+        ret = resctrl_mon_fd_read(fd, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 123456789012);
+
+        close(fd);
+
+        fd = counter_file("Unavailable\n");
+
+        ret = resctrl_mon_fd_read(fd, &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 0);
+
+        close(fd);
+}
+
+static void
+test_resctrl_mon_fd_read_error(void **state __attribute__((unused)))
+{
+        int ret;
+        int fd;
+        uint64_t value;
+
+        /* empty file */
+        fd = counter_file(NULL);
+
+        ret = resctrl_mon_fd_read(fd, &value);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+
+        close(fd);
+
+        /* closed descriptor */
+        ret = resctrl_mon_fd_read(fd, &value);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+}
+
+/* ======== resctrl_mon_assoc_restore_group ======== */
+
+static unsigned test_group_cores[] = {1, 2};
+
+static struct pqos_mon_data *
+assoc_group_new(void)
+{
+        struct pqos_mon_data *group = calloc(1, sizeof(*group));
+
+        assert_non_null(group);
+        group->intl = calloc(1, sizeof(*group->intl));
+        assert_non_null(group->intl);
+        group->intl->resctrl.mon_group = strdup("test");
+        group->num_cores = DIM(test_group_cores);
+        group->cores = test_group_cores;
+
+        return group;
+}
+
+static void
+assoc_group_free(struct pqos_mon_data *group)
+{
+        free(group->intl->resctrl.assoc_cos);
+        free(group->intl->resctrl.mon_group);
+        free(group->intl);
+        free(group);
+}
+
+static void
+expect_assoc_scan(const int cos0, const int cos1)
+{
+        expect_string(__wrap_pqos_dir_exists, path,
+                      RESCTRL_PATH "/mon_groups/test");
+        will_return(__wrap_pqos_dir_exists, cos0);
+        expect_string(__wrap_pqos_dir_exists, path,
+                      RESCTRL_PATH "/COS1/mon_groups/test");
+        will_return(__wrap_pqos_dir_exists, cos1);
+}
+
+static void
+expect_cpumask_read(const unsigned class_id,
+                    const int ret,
+                    const struct resctrl_cpumask *mask)
+{
+        expect_value(resctrl_mon_cpumask_read, class_id, class_id);
+        expect_string(resctrl_mon_cpumask_read, resctrl_group, "test");
+        will_return(resctrl_mon_cpumask_read, ret);
+        will_return(resctrl_mon_cpumask_read, mask);
+}
+
+static void
+test_resctrl_mon_assoc_restore_group_cached(void **state
+                                            __attribute__((unused)))
+{
+        struct pqos_mon_data *group = assoc_group_new();
+        struct resctrl_cpumask mask;
+        int ret;
+
+        memset(&mask, 0, sizeof(mask));
+        resctrl_cpumask_set(1, &mask);
+        resctrl_cpumask_set(2, &mask);
+
+        /* first poll builds the list of COS holding the mon group */
+        expect_assoc_scan(0, 1);
+        expect_cpumask_read(1, PQOS_RETVAL_OK, &mask);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->intl->resctrl.num_assoc_cos, 1);
+        assert_int_equal(group->intl->resctrl.assoc_cos[0], 1);
+
+        /* cached list is used, no directory scan */
+        expect_cpumask_read(1, PQOS_RETVAL_OK, &mask);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->intl->resctrl.num_assoc_cos, 1);
+
+        assoc_group_free(group);
+}
+
+static void
+test_resctrl_mon_assoc_restore_group_cos_change(void **state
+                                                __attribute__((unused)))
+{
+        struct pqos_mon_data *group = assoc_group_new();
+        struct resctrl_cpumask mask0;
+        struct resctrl_cpumask mask1;
+        int ret;
+
+        memset(&mask0, 0, sizeof(mask0));
+        memset(&mask1, 0, sizeof(mask1));
+        resctrl_cpumask_set(1, &mask0);
+        resctrl_cpumask_set(2, &mask0);
+        resctrl_cpumask_set(2, &mask1);
+
+        expect_assoc_scan(1, 0);
+        expect_cpumask_read(0, PQOS_RETVAL_OK, &mask0);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->intl->resctrl.assoc_cos[0], 0);
+
+        /* core 1 moved to COS1, kernel dropped it from the mon group */
+        memset(&mask0, 0, sizeof(mask0));
+        resctrl_cpumask_set(2, &mask0);
+        expect_cpumask_read(0, PQOS_RETVAL_OK, &mask0);
+        expect_value(resctrl_mon_assoc_restore, lcore, 1);
+        expect_string(resctrl_mon_assoc_restore, name, "test");
+        will_return(resctrl_mon_assoc_restore, PQOS_RETVAL_OK);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* restore created mon group under COS1, list is re-read */
+        resctrl_cpumask_set(1, &mask1);
+        expect_assoc_scan(1, 1);
+        expect_cpumask_read(0, PQOS_RETVAL_OK, &mask0);
+        expect_cpumask_read(1, PQOS_RETVAL_OK, &mask1);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->intl->resctrl.num_assoc_cos, 2);
+        assert_int_equal(group->intl->resctrl.assoc_cos[1], 1);
+
+        /* mon group removed from cached COS, list is re-read */
+        expect_cpumask_read(0, PQOS_RETVAL_ERROR, NULL);
+        expect_assoc_scan(0, 1);
+        expect_cpumask_read(1, PQOS_RETVAL_OK, &mask0);
+        expect_value(resctrl_mon_assoc_restore, lcore, 1);
+        expect_string(resctrl_mon_assoc_restore, name, "test");
+        will_return(resctrl_mon_assoc_restore, PQOS_RETVAL_OK);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->intl->resctrl.num_assoc_cos, 1);
+        assert_int_equal(group->intl->resctrl.assoc_cos[0], 1);
+
+        assoc_group_free(group);
+}
+
+static void
+test_resctrl_mon_assoc_restore_group_generation(void **state
+                                                __attribute__((unused)))
+{
+        struct pqos_mon_data *group = assoc_group_new();
+        struct resctrl_cpumask mask;
+        int ret;
+
+        memset(&mask, 0, sizeof(mask));
+        resctrl_cpumask_set(1, &mask);
+        resctrl_cpumask_set(2, &mask);
+
+        expect_assoc_scan(1, 0);
+        expect_cpumask_read(0, PQOS_RETVAL_OK, &mask);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->intl->resctrl.num_assoc_cos, 1);
+
+        /* any mon group directory created bumps the generation */
+        expect_string(__wrap_mkdir, path, RESCTRL_PATH "/COS1/mon_groups/x");
+        expect_value(__wrap_mkdir, mode, 0755);
+        will_return(__wrap_mkdir, 0);
+        ret = resctrl_mon_mkdir(1, "x");
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_assoc_scan(1, 1);
+        expect_cpumask_read(0, PQOS_RETVAL_OK, &mask);
+        expect_cpumask_read(1, PQOS_RETVAL_OK, &mask);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->intl->resctrl.num_assoc_cos, 2);
+
+        /* so does removal */
+        expect_string(__wrap_rmdir, path, RESCTRL_PATH "/COS1/mon_groups/x");
+        will_return(__wrap_rmdir, 0);
+        ret = resctrl_mon_rmdir(1, "x");
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_assoc_scan(1, 0);
+        expect_cpumask_read(0, PQOS_RETVAL_OK, &mask);
+
+        ret = resctrl_mon_assoc_restore_group(group, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->intl->resctrl.num_assoc_cos, 1);
+
+        assoc_group_free(group);
+}
+
 int
 main(void)
 {
@@ -188,6 +480,11 @@ main(void)
             cmocka_unit_test(test_resctrl_mon_rmdir),
             cmocka_unit_test(test_resctrl_mon_read_counter),
             cmocka_unit_test(test_resctrl_mon_read_counter_error),
+            cmocka_unit_test(test_resctrl_mon_fd_read),
+            cmocka_unit_test(test_resctrl_mon_fd_read_error),
+            cmocka_unit_test(test_resctrl_mon_assoc_restore_group_cached),
+            cmocka_unit_test(test_resctrl_mon_assoc_restore_group_cos_change),
+            cmocka_unit_test(test_resctrl_mon_assoc_restore_group_generation),
         };
 
         cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,290 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu_registers.h"
+#include "machine.h"
+#include "snapshot.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define SNAPSHOT_TEST_DIR  "/tmp"
+#define SNAPSHOT_TEST_FILE SNAPSHOT_TEST_DIR "/libpqos-snapshot-msr.bin"
+
+/* ======== helpers ======== */
+
+/**
+ * @brief Expects read of I/O RDT config register, test caps have no CDP
+ */
+static void
+expect_cfg_read(const struct test_data *data, const uint64_t io_cfg)
+{
+        expect_value(__wrap_msr_read, lcore, data->cpu->cores[0].lcore);
+        expect_value(__wrap_msr_read, reg, PQOS_MSR_L3_IO_QOS_CFG);
+        will_return(__wrap_msr_read, MACHINE_RETVAL_OK);
+        will_return(__wrap_msr_read, io_cfg);
+}
+
+static void
+store_snapshot(const struct test_data *data)
+{
+        int ret;
+
+        unlink(SNAPSHOT_TEST_FILE);
+        setenv("RDT_SNAPSHOT", SNAPSHOT_TEST_DIR, 1);
+
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        expect_cfg_read(data, 0);
+        ret = snapshot_store(data->cpu, data->cap);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        snapshot_close();
+
+        assert_int_equal(access(SNAPSHOT_TEST_FILE, F_OK), 0);
+}
+
+static void
+free_cap(struct pqos_cap *cap)
+{
+        unsigned i;
+
+        for (i = 0; i < cap->num_cap; i++)
+                free(cap->capabilities[i].u.generic_ptr);
+        free(cap);
+}
+
+/* ======== snapshot_open ======== */
+
+static void
+test_snapshot_open_disabled(void **state __attribute__((unused)))
+{
+        struct pqos_cap *cap = NULL;
+        int ret;
+
+        unsetenv("RDT_SNAPSHOT");
+
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        assert_null(snapshot_get_cpuinfo());
+        ret = snapshot_get_cap(&cap);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        snapshot_close();
+}
+
+static void
+test_snapshot_open(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_cpuinfo *cpu;
+        struct pqos_cap *cap = NULL;
+        unsigned i;
+        int ret;
+
+        store_snapshot(data);
+
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        cpu = snapshot_get_cpuinfo();
+        assert_non_null(cpu);
+        assert_int_equal(cpu->num_cores, data->cpu->num_cores);
+        assert_int_equal(cpu->vendor, data->cpu->vendor);
+        assert_memory_equal(cpu->cores, data->cpu->cores,
+                            cpu->num_cores * sizeof(cpu->cores[0]));
+
+        ret = snapshot_get_cap(&cap);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(cap->num_cap, data->cap->num_cap);
+        for (i = 0; i < cap->num_cap; i++) {
+                const struct pqos_capability *c = &cap->capabilities[i];
+                const struct pqos_capability *e = &data->cap->capabilities[i];
+
+                assert_int_equal(c->type, e->type);
+                if (c->type == PQOS_CAP_TYPE_MON) {
+                        size_t size = sizeof(*c->u.mon) +
+                                      c->u.mon->num_events *
+                                          sizeof(c->u.mon->events[0]);
+
+                        assert_int_equal(c->u.mon->num_events,
+                                         e->u.mon->num_events);
+                        assert_memory_equal(c->u.mon, e->u.mon, size);
+                } else if (c->type == PQOS_CAP_TYPE_L3CA)
+                        assert_memory_equal(c->u.l3ca, e->u.l3ca,
+                                            sizeof(*c->u.l3ca));
+        }
+
+        /* loaded snapshot is not rewritten */
+        ret = snapshot_store(data->cpu, data->cap);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        snapshot_close();
+        free(cpu);
+        free_cap(cap);
+        unlink(SNAPSHOT_TEST_FILE);
+}
+
+static void
+test_snapshot_open_interface(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        store_snapshot(data);
+
+        /* snapshot of other interface is not used */
+        ret = snapshot_open(PQOS_INTER_OS);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        assert_null(snapshot_get_cpuinfo());
+        snapshot_close();
+
+        unlink(SNAPSHOT_TEST_FILE);
+}
+
+static void
+test_snapshot_open_corrupted(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        FILE *fd;
+        long size;
+        int c;
+        int ret;
+
+        store_snapshot(data);
+
+        fd = fopen(SNAPSHOT_TEST_FILE, "r+");
+        assert_non_null(fd);
+        assert_int_equal(fseek(fd, 0, SEEK_END), 0);
+        size = ftell(fd);
+        assert_true(size > 0);
+        assert_int_equal(fseek(fd, size - 1, SEEK_SET), 0);
+        c = fgetc(fd);
+        assert_int_equal(fseek(fd, size - 1, SEEK_SET), 0);
+        fputc(c ^ 0xff, fd);
+        fclose(fd);
+
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        snapshot_close();
+
+        unlink(SNAPSHOT_TEST_FILE);
+}
+
+/* ======== snapshot_check_cfg ======== */
+
+static void
+test_snapshot_check_cfg(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_cap *cap = NULL;
+        int ret;
+
+        store_snapshot(data);
+
+        /* same configuration */
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        expect_cfg_read(data, 0);
+        ret = snapshot_check_cfg();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = snapshot_get_cap(&cap);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        free_cap(cap);
+        snapshot_close();
+
+        /* I/O RDT enabled by other process */
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        expect_cfg_read(data, PQOS_MSR_L3_IO_QOS_CA_EN);
+        ret = snapshot_check_cfg();
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        ret = snapshot_get_cap(&cap);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+
+        /* new snapshot is stored with current configuration */
+        expect_cfg_read(data, PQOS_MSR_L3_IO_QOS_CA_EN);
+        ret = snapshot_store(data->cpu, data->cap);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        snapshot_close();
+
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        expect_cfg_read(data, PQOS_MSR_L3_IO_QOS_CA_EN);
+        ret = snapshot_check_cfg();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        snapshot_close();
+
+        unlink(SNAPSHOT_TEST_FILE);
+}
+
+/* ======== snapshot_invalidate ======== */
+
+static void
+test_snapshot_invalidate(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        store_snapshot(data);
+
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        snapshot_close();
+
+        snapshot_invalidate();
+        assert_int_not_equal(access(SNAPSHOT_TEST_FILE, F_OK), 0);
+
+        ret = snapshot_open(PQOS_INTER_MSR);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        snapshot_close();
+        unsetenv("RDT_SNAPSHOT");
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_snapshot_open_disabled),
+            cmocka_unit_test(test_snapshot_open),
+            cmocka_unit_test(test_snapshot_open_interface),
+            cmocka_unit_test(test_snapshot_open_corrupted),
+            cmocka_unit_test(test_snapshot_check_cfg),
+            cmocka_unit_test(test_snapshot_invalidate),
+        };
+
+        result += cmocka_run_group_tests(tests, test_init_all, test_fini);
+
+        return result;
+}
@@ -0,0 +1,223 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test.h"
+#include "tid_set.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ======== mock ======== */
+
+/**
+ * Process 100 has threads 100-103, other tasks are single threaded
+ */
+int
+__wrap_scandir(const char *restrict dirp,
+               struct dirent ***restrict namelist,
+               int (*filter)(const struct dirent *) __attribute__((unused)),
+               int (*compar)(const struct dirent **, const struct dirent **)
+                   __attribute__((unused)))
+{
+        int ret;
+        pid_t pid = 0;
+        int num = 1;
+        int i;
+
+        ret = sscanf(dirp, "/proc/%d/task", &pid);
+        if (ret != 1 || pid == 0 || pid == 0xDEAD)
+                return -1;
+
+        if (pid >= 100 && pid <= 103)
+                num = 4;
+
+        *namelist = malloc(sizeof(struct dirent *) * num);
+        for (i = 0; i < num; i++) {
+                (*namelist)[i] = malloc(sizeof(struct dirent) + 10);
+                sprintf((*namelist)[i]->d_name, "%d", num > 1 ? 100 + i : pid);
+        }
+
+        return num;
+}
+
+/* ======== tid_set_add ======== */
+
+static void
+test_tid_set_add(void **state __attribute__((unused)))
+{
+        struct tid_set set;
+        const unsigned num = 10000;
+        unsigned i;
+        int ret;
+
+        tid_set_init(&set);
+        assert_false(tid_set_contains(&set, 1));
+
+        for (i = 1; i <= num; i++) {
+                ret = tid_set_add(&set, (pid_t)i);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+        }
+        /* duplicates are ignored */
+        for (i = 1; i <= num; i += 7) {
+                ret = tid_set_add(&set, (pid_t)i);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+        }
+        assert_int_equal(set.num, num);
+
+        for (i = 1; i <= num; i++) {
+                assert_true(tid_set_contains(&set, (pid_t)i));
+                /* insertion order is preserved */
+                assert_int_equal(set.tids[i - 1], i);
+        }
+        assert_false(tid_set_contains(&set, (pid_t)(num + 1)));
+
+        tid_set_fini(&set);
+        assert_int_equal(set.num, 0);
+        assert_null(set.tids);
+}
+
+static void
+test_tid_set_add_array(void **state __attribute__((unused)))
+{
+        struct tid_set set;
+        pid_t tids[] = {5, 3, 5, 9, 3};
+        pid_t *table;
+        unsigned num;
+        int ret;
+
+        tid_set_init(&set);
+
+        ret = tid_set_add_array(&set, DIM(tids), tids);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(set.num, 3);
+
+        table = tid_set_release(&set, &num);
+        assert_non_null(table);
+        assert_int_equal(num, 3);
+        assert_int_equal(table[0], 5);
+        assert_int_equal(table[1], 3);
+        assert_int_equal(table[2], 9);
+        assert_null(set.tids);
+        free(table);
+
+        table = tid_set_release(&set, &num);
+        assert_null(table);
+        assert_int_equal(num, 0);
+}
+
+/* ======== tid_set_find ======== */
+
+static void
+test_tid_set_find(void **state __attribute__((unused)))
+{
+        struct tid_set set;
+        int ret;
+
+        tid_set_init(&set);
+
+        /* process - all threads */
+        ret = tid_set_find(&set, 100);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(set.num, 4);
+
+        /* thread - only selected task */
+        tid_set_fini(&set);
+        ret = tid_set_find(&set, 102);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(set.num, 1);
+        assert_true(tid_set_contains(&set, 102));
+
+        ret = tid_set_find(&set, 0xDEAD);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        tid_set_fini(&set);
+}
+
+/* ======== tid_set_diff ======== */
+
+static void
+test_tid_set_diff(void **state __attribute__((unused)))
+{
+        struct tid_set known;
+        struct tid_set added;
+        struct tid_set vanished;
+        pid_t known_tids[] = {100, 101, 200, 300};
+        pid_t pids[] = {100, 200, 0xDEAD};
+        int ret;
+
+        tid_set_init(&known);
+        tid_set_init(&added);
+        tid_set_init(&vanished);
+
+        ret = tid_set_add_array(&known, DIM(known_tids), known_tids);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = tid_set_diff(&known, DIM(pids), pids, &added, &vanished);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        assert_int_equal(added.num, 2);
+        assert_true(tid_set_contains(&added, 102));
+        assert_true(tid_set_contains(&added, 103));
+
+        assert_int_equal(vanished.num, 1);
+        assert_true(tid_set_contains(&vanished, 300));
+
+        tid_set_fini(&vanished);
+
+        /* only vanished TIDs requested */
+        ret = tid_set_diff(&known, 0, NULL, NULL, &vanished);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(vanished.num, known.num);
+
+        tid_set_fini(&known);
+        tid_set_fini(&added);
+        tid_set_fini(&vanished);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_tid_set_add),
+            cmocka_unit_test(test_tid_set_add_array),
+            cmocka_unit_test(test_tid_set_find),
+            cmocka_unit_test(test_tid_set_diff),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
@@ -34,6 +34,9 @@
 #include "test.h"
 #include "utils.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 /* ======== pqos_l3ca_iordt_enabled ======== */
 
 void
@@ -841,6 +844,139 @@ test_pqos_cpu_get_one_by_numaid_param(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
 }
 
+/* ======== topology index ======== */
+
+static void
+test_utils_topo_index(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        size_t size = sizeof(*data->cpu) +
+                      data->cpu->num_cores * sizeof(data->cpu->cores[0]);
+        struct pqos_cpuinfo *ref = malloc(size);
+        unsigned *(*get_ids[])(const struct pqos_cpuinfo *, unsigned *) = {
+            pqos_cpu_get_sockets,     pqos_cpu_get_numa,
+            pqos_cpu_get_l2ids,       pqos_cpu_get_l3_clusters,
+            pqos_cpu_get_l3cat_ids,   pqos_cpu_get_mba_ids,
+            pqos_cpu_get_smba_ids};
+        unsigned i, j;
+        int ret;
+
+        assert_non_null(ref);
+        memcpy(ref, data->cpu, size);
+
+        ret = _pqos_utils_init(PQOS_INTER_MSR, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        for (i = 0; i < DIM(get_ids); i++) {
+                unsigned count, ref_count;
+                unsigned *ids = get_ids[i](data->cpu, &count);
+                unsigned *ref_ids = get_ids[i](ref, &ref_count);
+
+                assert_non_null(ids);
+                assert_non_null(ref_ids);
+                assert_int_equal(count, ref_count);
+                assert_memory_equal(ids, ref_ids, count * sizeof(ids[0]));
+                free(ids);
+                free(ref_ids);
+        }
+
+        for (i = 0; i <= data->cpu->num_cores; i++) {
+                const struct pqos_coreinfo *core, *ref_core;
+                unsigned socket, ref_socket;
+                unsigned lcore, ref_lcore;
+
+                core = pqos_cpu_get_core_info(data->cpu, i);
+                ref_core = pqos_cpu_get_core_info(ref, i);
+                if (ref_core == NULL) {
+                        assert_null(core);
+                        assert_int_equal(pqos_cpu_check_core(data->cpu, i),
+                                         PQOS_RETVAL_ERROR);
+                        continue;
+                }
+                assert_non_null(core);
+                assert_memory_equal(core, ref_core, sizeof(*core));
+                assert_int_equal(pqos_cpu_check_core(data->cpu, i),
+                                 PQOS_RETVAL_OK);
+
+                ret = pqos_cpu_get_socketid(data->cpu, i, &socket);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                ret = pqos_cpu_get_socketid(ref, i, &ref_socket);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(socket, ref_socket);
+
+                ret = pqos_cpu_get_one_by_l2id(data->cpu, core->l2_id, &lcore);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                ret = pqos_cpu_get_one_by_l2id(ref, core->l2_id, &ref_lcore);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(lcore, ref_lcore);
+        }
+
+        for (i = 0; i < 3; i++) {
+                unsigned count, ref_count;
+                unsigned *cores = pqos_cpu_get_cores(data->cpu, i, &count);
+                unsigned *ref_cores = pqos_cpu_get_cores(ref, i, &ref_count);
+
+                if (ref_cores == NULL) {
+                        assert_null(cores);
+                        continue;
+                }
+                assert_non_null(cores);
+                assert_int_equal(count, ref_count);
+                for (j = 0; j < count; j++)
+                        assert_int_equal(cores[j], ref_cores[j]);
+                free(cores);
+                free(ref_cores);
+        }
+
+        _pqos_utils_fini();
+        free(ref);
+}
+
+static void
+test_utils_topo_span(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned *span;
+        unsigned count = 0;
+        unsigned i;
+        int ret;
+
+        /* topology not indexed */
+        span = pqos_cpu_get_ids_span(data->cpu, TOPO_OBJ_SOCKET, &count);
+        assert_null(span);
+
+        ret = _pqos_utils_init(PQOS_INTER_MSR, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        span = pqos_cpu_get_ids_span(data->cpu, TOPO_OBJ_SOCKET, &count);
+        assert_non_null(span);
+        assert_int_equal(count, 2);
+        assert_int_equal(span[0], 0);
+        assert_int_equal(span[1], 1);
+
+        span = pqos_cpu_get_cores_span(data->cpu, TOPO_OBJ_L3_CLUSTER, 1,
+                                       &count);
+        assert_non_null(span);
+        assert_int_equal(count, data->cpu->num_cores / 2);
+        for (i = 0; i < count; i++)
+                assert_int_equal(span[i], data->cpu->num_cores / 2 + i);
+
+        span = pqos_cpu_get_cores_span(data->cpu, TOPO_OBJ_L2_CLUSTER, 1,
+                                       &count);
+        assert_non_null(span);
+        assert_int_equal(count, 2);
+        assert_int_equal(span[0], 2);
+        assert_int_equal(span[1], 3);
+
+        span = pqos_cpu_get_cores_span(data->cpu, TOPO_OBJ_MBA, 2, &count);
+        assert_null(span);
+
+        _pqos_utils_fini();
+
+        span = pqos_cpu_get_ids_span(data->cpu, TOPO_OBJ_SOCKET, &count);
+        assert_null(span);
+}
+
 int
 main(void)
 {
@@ -891,6 +1027,8 @@ main(void)
             cmocka_unit_test(test_pqos_l2ca_cdp_enabled_param),
             cmocka_unit_test(test_pqos_mba_ctrl_enabled),
             cmocka_unit_test(test_pqos_mba_ctrl_enabled_param),
+            cmocka_unit_test(test_utils_topo_index),
+            cmocka_unit_test(test_utils_topo_span),
         };
 
         const struct CMUnitTest tests_l3ca[] = {
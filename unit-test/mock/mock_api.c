@@ -61,8 +61,14 @@ __wrap_pqos_cap_get(const struct pqos_cap **cap,
         int ret = mock_type(int);
 
         if (ret == PQOS_RETVAL_OK) {
-                *cap = mock_ptr_type(struct pqos_cap *);
-                *cpu = mock_ptr_type(struct pqos_cpuinfo *);
+                struct pqos_cap *p_cap = mock_ptr_type(struct pqos_cap *);
+                struct pqos_cpuinfo *p_cpu =
+                    mock_ptr_type(struct pqos_cpuinfo *);
+
+                if (cap != NULL)
+                        *cap = p_cap;
+                if (cpu != NULL)
+                        *cpu = p_cpu;
         }
         return ret;
 }
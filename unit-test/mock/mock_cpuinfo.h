@@ -37,4 +37,12 @@
 
 void __wrap_cpuinfo_get_config(const struct cpuinfo_config **config);
 
+/* ======== headers for static functions ======== */
+int cpuinfo_detect_serial(const struct apic_info *apic,
+                          struct pqos_coreinfo *cores,
+                          int max_core_count);
+int cpuinfo_detect_parallel(const struct apic_info *apic,
+                            struct pqos_coreinfo *cores,
+                            int max_core_count);
+
 #endif /* MOCK_CPUINFO_H_ */
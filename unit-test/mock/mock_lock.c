@@ -56,8 +56,26 @@ __wrap_lock_get(void)
         function_called();
 }
 
+void
+__wrap_lock_get_shared(void)
+{
+        function_called();
+}
+
 void
 __wrap_lock_release(void)
 {
         function_called();
 }
+
+void
+__wrap_lock_alloc_get(void)
+{
+        function_called();
+}
+
+void
+__wrap_lock_alloc_release(void)
+{
+        function_called();
+}
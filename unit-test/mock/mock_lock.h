@@ -38,6 +38,9 @@
 int __wrap_lock_init(void);
 int __wrap_lock_fini(void);
 void __wrap_lock_get(void);
+void __wrap_lock_get_shared(void);
 void __wrap_lock_release(void);
+void __wrap_lock_alloc_get(void);
+void __wrap_lock_alloc_release(void);
 
 #endif /* MOCK_LOCK_H_ */
@@ -75,3 +75,25 @@ __wrap_msr_write(const unsigned lcore, const uint32_t reg, const uint64_t value)
 
         return mock_type(int);
 }
+
+int
+__wrap_msr_batch(struct machine_msr_op *ops, const unsigned num_ops)
+{
+        unsigned i;
+
+        /* Execute operations one by one to reuse msr_read/msr_write mocks */
+        for (i = 0; i < num_ops; i++) {
+                int ret;
+
+                if (ops[i].op == MACHINE_MSR_OP_READ)
+                        ret = __wrap_msr_read(ops[i].lcore, ops[i].reg,
+                                              &ops[i].value);
+                else
+                        ret = __wrap_msr_write(ops[i].lcore, ops[i].reg,
+                                               ops[i].value);
+                if (ret != MACHINE_RETVAL_OK)
+                        return ret;
+        }
+
+        return MACHINE_RETVAL_OK;
+}
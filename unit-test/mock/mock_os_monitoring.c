@@ -117,3 +117,12 @@ __wrap_os_mon_remove_pids(const unsigned num_pids,
 
         return mock_type(int);
 }
+
+int
+__wrap_os_mon_track_pids(struct pqos_mon_data *group, const int enable)
+{
+        check_expected_ptr(group);
+        check_expected(enable);
+
+        return mock_type(int);
+}
@@ -57,6 +57,7 @@ int __wrap_os_mon_add_pids(const unsigned num_pids,
 int __wrap_os_mon_remove_pids(const unsigned num_pids,
                               const pid_t *pids,
                               struct pqos_mon_data *group);
+int __wrap_os_mon_track_pids(struct pqos_mon_data *group, const int enable);
 
 /* ======== headers for static functions ======== */
 int os_mon_stop_events(struct pqos_mon_data *group);
@@ -74,5 +74,9 @@ int resctrl_mon_read_counter(const unsigned class_id,
                              const unsigned l3id,
                              const enum pqos_mon_event event,
                              uint64_t *value);
+int resctrl_mon_fd_read(const int fd, uint64_t *value);
+int resctrl_mon_assoc_restore(const unsigned lcore, const char *name);
+int resctrl_mon_assoc_restore_group(struct pqos_mon_data *group,
+                                    const unsigned max_cos);
 
 #endif /* MOCK_RESCTRL_MONITORING_H_ */
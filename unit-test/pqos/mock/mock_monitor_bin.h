@@ -0,0 +1,60 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __MOCK_MONITOR_BIN_H__
+#define __MOCK_MONITOR_BIN_H__
+
+#include "monitor.h"
+#include "pqos.h"
+
+#include <stdint.h>
+
+enum pqos_mon_event __wrap_monitor_get_events(void);
+enum monitor_llc_format __wrap_monitor_get_llc_format(void);
+int __wrap_monitor_get_interval(void);
+int __wrap_monitor_core_mode(void);
+int __wrap_monitor_mixed_mode(void);
+int __wrap_monitor_rt_mode(void);
+unsigned __wrap_monitor_get_num_groups(void);
+const struct pqos_mon_data *__wrap_monitor_get_group(const unsigned idx);
+int __wrap_pqos_mon_get_value(const struct pqos_mon_data *const group,
+                              const enum pqos_mon_event event_id,
+                              uint64_t *value,
+                              uint64_t *delta);
+int __wrap_pqos_mon_get_ipc(const struct pqos_mon_data *const group,
+                            double *value);
+int __wrap_pqos_mon_get_poll_time(const struct pqos_mon_data *const group,
+                                  struct pqos_mon_poll_time *poll_time);
+int __wrap_pqos_mon_get_tel_value(const struct pqos_mon_data *group,
+                                  const enum pqos_mon_event event,
+                                  double *value);
+
+#endif /* __MOCK_MONITOR_BIN_H__ */
@@ -0,0 +1,468 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2026 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+/* clang-format off */
+#include "mock_monitor_bin.h"
+#include <cmocka.h>
+#include "monitor_bin.c"
+/* clang-format on */
+
+/*
+ * Round-trip tests for binary monitoring output. Records are encoded by
+ * monitor_bin_*() and decoded by pqos-bin2csv linked in as bin2csv_main().
+ */
+
+#define MB (1024ULL * 1024ULL)
+
+int bin2csv_main(int argc, char **argv);
+
+static struct pqos_mon_data *groups;
+static unsigned num_groups;
+static double power_value;
+static int rt_mode;
+static struct pqos_cpuinfo cpu_info;
+
+/* ======== mock ======== */
+
+enum pqos_mon_event
+__wrap_monitor_get_events(void)
+{
+        return mock_type(enum pqos_mon_event);
+}
+
+enum monitor_llc_format
+__wrap_monitor_get_llc_format(void)
+{
+        return mock_type(enum monitor_llc_format);
+}
+
+int
+__wrap_monitor_get_interval(void)
+{
+        return mock_type(int);
+}
+
+int
+__wrap_monitor_core_mode(void)
+{
+        return 1;
+}
+
+int
+__wrap_monitor_mixed_mode(void)
+{
+        return 0;
+}
+
+int
+__wrap_monitor_rt_mode(void)
+{
+        return rt_mode;
+}
+
+unsigned
+__wrap_monitor_get_num_groups(void)
+{
+        return num_groups;
+}
+
+const struct pqos_mon_data *
+__wrap_monitor_get_group(const unsigned idx)
+{
+        if (idx >= num_groups)
+                return NULL;
+
+        return &groups[idx];
+}
+
+int
+__wrap_pqos_mon_get_value(const struct pqos_mon_data *const group,
+                          const enum pqos_mon_event event_id,
+                          uint64_t *value,
+                          uint64_t *delta)
+{
+        uint64_t val = 0;
+
+        if ((group->event & event_id) == 0)
+                return PQOS_RETVAL_PARAM;
+
+        switch (event_id) {
+        case PQOS_MON_EVENT_L3_OCCUP:
+                assert_null(delta);
+                *value = group->values.llc;
+                return PQOS_RETVAL_OK;
+        case PQOS_MON_EVENT_LMEM_BW:
+                val = group->values.mbm_local_delta;
+                break;
+        case PQOS_PERF_EVENT_LLC_MISS:
+                val = group->values.llc_misses_delta;
+                break;
+        default:
+                return PQOS_RETVAL_PARAM;
+        }
+
+        if (delta != NULL)
+                *delta = val;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+__wrap_pqos_mon_get_ipc(const struct pqos_mon_data *const group, double *value)
+{
+        assert_non_null(group);
+        *value = group->values.ipc;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+__wrap_pqos_mon_get_poll_time(const struct pqos_mon_data *const group,
+                              struct pqos_mon_poll_time *poll_time)
+{
+        uint64_t interval = mock_type(uint64_t);
+
+        assert_non_null(group);
+        if (interval == 0)
+                return PQOS_RETVAL_UNAVAILABLE;
+
+        memset(poll_time, 0, sizeof(*poll_time));
+        poll_time->interval = interval;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+__wrap_pqos_mon_get_tel_value(const struct pqos_mon_data *group,
+                              const enum pqos_mon_event event,
+                              double *value)
+{
+        assert_non_null(group);
+        assert_int_equal(event, PQOS_MON_EVENT_POWER);
+        *value = power_value;
+
+        return PQOS_RETVAL_OK;
+}
+
+/* ======== helpers ======== */
+
+static void
+mock_begin(const enum pqos_mon_event events,
+           const enum monitor_llc_format llc_format)
+{
+        will_return(__wrap_pqos_inter_get, PQOS_RETVAL_OK);
+        will_return(__wrap_pqos_inter_get, PQOS_INTER_MSR);
+        will_return_always(__wrap_monitor_get_events, events);
+        will_return_always(__wrap_monitor_get_llc_format, llc_format);
+        /* 1s interval */
+        will_return_always(__wrap_monitor_get_interval, 10);
+}
+
+/**
+ * @brief Takes monitoring record of the group
+ *
+ * @param [in] idx group index
+ * @param [in] interval time between counter reads, 0 if not available
+ * @param [out] rec monitoring record
+ */
+static void
+record_get(const unsigned idx,
+           const uint64_t interval,
+           struct monitor_record *rec)
+{
+        will_return(__wrap_pqos_mon_get_poll_time, interval);
+        if (groups[idx].event & PQOS_MON_EVENT_L3_OCCUP) {
+                will_return(__wrap_pqos_cap_get, PQOS_RETVAL_OK);
+                will_return(__wrap_pqos_cap_get, NULL);
+                will_return(__wrap_pqos_cap_get, &cpu_info);
+        }
+
+        monitor_utils_get_record(&groups[idx], idx, 0, rec);
+}
+
+static FILE *
+bin_open(char *path)
+{
+        int fd = mkstemp(path);
+
+        assert_true(fd >= 0);
+
+        return fdopen(fd, "wb");
+}
+
+/**
+ * @brief Converts binary file into CSV and strips timestamps
+ *
+ * @param [in] path binary file
+ * @param [out] csv CSV lines with the time column removed
+ * @param [in] size size of \a csv
+ */
+static void
+bin_decode(const char *path, char *csv, const size_t size)
+{
+        char out_path[] = "/tmp/test_monitor_bin_csv_XXXXXX";
+        char app[] = "pqos-bin2csv";
+        char opt[] = "-o";
+        char in_path[64];
+        char *argv[] = {app, opt, out_path, in_path, NULL};
+        char line[256];
+        size_t len = 0;
+        FILE *fp;
+        int fd;
+
+        snprintf(in_path, sizeof(in_path), "%s", path);
+        fd = mkstemp(out_path);
+        assert_true(fd >= 0);
+        close(fd);
+
+        optind = 1;
+        assert_int_equal(bin2csv_main(4, argv), EXIT_SUCCESS);
+
+        fp = fopen(out_path, "r");
+        assert_non_null(fp);
+        csv[0] = '\0';
+        while (fgets(line, sizeof(line), fp) != NULL) {
+                const char *p = line;
+
+                if (strncmp(line, "Time,", 5) != 0)
+                        p = strchr(line, ',');
+                assert_non_null(p);
+                len += snprintf(csv + len, size - len, "%s", p);
+                assert_true(len < size);
+        }
+        fclose(fp);
+        unlink(out_path);
+}
+
+/* ======== tests ======== */
+
+static void
+test_monitor_bin_round_trip(void **state)
+{
+        char ctx[3][8] = {"0", "1-2", "3"};
+        struct pqos_mon_data data[3];
+        struct monitor_record rec[3];
+        char path[] = "/tmp/test_monitor_bin_XXXXXX";
+        char csv[1024];
+        FILE *fp;
+
+        (void)state;
+
+        memset(&cpu_info, 0, sizeof(cpu_info));
+        cpu_info.l3.total_size = 8192;
+        memset(data, 0, sizeof(data));
+        data[0].context = ctx[0];
+        data[0].event = PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_LMEM_BW |
+                        PQOS_PERF_EVENT_IPC | PQOS_PERF_EVENT_LLC_MISS |
+                        PQOS_MON_EVENT_POWER;
+        data[1].context = ctx[1];
+        data[1].event = PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_LMEM_BW;
+        data[2].context = ctx[2];
+        data[2].event = PQOS_MON_EVENT_L3_OCCUP;
+        groups = data;
+        num_groups = 3;
+
+        mock_begin(data[0].event, LLC_FORMAT_KILOBYTES);
+
+        fp = bin_open(path);
+        assert_non_null(fp);
+        monitor_bin_begin(fp, 0, NULL);
+        assert_int_equal(bin.num_columns, 5);
+
+        /* first interval, group 2 not output */
+        data[0].values.llc = 6 * 1024;
+        data[0].values.mbm_local_delta = 3 * MB;
+        data[0].values.ipc_retired_delta = 300;
+        data[0].values.ipc_unhalted_delta = 200;
+        data[0].values.ipc = 1.5;
+        data[0].values.llc_misses_delta = 1234;
+        power_value = 12.5;
+        data[1].values.llc = 1024;
+        data[1].values.mbm_local_delta = MB;
+
+        /* 500ms between counter reads */
+        record_get(0, 500000000ULL, &rec[0]);
+        /* poll time not available, monitoring interval used */
+        record_get(1, 0, &rec[1]);
+        assert_int_equal(rec[1].interval, 1000000000ULL);
+
+        /* groups polled again before the records are written */
+        memset(&data[0].values, 0, sizeof(data[0].values));
+        memset(&data[1].values, 0, sizeof(data[1].values));
+
+        monitor_bin_header(fp, "", 0, NULL);
+        monitor_bin_row(fp, "", &rec[0]);
+        monitor_bin_row(fp, "", &rec[1]);
+        monitor_bin_footer(fp);
+
+        /* second interval, group 2 only */
+        data[2].values.llc = 512;
+        record_get(2, 1000000000ULL, &rec[2]);
+
+        monitor_bin_header(fp, "", 0, NULL);
+        monitor_bin_row(fp, "", &rec[2]);
+        monitor_bin_footer(fp);
+
+        monitor_bin_end(fp);
+        fclose(fp);
+
+        bin_decode(path, csv, sizeof(csv));
+        unlink(path);
+
+        assert_string_equal(
+            csv, "Time,Core,IPC,LLC Misses,LLC[KB],MBL[MB/s],Power[W]\n"
+                 ",\"0\",1.50,1234,6.0,6.0,12.500\n"
+                 ",\"1-2\",,,1.0,1.0,\n"
+                 ",\"3\",,,0.5,,\n");
+}
+
+static void
+test_monitor_bin_llc_percent(void **state)
+{
+        char ctx[] = "0-3";
+        struct pqos_mon_data data;
+        struct monitor_record rec;
+        char path[] = "/tmp/test_monitor_bin_XXXXXX";
+        char csv[256];
+        FILE *fp;
+
+        (void)state;
+
+        memset(&cpu_info, 0, sizeof(cpu_info));
+        cpu_info.l3.total_size = 4096;
+        memset(&data, 0, sizeof(data));
+        data.context = ctx;
+        data.event = PQOS_MON_EVENT_L3_OCCUP;
+        groups = &data;
+        num_groups = 1;
+
+        mock_begin(data.event, LLC_FORMAT_PERCENT);
+        will_return(__wrap_pqos_cap_get, PQOS_RETVAL_OK);
+        will_return(__wrap_pqos_cap_get, NULL);
+        will_return(__wrap_pqos_cap_get, &cpu_info);
+
+        fp = bin_open(path);
+        assert_non_null(fp);
+        monitor_bin_begin(fp, 0, NULL);
+        assert_int_equal(bin.num_columns, 1);
+        assert_int_equal(bin.columns[0].kind, MONITOR_BIN_KIND_VALUE);
+        assert_true(bin.columns[0].scale == 100.0 / 4096);
+
+        data.values.llc = 1024;
+        record_get(0, 0, &rec);
+        monitor_bin_header(fp, "", 0, NULL);
+        monitor_bin_row(fp, "", &rec);
+        monitor_bin_footer(fp);
+
+        monitor_bin_end(fp);
+        fclose(fp);
+
+        bin_decode(path, csv, sizeof(csv));
+        unlink(path);
+
+        assert_string_equal(csv, "Time,Core,LLC[%]\n"
+                                 ",\"0-3\",25.0\n");
+}
+
+static void
+test_monitor_bin_rt(void **state)
+{
+        char ctx[] = "0";
+        struct pqos_mon_data data;
+        struct monitor_record rec;
+        char path[] = "/tmp/test_monitor_bin_XXXXXX";
+        char csv[256];
+        FILE *fp;
+
+        (void)state;
+
+        memset(&cpu_info, 0, sizeof(cpu_info));
+        cpu_info.l3.total_size = 4096;
+        memset(&data, 0, sizeof(data));
+        data.context = ctx;
+        data.event = PQOS_MON_EVENT_L3_OCCUP;
+        groups = &data;
+        num_groups = 1;
+        rt_mode = 1;
+
+        mock_begin(data.event, LLC_FORMAT_KILOBYTES);
+
+        fp = bin_open(path);
+        assert_non_null(fp);
+        monitor_bin_begin(fp, 0, NULL);
+
+        data.values.llc = 1024;
+        record_get(0, 0, &rec);
+        rec.missed = 2;
+        rec.dropped = 1;
+        monitor_bin_header(fp, "", 0, NULL);
+        monitor_bin_row(fp, "", &rec);
+        monitor_bin_footer(fp);
+
+        record_get(0, 0, &rec);
+        rec.missed = 3;
+        rec.dropped = 1;
+        monitor_bin_header(fp, "", 0, NULL);
+        monitor_bin_row(fp, "", &rec);
+        monitor_bin_footer(fp);
+
+        monitor_bin_end(fp);
+        fclose(fp);
+        rt_mode = 0;
+
+        bin_decode(path, csv, sizeof(csv));
+        unlink(path);
+
+        assert_string_equal(csv, "Time,Core,LLC[KB],Missed,Dropped\n"
+                                 ",\"0\",1.0,2,1\n"
+                                 ",\"0\",1.0,3,1\n");
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_monitor_bin_round_trip),
+            cmocka_unit_test(test_monitor_bin_llc_percent),
+            cmocka_unit_test(test_monitor_bin_rt)};
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}